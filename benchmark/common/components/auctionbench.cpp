@@ -0,0 +1,69 @@
+/* Conquer Space
+ * Copyright (C) 2021-2023 Conquer Space
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <benchmark/benchmark.h>
+
+#include "common/components/auction.h"
+#include "common/systems/economy/auctionhandler.h"
+
+using cqsp::common::components::AuctionHouse;
+using cqsp::common::components::Order;
+
+namespace {
+const entt::entity good = static_cast<entt::entity>(1);
+const entt::entity agent = static_cast<entt::entity>(2);
+const double quantity = 10;
+
+// Each iteration fills the best order on the book, and then puts an order with the same price back,
+// so the depth of the book stays the same
+void BM_AuctionBuyGood(benchmark::State& state) {
+    AuctionHouse auction_house;
+    for (int i = 0; i < state.range(0); i++) {
+        auction_house.AddSellOrder(good, Order(100 + i * 0.01, quantity, agent));
+    }
+    double price = auction_house.sell_orders[good].front().price;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(cqsp::common::systems::BuyGood(auction_house, agent, good, price, quantity));
+        benchmark::DoNotOptimize(cqsp::common::systems::SellGood(auction_house, agent, good, price, quantity));
+    }
+}
+BENCHMARK(BM_AuctionBuyGood)->RangeMultiplier(8)->Range(8, 32768);
+
+void BM_AuctionSellGood(benchmark::State& state) {
+    AuctionHouse auction_house;
+    for (int i = 0; i < state.range(0); i++) {
+        auction_house.AddBuyOrder(good, Order(100 - i * 0.001, quantity, agent));
+    }
+    double price = auction_house.buy_orders[good].front().price;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(cqsp::common::systems::SellGood(auction_house, agent, good, price, quantity));
+        benchmark::DoNotOptimize(cqsp::common::systems::BuyGood(auction_house, agent, good, price, quantity));
+    }
+}
+BENCHMARK(BM_AuctionSellGood)->RangeMultiplier(8)->Range(8, 32768);
+
+void BM_AuctionGetSupply(benchmark::State& state) {
+    AuctionHouse auction_house;
+    for (int i = 0; i < state.range(0); i++) {
+        auction_house.AddSellOrder(good, Order(100 + i * 0.01, quantity, agent));
+    }
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(auction_house.GetSupply(good));
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_AuctionGetSupply)->RangeMultiplier(8)->Range(8, 32768);
+}  // namespace
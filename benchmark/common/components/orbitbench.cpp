@@ -0,0 +1,93 @@
+/* Conquer Space
+ * Copyright (C) 2021-2023 Conquer Space
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <benchmark/benchmark.h>
+
+#include <vector>
+
+#include "common/components/orbit.h"
+#include "common/components/units.h"
+
+namespace cqspt = cqsp::common::components::types;
+
+namespace {
+const int sample_count = 256;
+
+/// Evenly spaced angles from 0 to 2pi, so that every iteration doesn't solve the same problem
+std::vector<double> SampleAngles() {
+    std::vector<double> angles(sample_count);
+    for (int i = 0; i < sample_count; i++) {
+        angles[i] = cqspt::TWOPI * i / sample_count;
+    }
+    return angles;
+}
+
+// Eccentricity is passed in hundredths
+void BM_SolveKeplerElliptic(benchmark::State& state) {
+    const double ecc = state.range(0) / 100.;
+    std::vector<double> mean_anomalies = SampleAngles();
+    for (auto _ : state) {
+        for (double mean_anomaly : mean_anomalies) {
+            benchmark::DoNotOptimize(cqspt::SolveKeplerElliptic(mean_anomaly, ecc));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * sample_count);
+}
+BENCHMARK(BM_SolveKeplerElliptic)->Arg(0)->Arg(10)->Arg(50)->Arg(90)->Arg(99);
+
+void BM_OrbitToVec3(benchmark::State& state) {
+    std::vector<double> true_anomalies = SampleAngles();
+    for (auto _ : state) {
+        for (double v : true_anomalies) {
+            benchmark::DoNotOptimize(cqspt::OrbitToVec3(149598023, 0.0167086, 0.1, 3.0, 1.99, v));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * sample_count);
+}
+BENCHMARK(BM_OrbitToVec3);
+
+void BM_Vec3ToOrbit(benchmark::State& state) {
+    // State vectors of an earth-like orbit around the sun
+    std::vector<glm::dvec3> positions;
+    std::vector<glm::dvec3> velocities;
+    cqspt::Orbit orbit(149598023, 0.0167086, 0.1, 3.0, 1.99, 0);
+    for (double v : SampleAngles()) {
+        positions.push_back(cqspt::OrbitToVec3(orbit.semi_major_axis, orbit.eccentricity, orbit.inclination,
+                                               orbit.LAN, orbit.w, v));
+        velocities.push_back(cqspt::OrbitVelocityToVec3(orbit, v));
+    }
+    for (auto _ : state) {
+        for (int i = 0; i < sample_count; i++) {
+            benchmark::DoNotOptimize(cqspt::Vec3ToOrbit(positions[i], velocities[i], cqspt::SunMu, 0));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * sample_count);
+}
+BENCHMARK(BM_Vec3ToOrbit);
+
+// What SysOrbit does for every body every tick
+void BM_UpdateOrbit(benchmark::State& state) {
+    cqspt::Orbit orbit(149598023, 0.0167086, 0.1, 3.0, 1.99, 0);
+    double time = 0;
+    for (auto _ : state) {
+        time += 60;
+        cqspt::UpdateOrbit(orbit, time);
+        benchmark::DoNotOptimize(cqspt::toVec3(orbit));
+        benchmark::DoNotOptimize(cqspt::OrbitVelocityToVec3(orbit, orbit.v));
+    }
+}
+BENCHMARK(BM_UpdateOrbit);
+}  // namespace
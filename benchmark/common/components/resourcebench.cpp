@@ -0,0 +1,103 @@
+/* Conquer Space
+ * Copyright (C) 2021-2023 Conquer Space
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <benchmark/benchmark.h>
+
+#include "common/components/resource.h"
+
+namespace cqspc = cqsp::common::components;
+
+namespace {
+/// Ledger with `count` goods, every other one of which is also in a ledger made with `offset` 1
+cqspc::ResourceLedger MakeLedger(int count, int offset = 0) {
+    cqspc::ResourceLedger ledger;
+    for (int i = 0; i < count; i++) {
+        ledger[static_cast<entt::entity>(i * 2 + offset * (i % 2))] = i + 1;
+    }
+    return ledger;
+}
+
+void BM_LedgerAdd(benchmark::State& state) {
+    cqspc::ResourceLedger ledger = MakeLedger(state.range(0));
+    cqspc::ResourceLedger other = MakeLedger(state.range(0), 1);
+    for (auto _ : state) {
+        ledger += other;
+        benchmark::DoNotOptimize(ledger);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_LedgerAdd)->RangeMultiplier(4)->Range(8, 2048);
+
+void BM_LedgerMultiply(benchmark::State& state) {
+    cqspc::ResourceLedger ledger = MakeLedger(state.range(0));
+    cqspc::ResourceLedger other = MakeLedger(state.range(0), 1);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(ledger * other);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_LedgerMultiply)->RangeMultiplier(4)->Range(8, 2048);
+
+void BM_LedgerScale(benchmark::State& state) {
+    cqspc::ResourceLedger ledger = MakeLedger(state.range(0));
+    for (auto _ : state) {
+        ledger *= 1.0000001;
+        benchmark::DoNotOptimize(ledger);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_LedgerScale)->RangeMultiplier(4)->Range(8, 2048);
+
+void BM_LedgerSafeDivision(benchmark::State& state) {
+    cqspc::ResourceLedger ledger = MakeLedger(state.range(0));
+    cqspc::ResourceLedger other = MakeLedger(state.range(0), 1);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(ledger.SafeDivision(other));
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_LedgerSafeDivision)->RangeMultiplier(4)->Range(8, 2048);
+
+void BM_LedgerMultiplyAdd(benchmark::State& state) {
+    cqspc::ResourceLedger ledger = MakeLedger(state.range(0));
+    cqspc::ResourceLedger other = MakeLedger(state.range(0), 1);
+    for (auto _ : state) {
+        ledger.MultiplyAdd(other, 0.5);
+        benchmark::DoNotOptimize(ledger);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_LedgerMultiplyAdd)->RangeMultiplier(4)->Range(8, 2048);
+
+void BM_LedgerGetSum(benchmark::State& state) {
+    cqspc::ResourceLedger ledger = MakeLedger(state.range(0));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(ledger.GetSum());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_LedgerGetSum)->RangeMultiplier(4)->Range(8, 2048);
+
+void BM_LedgerCopyVals(benchmark::State& state) {
+    cqspc::ResourceLedger keys = MakeLedger(state.range(0) / 4);
+    cqspc::ResourceLedger values = MakeLedger(state.range(0), 1);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(cqspc::CopyVals(keys, values).Min());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_LedgerCopyVals)->RangeMultiplier(4)->Range(8, 2048);
+}  // namespace
@@ -0,0 +1,145 @@
+/* Conquer Space
+ * Copyright (C) 2021-2023 Conquer Space
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <benchmark/benchmark.h>
+
+#include <type_traits>
+
+#include "common/components/area.h"
+#include "common/components/bodies.h"
+#include "common/components/coordinates.h"
+#include "common/components/economy.h"
+#include "common/components/history.h"
+#include "common/components/infrastructure.h"
+#include "common/components/orbit.h"
+#include "common/components/population.h"
+#include "common/components/resource.h"
+#include "common/components/science.h"
+#include "common/components/surface.h"
+#include "common/game.h"
+#include "common/util/universefork.h"
+#include "syntheticuniverse.h"
+
+namespace {
+namespace cqspc = cqsp::common::components;
+namespace cqspt = cqsp::common::components::types;
+
+template <typename T>
+size_t CopyWholePool(cqsp::common::Universe& source, cqsp::common::Universe& copy) {
+    auto& pool = source.storage<T>();
+    const entt::sparse_set& entities = pool;
+    if constexpr (std::is_empty_v<T>) {
+        copy.insert<T>(entities.rbegin(), entities.rend());
+    } else {
+        copy.insert<T>(entities.rbegin(), entities.rend(), pool.rbegin());
+    }
+    return pool.empty() ? 0 : 1;
+}
+
+// Markets can't be copied as a whole because of the connected markets, so everything else is copied by hand
+size_t CopyWholeMarkets(cqsp::common::Universe& source, cqsp::common::Universe& copy) {
+    const entt::sparse_set& entities = source.storage<cqspc::Market>();
+    for (auto it = entities.rbegin(); it != entities.rend(); it++) {
+        const cqspc::Market& market = source.get<cqspc::Market>(*it);
+        auto& market_copy = copy.emplace<cqspc::Market>(*it);
+        static_cast<cqspc::MarketInformation&>(market_copy) = market;
+        market_copy.history = market.history;
+        market_copy.market_information = market.market_information;
+        market_copy.last_market_information = market.last_market_information;
+        market_copy.participants = market.participants;
+        market_copy.GDP = market.GDP;
+    }
+    return entities.empty() ? 0 : 1;
+}
+
+/// <summary>
+/// Copies every entity and every component of the synthetic universe, with the full market history. This is
+/// what a fork would cost if it didn't leave anything out.
+/// </summary>
+/// Returns the number of pools that were copied, so that the benchmark can check that nothing was missed.
+size_t CopyRegistry(cqsp::common::Universe& source, cqsp::common::Universe& copy) {
+    const entt::entity* entities = source.data();
+    for (size_t i = 0; i < source.size(); i++) {
+        if (source.valid(entities[i])) {
+            copy.create(entities[i]);
+        }
+    }
+    return CopyWholeMarkets(source, copy) + CopyWholePool<cqspc::MarketHistory>(source, copy) +
+           CopyWholePool<cqspc::PlanetaryMarket>(source, copy) + CopyWholePool<cqspc::MarketAgent>(source, copy) +
+           CopyWholePool<cqspc::Wallet>(source, copy) + CopyWholePool<cqspc::Price>(source, copy) +
+           CopyWholePool<cqspc::ConsumerGood>(source, copy) + CopyWholePool<cqspc::Recipe>(source, copy) +
+           CopyWholePool<cqspc::IndustrySize>(source, copy) + CopyWholePool<cqspc::Production>(source, copy) +
+           CopyWholePool<cqspc::IndustrialZone>(source, copy) + CopyWholePool<cqspc::Habitation>(source, copy) +
+           CopyWholePool<cqspc::Settlement>(source, copy) + CopyWholePool<cqspc::PopulationSegment>(source, copy) +
+           CopyWholePool<cqspc::infrastructure::CityInfrastructure>(source, copy) +
+           CopyWholePool<cqspc::infrastructure::PowerPlant>(source, copy) +
+           CopyWholePool<cqspc::infrastructure::PowerConsumption>(source, copy) +
+           CopyWholePool<cqspc::science::Lab>(source, copy) +
+           CopyWholePool<cqspc::science::ScientificResearch>(source, copy) +
+           CopyWholePool<cqspc::science::Technology>(source, copy) +
+           CopyWholePool<cqspc::bodies::Body>(source, copy) +
+           CopyWholePool<cqspc::bodies::OrbitalSystem>(source, copy) + CopyWholePool<cqspt::Orbit>(source, copy) +
+           CopyWholePool<cqspt::Kinematics>(source, copy);
+}
+
+size_t CountPools(cqsp::common::Universe& universe) {
+    size_t pools = 0;
+    for (auto&& [id, storage] : universe.storage()) {
+        pools += storage.empty() ? 0 : 1;
+    }
+    return pools;
+}
+
+void BuildUniverse(cqsp::common::Game& game, benchmark::State& state) {
+    cqsp::bench::SyntheticUniverseSize size;
+    size.cities_per_planet = state.range(0);
+    size.satellites_per_planet = state.range(0) * 2;
+    cqsp::bench::BuildSyntheticUniverse(game, size);
+}
+
+/// Forks the universe the way a forecast does
+void BM_ForkUniverse(benchmark::State& state) {
+    cqsp::common::Game game;
+    BuildUniverse(game, state);
+    cqsp::common::util::ForkStats stats;
+    for (auto _ : state) {
+        cqsp::common::Universe fork;
+        stats = cqsp::common::util::ForkUniverse(game.GetUniverse(), fork);
+        benchmark::DoNotOptimize(fork.size());
+    }
+    state.counters["entities"] = static_cast<double>(stats.entities);
+    state.counters["components"] = static_cast<double>(stats.components);
+}
+
+/// Copies the whole registry, to compare the fork against
+void BM_CopyRegistry(benchmark::State& state) {
+    cqsp::common::Game game;
+    BuildUniverse(game, state);
+    size_t pools = 0;
+    for (auto _ : state) {
+        cqsp::common::Universe copy;
+        pools = CopyRegistry(game.GetUniverse(), copy);
+        benchmark::DoNotOptimize(copy.size());
+    }
+    if (pools != CountPools(game.GetUniverse())) {
+        state.SkipWithError("The synthetic universe has pools that the registry copy doesn't know about");
+    }
+    state.counters["entities"] = static_cast<double>(game.GetUniverse().alive());
+}
+
+BENCHMARK(BM_ForkUniverse)->Arg(4)->Arg(16)->Arg(64)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_CopyRegistry)->Arg(4)->Arg(16)->Arg(64)->Unit(benchmark::kMillisecond);
+}  // namespace
@@ -0,0 +1,78 @@
+/* Conquer Space
+ * Copyright (C) 2021-2023 Conquer Space
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <benchmark/benchmark.h>
+#include <hjson.h>
+
+#include <memory>
+#include <string>
+
+#include "common/systems/loading/loadgoods.h"
+#include "common/systems/names/namegenerator.h"
+#include "common/universe.h"
+#include "common/util/random/stdrandom.h"
+
+namespace {
+Hjson::Value MakeGoods(int count) {
+    Hjson::Value goods(Hjson::Type::Vector);
+    for (int i = 0; i < count; i++) {
+        Hjson::Value good;
+        good["identifier"] = "good_" + std::to_string(i);
+        good["name"] = "Good " + std::to_string(i);
+        good["price"] = i;
+        good["mass"] = "1000 kg";
+        good["volume"] = "1 m3";
+        goods.push_back(good);
+    }
+    return goods;
+}
+
+void BM_HjsonLoaderGoods(benchmark::State& state) {
+    Hjson::Value goods = MakeGoods(state.range(0));
+    for (auto _ : state) {
+        state.PauseTiming();
+        auto universe = std::make_unique<cqsp::common::Universe>("bench");
+        state.ResumeTiming();
+        cqsp::common::systems::loading::GoodLoader loader(*universe);
+        benchmark::DoNotOptimize(loader.LoadHjson(goods));
+        state.PauseTiming();
+        universe.reset();
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_HjsonLoaderGoods)->RangeMultiplier(8)->Range(64, 4096)->Unit(benchmark::kMicrosecond);
+
+void BM_NameGeneratorGenerate(benchmark::State& state) {
+    Hjson::Value value = Hjson::Unmarshal(R"({
+        name: bench
+        rules: {
+            city: "{prefix}{middle}{suffix}"
+        }
+        prefix: [Ael, Ash, Bel, Cor, Dun, Eld, Fal, Gar]
+        middle: [a, e, i, o, u, ae, io]
+        suffix: [burn, ford, ham, ton, wick, mouth, dale]
+    })");
+    cqsp::common::systems::names::NameGenerator generator;
+    generator.LoadNameGenerator(value);
+    cqsp::common::util::StdRandom random(31415);
+    generator.SetRandom(&random);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(generator.Generate("city"));
+    }
+}
+BENCHMARK(BM_NameGeneratorGenerate);
+}  // namespace
@@ -0,0 +1,70 @@
+/* Conquer Space
+ * Copyright (C) 2021-2023 Conquer Space
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <benchmark/benchmark.h>
+
+#include <vector>
+
+#include "common/systems/economy/marketclearing.h"
+
+using cqsp::common::systems::economy::ClearingParameters;
+using cqsp::common::systems::economy::ClearMarket;
+using cqsp::common::systems::economy::ClearMarkets;
+
+namespace {
+// Every market starts with a different imbalance between supply and demand for every good
+void FillMarkets(size_t size, std::vector<double>& supply, std::vector<double>& demand, std::vector<double>& price) {
+    supply.resize(size);
+    demand.resize(size);
+    price.resize(size);
+    for (size_t i = 0; i < size; i++) {
+        supply[i] = 100 + static_cast<double>(i % 17) * 10;
+        demand[i] = 100 + static_cast<double>(i % 13) * 12;
+        price[i] = 1 + static_cast<double>(i % 5);
+    }
+}
+
+void BM_ClearMarket(benchmark::State& state) {
+    const size_t goods = state.range(0);
+    std::vector<double> supply, demand, price;
+    ClearingParameters parameters;
+    for (auto _ : state) {
+        state.PauseTiming();
+        FillMarkets(goods, supply, demand, price);
+        state.ResumeTiming();
+        ClearMarket(supply, demand, price, parameters);
+        benchmark::DoNotOptimize(price.data());
+    }
+    state.SetItemsProcessed(state.iterations() * goods);
+}
+BENCHMARK(BM_ClearMarket)->RangeMultiplier(4)->Range(16, 1024);
+
+void BM_ClearMarkets(benchmark::State& state) {
+    const size_t goods = 128;
+    const size_t markets = state.range(0);
+    std::vector<double> supply, demand, price;
+    ClearingParameters parameters;
+    for (auto _ : state) {
+        state.PauseTiming();
+        FillMarkets(goods * markets, supply, demand, price);
+        state.ResumeTiming();
+        ClearMarkets(goods, supply, demand, price, parameters);
+        benchmark::DoNotOptimize(price.data());
+    }
+    state.SetItemsProcessed(state.iterations() * goods * markets);
+}
+BENCHMARK(BM_ClearMarkets)->RangeMultiplier(4)->Range(4, 1024)->UseRealTime();
+}  // namespace
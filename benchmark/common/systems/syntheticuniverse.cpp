@@ -0,0 +1,215 @@
+/* Conquer Space
+ * Copyright (C) 2021-2023 Conquer Space
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "syntheticuniverse.h"
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include "common/components/area.h"
+#include "common/components/bodies.h"
+#include "common/components/coordinates.h"
+#include "common/components/economy.h"
+#include "common/components/infrastructure.h"
+#include "common/components/orbit.h"
+#include "common/components/organizations.h"
+#include "common/components/player.h"
+#include "common/components/population.h"
+#include "common/components/resource.h"
+#include "common/components/science.h"
+#include "common/components/surface.h"
+#include "common/components/units.h"
+#include "common/systems/economy/markethelpers.h"
+#include "common/systems/economy/sysmarket.h"
+
+namespace cqsp::bench {
+namespace cqspc = cqsp::common::components;
+namespace cqspt = cqsp::common::components::types;
+
+namespace {
+using Random = std::mt19937;
+
+double Uniform(Random& random, double min, double max) {
+    return std::uniform_real_distribution<double>(min, max)(random);
+}
+
+entt::entity Pick(Random& random, const std::vector<entt::entity>& list) {
+    return list[std::uniform_int_distribution<size_t>(0, list.size() - 1)(random)];
+}
+
+entt::entity CreateBody(common::Universe& universe, entt::entity parent, double radius, double GM, double a,
+                        Random& random) {
+    entt::entity entity = universe.create();
+    auto& body = universe.emplace<cqspc::bodies::Body>(entity);
+    body.radius = radius;
+    body.GM = GM;
+    body.mass = cqspc::bodies::CalculateMass(GM);
+    auto& parent_body = universe.get<cqspc::bodies::Body>(parent);
+
+    cqspt::Orbit& orbit = universe.emplace<cqspt::Orbit>(entity, a, Uniform(random, 0, 0.2), Uniform(random, 0, 0.1),
+                                                         Uniform(random, 0, cqspt::TWOPI),
+                                                         Uniform(random, 0, cqspt::TWOPI), Uniform(random, 0, 3));
+    orbit.reference_body = parent;
+    orbit.GM = parent_body.GM;
+    orbit.CalculateVariables();
+    body.SOI = cqspc::bodies::CalculateSOI(GM, orbit.GM, a);
+    universe.emplace<cqspt::Kinematics>(entity);
+    universe.get_or_emplace<cqspc::bodies::OrbitalSystem>(parent).push_back(entity);
+    return entity;
+}
+
+void CreateCity(common::Universe& universe, entt::entity planet, entt::entity province,
+                const SyntheticUniverseSize& size, const std::vector<entt::entity>& recipes,
+                const std::vector<entt::entity>& technologies, Random& random) {
+    entt::entity city = universe.create();
+    universe.get<cqspc::Habitation>(planet).settlements.push_back(city);
+    auto& coordinate =
+        universe.emplace<cqspt::SurfaceCoordinate>(city, Uniform(random, -90, 90), Uniform(random, -180, 180));
+    coordinate.planet = planet;
+    auto& province_component = universe.get<cqspc::Province>(province);
+    province_component.cities.push_back(city);
+    universe.emplace<cqspc::Governed>(city, province_component.country);
+    common::systems::economy::CreateMarket(universe, city);
+    universe.emplace<cqspc::infrastructure::CityInfrastructure>(city, 10., 0.);
+    universe.emplace<cqspc::Wallet>(city);
+
+    auto& settlement = universe.emplace<cqspc::Settlement>(city);
+    for (int i = 0; i < size.segments_per_city; i++) {
+        entt::entity segment = universe.create();
+        auto population = static_cast<uint64_t>(Uniform(random, 1e5, 1e7));
+        universe.emplace<cqspc::PopulationSegment>(segment, population, population / 2);
+        universe.emplace<cqspc::Wallet>(segment);
+        settlement.population.push_back(segment);
+    }
+
+    auto& zone = universe.emplace<cqspc::IndustrialZone>(city);
+    for (int i = 0; i < size.industries_per_city; i++) {
+        entt::entity industry = universe.create();
+        universe.emplace<cqspc::Production>(industry, cqspc::ProductionType::factory, Pick(random, recipes));
+        universe.emplace<cqspc::IndustrySize>(industry, Uniform(random, 100, 10000), Uniform(random, 10, 100));
+        universe.emplace<cqspc::Wallet>(industry);
+        if (i % 4 == 0) {
+            universe.emplace<cqspc::infrastructure::PowerPlant>(industry, Uniform(random, 100, 1000));
+        } else {
+            universe.emplace<cqspc::infrastructure::PowerConsumption>(industry, Uniform(random, 10, 100), 0., 0.);
+        }
+        zone.industries.push_back(industry);
+    }
+
+    auto& lab = universe.emplace<cqspc::science::Lab>(city);
+    lab.science_contribution[Pick(random, recipes)] = 1;
+
+    // Cities stand in for civilizations, so that the amount of research grows with the universe
+    auto& research = universe.emplace<cqspc::science::ScientificResearch>(city);
+    for (int i = 0; i < size.research_per_city; i++) {
+        research.current_research[Pick(random, technologies)] = 0;
+    }
+}
+}  // namespace
+
+void BuildSyntheticUniverse(common::Game& game, const SyntheticUniverseSize& size) {
+    common::Universe& universe = game.GetUniverse();
+    Random random(42);
+
+    std::vector<entt::entity> goods;
+    for (int i = 0; i < size.goods; i++) {
+        entt::entity good = universe.create();
+        universe.emplace<cqspc::Price>(good, Uniform(random, 1, 100));
+        universe.goods["good_" + std::to_string(i)] = good;
+        if (i < size.consumer_goods) {
+            universe.emplace<cqspc::ConsumerGood>(good, Uniform(random, 0.001, 0.01),
+                                                  Uniform(random, 0.01, 0.5 / size.consumer_goods));
+            universe.consumergoods.push_back(good);
+        }
+        goods.push_back(good);
+    }
+
+    // One recipe for every good, made out of two other goods
+    std::vector<entt::entity> recipes;
+    for (int i = 0; i < size.goods; i++) {
+        entt::entity entity = universe.create();
+        auto& recipe = universe.emplace<cqspc::Recipe>(entity);
+        recipe.output.entity = goods[i];
+        recipe.output.amount = 1;
+        recipe.input[Pick(random, goods)] = Uniform(random, 0.1, 2);
+        recipe.input[Pick(random, goods)] = Uniform(random, 0.1, 2);
+        recipe.capitalcost[Pick(random, goods)] = Uniform(random, 0.1, 2);
+        recipe.workers = Uniform(random, 1, 10);
+        universe.recipes["recipe_" + std::to_string(i)] = entity;
+        recipes.push_back(entity);
+    }
+
+    // Technologies unlock a recipe, and take long enough that a benchmark only finishes a few of them
+    std::vector<entt::entity> technologies;
+    for (int i = 0; i < size.technologies; i++) {
+        entt::entity entity = universe.create();
+        auto& technology = universe.emplace<cqspc::science::Technology>(entity);
+        technology.actions.push_back("recipe:recipe_" + std::to_string(i % size.goods));
+        technology.difficulty = static_cast<int>(Uniform(random, 1e4, 1e8));
+        universe.technologies["technology_" + std::to_string(i)] = entity;
+        technologies.push_back(entity);
+    }
+
+    universe.sun = universe.create();
+    auto& sun = universe.emplace<cqspc::bodies::Body>(universe.sun);
+    sun.radius = 696340;
+    sun.GM = cqspt::SunMu;
+    sun.mass = cqspc::bodies::CalculateMass(sun.GM);
+    universe.emplace<cqspt::Orbit>(universe.sun);
+    universe.emplace<cqspt::Kinematics>(universe.sun);
+
+    for (int p = 0; p < size.planets; p++) {
+        double a = cqspt::KmInAu * (0.4 + p * 0.7);
+        entt::entity planet = CreateBody(universe, universe.sun, 6000, 4e5, a, random);
+        universe.planets["planet_" + std::to_string(p)] = planet;
+        common::systems::economy::CreateMarket(universe, planet);
+        universe.emplace<cqspc::PlanetaryMarket>(planet);
+        universe.emplace<cqspc::Habitation>(planet);
+
+        // A country with one province on every planet, and the player owns the first one
+        entt::entity country = universe.create();
+        universe.emplace<cqspc::Country>(country);
+        if (p == 0) {
+            universe.emplace<cqspc::Player>(country);
+        }
+        entt::entity province = universe.create();
+        universe.emplace<cqspc::Province>(province, country);
+        for (int c = 0; c < size.cities_per_planet; c++) {
+            CreateCity(universe, planet, province, size, recipes, technologies, random);
+        }
+
+        const double soi = universe.get<cqspc::bodies::Body>(planet).SOI;
+        for (int m = 0; m < size.moons_per_planet; m++) {
+            CreateBody(universe, planet, 1700, 5e3, soi * Uniform(random, 0.05, 0.3), random);
+        }
+        // Satellites don't have a body of their own
+        for (int s = 0; s < size.satellites_per_planet; s++) {
+            entt::entity satellite = universe.create();
+            cqspt::Orbit& orbit = universe.emplace<cqspt::Orbit>(
+                satellite, Uniform(random, 7000, 40000), Uniform(random, 0, 0.1), Uniform(random, 0, cqspt::PI),
+                Uniform(random, 0, cqspt::TWOPI), Uniform(random, 0, cqspt::TWOPI), Uniform(random, 0, 3));
+            orbit.reference_body = planet;
+            orbit.GM = universe.get<cqspc::bodies::Body>(planet).GM;
+            orbit.CalculateVariables();
+            universe.emplace<cqspt::Kinematics>(satellite);
+            universe.get_or_emplace<cqspc::bodies::OrbitalSystem>(planet).push_back(satellite);
+        }
+    }
+
+    common::systems::SysMarket::InitializeMarket(game);
+}
+}  // namespace cqsp::bench
@@ -0,0 +1,48 @@
+/* Conquer Space
+ * Copyright (C) 2021-2023 Conquer Space
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include "common/game.h"
+
+namespace cqsp::bench {
+/// <summary>
+/// How big a synthetic universe is.
+/// </summary>
+struct SyntheticUniverseSize {
+    int goods = 64;
+    /// The first goods are consumer goods
+    int consumer_goods = 8;
+    int planets = 8;
+    int cities_per_planet = 16;
+    int industries_per_city = 8;
+    int segments_per_city = 2;
+    int moons_per_planet = 2;
+    int satellites_per_planet = 32;
+    int technologies = 64;
+    int research_per_city = 4;
+};
+
+/// <summary>
+/// Fills the universe of the game with randomly generated goods, recipes, technologies, planets, cities
+/// and orbits, without loading any assets.
+/// </summary>
+/// Every planet has a country with one province holding all of its cities, and the player is the country on
+/// the first planet.
+/// The universe has everything the economy and orbit systems need to run, and is generated the same way
+/// for the same size so that the results can be compared between commits.
+void BuildSyntheticUniverse(common::Game& game, const SyntheticUniverseSize& size);
+}  // namespace cqsp::bench
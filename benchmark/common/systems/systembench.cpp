@@ -0,0 +1,125 @@
+/* Conquer Space
+ * Copyright (C) 2021-2023 Conquer Space
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <benchmark/benchmark.h>
+
+#include <utility>
+#include <vector>
+
+#include "common/components/bodies.h"
+#include "common/components/coordinates.h"
+#include "common/components/orbit.h"
+#include "common/components/surface.h"
+#include "common/game.h"
+#include "common/systems/economy/sysfactory.h"
+#include "common/systems/economy/sysfinance.h"
+#include "common/systems/economy/sysinfrastructure.h"
+#include "common/systems/economy/syslod.h"
+#include "common/systems/economy/sysmarket.h"
+#include "common/systems/economy/syspopulation.h"
+#include "common/systems/economy/systrade.h"
+#include "common/systems/history/sysmarkethistory.h"
+#include "common/systems/movement/sysmovement.h"
+#include "common/systems/population/sysrollup.h"
+#include "common/systems/science/syssciencelab.h"
+#include "common/systems/science/systechnology.h"
+#include "syntheticuniverse.h"
+
+namespace cqspc = cqsp::common::components;
+namespace cqspcs = cqsp::common::systems;
+namespace cqspt = cqsp::common::components::types;
+
+namespace {
+/// <summary>
+/// Runs one system over and over on a synthetic universe, with the given number of cities per planet.
+/// </summary>
+/// SysScript isn't covered because it needs the lua scripts from the assets.
+template <typename T>
+void BM_System(benchmark::State& state) {
+    cqsp::common::Game game;
+    cqsp::bench::SyntheticUniverseSize size;
+    size.cities_per_planet = state.range(0);
+    size.satellites_per_planet = state.range(0) * 2;
+    cqsp::bench::BuildSyntheticUniverse(game, size);
+
+    T system(game);
+    for (auto _ : state) {
+        game.GetUniverse().date.IncrementDate();
+        system.DoSystem();
+        game.GetTickArenas().Reset();
+    }
+    state.counters["entities"] = static_cast<double>(game.GetUniverse().size());
+}
+
+/// <summary>
+/// SysPath only has work while ships are moving, so every satellite that isn't moving anymore is sent to the
+/// next satellite around the same planet before each tick.
+/// </summary>
+void BM_SysPath(benchmark::State& state) {
+    cqsp::common::Game game;
+    cqsp::bench::SyntheticUniverseSize size;
+    size.cities_per_planet = state.range(0);
+    size.satellites_per_planet = state.range(0) * 2;
+    cqsp::bench::BuildSyntheticUniverse(game, size);
+    cqsp::common::Universe& universe = game.GetUniverse();
+
+    std::vector<std::pair<entt::entity, entt::entity>> moves;
+    for (entt::entity planet : universe.view<cqspc::bodies::OrbitalSystem, cqspc::Habitation>()) {
+        std::vector<entt::entity> satellites;
+        for (entt::entity body : universe.get<cqspc::bodies::OrbitalSystem>(planet).children) {
+            if (!universe.all_of<cqspc::bodies::Body>(body)) {
+                satellites.push_back(body);
+            }
+        }
+        for (size_t i = 0; i < satellites.size(); i++) {
+            moves.emplace_back(satellites[i], satellites[(i + 1) % satellites.size()]);
+        }
+    }
+
+    cqspcs::SysPath system(game);
+    for (auto _ : state) {
+        state.PauseTiming();
+        for (auto [ship, target] : moves) {
+            if (!universe.all_of<cqspt::MoveTarget>(ship)) {
+                universe.emplace<cqspt::MoveTarget>(ship, target);
+            }
+        }
+        state.ResumeTiming();
+        universe.date.IncrementDate();
+        system.DoSystem();
+        game.GetTickArenas().Reset();
+    }
+    state.counters["ships"] = static_cast<double>(moves.size());
+}
+
+#define SYSTEM_BENCHMARK(system) \
+    BENCHMARK_TEMPLATE(BM_System, system)->Arg(4)->Arg(16)->Arg(64)->Unit(benchmark::kMicrosecond)
+
+SYSTEM_BENCHMARK(cqspcs::SysWalletReset);
+SYSTEM_BENCHMARK(cqspcs::SysScienceLab);
+SYSTEM_BENCHMARK(cqspcs::SysTechProgress);
+SYSTEM_BENCHMARK(cqspcs::SysLod);
+SYSTEM_BENCHMARK(cqspcs::InfrastructureSim);
+SYSTEM_BENCHMARK(cqspcs::SysPopulationGrowth);
+SYSTEM_BENCHMARK(cqspcs::SysPopulationConsumption);
+SYSTEM_BENCHMARK(cqspcs::SysProduction);
+SYSTEM_BENCHMARK(cqspcs::SysMarket);
+SYSTEM_BENCHMARK(cqspcs::SysTrade);
+SYSTEM_BENCHMARK(cqspcs::history::SysMarketHistory);
+SYSTEM_BENCHMARK(cqspcs::SysRollup);
+SYSTEM_BENCHMARK(cqspcs::SysOrbit);
+BENCHMARK(BM_SysPath)->Arg(4)->Arg(16)->Arg(64)->Unit(benchmark::kMicrosecond);
+}  // namespace
@@ -0,0 +1,74 @@
+/* Conquer Space
+ * Copyright (C) 2021-2023 Conquer Space
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <benchmark/benchmark.h>
+
+#include <cmath>
+#include <vector>
+
+#include "common/components/orbit.h"
+#include "common/systems/movement/lambert.h"
+#include "common/systems/movement/transferplanner.h"
+
+namespace cqspt = cqsp::common::components::types;
+using cqsp::common::systems::LambertProblem;
+using cqsp::common::systems::LambertSolution;
+
+namespace {
+constexpr double earth_mu = 398600.4418;
+
+// Transfers from low orbit to points of different radius and angle, with different times of flight
+std::vector<LambertProblem> MakeProblems(size_t count) {
+    std::vector<LambertProblem> problems(count);
+    for (size_t i = 0; i < count; i++) {
+        const double angle = 0.2 + 5.8 * static_cast<double>(i % 97) / 97;
+        const double radius = 8000 + 40000 * static_cast<double>(i % 31) / 31;
+        problems[i].r1 = glm::dvec3(7000, 0, 0);
+        problems[i].r2 = glm::dvec3(radius * std::cos(angle), radius * std::sin(angle), 0);
+        problems[i].time_of_flight = 1800 + 60 * static_cast<double>(i % 401);
+        problems[i].GM = earth_mu;
+    }
+    return problems;
+}
+
+void BM_SolveLambert(benchmark::State& state) {
+    std::vector<LambertProblem> problems = MakeProblems(state.range(0));
+    std::vector<LambertSolution> solutions(problems.size());
+    for (auto _ : state) {
+        cqsp::common::systems::SolveLambert(problems, solutions);
+        benchmark::DoNotOptimize(solutions.data());
+    }
+    state.SetItemsProcessed(state.iterations() * problems.size());
+}
+BENCHMARK(BM_SolveLambert)->RangeMultiplier(8)->Range(64, 32768)->UseRealTime();
+
+// What planning a transfer costs when it isn't in the cache
+void BM_ComputePorkchop(benchmark::State& state) {
+    cqspt::Orbit origin(7000, 0.01, 0, 0, 0, 0);
+    origin.GM = earth_mu;
+    origin.CalculateVariables();
+    cqspt::Orbit target(42164, 0.01, 0.1, 0, 0, 1);
+    target.GM = earth_mu;
+    target.CalculateVariables();
+    cqsp::common::systems::PorkchopParameters parameters;
+    parameters.departure_steps = state.range(0);
+    parameters.flight_steps = state.range(0);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(cqsp::common::systems::ComputePorkchop(origin, target, 0, parameters));
+    }
+}
+BENCHMARK(BM_ComputePorkchop)->Arg(16)->Arg(32)->Arg(64)->UseRealTime();
+}  // namespace
@@ -0,0 +1,11 @@
+// Flat colored billboard, the color comes from the instance
+#version 330 core
+
+out vec4 FragColor;
+
+in vec4 Color;
+
+void main()
+{
+    FragColor = Color;
+}
@@ -0,0 +1,14 @@
+#version 330 core
+layout (location = 0) in vec3 iPos;
+// Per instance, in normalized device coordinates
+layout (location = 2) in vec2 instancePosition;
+layout (location = 3) in vec2 instanceSize;
+layout (location = 4) in vec4 instanceColor;
+
+out vec4 Color;
+
+void main()
+{
+    gl_Position = vec4(instancePosition + iPos.xy * instanceSize, 0.0, 1.0);
+    Color = instanceColor;
+}
@@ -26,6 +26,7 @@
 #include "common/components/organizations.h"
 #include "common/components/player.h"
 #include "common/components/surface.h"
+#include "common/systems/population/sysrollup.h"
 #include "common/util/nameutil.h"
 #include "common/util/utilnumberdisplay.h"
 
@@ -77,6 +78,9 @@ void cqsp::client::systems::CivilizationInfoPanel::CivInfoPanel() {
         auto& wallet = GetUniverse().get<common::components::Wallet>(player);
         ImGui::TextFmt("Reserves: {}", util::LongToHumanString(wallet.GetBalance()));
     }
+    const auto& rollup = common::systems::GetRollup(GetUniverse(), player);
+    ImGui::TextFmt("Population: {}", util::LongToHumanString(rollup.population));
+    ImGui::TextFmt("GDP: {}", util::LongToHumanString(static_cast<int64_t>(rollup.gdp)));
 
     if (ImGui::BeginTabBar("civ_info_window")) {
         if (ImGui::BeginTabItem("City Information")) {
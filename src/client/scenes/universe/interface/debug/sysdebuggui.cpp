@@ -20,6 +20,7 @@
 #include "client/components/clientctx.h"
 #include "client/scenes/universe/views/starsystemview.h"
 #include "common/components/name.h"
+#include "common/util/memorycensus.h"
 #include "common/util/nameutil.h"
 #include "common/util/profiler.h"
 #include "glad/glad.h"
@@ -51,6 +52,18 @@ SysDebugMenu::SysDebugMenu(Application& app) : SysUserInterface(app) {
         input.push_back(fmt::format("Total entities: {}, Alive: {}", universe.size(), universe.alive()));
     };
 
+    auto memory = [](sysdebuggui_parameters) {
+        // Optional number of pools to list
+        size_t pool_count = 10;
+        if (!args.empty() && std::all_of(args.begin(), args.end(), ::isdigit)) {
+            pool_count = std::stoul(std::string(args));
+        }
+        auto census = cqsp::common::util::TakeMemoryCensus(universe);
+        for (auto& line : cqsp::common::util::FormatMemoryCensus(census, pool_count)) {
+            input.push_back(std::move(line));
+        }
+    };
+
     auto entity_name = [](sysdebuggui_parameters) {
         if (std::all_of(args.begin(), args.end(), ::isdigit)) {
             namespace cqspc = cqsp::common::components;
@@ -74,6 +87,7 @@ SysDebugMenu::SysDebugMenu(Application& app) : SysUserInterface(app) {
                 {"mouseon", {"Get the entitiy the mouse is over", entity_command}},
                 {"clear", {"Clears screen", screen_clear}},
                 {"entitycount", {"Gets number of entities", entitycount}},
+                {"memory", {"Gets memory used by the universe, and the largest component pools", memory}},
                 {"name", {"Gets name and identifier of entity", entity_name}},
                 {"lua", {"Executes lua script", lua}}};
 }
@@ -33,6 +33,7 @@
 #include "common/components/ships.h"
 #include "common/components/surface.h"
 #include "common/systems/actions/shiplaunchaction.h"
+#include "common/systems/population/sysrollup.h"
 #include "common/util/nameutil.h"
 #include "common/util/utilnumberdisplay.h"
 #include "engine/cqspgui.h"
@@ -78,19 +79,10 @@ void SysProvinceInformation::ProvinceView() {
     ImGui::TextFmt("{}", common::util::GetName(GetUniverse(), current_country));
     // List the cities
     auto& city_list = GetUniverse().get<common::components::Province>(current_country);
-    int population = 0;
-    for (entt::entity entity : city_list.cities) {
-        using cqsp::common::components::PopulationSegment;
-        using cqsp::common::components::Settlement;
-        // Get city population
-        auto& settlement = GetUniverse().get<Settlement>(entity);
-        for (auto& seg_entity : settlement.population) {
-            auto& segment = GetUniverse().get<PopulationSegment>(seg_entity);
-            population += segment.population;
-        }
-    }
+    const auto& rollup = common::systems::GetRollup(GetUniverse(), current_country);
     ImGui::TextFmt("Part of {}", common::util::GetName(GetUniverse(), city_list.country));
-    ImGui::TextFmt("Population: {}", util::LongToHumanString(population));
+    ImGui::TextFmt("Population: {}", util::LongToHumanString(rollup.population));
+    ImGui::TextFmt("GDP: {}", util::LongToHumanString(static_cast<int64_t>(rollup.gdp)));
     ImGui::Separator();
     for (entt::entity entity : city_list.cities) {
         if (CQSPGui::DefaultSelectable(fmt::format("{}", common::util::GetName(GetUniverse(), entity)).c_str())) {
@@ -0,0 +1,167 @@
+/* Conquer Space
+ * Copyright (C) 2021-2023 Conquer Space
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "client/scenes/universe/views/orbitgeometry.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+
+#include <glm/gtc/quaternion.hpp>
+
+#include "common/util/parallel.h"
+
+namespace cqsp::client::systems {
+namespace cqspt = cqsp::common::components::types;
+
+OrbitShapeKey::OrbitShapeKey(const cqspt::Orbit& orb, double SOI)
+    : semi_major_axis(orb.semi_major_axis),
+      eccentricity(orb.eccentricity),
+      inclination(orb.inclination),
+      LAN(orb.LAN),
+      w(orb.w),
+      SOI(SOI) {}
+
+size_t OrbitShapeKeyHash::operator()(const OrbitShapeKey& key) const {
+    size_t seed = 0;
+    for (double value : {key.semi_major_axis, key.eccentricity, key.inclination, key.LAN, key.w, key.SOI}) {
+        seed ^= std::hash<double>()(value) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+    }
+    return seed;
+}
+
+namespace {
+struct OrbitSampler {
+    // Semi latus rectum
+    double p;
+    double e;
+    double max_angle_cos;
+    std::vector<glm::dvec2> points;
+
+    glm::dvec2 Point(double v) const {
+        double r = p / (1 + e * cos(v));
+        return glm::dvec2(r * cos(v), r * sin(v));
+    }
+
+    /// Adds points between v0 and v1, not including v0
+    void Subdivide(double v0, const glm::dvec2& p0, double v1, const glm::dvec2& p1, int depth) {
+        double vm = (v0 + v1) / 2;
+        glm::dvec2 pm = Point(vm);
+        glm::dvec2 a = pm - p0;
+        glm::dvec2 b = p1 - pm;
+        double len = glm::length(a) * glm::length(b);
+        if (depth > 0 && len > 0 && glm::dot(a, b) < max_angle_cos * len) {
+            Subdivide(v0, p0, vm, pm, depth - 1);
+            Subdivide(vm, pm, v1, p1, depth - 1);
+            return;
+        }
+        points.push_back(p1);
+    }
+};
+}  // namespace
+
+std::vector<glm::vec3> GenerateOrbitPoints(const OrbitShapeKey& key, double max_angle) {
+    const double a = key.semi_major_axis;
+    const double e = key.eccentricity;
+    const double p = a * (1 - e * e);
+    if (a == 0 || !std::isfinite(p) || p <= 0) {
+        return {};
+    }
+
+    // Range of true anomaly to draw
+    double v_begin = 0;
+    double v_end = cqspt::TWOPI;
+    auto soi_anomaly = [&]() {
+        // True anomaly where the orbit leaves the sphere of influence
+        return acos(std::clamp((p / key.SOI - 1) / e, -1., 1.));
+    };
+    if (e < 1) {
+        if (a * (1 + e) > key.SOI) {
+            v_end = soi_anomaly();
+            v_begin = -v_end;
+        }
+    } else {
+        // Stop a little short of the asymptote, where the radius goes to infinity
+        v_end = acos(-1 / e) * 0.98;
+        if (std::isfinite(key.SOI)) {
+            v_end = std::min(v_end, soi_anomaly());
+        }
+        v_begin = -v_end;
+    }
+
+    OrbitSampler sampler {p, e, cos(max_angle), {}};
+    const int initial_segments = 16;
+    const int max_depth = 8;
+    double step = (v_end - v_begin) / initial_segments;
+    glm::dvec2 previous = sampler.Point(v_begin);
+    sampler.points.push_back(previous);
+    for (int i = 0; i < initial_segments; i++) {
+        double v0 = v_begin + step * i;
+        double v1 = (i == initial_segments - 1) ? v_end : v0 + step;
+        glm::dvec2 next = sampler.Point(v1);
+        sampler.Subdivide(v0, previous, v1, next, max_depth);
+        previous = next;
+    }
+
+    // Rotate out of the orbital plane once for the whole orbit, instead of once per point. This is the same
+    // as `ConvertOrbParams`, followed by the swap of axes that the renderer does.
+    glm::dmat3 rotation = glm::mat3_cast(glm::dquat {glm::dvec3(0, 0, key.LAN)} *
+                                         glm::dquat {glm::dvec3(key.inclination, 0, 0)} *
+                                         glm::dquat {glm::dvec3(0, 0, key.w)});
+    glm::dmat3 swap(1, 0, 0, 0, 0, -1, 0, 1, 0);
+    glm::dmat3 transform = swap * rotation;
+
+    std::vector<glm::vec3> result;
+    result.reserve(sampler.points.size());
+    for (const auto& point : sampler.points) {
+        result.emplace_back(transform * glm::dvec3(point, 0));
+    }
+    return result;
+}
+
+std::vector<OrbitGeometryCache::Points> OrbitGeometryCache::Generate(const std::vector<OrbitShapeKey>& keys) {
+    std::vector<Points> result(keys.size());
+    // Orbits that have to be sampled, by index into `keys`
+    std::vector<size_t> missing;
+    for (size_t i = 0; i < keys.size(); i++) {
+        auto it = cache.find(keys[i]);
+        if (it != cache.end()) {
+            result[i] = it->second;
+        } else {
+            missing.push_back(i);
+        }
+    }
+    if (missing.empty()) {
+        return result;
+    }
+
+    auto generate_range = [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            result[missing[i]] = std::make_shared<const std::vector<glm::vec3>>(GenerateOrbitPoints(keys[missing[i]]));
+        }
+    };
+    common::util::ParallelFor(missing.size(), parallel_threshold, generate_range);
+
+    if (cache.size() + missing.size() > max_size) {
+        cache.clear();
+    }
+    for (size_t i : missing) {
+        cache.emplace(keys[i], result[i]);
+    }
+    return result;
+}
+}  // namespace cqsp::client::systems
@@ -0,0 +1,83 @@
+/* Conquer Space
+ * Copyright (C) 2021-2023 Conquer Space
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "common/components/orbit.h"
+
+namespace cqsp::client::systems {
+/// <summary>
+/// The elements that decide the shape of an orbit line.
+/// </summary>
+/// Where the body is on the orbit doesn't change the line, so orbits that only differ in
+/// mean anomaly or epoch share the same key.
+struct OrbitShapeKey {
+    double semi_major_axis = 0;
+    double eccentricity = 0;
+    double inclination = 0;
+    double LAN = 0;
+    double w = 0;
+    // Sphere of influence of the reference body, the line is cut off there
+    double SOI = 0;
+
+    OrbitShapeKey() = default;
+    OrbitShapeKey(const common::components::types::Orbit& orb, double SOI);
+
+    bool operator==(const OrbitShapeKey&) const = default;
+};
+
+struct OrbitShapeKeyHash {
+    size_t operator()(const OrbitShapeKey& key) const;
+};
+
+/// <summary>
+/// Samples the orbit into a line strip, in the coordinates that the star system renderer uses.
+/// </summary>
+/// The orbit is sampled by true anomaly, starting from 16 segments that are split in half until the line turns
+/// less than `max_angle` radians between the two halves. With the default angle a circular orbit ends up with 64
+/// segments, so 65 points, while eccentric orbits get more points around periapsis where they bend the most.
+/// <param name="max_angle">Maximum turning angle between segments, in radians</param>
+std::vector<glm::vec3> GenerateOrbitPoints(const OrbitShapeKey& key, double max_angle = 0.05);
+
+/// <summary>
+/// Cache of orbit lines keyed by their shape.
+/// </summary>
+class OrbitGeometryCache {
+ public:
+    using Points = std::shared_ptr<const std::vector<glm::vec3>>;
+
+    /// <summary>
+    /// Gets the lines for every key, generating the missing ones in parallel.
+    /// </summary>
+    std::vector<Points> Generate(const std::vector<OrbitShapeKey>& keys);
+
+    void Clear() { cache.clear(); }
+    size_t size() const { return cache.size(); }
+
+ private:
+    std::unordered_map<OrbitShapeKey, Points, OrbitShapeKeyHash> cache;
+    // Number of lines kept before the cache is flushed
+    static constexpr size_t max_size = 8192;
+    // Fewer missing shapes than this are generated on the calling thread
+    static constexpr size_t parallel_threshold = 32;
+};
+}  // namespace cqsp::client::systems
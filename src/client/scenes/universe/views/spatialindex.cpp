@@ -0,0 +1,313 @@
+/* Conquer Space
+ * Copyright (C) 2021-2023 Conquer Space
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "client/scenes/universe/views/spatialindex.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+
+namespace cqsp::client::systems {
+Frustum::Frustum(const glm::dmat4& m) {
+    // Gribb-Hartmann plane extraction, glm matrices are column major
+    glm::dvec4 row0(m[0][0], m[1][0], m[2][0], m[3][0]);
+    glm::dvec4 row1(m[0][1], m[1][1], m[2][1], m[3][1]);
+    glm::dvec4 row2(m[0][2], m[1][2], m[2][2], m[3][2]);
+    glm::dvec4 row3(m[0][3], m[1][3], m[2][3], m[3][3]);
+
+    planes = {row3 + row0, row3 - row0, row3 + row1, row3 - row1, row3 + row2, row3 - row2};
+    for (auto& plane : planes) {
+        double length = glm::length(glm::dvec3(plane));
+        if (length < 1e-12) {
+            // Infinite projections have no far plane, so let everything through
+            plane = glm::dvec4(0, 0, 0, 1);
+            continue;
+        }
+        plane /= length;
+    }
+}
+
+bool Frustum::SphereVisible(const glm::dvec3& center, double radius) const {
+    for (const auto& plane : planes) {
+        if (glm::dot(glm::dvec3(plane), center) + plane.w < -radius) {
+            return false;
+        }
+    }
+    return true;
+}
+
+namespace {
+bool RayIntersectsBox(const glm::dvec3& origin, const glm::dvec3& inv_dir, const glm::dvec3& min,
+                      const glm::dvec3& max, double max_dist) {
+    glm::dvec3 t0 = (min - origin) * inv_dir;
+    glm::dvec3 t1 = (max - origin) * inv_dir;
+    glm::dvec3 t_small = glm::min(t0, t1);
+    glm::dvec3 t_big = glm::max(t0, t1);
+    double t_enter = std::max({t_small.x, t_small.y, t_small.z, 0.0});
+    double t_exit = std::min({t_big.x, t_big.y, t_big.z, max_dist});
+    return t_enter <= t_exit;
+}
+
+/// Returns the distance to the first intersection with the sphere, or a negative number if it misses.
+/// If the origin is inside the sphere, the distance is 0.
+double RaySphereDistance(const glm::dvec3& origin, const glm::dvec3& direction, const glm::dvec3& center,
+                         double radius) {
+    glm::dvec3 sub = origin - center;
+    double b = glm::dot(direction, sub);
+    double c = glm::dot(sub, sub) - radius * radius;
+    double discriminant = b * b - c;
+    if (discriminant < 0) {
+        return -1;
+    }
+    double root = std::sqrt(discriminant);
+    if (-b + root < 0) {
+        // Sphere is behind the ray
+        return -1;
+    }
+    return std::max(-b - root, 0.0);
+}
+}  // namespace
+
+void BodyBVH::Build(std::vector<Primitive> _primitives) {
+    primitives = std::move(_primitives);
+    nodes.clear();
+    indices.resize(primitives.size());
+    for (int i = 0; i < static_cast<int>(indices.size()); i++) {
+        indices[i] = i;
+    }
+    if (primitives.empty()) {
+        return;
+    }
+    nodes.reserve(primitives.size() * 2 / max_leaf_size + 1);
+    BuildRecursive(0, static_cast<int>(primitives.size()));
+    RefitNodes();
+}
+
+int BodyBVH::BuildRecursive(int begin, int end) {
+    int node_idx = static_cast<int>(nodes.size());
+    nodes.push_back(Node {});
+    if (end - begin <= max_leaf_size) {
+        nodes[node_idx].offset = begin;
+        nodes[node_idx].count = end - begin;
+        return node_idx;
+    }
+
+    // Split along the axis with the largest spread of centers
+    glm::dvec3 c_min(std::numeric_limits<double>::max());
+    glm::dvec3 c_max(std::numeric_limits<double>::lowest());
+    for (int i = begin; i < end; i++) {
+        c_min = glm::min(c_min, primitives[indices[i]].center);
+        c_max = glm::max(c_max, primitives[indices[i]].center);
+    }
+    glm::dvec3 extent = c_max - c_min;
+    int axis = 0;
+    if (extent.y > extent[axis]) axis = 1;
+    if (extent.z > extent[axis]) axis = 2;
+
+    int mid = (begin + end) / 2;
+    std::nth_element(indices.begin() + begin, indices.begin() + mid, indices.begin() + end, [&](int a, int b) {
+        return primitives[a].center[axis] < primitives[b].center[axis];
+    });
+
+    BuildRecursive(begin, mid);
+    int right = BuildRecursive(mid, end);
+    nodes[node_idx].offset = right;
+    nodes[node_idx].count = 0;
+    return node_idx;
+}
+
+void BodyBVH::Refit(const std::vector<Primitive>& _primitives) {
+    bool same_topology = _primitives.size() == primitives.size();
+    for (size_t i = 0; same_topology && i < primitives.size(); i++) {
+        same_topology = primitives[i].entity == _primitives[i].entity;
+    }
+    if (!same_topology) {
+        Build(_primitives);
+        return;
+    }
+    std::copy(_primitives.begin(), _primitives.end(), primitives.begin());
+    RefitNodes();
+}
+
+void BodyBVH::RefitNodes() {
+    // Children always come after their parents, so walking backwards visits children first
+    for (int i = static_cast<int>(nodes.size()) - 1; i >= 0; i--) {
+        Node& node = nodes[i];
+        if (node.count > 0) {
+            node.min = glm::dvec3(std::numeric_limits<double>::max());
+            node.max = glm::dvec3(std::numeric_limits<double>::lowest());
+            for (int p = node.offset; p < node.offset + node.count; p++) {
+                const Primitive& prim = primitives[indices[p]];
+                node.min = glm::min(node.min, prim.center - glm::dvec3(prim.radius));
+                node.max = glm::max(node.max, prim.center + glm::dvec3(prim.radius));
+            }
+        } else {
+            const Node& left = nodes[i + 1];
+            const Node& right = nodes[node.offset];
+            node.min = glm::min(left.min, right.min);
+            node.max = glm::max(left.max, right.max);
+        }
+    }
+}
+
+BodyBVH::RayHit BodyBVH::Raycast(const glm::dvec3& origin, const glm::dvec3& direction) const {
+    RayHit hit;
+    if (nodes.empty()) {
+        return hit;
+    }
+    double closest = std::numeric_limits<double>::infinity();
+    glm::dvec3 inv_dir = 1.0 / direction;
+
+    int stack[64];
+    int stack_size = 0;
+    stack[stack_size++] = 0;
+    while (stack_size > 0) {
+        const Node& node = nodes[stack[--stack_size]];
+        if (!RayIntersectsBox(origin, inv_dir, node.min, node.max, closest)) {
+            continue;
+        }
+        if (node.count > 0) {
+            for (int p = node.offset; p < node.offset + node.count; p++) {
+                const Primitive& prim = primitives[indices[p]];
+                double dist = RaySphereDistance(origin, direction, prim.center, prim.radius);
+                if (dist >= 0 && dist < closest) {
+                    closest = dist;
+                    hit.entity = prim.entity;
+                    hit.distance = dist;
+                }
+            }
+            continue;
+        }
+        // The tree is balanced by construction so the depth is bounded by log2 of the body count
+        stack[stack_size++] = node.offset;
+        stack[stack_size++] = static_cast<int>(&node - nodes.data()) + 1;
+    }
+    return hit;
+}
+
+void BodyBVH::QueryFrustum(const Frustum& frustum, std::vector<entt::entity>& out) const {
+    if (nodes.empty()) {
+        return;
+    }
+    int stack[64];
+    int stack_size = 0;
+    stack[stack_size++] = 0;
+    while (stack_size > 0) {
+        const Node& node = nodes[stack[--stack_size]];
+        glm::dvec3 center = (node.min + node.max) * 0.5;
+        if (!frustum.SphereVisible(center, glm::length(node.max - center))) {
+            continue;
+        }
+        if (node.count > 0) {
+            for (int p = node.offset; p < node.offset + node.count; p++) {
+                const Primitive& prim = primitives[indices[p]];
+                if (frustum.SphereVisible(prim.center, prim.radius)) {
+                    out.push_back(prim.entity);
+                }
+            }
+            continue;
+        }
+        stack[stack_size++] = node.offset;
+        stack[stack_size++] = static_cast<int>(&node - nodes.data()) + 1;
+    }
+}
+
+SurfaceGrid::SurfaceGrid(int resolution) : resolution(resolution) {
+    cells.resize(6 * resolution * resolution);
+    for (int face = 0; face < 6; face++) {
+        int axis = face / 2;
+        double sign = (face % 2 == 0) ? 1 : -1;
+        auto face_point = [&](double u, double v) {
+            glm::dvec3 p;
+            p[axis] = sign;
+            p[(axis + 1) % 3] = u;
+            p[(axis + 2) % 3] = v;
+            return glm::normalize(p);
+        };
+        for (int i = 0; i < resolution; i++) {
+            for (int j = 0; j < resolution; j++) {
+                double u0 = 2.0 * i / resolution - 1;
+                double u1 = 2.0 * (i + 1) / resolution - 1;
+                double v0 = 2.0 * j / resolution - 1;
+                double v1 = 2.0 * (j + 1) / resolution - 1;
+                Cell& cell = cells[(face * resolution + i) * resolution + j];
+                cell.axis = face_point((u0 + u1) / 2, (v0 + v1) / 2);
+                // The cone has to contain all four corners
+                double cos_radius = 1;
+                for (auto corner : {face_point(u0, v0), face_point(u0, v1), face_point(u1, v0), face_point(u1, v1)}) {
+                    cos_radius = std::min(cos_radius, glm::dot(cell.axis, corner));
+                }
+                cell.cos_radius = cos_radius;
+                cell.sin_radius = std::sqrt(1 - cos_radius * cos_radius);
+            }
+        }
+    }
+}
+
+void SurfaceGrid::Clear() {
+    for (auto& cell : cells) {
+        cell.entities.clear();
+    }
+    count = 0;
+}
+
+int SurfaceGrid::CellIndex(const glm::vec3& direction) const {
+    glm::vec3 abs_dir = glm::abs(direction);
+    int axis = 0;
+    if (abs_dir.y > abs_dir[axis]) axis = 1;
+    if (abs_dir.z > abs_dir[axis]) axis = 2;
+    int face = axis * 2 + (direction[axis] < 0 ? 1 : 0);
+    if (abs_dir[axis] == 0) {
+        return 0;
+    }
+    float u = direction[(axis + 1) % 3] / abs_dir[axis];
+    float v = direction[(axis + 2) % 3] / abs_dir[axis];
+    int i = std::clamp(static_cast<int>((u + 1) / 2 * resolution), 0, resolution - 1);
+    int j = std::clamp(static_cast<int>((v + 1) / 2 * resolution), 0, resolution - 1);
+    return (face * resolution + i) * resolution + j;
+}
+
+void SurfaceGrid::Insert(entt::entity entity, const glm::vec3& direction) {
+    cells[CellIndex(direction)].entities.push_back(entity);
+    count++;
+}
+
+void SurfaceGrid::QueryHorizon(const glm::dvec3& viewer, std::vector<entt::entity>& out) const {
+    double distance = glm::length(viewer);
+    if (distance <= 1) {
+        // Inside the planet, so there's no horizon to cull with
+        for (const auto& cell : cells) {
+            out.insert(out.end(), cell.entities.begin(), cell.entities.end());
+        }
+        return;
+    }
+    // Everything within the cap of half angle acos(1 / distance) is above the horizon
+    glm::dvec3 viewer_dir = viewer / distance;
+    double cos_horizon = 1 / distance;
+    double sin_horizon = std::sqrt(1 - cos_horizon * cos_horizon);
+    for (const auto& cell : cells) {
+        if (cell.entities.empty()) {
+            continue;
+        }
+        // cos(horizon + cell radius), the cell is visible if it is within that angle of the viewer
+        double cos_limit = cos_horizon * cell.cos_radius - sin_horizon * cell.sin_radius;
+        if (glm::dot(cell.axis, viewer_dir) >= cos_limit) {
+            out.insert(out.end(), cell.entities.begin(), cell.entities.end());
+        }
+    }
+}
+}  // namespace cqsp::client::systems
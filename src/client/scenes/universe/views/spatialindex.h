@@ -0,0 +1,146 @@
+/* Conquer Space
+ * Copyright (C) 2021-2023 Conquer Space
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <array>
+#include <vector>
+
+#include <entt/entt.hpp>
+#include <glm/glm.hpp>
+
+namespace cqsp::client::systems {
+/// <summary>
+/// Six clipping planes of a view frustum, extracted from a projection * view matrix.
+/// </summary>
+/// Planes are stored as (normal, distance) with normals pointing into the frustum.
+struct Frustum {
+    std::array<glm::dvec4, 6> planes;
+
+    Frustum() = default;
+    explicit Frustum(const glm::dmat4& projection_view);
+
+    /// Returns false if the sphere is completely outside any of the planes
+    bool SphereVisible(const glm::dvec3& center, double radius) const;
+};
+
+/// <summary>
+/// Bounding volume hierarchy over spherical bodies.
+/// </summary>
+/// The tree is built once when the set of bodies changes, and then refit in place every tick
+/// when only the positions change. Positions are kept in doubles because star system coordinates
+/// are far too large to be precise in floats.
+class BodyBVH {
+ public:
+    struct Primitive {
+        entt::entity entity;
+        glm::dvec3 center;
+        double radius;
+    };
+
+    struct RayHit {
+        entt::entity entity = entt::null;
+        // Distance along the ray to the first intersection with the sphere
+        double distance = 0;
+    };
+
+    /// <summary>
+    /// Rebuilds the tree from scratch. Call this when bodies are added or removed.
+    /// </summary>
+    void Build(std::vector<Primitive> primitives);
+
+    /// <summary>
+    /// Updates the positions and radii of the bodies, keeping the topology of the tree.
+    /// </summary>
+    /// The primitives have to be the same entities in the same order that was passed into
+    /// `Build`, otherwise the tree is rebuilt.
+    void Refit(const std::vector<Primitive>& primitives);
+
+    /// <summary>
+    /// Finds the closest body intersecting the ray.
+    /// </summary>
+    /// <param name="origin">Origin of the ray</param>
+    /// <param name="direction">Normalized direction of the ray</param>
+    RayHit Raycast(const glm::dvec3& origin, const glm::dvec3& direction) const;
+
+    /// <summary>
+    /// Appends every body that may be inside the frustum to `out`.
+    /// </summary>
+    void QueryFrustum(const Frustum& frustum, std::vector<entt::entity>& out) const;
+
+    size_t size() const { return primitives.size(); }
+    bool empty() const { return primitives.empty(); }
+
+ private:
+    struct Node {
+        glm::dvec3 min;
+        glm::dvec3 max;
+        // For internal nodes this is the index of the right child, the left child is always
+        // the next node. For leaves this is the first primitive.
+        int offset;
+        // Number of primitives, 0 if this is an internal node
+        int count;
+    };
+
+    int BuildRecursive(int begin, int end);
+    void RefitNodes();
+
+    std::vector<Node> nodes;
+    // Primitives in the order they were passed in, so that refits are a straight copy
+    std::vector<Primitive> primitives;
+    // Indices into `primitives`, ordered so that every leaf refers to a contiguous range
+    std::vector<int> indices;
+
+    static constexpr int max_leaf_size = 4;
+};
+
+/// <summary>
+/// Spatial index of points on the surface of a sphere, such as cities on a planet.
+/// </summary>
+/// The sphere is split into a cube-sphere grid, with `resolution` x `resolution` cells on each cube face.
+/// Every cell keeps a bounding cone so that horizon culling can discard whole cells at once.
+/// All directions are in the unrotated frame of the planet, with the planet as a unit sphere.
+class SurfaceGrid {
+ public:
+    explicit SurfaceGrid(int resolution = 8);
+
+    void Clear();
+    void Insert(entt::entity entity, const glm::vec3& direction);
+
+    /// <summary>
+    /// Appends the entities in every cell that may be visible from `viewer` to `out`.
+    /// </summary>
+    /// <param name="viewer">Position of the viewer, in units of planet radius</param>
+    void QueryHorizon(const glm::dvec3& viewer, std::vector<entt::entity>& out) const;
+
+    size_t size() const { return count; }
+
+ private:
+    int CellIndex(const glm::vec3& direction) const;
+
+    struct Cell {
+        glm::dvec3 axis;
+        // Cosine and sine of the angular radius of the cone containing the cell
+        double cos_radius;
+        double sin_radius;
+        std::vector<entt::entity> entities;
+    };
+
+    int resolution;
+    size_t count = 0;
+    std::vector<Cell> cells;
+};
+}  // namespace cqsp::client::systems
@@ -33,6 +33,7 @@
 #include "common/components/area.h"
 #include "common/components/bodies.h"
 #include "common/components/coordinates.h"
+#include "common/components/lod.h"
 #include "common/components/name.h"
 #include "common/components/orbit.h"
 #include "common/components/organizations.h"
@@ -94,9 +95,16 @@ struct PlanetTexture {
 
 struct PlanetOrbit {
     cqsp::engine::Mesh* orbit_mesh;
+    // Shape the mesh was generated with
+    OrbitShapeKey shape;
 
     ~PlanetOrbit() { delete orbit_mesh; }
 };
+
+// Cities on a planet, indexed by where they are on the surface
+struct CityIndex {
+    SurfaceGrid grid;
+};
 }  // namespace
 
 void SysStarSystemRenderer::Initialize() {
@@ -119,7 +127,7 @@ void SysStarSystemRenderer::OnTick() {
     if (current_planet != entt::null) {
         view_center = CalculateObjectPos(m_viewing_entity);
     }
-    namespace cqspb = cqsp::common::components::bodies;
+    RefitBodyIndex();
 }
 
 void SysStarSystemRenderer::Render(float deltaTime) {
@@ -168,6 +176,7 @@ void SysStarSystemRenderer::SeeStarSystem() {
     namespace cqspb = cqsp::common::components::bodies;
 
     GenerateOrbitLines();
+    RefitBodyIndex();
 
     SPDLOG_INFO("Loading planet textures");
     LoadPlanetTextures();
@@ -184,6 +193,16 @@ void SysStarSystemRenderer::SeeEntity() {
     // See the object
     view_center = CalculateObjectPos(m_viewing_entity);
 
+    // Start loading the textures of the planet while the camera moves there
+    if (m_universe.all_of<PlanetTexture>(m_viewing_entity)) {
+        auto& textures = m_universe.get<PlanetTexture>(m_viewing_entity);
+        auto& residency = m_app.GetAssetManager().GetResidency();
+        for (asset::Texture* texture :
+             {textures.terrain, textures.normal, textures.roughness, textures.province_texture}) {
+            residency.Prefetch(texture);
+        }
+    }
+
     // Set the variable
     if (m_universe.all_of<cqspb::Body>(m_viewing_entity)) {
         scroll = m_universe.get<cqspb::Body>(m_viewing_entity).radius * 2.5;
@@ -250,6 +269,9 @@ void SysStarSystemRenderer::Update(float deltaTime) {
 void SysStarSystemRenderer::SeePlanet(entt::entity ent) {
     m_universe.clear<FocusedPlanet>();
     m_universe.emplace<FocusedPlanet>(ent);
+    // Simulate the planet that the player is looking at in full
+    m_universe.clear<common::components::LodFocus>();
+    m_universe.emplace<common::components::LodFocus>(ent);
 }
 
 void SysStarSystemRenderer::DoUI(float deltaTime) {
@@ -278,11 +300,21 @@ void SysStarSystemRenderer::DrawStars() {
 
 void SysStarSystemRenderer::DrawBodies() {
     ZoneScoped;
-    // Draw other bodies
-    auto bodies = m_universe.view<cqspb::Body>(entt::exclude<cqspb::LightEmitter>);
+    // Draw other bodies, skipping everything that is outside of the view
+    Frustum frustum(glm::dmat4(projection) * glm::dmat4(camera_matrix) *
+                    glm::translate(glm::dmat4(1.0), -glm::dvec3(view_center)));
+    visible_bodies.clear();
+    body_index.QueryFrustum(frustum, visible_bodies);
+    std::erase_if(visible_bodies, [&](entt::entity entity) {
+        return !m_universe.valid(entity) || m_universe.any_of<cqspb::LightEmitter>(entity);
+    });
+    auto& bodies = visible_bodies;
+    // Labels are batched per layer, so that they are drawn in a single draw call on top of the icons
     renderer.BeginDraw(planet_icon_layer);
     glDepthFunc(GL_ALWAYS);
+    m_app.BeginTextBatch();
     DrawAllPlanetBillboards(bodies);
+    m_app.EndTextBatch();
     glDepthFunc(GL_LESS);
     renderer.EndDraw(planet_icon_layer);
 
@@ -294,7 +326,9 @@ void SysStarSystemRenderer::DrawBodies() {
     // This is on the ship icon layer because the cities have to appear on top of planets
     // and planet_icon_layer is behind all the planets.
     renderer.BeginDraw(ship_icon_layer);
+    m_app.BeginTextBatch();
     DrawAllCities(bodies);
+    m_app.EndTextBatch();
     renderer.EndDraw(ship_icon_layer);
 }
 
@@ -305,7 +339,7 @@ void SysStarSystemRenderer::DrawShips() {
     auto ships = m_universe.view<cqsps::Ship, ctx::VisibleOrbit>();
 
     renderer.BeginDraw(ship_icon_layer);
-    ship_overlay.shaderProgram->UseProgram();
+    billboards.Begin(projection * camera_matrix);
     for (auto ent_id : ships) {
         // if it's not visible, then don't render
         glm::vec3 object_pos = CalculateCenteredObject(ent_id);
@@ -313,9 +347,9 @@ void SysStarSystemRenderer::DrawShips() {
         auto& future_comp = m_universe.get<common::components::types::FuturePosition>(ent_id);
         const auto& pos = future_comp.position + future_comp.center;
         glm::vec3 future_pos = CalculateCenteredObject(ConvertPoint(pos));
-        ship_overlay.shaderProgram->setVec4("color", 1, 0, 0, 1);
         DrawShipIcon(glm::mix(object_pos, future_pos, m_universe.tick_fraction));
     }
+    billboards.Draw();
     renderer.EndDraw(ship_icon_layer);
 }
 
@@ -362,55 +396,32 @@ void SysStarSystemRenderer::DrawPlanetBillboards(const entt::entity& ent_id, con
 
     std::string text = common::util::GetName(m_universe, ent_id);
 
-    glm::mat4 planetDispMat = GetBillboardMatrix(pos);
-
-    SetBillboardProjection(planet_circle.shaderProgram, planetDispMat);
-
-    engine::Draw(planet_circle);
+    billboards.Add(planet_icon, object_pos, glm::vec2(circle_size), glm::vec4(0, 0, 1, 1));
 
     m_app.DrawText(text, pos.x, pos.y, 20);
 }
 
 void SysStarSystemRenderer::DrawCityIcon(const glm::vec3& object_pos) {
-    glm::vec3 pos = GetBillboardPosition(object_pos);
-    if (pos.z >= 1 || pos.z <= -1) {
-        return;
-    }
-
-    glm::mat4 planetDispMat = GetBillboardMatrix(pos);
     // Scale it by the window ratio
-    planetDispMat = glm::scale(planetDispMat, glm::vec3(1, GetWindowRatio(), 1));
-
-    SetBillboardProjection(city.shaderProgram, planetDispMat);
-    city.shaderProgram->Set("color", 1, 0, 1, 1);
-
-    engine::Draw(city);
+    billboards.Add(city_icon, object_pos, glm::vec2(circle_size, circle_size * GetWindowRatio()),
+                   glm::vec4(1, 0, 1, 1));
 }
 
 void SysStarSystemRenderer::DrawAllCities(auto& bodies) {
+    billboards.Begin(projection * camera_matrix);
     for (auto body_entity : bodies) {
         glm::vec3 object_pos = CalculateCenteredObject(body_entity);
         // if (glm::distance(object_pos, cam_pos) <= dist) {
         RenderCities(object_pos, body_entity);
         //}
     }
+    billboards.Draw();
 }
 
 void SysStarSystemRenderer::DrawShipIcon(const glm::vec3& object_pos) {
-    glm::vec3 pos = GetBillboardPosition(object_pos);
-    glm::mat4 shipDispMat = GetBillboardMatrix(pos);
-    float window_ratio = GetWindowRatio();
-    glm::vec4 gl_Position = CalculateGLPosition(object_pos);
-
-    // Check if the position on screen is within bounds
-    if (GLPositionNotInBounds(gl_Position, pos)) {
-        return;
-    }
-
-    shipDispMat = glm::scale(shipDispMat, glm::vec3(1, window_ratio, 1));
-    SetBillboardProjection(ship_overlay.shaderProgram, shipDispMat);
-
-    engine::Draw(ship_overlay);
+    // Icons off the screen are culled by the billboard renderer
+    billboards.Add(ship_icon, object_pos, glm::vec2(circle_size, circle_size * GetWindowRatio()),
+                   glm::vec4(1, 0, 0, 1));
 }
 
 void SysStarSystemRenderer::DrawTexturedPlanet(const glm::vec3& object_pos, const entt::entity entity) {
@@ -441,18 +452,28 @@ void SysStarSystemRenderer::DrawTexturedPlanet(const glm::vec3& object_pos, cons
 
     shader->SetMVP(position, camera_matrix, projection);
 
+    // Set for every planet, so the names are only looked up once
+    static const asset::UniformId have_normal_id("haveNormal");
+    static const asset::UniformId light_dir_id("lightDir");
+    static const asset::UniformId light_position_id("lightPosition");
+    static const asset::UniformId light_color_id("lightColor");
+    static const asset::UniformId view_pos_id("viewPos");
+    static const asset::UniformId country_color_id("country_color");
+    static const asset::UniformId country_id("country");
+    static const asset::UniformId is_roughness_id("is_roughness");
+
     // Maybe a seperate shader for planets without normal maps would be better
-    shader->setBool("haveNormal", have_normal);
+    shader->setBool(have_normal_id, have_normal);
 
-    shader->setVec3("lightDir", glm::normalize(sun_position - object_pos));
-    shader->setVec3("lightPosition", sun_position);
-    shader->setVec3("lightColor", sun_color);
-    shader->setVec3("viewPos", cam_pos);
+    shader->setVec3(light_dir_id, glm::normalize(sun_position - object_pos));
+    shader->setVec3(light_position_id, sun_position);
+    shader->setVec3(light_color_id, sun_color);
+    shader->setVec3(view_pos_id, cam_pos);
 
     // If a country is clicked on...
-    shader->setVec4("country_color", glm::vec4(selected_country_color, 1));
-    shader->setBool("country", have_province);
-    shader->setBool("is_roughness", have_roughness);
+    shader->setVec4(country_color_id, glm::vec4(selected_country_color, 1));
+    shader->setBool(country_id, have_province);
+    shader->setBool(is_roughness_id, have_roughness);
 
     engine::Draw(textured_planet, shader);
     glDepthFunc(GL_LESS);
@@ -464,6 +485,13 @@ void SysStarSystemRenderer::GetPlanetTexture(const entt::entity entity, bool& ha
         return;
     }
     auto& terrain_data = m_universe.get<PlanetTexture>(entity);
+    // Keeps the textures from being evicted, and starts loading them if they aren't loaded yet.
+    // Until then the planet is drawn without them.
+    auto& residency = m_app.GetAssetManager().GetResidency();
+    for (asset::Texture* texture :
+         {terrain_data.terrain, terrain_data.normal, terrain_data.roughness, terrain_data.province_texture}) {
+        residency.Request(texture);
+    }
     textured_planet.textures.clear();
     textured_planet.textures.push_back(terrain_data.terrain);
     if (terrain_data.normal != nullptr) {
@@ -509,8 +537,7 @@ void SysStarSystemRenderer::DrawAllPlanets(auto& bodies) {
 
 void SysStarSystemRenderer::DrawAllPlanetBillboards(auto& bodies) {
     ZoneScoped;
-    planet_circle.shaderProgram->UseProgram();
-    planet_circle.shaderProgram->setVec4("color", 0, 0, 1, 1);
+    billboards.Begin(projection * camera_matrix);
     for (auto body_entity : bodies) {
         // Draw the planet circle
         glm::vec3 object_pos = CalculateCenteredObject(body_entity);
@@ -523,6 +550,7 @@ void SysStarSystemRenderer::DrawAllPlanetBillboards(auto& bodies) {
         //continue;
         //}
     }
+    billboards.Draw();
 }
 
 void SysStarSystemRenderer::DrawStar(const entt::entity& entity, glm::vec3& object_pos) {
@@ -565,28 +593,30 @@ void SysStarSystemRenderer::RenderCities(glm::vec3& object_pos, const entt::enti
     // Draw Cities
     namespace cqspc = cqsp::common::components;
     namespace cqspt = cqsp::common::components::types;
-    if (!m_universe.all_of<cqspc::Habitation>(body_entity)) {
+    // Only planets that had their city positions calculated can be rendered
+    if (!m_universe.all_of<CityIndex>(body_entity)) {
         return;
     }
-    std::vector<entt::entity> cities = m_universe.get<cqspc::Habitation>(body_entity).settlements;
-    if (cities.empty()) {
+    auto& city_index = m_universe.get<CityIndex>(body_entity);
+    if (city_index.grid.size() == 0) {
         return;
     }
 
     auto& body = m_universe.get<cqspc::bodies::Body>(body_entity);
     auto quat = GetBodyRotation(body.axial, body.rotation, body.rotation_offset);
 
+    // Cull the cities that are over the horizon in the frame of the planet
+    glm::vec3 local_cam = glm::inverse(quat) * (cam_pos - object_pos) / (float)body.radius;
+    visible_cities.clear();
+    city_index.grid.QueryHorizon(glm::dvec3(local_cam), visible_cities);
+
     // Rotate the body
     // Put in same layer as ships
-    city.shaderProgram->UseProgram();
-    city.shaderProgram->setVec4("color", 0.5, 0.5, 0.5, 1);
-    for (auto city_entity : cities) {
+    for (auto city_entity : visible_cities) {
         // Calculate position to render
         if (!m_universe.any_of<Offset>(city_entity)) {
-            // Calculate offset
             continue;
         }
-        Offset doffset = m_universe.get<Offset>(city_entity);
         glm::vec3 city_pos = m_universe.get<Offset>(city_entity).offset * (float)body.radius;
         // Check if line of sight and city position intersects the sphere that is the planet
         city_pos = quat * city_pos;
@@ -624,17 +654,19 @@ void SysStarSystemRenderer::CalculateCityPositions() {
     if (!m_universe.all_of<cqspc::Habitation>(m_viewing_entity)) {
         return;
     }
-    std::vector<entt::entity> cities = m_universe.get<cqspc::Habitation>(m_viewing_entity).settlements;
+    const std::vector<entt::entity>& cities = m_universe.get<cqspc::Habitation>(m_viewing_entity).settlements;
     if (cities.empty()) {
         return;
     }
+    auto& city_index = m_universe.get_or_emplace<CityIndex>(m_viewing_entity);
+    city_index.grid.Clear();
     for (auto& city_entity : cities) {
         if (!m_universe.all_of<cqspt::SurfaceCoordinate>(city_entity)) {
             continue;
         }
         auto& coord = m_universe.get<cqspt::SurfaceCoordinate>(city_entity);
-        cqspb::Body parent = m_universe.get<cqspb::Body>(m_viewing_entity);
-        m_universe.emplace_or_replace<Offset>(city_entity, cqspt::toVec3(coord.universe_view(), 1));
+        auto& offset = m_universe.emplace_or_replace<Offset>(city_entity, cqspt::toVec3(coord.universe_view(), 1));
+        city_index.grid.Insert(city_entity, offset.offset);
     }
     SPDLOG_INFO("Calculated offset");
 }
@@ -661,20 +693,21 @@ void SysStarSystemRenderer::LoadPlanetTextures() {
             continue;
         }
         auto textures = m_universe.get<cqspb::TexturedTerrain>(body);
+        // Only the handles, the textures are loaded once the planet is drawn
         auto& data = m_universe.get_or_emplace<PlanetTexture>(body);
-        data.terrain = m_app.GetAssetManager().GetAsset<cqsp::asset::Texture>(textures.terrain_name);
+        data.terrain = m_app.GetAssetManager().FindAsset<cqsp::asset::Texture>(textures.terrain_name);
         if (!textures.normal_name.empty()) {
-            data.normal = m_app.GetAssetManager().GetAsset<cqsp::asset::Texture>(textures.normal_name);
+            data.normal = m_app.GetAssetManager().FindAsset<cqsp::asset::Texture>(textures.normal_name);
         }
         if (!textures.roughness_name.empty()) {
-            data.roughness = m_app.GetAssetManager().GetAsset<cqsp::asset::Texture>(textures.roughness_name);
+            data.roughness = m_app.GetAssetManager().FindAsset<cqsp::asset::Texture>(textures.roughness_name);
         }
         if (!m_universe.any_of<common::components::ProvincedPlanet>(body)) {
             continue;
         }
         auto& province_map = m_universe.get<common::components::ProvincedPlanet>(body);
         // Add province data if they have it
-        data.province_texture = m_app.GetAssetManager().GetAsset<cqsp::asset::Texture>(province_map.province_texture);
+        data.province_texture = m_app.GetAssetManager().FindAsset<cqsp::asset::Texture>(province_map.province_texture);
 
         cqsp::asset::BinaryAsset* bin_asset =
             m_app.GetAssetManager().GetAsset<cqsp::asset::BinaryAsset>(province_map.province_map);
@@ -699,6 +732,8 @@ void SysStarSystemRenderer::LoadPlanetTextures() {
             }
         }
         delete d;
+        // Only needed to build the province map, so it can go until the textures are loaded again
+        m_app.GetAssetManager().GetResidency().Release(bin_asset);
     }
 }
 
@@ -736,6 +771,11 @@ void SysStarSystemRenderer::InitializeMeshes() {
     city.mesh = engine::primitive::MakeTexturedPaneMesh();
     city.shaderProgram = circle_shader;
 
+    billboards.Initialize(m_app.GetAssetManager().GetAsset<asset::ShaderDefinition>("core:billboard")->MakeShader());
+    planet_icon = billboards.AddIcon(*planet_circle.mesh);
+    ship_icon = billboards.AddIcon(*ship_overlay.mesh);
+    city_icon = billboards.AddIcon(*city.mesh);
+
     // Initialize shaders
     asset::ShaderProgram_t planet_shader =
         m_app.GetAssetManager().GetAsset<asset::ShaderDefinition>("core:planetshader")->MakeShader();
@@ -798,6 +838,17 @@ glm::vec3 SysStarSystemRenderer::CalculateObjectPos(const entt::entity& ent) {
     return ConvertPoint(pos);
 }
 
+glm::dvec3 SysStarSystemRenderer::CalculateWorldPos(const entt::entity& ent) {
+    namespace cqspt = cqsp::common::components::types;
+    if (!m_universe.all_of<cqspt::Kinematics>(ent)) {
+        return glm::dvec3(0, 0, 0);
+    }
+    auto& kin = m_universe.get<cqspt::Kinematics>(ent);
+    const glm::dvec3 pos = kin.position + kin.center;
+    // Same as ConvertPoint, but without losing precision
+    return glm::dvec3(pos.x, pos.z, -pos.y);
+}
+
 glm::vec3 SysStarSystemRenderer::CalculateCenteredObject(const glm::vec3& vec) { return vec - view_center; }
 
 glm::vec3 SysStarSystemRenderer::TranslateToNormalized(const glm::vec3& pos) {
@@ -952,6 +1003,30 @@ glm::vec3 SysStarSystemRenderer::CalculateMouseRay(const glm::vec3& ray_nds) {
     return glm::normalize(glm::vec3(inv.x, inv.y, inv.z));
 }
 
+glm::vec3 SysStarSystemRenderer::CalculateMouseRay(int mouse_x, int mouse_y) {
+    // Normalize 3d device coordinates
+    float x = (2.0f * mouse_x) / m_app.GetWindowWidth() - 1.0f;
+    float y = 1.0f - (2.0f * mouse_y) / m_app.GetWindowHeight();
+    float z = 1.0f;
+    return CalculateMouseRay(glm::vec3(x, y, z));
+}
+
+void SysStarSystemRenderer::RefitBodyIndex() {
+    ZoneScoped;
+    auto bodies = m_universe.view<cqspb::Body>();
+    std::vector<BodyBVH::Primitive> primitives;
+    primitives.reserve(bodies.size());
+    for (entt::entity ent_id : bodies) {
+        primitives.push_back({ent_id, CalculateWorldPos(ent_id), bodies.get<cqspb::Body>(ent_id).radius});
+    }
+    body_index.Refit(primitives);
+}
+
+BodyBVH::RayHit SysStarSystemRenderer::PickBody(const glm::vec3& ray_wor) {
+    // The index is in world space, while the camera is relative to the view center
+    return body_index.Raycast(glm::dvec3(cam_pos) + glm::dvec3(view_center), glm::dvec3(ray_wor));
+}
+
 void SysStarSystemRenderer::CalculateViewChange(double deltaX, double deltaY) {
     if (!m_app.MouseButtonIsHeld(engine::MouseInput::LEFT)) {
         return;
@@ -1040,21 +1115,38 @@ void SysStarSystemRenderer::GenerateOrbitLines() {
     SPDLOG_TRACE("Creating planet orbits");
     namespace cqspt = common::components::types;
 
+    std::vector<entt::entity> to_generate;
+
     // Generates orbits for satellites
     auto orbit_list = m_universe.view<cqspt::Orbit>(entt::exclude<PlanetOrbit>);
-    orbits_generated = 0;
     for (auto body : orbit_list) {
-        GenerateOrbit(body);
-        orbits_generated++;
+        if (static_cast<int>(to_generate.size()) >= max_new_orbits_per_frame) {
+            // The rest will be done next frame
+            break;
+        }
+        if (orbit_list.get<cqspt::Orbit>(body).semi_major_axis == 0) {
+            continue;
+        }
+        to_generate.push_back(body);
     }
 
-    // Generate dirty orbits
-    auto orbit4 = m_universe.view<cqspt::Orbit, cqspb::DirtyOrbit>();
-    for (auto body : orbit4) {
-        GenerateOrbit(body);
-        m_universe.remove<cqspb::DirtyOrbit>(body);
-        orbits_generated++;
+    // Generate dirty orbits, but only if the shape of the orbit actually changed
+    std::vector<entt::entity> up_to_date;
+    auto dirty_orbits = m_universe.view<cqspt::Orbit, cqspb::DirtyOrbit, PlanetOrbit>();
+    for (auto body : dirty_orbits) {
+        if (dirty_orbits.get<PlanetOrbit>(body).shape == GetOrbitShape(body)) {
+            up_to_date.push_back(body);
+        } else {
+            to_generate.push_back(body);
+        }
     }
+
+    GenerateOrbits(to_generate);
+    // Only the orbits whose lines match them now are clean. Orbits that weren't looked at, such as new ones past
+    // the limit for this frame, stay dirty.
+    m_universe.remove<cqspb::DirtyOrbit>(up_to_date.begin(), up_to_date.end());
+    m_universe.remove<cqspb::DirtyOrbit>(to_generate.begin(), to_generate.end());
+    orbits_generated = static_cast<int>(to_generate.size());
 }
 
 void SysStarSystemRenderer::RenderInformationWindow(double deltaTime) {
@@ -1173,118 +1265,56 @@ void SysStarSystemRenderer::CityDetection() {
 
 glm::vec3 SysStarSystemRenderer::GetMouseIntersectionOnObject(int mouse_x, int mouse_y) {
     ZoneScoped;
-    // Normalize 3d device coordinates
-    namespace cqspb = cqsp::common::components::bodies;
-    auto bodies = m_universe.view<cqspb::Body>();
-    // TODO(EhWhoAmI): Sort the bodies by distance before calculating intersection
-    for (entt::entity ent_id : bodies) {
-        glm::vec3 object_pos = CalculateCenteredObject(ent_id);
-        float x = (2.0f * mouse_x) / m_app.GetWindowWidth() - 1.0f;
-        float y = 1.0f - (2.0f * mouse_y) / m_app.GetWindowHeight();
-        float z = 1.0f;
-
-        glm::vec3 ray_wor = CalculateMouseRay(glm::vec3(x, y, z));
-        auto& body = m_universe.get<cqspb::Body>(ent_id);
-        float radius = body.radius;
-
-        // Check for intersection for sphere
-        glm::vec3 sub = cam_pos - object_pos;
-        float b = glm::dot(ray_wor, sub);
-        float c = glm::dot(sub, sub) - radius * radius;
-
-        glm::vec3 closest_hit = cam_pos + (-b - sqrt(b * b - c)) * ray_wor;
-        // Get the closer value
-        if ((b * b - c) >= 0) {
-            is_rendering_founding_city = true;
-            on_planet = ent_id;
-            return closest_hit;
-        }
+    glm::vec3 ray_wor = CalculateMouseRay(mouse_x, mouse_y);
+    BodyBVH::RayHit hit = PickBody(ray_wor);
+    if (hit.entity != entt::null && m_universe.valid(hit.entity)) {
+        is_rendering_founding_city = true;
+        on_planet = hit.entity;
+        return cam_pos + static_cast<float>(hit.distance) * ray_wor;
     }
     is_rendering_founding_city = false;
     return glm::vec3(0, 0, 0);
 }
 
-void SysStarSystemRenderer::GenerateOrbit(entt::entity body) {
-    // Then produce orbits
-    ZoneScoped;
-    // Generate the orbit
+OrbitShapeKey SysStarSystemRenderer::GetOrbitShape(entt::entity body) {
     auto& orb = m_universe.get<common::components::types::Orbit>(body);
-    if (orb.semi_major_axis == 0) {
-        return;
-    }
-    const int res = 500;
-    std::vector<glm::vec3> orbit_points;
     double SOI = std::numeric_limits<double>::infinity();
     if (m_universe.valid(orb.reference_body)) {
         SOI = m_universe.get<common::components::bodies::Body>(orb.reference_body).SOI;
     }
+    return OrbitShapeKey(orb, SOI);
+}
 
-    orbit_points.reserve(res);
-    if (orb.eccentricity > 1) {
-        for (int i = 0; i <= res; i++) {
-            ZoneScoped;
-            double theta =
-                (common::components::types::PI / res * 1.5 * i) - common::components::types::PI / 2 - 1.5 / 2;
-
-            glm::vec3 vec = common::components::types::toVec3(orb, theta);
-
-            // If the length is greater than the sphere of influence, then
-            // remove it
-            orbit_points.push_back(ConvertPoint(vec));
-        }
-    } else {
-        for (int i = 0; i <= res; i++) {
-            ZoneScoped;
-            double theta = 3.1415926535 * 2 / res * i;
-
-            glm::vec3 vec = common::components::types::toVec3(orb, theta);
-
-            // If the length is greater than the sphere of influence, then
-            // remove it
-            if (glm::length(vec) < SOI) {
-                orbit_points.push_back(ConvertPoint(vec));
-            }
-        }
+void SysStarSystemRenderer::GenerateOrbits(const std::vector<entt::entity>& bodies) {
+    ZoneScoped;
+    if (bodies.empty()) {
+        return;
+    }
+    std::vector<OrbitShapeKey> shapes;
+    shapes.reserve(bodies.size());
+    for (entt::entity body : bodies) {
+        shapes.push_back(GetOrbitShape(body));
     }
 
-    // m_universe.remove<cqspt::OrbitDirty>(body);
-    auto& line = m_universe.get_or_emplace<PlanetOrbit>(body);
-    // Get the orbit line
-    // Do the points
-    delete line.orbit_mesh;
-    line.orbit_mesh = engine::primitive::CreateLineSequence(orbit_points);
+    // The points are made in parallel, but the meshes have to be made on this thread
+    std::vector<OrbitGeometryCache::Points> points = orbit_cache.Generate(shapes);
+    for (size_t i = 0; i < bodies.size(); i++) {
+        auto& line = m_universe.get_or_emplace<PlanetOrbit>(bodies[i]);
+        delete line.orbit_mesh;
+        line.orbit_mesh = engine::primitive::CreateLineSequence(*points[i]);
+        line.shape = shapes[i];
+    }
 }
 
 entt::entity SysStarSystemRenderer::GetMouseOnObject(int mouse_x, int mouse_y) {
-    namespace cqspb = cqsp::common::components::bodies;
-
-    // Loop through objects
-    auto bodies = m_universe.view<cqspb::Body>();
-    for (entt::entity ent_id : bodies) {
-        glm::vec3 object_pos = CalculateCenteredObject(ent_id);
-        // Check if the sphere is rendered or not
-        // Normalize 3d device coordinates
-        float x = (2.0f * mouse_x) / m_app.GetWindowWidth() - 1.0f;
-        float y = 1.0f - (2.0f * mouse_y) / m_app.GetWindowHeight();
-        float z = 1.0f;
-
-        glm::vec3 ray_wor = CalculateMouseRay(glm::vec3(x, y, z));
-        auto& body = m_universe.get<cqspb::Body>(ent_id);
-        float radius = body.radius;
-
-        // Check for intersection for sphere
-        glm::vec3 sub = cam_pos - object_pos;
-        float b = glm::dot(ray_wor, sub);
-        // Object radius
-        float c = glm::dot(sub, sub) - radius * radius;
-
-        // Get the closer value
-        if ((b * b - c) >= 0) {
-            m_universe.emplace<MouseOverEntity>(ent_id);
-            return ent_id;
-        }
+    ZoneScoped;
+    // Closest body under the mouse
+    BodyBVH::RayHit hit = PickBody(CalculateMouseRay(mouse_x, mouse_y));
+    if (hit.entity == entt::null || !m_universe.valid(hit.entity)) {
+        return entt::null;
     }
-    return entt::null;
+    m_universe.emplace<MouseOverEntity>(hit.entity);
+    return hit.entity;
 }
 
 bool SysStarSystemRenderer::IsFoundingCity(common::Universe& universe) {
@@ -1347,7 +1377,8 @@ void SysStarSystemRenderer::DrawOrbit(const entt::entity& entity) {
     float g = 1 - r;
     float b = inc / 3.15;
     glm::vec4 color_v = {r, g, b, 1};
-    orbit_shader->Set("color", color_v);
+    static const asset::UniformId color_id("color");
+    orbit_shader->Set(color_id, color_v);
 
 
     //orbit_shader->Set("color", glm::vec4(1, 1, 1, 1));
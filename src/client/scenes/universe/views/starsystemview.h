@@ -20,10 +20,13 @@
 #include <string>
 #include <vector>
 
+#include "client/scenes/universe/views/orbitgeometry.h"
+#include "client/scenes/universe/views/spatialindex.h"
 #include "common/components/coordinates.h"
 #include "common/universe.h"
 #include "engine/application.h"
 #include "engine/graphics/renderable.h"
+#include "engine/renderer/billboardrenderer.h"
 #include "engine/renderer/framebuffer.h"
 #include "engine/renderer/renderer.h"
 #include "entt/entt.hpp"
@@ -102,6 +105,12 @@ class SysStarSystemRenderer {
     cqsp::engine::Renderable city;
     cqsp::engine::Renderable sun;
 
+    // Planet, ship and city icons are drawn instanced
+    cqsp::engine::BillboardRenderer billboards;
+    int planet_icon;
+    int ship_icon;
+    int city_icon;
+
     cqsp::asset::ShaderProgram_t orbit_shader;
     cqsp::asset::ShaderProgram_t near_shader;
 #if FALSE
@@ -148,7 +157,11 @@ class SysStarSystemRenderer {
     void LoadProvinceMap();
     void InitializeMeshes();
 
-    void GenerateOrbit(entt::entity body);
+    /// <summary>
+    /// Creates the orbit line meshes for the bodies
+    /// </summary>
+    void GenerateOrbits(const std::vector<entt::entity> &bodies);
+    OrbitShapeKey GetOrbitShape(entt::entity body);
 
     /// <summary>
     /// Gets the quaternion to calculate the planet's rotation from the axial rotation
@@ -160,6 +173,7 @@ class SysStarSystemRenderer {
     void FocusCityView();
 
     glm::vec3 CalculateObjectPos(const entt::entity &);
+    glm::dvec3 CalculateWorldPos(const entt::entity &);
     glm::vec3 CalculateCenteredObject(const entt::entity &);
     glm::vec3 CalculateCenteredObject(const glm::vec3 &);
     glm::vec3 TranslateToNormalized(const glm::vec3 &);
@@ -184,6 +198,13 @@ class SysStarSystemRenderer {
     void CheckResourceDistRender();
 
     glm::vec3 CalculateMouseRay(const glm::vec3 &ray_nds);
+    glm::vec3 CalculateMouseRay(int mouse_x, int mouse_y);
+
+    /// <summary>
+    /// Rebuilds or refits the body BVH to the current positions of the bodies.
+    /// </summary>
+    void RefitBodyIndex();
+    BodyBVH::RayHit PickBody(const glm::vec3 &ray_wor);
 
     void CalculateViewChange(double deltaX, double deltaY);
     void FoundCity();
@@ -247,6 +268,14 @@ class SysStarSystemRenderer {
     entt::entity selected_province;
 
     int orbits_generated = 0;
+    OrbitGeometryCache orbit_cache;
+    // Cap on new orbit lines made every frame, so that loading a lot of satellites at once doesn't stall a frame
+    const int max_new_orbits_per_frame = 2048;
+
+    BodyBVH body_index;
+    // Scratch buffers for spatial queries so that they don't allocate every frame
+    std::vector<entt::entity> visible_bodies;
+    std::vector<entt::entity> visible_cities;
 
     const int sphere_resolution = 64;
 };
@@ -16,74 +16,98 @@
  */
 #include "sysplanetterraingenerator.h"
 
+#include <algorithm>
 #include <cmath>
 
 #include "common/components/bodies.h"
+#include "common/util/parallel.h"
 #include "spdlog/spdlog.h"
 #include "tracy/Tracy.hpp"
 
 using cqsp::client::systems::TerrainImageGenerator;
+using cqsp::common::components::bodies::TerrainData;
 
-void TerrainImageGenerator::GenerateTerrain(cqsp::common::Universe& universe, int octaves, int size) {
-    ZoneScoped;
-    noise::module::Perlin noise_module;
-    noise_module.SetOctaveCount(octaves);
-    noise_module.SetNoiseQuality(noise::QUALITY_FAST);
-    noise_module.SetSeed(terrain.seed);
-    noise_module.SetFrequency(2);
-
-    noise::utils::NoiseMap noise_map;
-    int textureWidth = std::pow(2, size);
-    int textureHeight = std::pow(2, size);
-    utils::NoiseMapBuilderSphere heightMapBuilder;
-    heightMapBuilder.SetSourceModule(noise_module);
-    heightMapBuilder.SetDestNoiseMap(noise_map);
-    heightMapBuilder.SetDestSize(textureWidth, textureHeight);
-
-    heightMapBuilder.SetBounds(-90.0, 90.0, -180.0, 180.0);
-
-    heightMapBuilder.Build();
-
-    noise::utils::RendererImage renderer;
-    renderer.SetSourceNoiseMap(noise_map);
-    renderer.SetDestImage(height_map);
-    renderer.Render();
-
-    renderer.SetDestImage(albedo_map);
+namespace {
+void CopyRows(const noise::utils::Image& source, noise::utils::Image& dest, int dest_row) {
+    for (int y = 0; y < source.GetHeight(); y++) {
+        std::copy_n(source.GetConstSlabPtr(y), source.GetWidth(), dest.GetSlabPtr(dest_row + y));
+    }
+}
 
+void AddTerrainGradient(noise::utils::RendererImage& renderer, const TerrainData& terrain_data) {
     renderer.ClearGradient();
-
-    auto& terrain_data = universe.get<cqsp::common::components::bodies::TerrainData>(terrain.terrain_type);
     for (auto it = terrain_data.data.begin(); it != terrain_data.data.end(); it++) {
         renderer.AddGradientPoint(it->first, noise::utils::Color(std::get<0>(it->second), std::get<1>(it->second),
                                                                  std::get<2>(it->second), std::get<3>(it->second)));
     }
-    renderer.Render();
+}
+}  // namespace
+
+void TerrainImageGenerator::GenerateTerrain(cqsp::common::Universe& universe, int octaves, int size) {
+    auto& terrain_data = universe.get<TerrainData>(terrain.terrain_type);
+    GenerateTerrain(terrain_data, octaves, size);
+}
+
+void TerrainImageGenerator::GenerateTerrain(const TerrainData& terrain_data, int octaves, int size) {
+    Generate(&terrain_data, octaves, size);
+}
+
+void TerrainImageGenerator::GenerateHeightMap(int octaves, int size) { Generate(nullptr, octaves, size); }
+
+void TerrainImageGenerator::Generate(const TerrainData* terrain_data, int octaves, int size) {
+    ZoneScoped;
+    const bool albedo = terrain_data != nullptr;
+    int texture_width = 1 << size;
+    int texture_height = 1 << size;
+    height_map.SetSize(texture_width, texture_height);
+    if (albedo) {
+        albedo_map.SetSize(texture_width, texture_height);
+    }
+
+    // Each band builds its own noise map, so bands of a few rows keep that overhead small
+    common::util::ParallelFor(
+        texture_height, 64,
+        [&](size_t begin, size_t end) {
+            GenerateBand(terrain_data, octaves, size, static_cast<int>(begin), static_cast<int>(end));
+        },
+        16);
 }
 
-void TerrainImageGenerator::GenerateHeightMap(int octaves, int size) {
+void TerrainImageGenerator::GenerateBand(const TerrainData* terrain_data, int octaves, int size, int begin_row,
+                                         int end_row) {
+    ZoneScoped;
     noise::module::Perlin noise_module;
     noise_module.SetOctaveCount(octaves);
     noise_module.SetNoiseQuality(noise::QUALITY_FAST);
     noise_module.SetSeed(terrain.seed);
     noise_module.SetFrequency(2);
 
+    int texture_width = 1 << size;
+    int texture_height = 1 << size;
+    double row_latitude = 180.0 / texture_height;
+
     noise::utils::NoiseMap noise_map;
-    int textureWidth = std::pow(2, size);
-    int textureHeight = std::pow(2, size);
     utils::NoiseMapBuilderSphere heightMapBuilder;
     heightMapBuilder.SetSourceModule(noise_module);
     heightMapBuilder.SetDestNoiseMap(noise_map);
-    heightMapBuilder.SetDestSize(textureWidth, textureHeight);
-
-    heightMapBuilder.SetBounds(-90.0, 90.0, -180.0, 180.0);
-
+    heightMapBuilder.SetDestSize(texture_width, end_row - begin_row);
+    // Rows go from south to north, so this band covers the same samples as the rows of the full map would
+    heightMapBuilder.SetBounds(-90.0 + begin_row * row_latitude, -90.0 + end_row * row_latitude, -180.0, 180.0);
     heightMapBuilder.Build();
 
+    // Render both images from the same band while the noise is still hot
+    noise::utils::Image band_image;
     noise::utils::RendererImage renderer;
     renderer.SetSourceNoiseMap(noise_map);
-    renderer.SetDestImage(height_map);
+    renderer.SetDestImage(band_image);
     renderer.Render();
+    CopyRows(band_image, height_map, begin_row);
+
+    if (terrain_data != nullptr) {
+        AddTerrainGradient(renderer, *terrain_data);
+        renderer.Render();
+        CopyRows(band_image, albedo_map, begin_row);
+    }
 }
 
 void TerrainImageGenerator::ClearData() {
@@ -25,9 +25,15 @@
 namespace cqsp {
 namespace client {
 namespace systems {
+/// <summary>
+/// Generates the height map and albedo map of a procedurally generated planet.
+/// </summary>
+/// The sphere is split into latitude bands which are generated in parallel, and each band renders
+/// both images while its noise is still in cache.
 class TerrainImageGenerator {
  public:
     void GenerateTerrain(cqsp::common::Universe& universe, int octaves, int size);
+    void GenerateTerrain(const cqsp::common::components::bodies::TerrainData& terrain_data, int octaves, int size);
     void GenerateHeightMap(int octaves, int size);
     void ClearData();
 
@@ -37,6 +43,10 @@ class TerrainImageGenerator {
     cqsp::common::components::bodies::Terrain terrain;
 
  private:
+    void Generate(const cqsp::common::components::bodies::TerrainData* terrain_data, int octaves, int size);
+    void GenerateBand(const cqsp::common::components::bodies::TerrainData* terrain_data, int octaves, int size,
+                      int begin_row, int end_row);
+
     noise::utils::Image height_map;
     noise::utils::Image albedo_map;
 };
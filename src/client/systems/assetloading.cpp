@@ -18,6 +18,8 @@
 
 #include <memory>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "client/systems/clientscripting.h"
 #include "common/scripting/luafunctions.h"
@@ -25,6 +27,7 @@
 #include "common/systems/loading/loadcities.h"
 #include "common/systems/loading/loadcountries.h"
 #include "common/systems/loading/loadgoods.h"
+#include "common/systems/loading/loadingpipeline.h"
 #include "common/systems/loading/loadnames.h"
 #include "common/systems/loading/loadplanets.h"
 #include "common/systems/loading/loadprovinces.h"
@@ -35,64 +38,122 @@
 #include "common/systems/sysuniversegenerator.h"
 
 namespace {
-void LoadResource(cqsp::engine::Application& app, cqsp::common::Universe& universe, const std::string& asset_name,
-                  void (*func)(cqsp::common::Universe& universe, Hjson::Value& recipes)) {
-    namespace cqspc = cqsp::common::components;
+using cqsp::common::systems::loading::LoadingPipeline;
+
+/// Gets the data of the hjson asset called `asset_name` in every package that has one.
+/// Getting an asset can load it, and the asset manager isn't thread safe, so this is called when the
+/// stages are added rather than in their prepare step.
+std::vector<Hjson::Value*> GatherHjson(cqsp::engine::Application& app, const std::string& asset_name) {
+    std::vector<Hjson::Value*> values;
     for (const auto& it : app.GetAssetManager()) {
         if (!it.second->HasAsset(asset_name)) {
             continue;
         }
-        cqsp::asset::HjsonAsset* good_assets = it.second->GetAsset<cqsp::asset::HjsonAsset>(asset_name);
-        try {
-            func(universe, good_assets->data);
-        } catch (std::runtime_error& error) {
-            SPDLOG_INFO("Failed to load hjson asset {}: {}", asset_name, error.what());
-        } catch (Hjson::index_out_of_bounds&) {
-        }
+        values.push_back(&it.second->GetAsset<cqsp::asset::HjsonAsset>(asset_name)->data);
     }
+    return values;
+}
+
+void AddStage(LoadingPipeline& pipeline, cqsp::engine::Application& app, cqsp::common::Universe& universe,
+              const std::string& asset_name, std::vector<std::string> inputs, std::vector<std::string> outputs,
+              void (*func)(cqsp::common::Universe& universe, Hjson::Value& recipes)) {
+    auto commit = [values = GatherHjson(app, asset_name), &universe, asset_name, func]() {
+        for (Hjson::Value* value : values) {
+            try {
+                func(universe, *value);
+            } catch (std::runtime_error& error) {
+                SPDLOG_INFO("Failed to load hjson asset {}: {}", asset_name, error.what());
+            } catch (Hjson::index_out_of_bounds&) {
+            }
+        }
+    };
+    pipeline.AddStage(asset_name, std::move(inputs), std::move(outputs), commit);
 }
 
 template <class T>
-void LoadResource(cqsp::engine::Application& app, cqsp::common::Universe& universe, const std::string& asset_name) {
+void AddStage(LoadingPipeline& pipeline, cqsp::engine::Application& app, cqsp::common::Universe& universe,
+              const std::string& asset_name, std::vector<std::string> inputs, std::vector<std::string> outputs) {
     using cqsp::common::systems::loading::HjsonLoader;
     static_assert(std::is_base_of<HjsonLoader, T>::value, "Class is not child of");
-    std::unique_ptr<HjsonLoader> ptr = std::make_unique<T>(universe);
-
-    namespace cqspc = cqsp::common::components;
-    for (const auto& it : app.GetAssetManager()) {
-        if (!it.second->HasAsset(asset_name)) {
-            continue;
-        }
-        cqsp::asset::HjsonAsset* good_assets = it.second->GetAsset<cqsp::asset::HjsonAsset>(asset_name);
+    // The loader only reads the hjson while preparing, the universe is only touched when committing
+    std::shared_ptr<HjsonLoader> loader = std::make_shared<T>(universe);
+    auto commit = [loader, asset_name]() {
         try {
-            ptr->LoadHjson(good_assets->data);
+            int count = loader->Commit();
+            SPDLOG_TRACE("Loaded {} {}", count, asset_name);
         } catch (std::runtime_error& error) {
             SPDLOG_INFO("Failed to load hjson asset {}: {}", asset_name, error.what());
-        } catch (Hjson::index_out_of_bounds&) {
         }
-    }
+    };
+    auto prepare = [loader, values = GatherHjson(app, asset_name), asset_name]() {
+        for (Hjson::Value* value : values) {
+            try {
+                loader->Prepare(*value);
+            } catch (std::runtime_error& error) {
+                SPDLOG_INFO("Failed to load hjson asset {}: {}", asset_name, error.what());
+            } catch (Hjson::index_out_of_bounds&) {
+            }
+        }
+    };
+    pipeline.AddStage(asset_name, std::move(inputs), std::move(outputs), commit, prepare);
 }
+
+// Assets that are only read to make the game objects, and aren't used again after
+constexpr const char* ingested_assets[] = {"goods",         "recipes", "planets", "timezones",  "countries",
+                                           "province_defs", "cities",  "names",   "tech_fields", "tech_list",
+                                           "satellites",    "terrain_colors"};
 }  // namespace
 
 namespace cqsp::client::systems {
 void LoadAllResources(cqsp::engine::Application& app, ConquerSpace& conquer_space) {
     using namespace cqsp::common::systems::loading;  // NOLINT
-    LoadResource<GoodLoader>(app, conquer_space.GetUniverse(), "goods");
-    LoadResource<RecipeLoader>(app, conquer_space.GetUniverse(), "recipes");
-    LoadResource<PlanetLoader>(app, conquer_space.GetUniverse(), "planets");
-    LoadResource<TimezoneLoader>(app, conquer_space.GetUniverse(), "timezones");
-    LoadResource<CountryLoader>(app, conquer_space.GetUniverse(), "countries");
-    LoadProvinces(conquer_space.GetUniverse(), app.GetAssetManager().GetAsset<asset::TextAsset>("province_defs")->data);
-    LoadResource<CityLoader>(app, conquer_space.GetUniverse(), "cities");
-    LoadResource(app, conquer_space.m_universe, "names", LoadNameLists);
-    LoadResource(app, conquer_space.m_universe, "tech_fields", common::systems::science::LoadFields);
-    LoadResource(app, conquer_space.m_universe, "tech_list", common::systems::science::LoadTechnologies);
-    common::systems::loading::LoadSatellites(conquer_space.GetUniverse(),
-                                             app.GetAssetManager().GetAsset<asset::TextAsset>("satellites")->data);
+    common::Universe& universe = conquer_space.GetUniverse();
+
+    // Stages are committed in the order they're added when their inputs allow it, which keeps the
+    // entities the same as when everything was loaded one after the other. The assets that the stages
+    // read are fetched here, on this thread, so prepare steps only parse data that is already loaded.
+    LoadingPipeline pipeline;
+    AddStage<GoodLoader>(pipeline, app, universe, "goods", {}, {"goods"});
+    AddStage<RecipeLoader>(pipeline, app, universe, "recipes", {"goods"}, {"recipes"});
+    AddStage<PlanetLoader>(pipeline, app, universe, "planets", {}, {"planets"});
+    AddStage<TimezoneLoader>(pipeline, app, universe, "timezones", {}, {"timezones"});
+    AddStage<CountryLoader>(pipeline, app, universe, "countries", {}, {"countries"});
+
+    auto provinces = std::make_shared<std::vector<ProvinceDefinition>>();
+    pipeline.AddStage(
+        "provinces", {"countries"}, {"provinces"}, [provinces, &universe]() { LoadProvinces(universe, *provinces); },
+        [provinces, province_defs = app.GetAssetManager().GetAsset<asset::TextAsset>("province_defs")]() {
+            *provinces = ParseProvinces(province_defs->data);
+        });
+
+    AddStage<CityLoader>(pipeline, app, universe, "cities",
+                         {"planets", "timezones", "recipes", "countries", "provinces"}, {"cities"});
+    AddStage(pipeline, app, universe, "names", {}, {"names"}, LoadNameLists);
+    AddStage(pipeline, app, universe, "tech_fields", {}, {"fields"}, common::systems::science::LoadFields);
+    AddStage(pipeline, app, universe, "tech_list", {"fields", "goods", "recipes"}, {"technologies"},
+             common::systems::science::LoadTechnologies);
+
+    // Satellites need the mass of the earth to parse their orbits, so there's nothing to prepare
+    pipeline.AddStage("satellites", {"planets"}, {"satellites"}, [&app, &universe]() {
+        LoadSatellites(universe, app.GetAssetManager().GetAsset<asset::TextAsset>("satellites")->data);
+    });
 
     // Initialize planet terrains
-    asset::HjsonAsset* asset = app.GetAssetManager().GetAsset<asset::HjsonAsset>("core:terrain_colors");
-    common::systems::loading::LoadTerrainData(conquer_space.GetUniverse(), asset->data);
+    pipeline.AddStage("terrain_colors", {}, {"terrain"},
+                      [terrain = app.GetAssetManager().GetAsset<asset::HjsonAsset>("core:terrain_colors"),
+                       &universe]() { LoadTerrainData(universe, terrain->data); });
+
+    pipeline.Run();
+
+    // Everything has been copied into the universe, so the parsed data can go. It's loaded again
+    // if another game is started.
+    uint64_t released = 0;
+    for (const char* name : ingested_assets) {
+        uint64_t bytes = app.GetAssetManager().ReleaseAssets(name);
+        SPDLOG_TRACE("Released {} bytes of {}", bytes, name);
+        released += bytes;
+    }
+    SPDLOG_INFO("Released {} KiB of ingested asset data", released / 1024);
 
     // Load scripts
     // Load lua functions
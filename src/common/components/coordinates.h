@@ -18,6 +18,8 @@
 
 #include <math.h>
 
+#include <vector>
+
 #include <entt/entt.hpp>
 #include <glm/glm.hpp>
 #include <glm/gtc/quaternion.hpp>
@@ -69,6 +71,21 @@ struct MoveTarget {
     explicit MoveTarget(entt::entity _targetent) : target(_targetent) {}
 };
 
+/// <summary>
+/// Burns planned to get to a `MoveTarget`, each of them is added as an `Impulse` on the tick it is due.
+/// </summary>
+struct ImpulseSchedule {
+    struct Burn {
+        /// Seconds
+        double time;
+        glm::dvec3 impulse;
+    };
+    /// In order of time
+    std::vector<Burn> burns;
+    /// Target the burns were planned for, so that they are planned again if it changes
+    entt::entity target = entt::null;
+};
+
 /// <summary>
 /// Longitude and lattitude.
 /// Planet coordinates.
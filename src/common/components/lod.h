@@ -0,0 +1,54 @@
+/* Conquer Space
+ * Copyright (C) 2021-2023 Conquer Space
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+namespace cqsp::common::components {
+/// <summary>
+/// How closely a market and the cities and factories on it are simulated.
+/// </summary>
+enum class LodTier {
+    /// Simulated every day
+    Full = 0,
+    /// Simulated every week, with a week's worth of production and consumption at once
+    Reduced = 1,
+    /// Simulated every month, with a month's worth of production and consumption at once
+    Dormant = 2,
+};
+
+struct SimulationLod {
+    LodTier tier = LodTier::Full;
+    /// Day that the entity was last simulated on
+    int last_day = 0;
+    /// Offset of the day the entity is simulated on, so that not everything in a tier is simulated on the same day
+    int phase = 0;
+    /// Days in a row that the entity could have been in a lower tier
+    int demote_days = 0;
+    /// Number of days that are simulated at once today, 0 if the entity isn't simulated today
+    int scale = 1;
+};
+
+/// <summary>
+/// Keeps a city, or the cities on a planet, at full detail no matter where the player is.
+/// </summary>
+struct FullDetail {};
+
+/// <summary>
+/// Planet that the player is looking at. Cities on it are kept at full detail, and cities on planets near it
+/// are kept at reduced detail.
+/// </summary>
+struct LodFocus {};
+}  // namespace cqsp::common::components
@@ -335,8 +335,8 @@ double ResourceLedger::MultiplyAndGetSum(ResourceLedger &other) {
     return sum;
 }
 
-ResourceLedger ResourceLedger::SafeDivision(const ResourceLedger &other) {
-    ResourceLedger ledger;
+ResourceLedger ResourceLedger::SafeDivision(const ResourceLedger &other, std::pmr::memory_resource *resource) {
+    ResourceLedger ledger(resource);
     ledger = *this;
     for (auto iterator = other.begin(); iterator != other.end(); iterator++) {
         if (iterator->second == 0) {
@@ -401,8 +401,8 @@ ResourceLedger RecipeOutput::operator*(ResourceLedger &ledger) const {
 /// <summary>
 /// Creates a new resource ledger using the keys from one resource ledger, and the values from annother
 /// </summary>
-ResourceLedger CopyVals(const ResourceLedger &keys, const ResourceLedger &values) {
-    ResourceLedger tkeys = keys;
+ResourceLedger CopyVals(const ResourceLedger &keys, const ResourceLedger &values, std::pmr::memory_resource *resource) {
+    ResourceLedger tkeys(resource);
     for (auto iterator = keys.begin(); iterator != keys.end(); iterator++) {
         tkeys[iterator->first] = values[iterator->first];
     }
@@ -18,7 +18,9 @@
 
 #include <iostream>
 #include <map>
+#include <memory_resource>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include <entt/entt.hpp>
@@ -71,11 +73,21 @@ struct Mineral {};
 // Good is for capital goods
 struct CapitalGood {};
 
-typedef std::map<entt::entity, double> LedgerMap;
+typedef std::pmr::map<entt::entity, double> LedgerMap;
 
 class ResourceLedger : private LedgerMap {
  public:
     ResourceLedger() = default;
+    /// <summary>
+    /// Creates a ledger that allocates from `resource`, such as the tick arena.
+    /// </summary>
+    /// Copying or moving a ledger always makes one on the heap, so that a ledger in an arena can be kept
+    /// by copying or moving it out. Assigning keeps the memory of the ledger that is assigned to.
+    explicit ResourceLedger(std::pmr::memory_resource* resource) : LedgerMap(resource) {}
+    ResourceLedger(const ResourceLedger&) = default;
+    ResourceLedger(ResourceLedger&& other) noexcept : LedgerMap(std::move(other), allocator_type()) {}
+    ResourceLedger& operator=(const ResourceLedger&) = default;
+    ResourceLedger& operator=(ResourceLedger&&) = default;
     ~ResourceLedger() = default;
 
     double operator[](const entt::entity) const;
@@ -174,7 +186,8 @@ class ResourceLedger : private LedgerMap {
     /// <summary>
     /// Returns a copy of the vector divided by the indicated vector, with division by zero resulting in infiniy
     /// </summary>
-    ResourceLedger SafeDivision(const ResourceLedger&);
+    ResourceLedger SafeDivision(const ResourceLedger&,
+                                std::pmr::memory_resource* resource = std::pmr::get_default_resource());
 
     /// <summary>
     /// Returns a copy of the vector divided by the indicated vector, with
@@ -224,7 +237,8 @@ class ResourceLedger : private LedgerMap {
     using LedgerMap::value_comp;
 };
 
-ResourceLedger CopyVals(const ResourceLedger& keys, const ResourceLedger& values);
+ResourceLedger CopyVals(const ResourceLedger& keys, const ResourceLedger& values,
+                        std::pmr::memory_resource* resource = std::pmr::get_default_resource());
 ResourceLedger ResourceLedgerZip(const ResourceLedger& key, const ResourceLedger& value);
 
 struct RecipeOutput {
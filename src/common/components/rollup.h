@@ -0,0 +1,49 @@
+/* Conquer Space
+ * Copyright (C) 2021-2023 Conquer Space
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <cstdint>
+
+#include <entt/entt.hpp>
+
+#include "common/components/resource.h"
+
+namespace cqsp::common::components {
+/// <summary>
+/// Totals of the cities in a province, country or planet. On a city, it's what the city added to them.
+/// </summary>
+struct Rollup {
+    uint64_t population = 0;
+    uint64_t labor_force = 0;
+    /// Value of everything produced, at market prices
+    double gdp = 0;
+    ResourceLedger production;
+    ResourceLedger consumption;
+    int cities = 0;
+};
+
+/// <summary>
+/// Where the rollup of a city was added, so that it can be taken out again if the city changes hands.
+/// </summary>
+struct RollupParents {
+    entt::entity province = entt::null;
+    entt::entity country = entt::null;
+    entt::entity planet = entt::null;
+
+    bool operator==(const RollupParents&) const = default;
+};
+}  // namespace cqsp::common::components
@@ -0,0 +1,81 @@
+/* Conquer Space
+ * Copyright (C) 2021-2023 Conquer Space
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "common/forecast.h"
+
+#include <spdlog/spdlog.h>
+
+#include <utility>
+
+#include <tracy/Tracy.hpp>
+
+#include "common/components/economy.h"
+#include "common/simulation.h"
+#include "common/util/universefork.h"
+
+namespace cqsp::common::systems::simulation {
+ForecastResult RunForecast(Game& fork, const ForecastRequest& request) {
+    ZoneScoped;
+    Universe& universe = fork.GetUniverse();
+    if (request.setup) {
+        request.setup(universe);
+    }
+    auto simulation = Simulation::ForForecast(fork);
+
+    std::vector<entt::entity> markets = request.markets;
+    if (markets.empty()) {
+        auto view = universe.view<components::Market>();
+        markets.assign(view.begin(), view.end());
+    }
+
+    ForecastResult result;
+    result.start_date = universe.date.GetDate();
+    for (entt::entity market : markets) {
+        auto& forecast = result.markets[market];
+        forecast.prices.reserve(request.days);
+        forecast.gdp.reserve(request.days);
+    }
+    for (int tick = 0; tick < request.days * components::StarDate::DAY; tick++) {
+        simulation->tick();
+        if (universe.date.GetDate() % components::StarDate::DAY != 0) {
+            continue;
+        }
+        for (auto& [market, forecast] : result.markets) {
+            if (!universe.valid(market) || !universe.all_of<components::Market>(market)) {
+                continue;
+            }
+            const auto& market_data = universe.get<components::Market>(market);
+            forecast.prices.push_back(market_data.price);
+            forecast.gdp.push_back(market_data.GDP);
+        }
+    }
+    result.end_date = universe.date.GetDate();
+    return result;
+}
+
+std::future<ForecastResult> StartForecast(Game& game, ForecastRequest request) {
+    auto fork = std::make_unique<Game>();
+    {
+        ZoneScopedN("Fork universe");
+        auto stats = util::ForkUniverse(game.GetUniverse(), fork->GetUniverse(), request.stream);
+        SPDLOG_DEBUG("Forked {} entities, {} components in {} pools, left out {} pools", stats.entities,
+                     stats.components, stats.pools, stats.skipped_pools);
+    }
+    return std::async(std::launch::async, [fork = std::move(fork), request = std::move(request)]() {
+        return RunForecast(*fork, request);
+    });
+}
+}  // namespace cqsp::common::systems::simulation
@@ -0,0 +1,72 @@
+/* Conquer Space
+ * Copyright (C) 2021-2023 Conquer Space
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "common/components/resource.h"
+#include "common/game.h"
+
+namespace cqsp::common::systems::simulation {
+/// <summary>
+/// What to forecast.
+/// </summary>
+struct ForecastRequest {
+    int days = 30;
+    /// <summary>
+    /// Changes to make to the fork before it is simulated, such as ordering a factory to see what it does
+    /// to prices. It's run on the forecast thread, and must only touch the universe it is given.
+    /// </summary>
+    std::function<void(Universe&)> setup;
+    /// Markets to report, every market if it's empty
+    std::vector<entt::entity> markets;
+    /// Random stream of the fork, forecasts with the same request and stream give the same result
+    uint32_t stream = 0;
+};
+
+/// <summary>
+/// Forecast of one market, with one entry at the end of every day.
+/// </summary>
+struct MarketForecast {
+    std::vector<components::ResourceLedger> prices;
+    std::vector<double> gdp;
+};
+
+struct ForecastResult {
+    int start_date = 0;
+    int end_date = 0;
+    std::map<entt::entity, MarketForecast> markets;
+};
+
+/// <summary>
+/// Forks the universe of `game` and simulates the fork for the number of days in the request on
+/// another thread.
+/// </summary>
+/// The fork is taken before this returns, so the game can keep ticking right after. Several forecasts
+/// can run at the same time, they don't share anything.
+std::future<ForecastResult> StartForecast(Game& game, ForecastRequest request);
+
+/// <summary>
+/// Simulates a game that holds a fork on the calling thread.
+/// </summary>
+ForecastResult RunForecast(Game& fork, const ForecastRequest& request);
+}  // namespace cqsp::common::systems::simulation
@@ -18,6 +18,7 @@
 
 #include "common/scripting/scripting.h"
 #include "common/universe.h"
+#include "common/util/tickarena.h"
 
 namespace cqsp {
 namespace common {
@@ -34,9 +35,15 @@ class Game {
 
     scripting::ScriptInterface& GetScriptInterface() { return script_interface; }
 
+    /// <summary>
+    /// Memory for data that systems only need during a tick, reset at the end of every tick.
+    /// </summary>
+    util::TickArenas& GetTickArenas() { return tick_arenas; }
+
  private:
     Universe universe;
     scripting::ScriptInterface script_interface;
+    util::TickArenas tick_arenas;
 };
 }  // namespace common
 }  // namespace cqsp
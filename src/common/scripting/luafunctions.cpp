@@ -176,8 +176,8 @@ void FunctionEconomy(cqsp::common::Universe& universe, cqsp::scripting::ScriptIn
                       [&](entt::entity city) { return cqspa::CreateCommercialArea(universe, city); });
 
     REGISTER_FUNCTION("set_resource_consume", [&](entt::entity entity, entt::entity good, double amount) {
-        auto& consumption = universe.get_or_emplace<cqspc::ResourceConsumption>(entity);
-        consumption[good] = amount;
+        universe.get_or_emplace<cqspc::ResourceConsumption>(entity);
+        universe.patch<cqspc::ResourceConsumption>(entity)[good] = amount;
     });
 
     REGISTER_FUNCTION("set_resource", [&](entt::entity planet, entt::entity resource, int seed) {
@@ -22,6 +22,8 @@
 #include <string>
 #include <vector>
 
+#include <tracy/Tracy.hpp>
+
 #include "common/components/area.h"
 #include "common/components/coordinates.h"
 #include "common/components/event.h"
@@ -35,23 +37,35 @@
 #include "common/systems/economy/sysfactory.h"
 #include "common/systems/economy/sysfinance.h"
 #include "common/systems/economy/sysinfrastructure.h"
+#include "common/systems/economy/syslod.h"
 #include "common/systems/economy/sysmarket.h"
 #include "common/systems/economy/syspopulation.h"
 #include "common/systems/economy/systrade.h"
 #include "common/systems/history/sysmarkethistory.h"
 #include "common/systems/movement/sysmovement.h"
 #include "common/systems/navy/sysnavy.h"
+#include "common/systems/population/sysrollup.h"
 #include "common/systems/science/syssciencelab.h"
 #include "common/systems/science/systechnology.h"
 #include "common/systems/scriptrunner.h"
+#include "common/util/memorycensus.h"
 #include "common/util/profiler.h"
 
 using cqsp::common::Universe;
 using cqsp::common::systems::simulation::Simulation;
 
-Simulation::Simulation(cqsp::common::Game& game) : m_game(game), m_universe(game.GetUniverse()) {
+Simulation::Simulation(cqsp::common::Game& game) : Simulation(game, false) {}
+
+std::unique_ptr<Simulation> Simulation::ForForecast(cqsp::common::Game& game) {
+    return std::unique_ptr<Simulation>(new Simulation(game, true));
+}
+
+Simulation::Simulation(cqsp::common::Game& game, bool forecast)
+    : m_game(game), m_universe(game.GetUniverse()), forecast(forecast) {
     namespace cqspcs = cqsp::common::systems;
-    AddSystem<cqspcs::SysScript>();
+    if (!forecast) {
+        AddSystem<cqspcs::SysScript>();
+    }
     AddSystem<cqspcs::SysWalletReset>();
 
     // AddSystem<cqspcs::SysNavyControl>();
@@ -59,6 +73,7 @@ Simulation::Simulation(cqsp::common::Game& game) : m_game(game), m_universe(game
     AddSystem<cqspcs::SysScienceLab>();
     AddSystem<cqspcs::SysTechProgress>();
 
+    AddSystem<cqspcs::SysLod>();
     AddSystem<cqspcs::InfrastructureSim>();
     AddSystem<cqspcs::SysPopulationConsumption>();
     AddSystem<cqspcs::SysProduction>();
@@ -67,9 +82,15 @@ Simulation::Simulation(cqsp::common::Game& game) : m_game(game), m_universe(game
     AddSystem<cqspcs::SysMarket>();
     AddSystem<cqspcs::SysTrade>();
     AddSystem<cqspcs::history::SysMarketHistory>();
+    AddSystem<cqspcs::SysRollup>();
+    AddSystem<cqspcs::SysPath>();
     AddSystem<cqspcs::SysOrbit>();
 
-    cqspcs::SysMarket::InitializeMarket(game);
+    if (!forecast) {
+        cqspcs::SysMarket::InitializeMarket(game);
+        // So that the interface has totals before the first day goes by
+        cqspcs::UpdateRollups(m_universe);
+    }
 }
 
 void Simulation::tick() {
@@ -87,11 +108,37 @@ void Simulation::tick() {
             sys->DoSystem();
         }
     }
+    // Everything the systems allocated for this tick goes at once
+    m_game.GetTickArenas().Reset();
+    if (state_digest) {
+        state_digest->Update();
+        SPDLOG_TRACE("State digest at {}: {:016x}", m_universe.date.GetDate(), state_digest->Get());
+    }
     END_TIMED_BLOCK(Game_Loop);
     auto end = std::chrono::high_resolution_clock::now();
     int len = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
     const int expected_len = 250;
-    if (len > expected_len) {
+    if (len > expected_len && !forecast) {
         SPDLOG_WARN("Tick has taken more than {} ms at {} ms", expected_len, len);
     }
+
+    if (!forecast && m_universe.date.GetDate() % memory_census_interval == 0) {
+        RecordMemoryCensus();
+    }
+}
+
+void Simulation::EnableStateDigest() {
+    if (!state_digest) {
+        state_digest = std::make_unique<cqsp::common::util::StateDigest>(m_universe);
+    }
+}
+
+void Simulation::RecordMemoryCensus() {
+    auto census = cqsp::common::util::TakeMemoryCensus(m_universe);
+    TracyPlot("Universe memory (KiB)", static_cast<int64_t>(census.TotalBytes() / 1024));
+    auto lines = cqsp::common::util::FormatMemoryCensus(census);
+    SPDLOG_INFO("{}", lines.front());
+    for (size_t i = 1; i < lines.size(); i++) {
+        SPDLOG_DEBUG("{}", lines[i]);
+    }
 }
@@ -21,6 +21,7 @@
 
 #include "common/game.h"
 #include "common/systems/isimulationsystem.h"
+#include "common/util/statedigest.h"
 
 namespace cqsp {
 namespace common {
@@ -39,6 +40,12 @@ class Simulation {
  public:
     explicit Simulation(cqsp::common::Game &game);
 
+    /// <summary>
+    /// Simulation of a universe forked with `cqsp::common::util::ForkUniverse`, see `StartForecast`.
+    /// </summary>
+    /// The markets of a fork are already initialized, and it doesn't run scripts or take memory censuses.
+    static std::unique_ptr<Simulation> ForForecast(cqsp::common::Game &game);
+
     /// <summary>
     /// 1 game tick, runs every single system that is added.
     /// </summary>
@@ -50,13 +57,33 @@ class Simulation {
         system_list.push_back(std::make_unique<T>(m_game));
     }
 
+    /// <summary>
+    /// Starts keeping a digest of the universe that is updated after every tick, so that two runs
+    /// can be checked against each other.
+    /// </summary>
+    void EnableStateDigest();
+    /// Digest of the universe after the last tick, null if it isn't enabled
+    const cqsp::common::util::StateDigest *GetStateDigest() const { return state_digest.get(); }
+
  private:
+    /// <summary>
+    /// Logs how much memory the universe uses, so that leaks show up over long games.
+    /// </summary>
+    void RecordMemoryCensus();
+
+    Simulation(cqsp::common::Game &game, bool forecast);
+
     cqsp::common::Game &m_game;
     /// <summary>
     /// Holds all the systems.
     /// </summary>
     std::vector<std::unique_ptr<cqsp::common::systems::ISimulationSystem>> system_list;
     cqsp::common::Universe &m_universe;
+    std::unique_ptr<cqsp::common::util::StateDigest> state_digest;
+    bool forecast;
+
+    /// Number of ticks between memory censuses, about a month
+    static constexpr int memory_census_interval = components::StarDate::DAY * 30;
 };
 }  // namespace simulation
 }  // namespace systems
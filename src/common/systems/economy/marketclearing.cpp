@@ -0,0 +1,62 @@
+/* Conquer Space
+ * Copyright (C) 2021-2023 Conquer Space
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "common/systems/economy/marketclearing.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "common/util/parallel.h"
+
+namespace cqsp::common::systems::economy {
+namespace {
+// Fewer markets than this are cleared on the calling thread, each good only takes a log and an exp
+constexpr size_t parallel_threshold = 64;
+}  // namespace
+
+void ClearMarket(std::span<const double> supply, std::span<const double> demand, std::span<double> price,
+                 const ClearingParameters& parameters) {
+    const size_t count = price.size();
+    const double elasticity = parameters.demand_elasticity + parameters.supply_elasticity;
+    for (size_t i = 0; i < count; i++) {
+        const double d = demand[i];
+        const double s = supply[i];
+        double change = 0;
+        if (d > 0 && s > 0) {
+            change = std::log(d / s) / elasticity;
+        } else if (d > 0) {
+            change = parameters.max_change;
+        } else if (s > 0) {
+            change = -parameters.max_change;
+        }
+        change = std::clamp(change, -parameters.max_change, parameters.max_change);
+        price[i] = std::max(std::max(price[i], parameters.min_price) * std::exp(change), parameters.min_price);
+    }
+}
+
+void ClearMarkets(size_t goods, std::span<const double> supply, std::span<const double> demand,
+                  std::span<double> price, const ClearingParameters& parameters) {
+    const size_t markets = goods == 0 ? 0 : price.size() / goods;
+    auto clear_range = [&](size_t begin, size_t end) {
+        for (size_t m = begin; m < end; m++) {
+            const size_t offset = m * goods;
+            ClearMarket(supply.subspan(offset, goods), demand.subspan(offset, goods), price.subspan(offset, goods),
+                        parameters);
+        }
+    };
+    util::ParallelFor(markets, parallel_threshold, clear_range);
+}
+}  // namespace cqsp::common::systems::economy
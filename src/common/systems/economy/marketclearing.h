@@ -0,0 +1,54 @@
+/* Conquer Space
+ * Copyright (C) 2021-2023 Conquer Space
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <cstddef>
+#include <span>
+
+namespace cqsp::common::systems::economy {
+/// <summary>
+/// How the market clearing solver models supply and demand.
+/// </summary>
+/// Between two days the supply and demand of a good are only known at one price. The solver assumes
+/// constant elasticities around that price, so demand goes to `demand * (p / p0) ^ -demand_elasticity`, and supply
+/// to `supply * (p / p0) ^ supply_elasticity`. Both elasticities have to be positive.
+struct ClearingParameters {
+    double demand_elasticity = 0.5;
+    double supply_elasticity = 0.5;
+    /// Largest change of the log of a price in a day, so that a good with no supply or no demand
+    /// doesn't go to infinity or zero at once
+    double max_change = 0.2;
+    double min_price = 0.00001;
+};
+
+/// <summary>
+/// Moves the prices of one market to the prices where supply meets demand.
+/// </summary>
+/// All of the spans are indexed by good, and have the same size. Goods don't affect each other, so every
+/// price is solved on its own: supply meets demand when the log of the price changes by
+/// `ln(demand / supply) / (demand_elasticity + supply_elasticity)`, which is clamped to `max_change`.
+/// Goods without supply and demand keep their price.
+void ClearMarket(std::span<const double> supply, std::span<const double> demand, std::span<double> price,
+                 const ClearingParameters& parameters);
+
+/// <summary>
+/// Clears many markets at once, splitting them between threads when there are enough of them.
+/// </summary>
+/// The spans hold one row of `goods` values for every market, one after the other.
+void ClearMarkets(size_t goods, std::span<const double> supply, std::span<const double> demand,
+                  std::span<double> price, const ClearingParameters& parameters);
+}  // namespace cqsp::common::systems::economy
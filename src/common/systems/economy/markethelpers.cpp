@@ -52,7 +52,7 @@ bool cqsp::common::systems::economy::PurchaseGood(Universe& universe, entt::enti
     // Calculating on how to buy from the market shouldn't be too hard, right?
     // Get the market connected to, and build the demand
     entt::entity market = universe.get<components::MarketAgent>(agent).market;
-    auto& market_comp = universe.get<components::Market>(market);
+    auto& market_comp = universe.patch<components::Market>(market);
     // Prices
     double cost = market_comp.GetPrice(purchase);
 
@@ -83,7 +83,7 @@ bool cqsp::common::systems::economy::SellGood(Universe& universe, entt::entity a
     // Calculating on how to buy from the market shouldn't be too hard, right?
     // Get the market connected to, and build the demand
     entt::entity market = universe.get<components::MarketAgent>(agent).market;
-    auto& market_comp = universe.get<components::Market>(market);
+    auto& market_comp = universe.patch<components::Market>(market);
     auto& agent_stockpile = universe.get<components::ResourceStockpile>(agent);
     market_comp.AddSupply(selling);
 
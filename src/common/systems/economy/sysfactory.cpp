@@ -18,6 +18,9 @@
 
 #include <spdlog/spdlog.h>
 
+#include <cmath>
+#include <memory_resource>
+
 #include <tracy/Tracy.hpp>
 
 #include "common/components/area.h"
@@ -26,6 +29,7 @@
 #include "common/components/name.h"
 #include "common/components/organizations.h"
 #include "common/components/surface.h"
+#include "common/systems/economy/syslod.h"
 #include "common/util/profiler.h"
 
 namespace cqsp::common::systems {
@@ -38,8 +42,10 @@ namespace {
 /// <param name="universe">Registry used for searching for components</param>
 /// <param name="entity">Entity containing an Inudstries that need to be processed</param>
 /// <param name="market">The market the industry uses.</param>
-void ProcessIndustries(Universe& universe, entt::entity entity) {
-    auto& market = universe.get<components::Market>(entity);
+/// <param name="days">Number of days to produce for, if the market isn't simulated every day</param>
+/// <param name="arena">Memory for the ledgers that only live while the industry is processed</param>
+void ProcessIndustries(Universe& universe, entt::entity entity, int days, std::pmr::memory_resource* arena) {
+    auto& market = universe.patch<components::Market>(entity);
     // Get the transport cost
     auto& infrastructure = universe.get<cqspc::infrastructure::CityInfrastructure>(entity);
     // Calculate the infrastructure cost
@@ -52,28 +58,34 @@ void ProcessIndustries(Universe& universe, entt::entity entity) {
         // Process imdustries
         // Industries MUST have production and a linked recipe
         if (!universe.all_of<components::Production>(productionentity)) continue;
-        components::Recipe recipe =
+        const components::Recipe& recipe =
             universe.get_or_emplace<components::Recipe>(universe.get<components::Production>(productionentity).recipe);
-        components::IndustrySize& size = universe.get_or_emplace<components::IndustrySize>(productionentity, 1000.0);
+        universe.get_or_emplace<components::IndustrySize>(productionentity, 1000.0);
+        components::IndustrySize& size = universe.patch<components::IndustrySize>(productionentity);
         // Calculate resource consumption
-        components::ResourceLedger capitalinput = recipe.capitalcost * (0.01 * size.size);
-        components::ResourceLedger input = (recipe.input + size.utilization) + capitalinput;
+        components::ResourceLedger capitalinput(arena);
+        capitalinput = recipe.capitalcost;
+        capitalinput *= 0.01 * size.size;
+        components::ResourceLedger input(arena);
+        input = recipe.input;
+        input += size.utilization;
+        input += capitalinput;
 
         // Calculate the greatest possible production
-        components::ResourceLedger output;  // * ratio.output;
+        components::ResourceLedger output(arena);  // * ratio.output;
         output[recipe.output.entity] = recipe.output.amount * size.utilization;
 
         // Figure out what's throttling production and maintenance
-        double limitedinput = CopyVals(input, market.history.back().sd_ratio).Min();
-        double limitedcapitalinput = CopyVals(capitalinput, market.history.back().sd_ratio).Min();
+        double limitedinput = CopyVals(input, market.history.back().sd_ratio, arena).Min();
+        double limitedcapitalinput = CopyVals(capitalinput, market.history.back().sd_ratio, arena).Min();
 
         // Log how much manufacturing is being throttled by input
         market[recipe.output.entity].inputratio = limitedinput;
 
         if (market.sd_ratio[recipe.output.entity] < 1.1) {
-            size.utilization *= 1 + (0.01) * std::fmin(limitedcapitalinput, 1);
+            size.utilization *= std::pow(1 + (0.01) * std::fmin(limitedcapitalinput, 1), days);
         } else {
-            size.utilization *= 0.99;
+            size.utilization *= std::pow(0.99, days);
         }
         size.utilization = std::clamp(size.utilization, 0., size.size);
 
@@ -84,8 +96,8 @@ void ProcessIndustries(Universe& universe, entt::entity entity) {
             // Industry
         }
 
-        market.demand += input;
-        market.supply += output;
+        market.demand.MultiplyAdd(input, days);
+        market.supply.MultiplyAdd(output, days);
 
         double output_transport_cost = output.GetSum() * infra_cost;
         double input_transport_cost = input.GetSum() * infra_cost;
@@ -105,15 +117,9 @@ void ProcessIndustries(Universe& universe, entt::entity entity) {
         costs.wages = size.size * recipe.workers * size.wages;
         costs.profit = costs.revenue - costs.maintenance - costs.materialcosts - costs.wages;
         costs.transport = output_transport_cost + input_transport_cost;
-        double& price = market.price[recipe.output.entity];
-        if (costs.profit > 0) {
-            price += (-0.1 + price * -0.01f);
-        } else {
-            price += (0.2 + price * 0.01f);
-        }
 
         // Pay the workers
-        population_wallet += costs.wages;
+        population_wallet += costs.wages * days;
     }
 }
 }  // namespace
@@ -127,9 +133,14 @@ void SysProduction::DoSystem() {
     int factories = 0;
     // Loop through the markets
     int settlement_count = 0;
+    std::pmr::memory_resource* arena = GetTickArena();
     // Get the markets and process the values?
     for (entt::entity entity : view) {
-        ProcessIndustries(universe, entity);
+        int days = GetLodScale(universe, entity);
+        if (days == 0) {
+            continue;
+        }
+        ProcessIndustries(universe, entity, days, arena);
     }
     END_TIMED_BLOCK(INDUSTRY);
     SPDLOG_TRACE("Updated {} factories, {} industries", factories, view.size());
@@ -0,0 +1,152 @@
+/* Conquer Space
+ * Copyright (C) 2021-2023 Conquer Space
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "common/systems/economy/syslod.h"
+
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
+
+#include <tracy/Tracy.hpp>
+
+#include "common/components/coordinates.h"
+#include "common/components/economy.h"
+#include "common/components/orbit.h"
+#include "common/components/organizations.h"
+#include "common/components/player.h"
+#include "common/components/surface.h"
+
+namespace cqsp::common::systems {
+namespace cqspc = cqsp::common::components;
+
+namespace {
+void UpdateLod(Universe& universe, entt::entity entity, cqspc::LodTier desired, int day) {
+    auto* lod = universe.try_get<cqspc::SimulationLod>(entity);
+    if (lod == nullptr) {
+        // New entities start in their tier straight away, as if they were simulated yesterday
+        lod = &universe.emplace<cqspc::SimulationLod>(entity);
+        lod->tier = desired;
+        lod->last_day = day - 1;
+        lod->phase = static_cast<int>(entt::to_integral(entity) % LodInterval(cqspc::LodTier::Dormant));
+    }
+
+    if (desired < lod->tier) {
+        lod->tier = desired;
+        lod->demote_days = 0;
+    } else if (desired > lod->tier) {
+        lod->demote_days++;
+        if (lod->demote_days >= SysLod::demotion_delay) {
+            lod->tier = static_cast<cqspc::LodTier>(static_cast<int>(lod->tier) + 1);
+            lod->demote_days = 0;
+        }
+    } else {
+        lod->demote_days = 0;
+    }
+
+    const int interval = LodInterval(lod->tier);
+    if ((day + lod->phase) % interval == 0 || day - lod->last_day >= interval) {
+        lod->scale = day - lod->last_day;
+        lod->last_day = day;
+    } else {
+        lod->scale = 0;
+    }
+}
+}  // namespace
+
+void SysLod::DoSystem() {
+    ZoneScoped;
+    Universe& universe = GetUniverse();
+    const int day = universe.date.GetDate() / components::StarDate::DAY;
+    entt::entity player = universe.view<cqspc::Player>().front();
+
+    // Planets the player is looking at or has cities on
+    std::unordered_set<entt::entity> focus;
+    for (entt::entity planet : universe.view<cqspc::LodFocus>()) {
+        focus.insert(planet);
+    }
+    for (entt::entity city : universe.view<cqspc::Settlement, cqspc::Governed>()) {
+        const auto* coordinate = universe.try_get<cqspc::types::SurfaceCoordinate>(city);
+        if (coordinate != nullptr && universe.get<cqspc::Governed>(city).governor == player) {
+            focus.insert(coordinate->planet);
+        }
+    }
+
+    // Planets that orbit a focused planet, orbit the same body as one, or are orbited by one
+    std::unordered_set<entt::entity> parents;
+    for (entt::entity planet : focus) {
+        if (const auto* orbit = universe.try_get<cqspc::types::Orbit>(planet)) {
+            parents.insert(orbit->reference_body);
+        }
+    }
+    std::unordered_set<entt::entity> near = parents;
+    for (entt::entity body : universe.view<cqspc::types::Orbit>()) {
+        entt::entity reference = universe.get<cqspc::types::Orbit>(body).reference_body;
+        if (focus.contains(reference) || parents.contains(reference)) {
+            near.insert(body);
+        }
+    }
+
+    std::unordered_map<entt::entity, cqspc::LodTier> planet_tiers;
+    for (entt::entity city : universe.view<cqspc::Settlement>()) {
+        const auto* coordinate = universe.try_get<cqspc::types::SurfaceCoordinate>(city);
+        const auto* governed = universe.try_get<cqspc::Governed>(city);
+        entt::entity planet = coordinate == nullptr ? entt::null : coordinate->planet;
+        cqspc::LodTier tier = cqspc::LodTier::Dormant;
+        // Cities that we can't place anywhere are kept at full detail to be safe
+        if (planet == entt::null || focus.contains(planet) || universe.any_of<cqspc::FullDetail>(city) ||
+            universe.any_of<cqspc::FullDetail>(planet) || (governed != nullptr && governed->governor == player)) {
+            tier = cqspc::LodTier::Full;
+        } else if (near.contains(planet)) {
+            tier = cqspc::LodTier::Reduced;
+        }
+        UpdateLod(universe, city, tier, day);
+
+        if (planet != entt::null) {
+            auto [it, inserted] = planet_tiers.emplace(planet, tier);
+            it->second = std::min(it->second, tier);
+        }
+    }
+
+    for (entt::entity planet : universe.view<cqspc::Habitation>()) {
+        cqspc::LodTier tier = cqspc::LodTier::Dormant;
+        auto it = planet_tiers.find(planet);
+        if (it != planet_tiers.end()) {
+            tier = it->second;
+        }
+        if (focus.contains(planet) || universe.any_of<cqspc::FullDetail>(planet)) {
+            tier = cqspc::LodTier::Full;
+        }
+        UpdateLod(universe, planet, tier, day);
+    }
+}
+
+int LodInterval(cqspc::LodTier tier) {
+    switch (tier) {
+        case cqspc::LodTier::Full:
+            return 1;
+        case cqspc::LodTier::Reduced:
+            return 7;
+        case cqspc::LodTier::Dormant:
+            return 30;
+    }
+    return 1;
+}
+
+int GetLodScale(const Universe& universe, entt::entity entity) {
+    const auto* lod = universe.try_get<cqspc::SimulationLod>(entity);
+    return lod == nullptr ? 1 : lod->scale;
+}
+}  // namespace cqsp::common::systems
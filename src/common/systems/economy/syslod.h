@@ -0,0 +1,54 @@
+/* Conquer Space
+ * Copyright (C) 2021-2023 Conquer Space
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include "common/components/lod.h"
+#include "common/systems/isimulationsystem.h"
+
+namespace cqsp::common::systems {
+/// <summary>
+/// Decides how closely each city and planetary market is simulated.
+/// </summary>
+/// Cities owned by the player, tagged with `FullDetail`, or on a planet with a `LodFocus` or any of the
+/// player's cities, are simulated every day. Cities on planets that orbit the same body as one of those planets,
+/// or orbit one of them, are simulated every week, and everything else every month. A planetary market is
+/// simulated as closely as the closest of its cities.
+///
+/// When an entity is simulated, the economic systems scale what they produce and consume by the number of days
+/// since it was last simulated, and the market divides it back into daily amounts. Entities are promoted to a
+/// closer tier at once, and only demoted one tier at a time after they have been far away for a while, so that
+/// nothing flickers between tiers. This has to run before the economic systems.
+class SysLod : public ISimulationSystem {
+ public:
+    explicit SysLod(Game& game) : ISimulationSystem(game) {}
+    void DoSystem() override;
+
+    /// Days an entity has to be eligible for a lower tier before it is demoted
+    static constexpr int demotion_delay = 14;
+};
+
+/// <summary>
+/// Number of days between simulations of an entity in the tier.
+/// </summary>
+int LodInterval(components::LodTier tier);
+
+/// <summary>
+/// Number of days of production and consumption that an entity has to simulate today.
+/// </summary>
+/// This is 0 if the entity is skipped today, and 1 if it doesn't have a level of detail.
+int GetLodScale(const Universe& universe, entt::entity entity);
+}  // namespace cqsp::common::systems
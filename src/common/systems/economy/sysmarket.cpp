@@ -16,61 +16,78 @@
  */
 #include "common/systems/economy/sysmarket.h"
 
+#include <algorithm>
 #include <fstream>
 #include <limits>
+#include <memory_resource>
 #include <utility>
+#include <vector>
 
 #include <tracy/Tracy.hpp>
 
 #include "common/components/economy.h"
 #include "common/components/name.h"
+#include "common/systems/economy/syslod.h"
 
 void cqsp::common::systems::SysMarket::DoSystem() {
     ZoneScoped;
-    // Get all the new and improved (tm) markets
-    auto marketview = GetUniverse().view<components::Market>();
+    Universe& universe = GetUniverse();
+    auto marketview = universe.view<components::Market>();
     SPDLOG_INFO("Processing {} market(s)", marketview.size());
     TracyPlot("Market Count", (int64_t)marketview.size());
-    auto goodsview = GetUniverse().view<components::Price>();
-    Universe& universe = GetUniverse();
-    // Calculate all the things
-    for (entt::entity entity : marketview) {
-        // Get the resources and process the price, then do things, I guess
-        // Get demand
-        components::Market& market = universe.get<components::Market>(entity);
+    auto goodsview = universe.view<components::Price>();
+    std::pmr::memory_resource* arena = GetTickArena();
 
-        // TODO(EhWhoAmI): GDP Calculations
-        // market.gdp = market.volume* market.price;
+    // Markets that aren't simulated every day are only cleared on the days that they are simulated
+    std::pmr::vector<entt::entity> markets(arena);
+    markets.reserve(marketview.size());
+    for (entt::entity entity : marketview) {
+        int days = GetLodScale(universe, entity);
+        if (days == 0) {
+            continue;
+        }
+        markets.push_back(entity);
+        if (days > 1) {
+            // Everything since the market was last cleared was added at once, turn it back into daily amounts
+            components::Market& market = universe.get<components::Market>(entity);
+            market.supply /= days;
+            market.demand /= days;
+            market.latent_supply /= days;
+            market.latent_demand /= days;
+        }
+    }
 
+    // Copy supply, demand and prices into dense rows, one row per market, so that the solver doesn't
+    // have to look anything up in the ledgers
+    const size_t good_count = goodsview.size();
+    const size_t size = markets.size() * good_count;
+    std::pmr::vector<double> supply(size, arena);
+    std::pmr::vector<double> demand(size, arena);
+    std::pmr::vector<double> prices(size, arena);
+    size_t offset = 0;
+    for (entt::entity entity : markets) {
+        components::Market& market = universe.get<components::Market>(entity);
         // Calculate Supply and demand
-        market.sd_ratio = market.supply.SafeDivision(market.demand);
-        // market.ds_ratio = market.previous_demand.SafeDivision(market.supply);
-        // market.ds_ratio = market.ds_ratio.Clamp(0, 2);
-
+        market.sd_ratio = market.supply.SafeDivision(market.demand, arena);
         for (entt::entity good_entity : goodsview) {
-            const double sd_ratio = market.sd_ratio[good_entity];
-            double& price = market.price[good_entity];
-            // If supply and demand = 0, then it will be undefined
-            if (sd_ratio < 1) {
-                // Too much demand, so we will increase the price
-                // Later increase it based on SD ratio
-                price += (0.02 + price * 0.01f);
-                //price = 0.5;
-            } else if (sd_ratio > 1 || sd_ratio == std::numeric_limits<double>::infinity()) {
-                // Too much supply, so we will decrease the price
-                price += (-0.01 + price * -0.01f);
+            const components::ResourceLedger& market_supply = market.supply;
+            const components::ResourceLedger& market_demand = market.demand;
+            const components::ResourceLedger& market_price = market.price;
+            supply[offset] = market_supply[good_entity];
+            demand[offset] = market_demand[good_entity];
+            prices[offset] = market_price[good_entity];
+            offset++;
+        }
+    }
+
+    economy::ClearMarkets(good_count, supply, demand, prices, clearing);
 
-                // Limit price to a minimum of 0.001
-                if (price < 0.00001) {
-                    price = 0.00001;
-                }
-            } else {
-                // Keep price approximately the same
-            }
+    offset = 0;
+    for (entt::entity entity : markets) {
+        components::Market& market = universe.patch<components::Market>(entity);
+        for (entt::entity good_entity : goodsview) {
+            market.price[good_entity] = prices[offset++];
         }
-        // Set the previous supply and demand
-        //components::MarketInformation current = market;
-        //market.history.push_back(current);
 
         // Swap and clear?
         std::swap(market.supply, market.previous_supply);
@@ -93,7 +110,7 @@ void cqsp::common::systems::SysMarket::InitializeMarket(Game& game) {
     for (entt::entity entity : marketview) {
         // Get the resources and process the price, then do things, I guess
         // Get demand
-        components::Market& market = universe.get<components::Market>(entity);
+        components::Market& market = universe.patch<components::Market>(entity);
 
         // Initialize the price
         for (entt::entity goodenity : goodsview) {
@@ -16,9 +16,15 @@
  */
 #pragma once
 
+#include "common/systems/economy/marketclearing.h"
 #include "common/systems/isimulationsystem.h"
 
 namespace cqsp::common::systems {
+/// <summary>
+/// Sets the prices of every market from the supply and demand of the day, and then starts the next day.
+/// </summary>
+/// Prices are solved for the price where supply meets demand, instead of being nudged up or down by a fixed
+/// step every day, so that they settle in a few days instead of oscillating for months.
 class SysMarket : public ISimulationSystem {
  public:
     explicit SysMarket(Game& game) : ISimulationSystem(game) {}
@@ -30,5 +36,7 @@ class SysMarket : public ISimulationSystem {
     /// </summary>
     /// <param name="game"></param>
     static void InitializeMarket(Game& game);
+
+    economy::ClearingParameters clearing;
 };
 }  // namespace cqsp::common::systems
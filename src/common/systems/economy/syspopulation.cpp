@@ -18,6 +18,8 @@
 
 #include <spdlog/spdlog.h>
 
+#include <memory_resource>
+
 #include <tracy/Tracy.hpp>
 
 #include "common/components/economy.h"
@@ -26,6 +28,7 @@
 #include "common/components/population.h"
 #include "common/components/resource.h"
 #include "common/components/surface.h"
+#include "common/systems/economy/syslod.h"
 
 namespace cqspc = cqsp::common::components;
 
@@ -41,7 +44,7 @@ void SysPopulationGrowth::DoSystem() {
 
     auto view = universe.view<cqspc::PopulationSegment>();
     for (entt::entity entity : view) {
-        auto& segment = universe.get<cqspc::PopulationSegment>(entity);
+        auto& segment = universe.patch<cqspc::PopulationSegment>(entity);
         // If it's hungry, decay population
         if (universe.all_of<cqspc::Hunger>(entity)) {
             // Population decrease will be about 1 percent each year.
@@ -75,7 +78,8 @@ void SysPopulationGrowth::DoSystem() {
 namespace {
 void ProcessSettlement(cqsp::common::Universe& universe, entt::entity settlement, cqspc::Market& market,
                        cqspc::ResourceConsumption& marginal_propensity_base,
-                       cqspc::ResourceConsumption& autonomous_consumption_base, float savings) {
+                       cqspc::ResourceConsumption& autonomous_consumption_base, float savings, int days,
+                       std::pmr::memory_resource* arena) {
     // Get the transport cost
     auto& infrastructure = universe.get<cqspc::infrastructure::CityInfrastructure>(settlement);
     // Calculate the infrastructure cost
@@ -86,7 +90,8 @@ void ProcessSettlement(cqsp::common::Universe& universe, entt::entity settlement
     for (entt::entity segmententity : settlement_comp.population) {
         // Compute things
         cqspc::PopulationSegment& segment = universe.get_or_emplace<cqspc::PopulationSegment>(segmententity);
-        cqspc::ResourceConsumption& consumption = universe.get_or_emplace<cqspc::ResourceConsumption>(segmententity);
+        universe.get_or_emplace<cqspc::ResourceConsumption>(segmententity);
+        cqspc::ResourceConsumption& consumption = universe.patch<cqspc::ResourceConsumption>(segmententity);
         // Reduce pop to some unreasonably low level so that the economy can
         // handle it
         const uint64_t population = segment.population / 10;
@@ -98,11 +103,13 @@ void ProcessSettlement(cqsp::common::Universe& universe, entt::entity settlement
         consumption *= population;
 
         cqspc::Wallet& wallet = universe.get_or_emplace<cqspc::Wallet>(segmententity);
-        const double cost = (consumption * market.price).GetSum();
+        // Markets that aren't simulated every day pay for the days that they skipped
+        const double cost = (consumption * market.price).GetSum() * days;
         wallet -= cost;    // Spend, even if it puts the pop into debt
         if (wallet > 0) {  // If the pop has cash left over spend it
             // Add to the cost of price of transport
-            cqspc::ResourceConsumption extraconsumption = marginal_propensity_base;
+            cqspc::ResourceLedger extraconsumption(arena);
+            extraconsumption = marginal_propensity_base;
             // Loop through all the things, if there isn't enough resources for a
             // If the market supply has all of the goods, then they can buy the goods
             // Get previous market supply
@@ -119,7 +126,7 @@ void ProcessSettlement(cqsp::common::Universe& universe, entt::entity settlement
                     // Then they cannot buy the stuff
                     // Then do the consumption
                     // Add to latent demand
-                    market.latent_demand[t.first] += t.second;
+                    market.latent_demand[t.first] += t.second * days;
                     t.second = 0;
                 }
             }
@@ -132,9 +139,9 @@ void ProcessSettlement(cqsp::common::Universe& universe, entt::entity settlement
         }
 
         // TODO(EhWhoAmI): Don't inject cash, take the money from the government
-        wallet += segment.population * 50000;  // Inject cash
+        wallet += segment.population * 50000 * days;  // Inject cash
 
-        market.demand += consumption;
+        market.demand.MultiplyAdd(consumption, days);
     }
 }
 }  // namespace
@@ -183,16 +190,22 @@ void SysPopulationConsumption::DoSystem() {
 
     // Loop through the settlements on a planet, then process the market?
     auto market_view = universe.view<cqspc::Habitation>();
+    std::pmr::memory_resource* arena = GetTickArena();
     int settlement_count = 0;
     for (entt::entity entity : market_view) {
+        int days = GetLodScale(universe, entity);
+        if (days == 0) {
+            continue;
+        }
         // Get the children, because reasons
         // All planets with a habitation WILL have a market
-        auto& market = universe.get_or_emplace<cqspc::Market>(entity);
+        universe.get_or_emplace<cqspc::Market>(entity);
+        auto& market = universe.patch<cqspc::Market>(entity);
         // Read the segment information
         auto& habit = universe.get<cqspc::Habitation>(entity);
         for (entt::entity settlement : habit.settlements) {
             ProcessSettlement(universe, settlement, market, marginal_propensity_base, autonomous_consumption_base,
-                              savings);
+                              savings, days, arena);
             settlement_count++;
         }
     }
@@ -28,7 +28,7 @@ void cqsp::common::systems::SysTrade::DoSystem() {
     auto planetary_markets =
         GetUniverse().view<components::Market, components::PlanetaryMarket, components::Habitation>();
     for (entt::entity entity : planetary_markets) {
-        auto& p_market = GetUniverse().get<components::Market>(entity);
+        auto& p_market = GetUniverse().patch<components::Market>(entity);
         auto& habitation = GetUniverse().get<components::Habitation>(entity);
         for (entt::entity habitation : habitation.settlements) {
             if (!GetUniverse().any_of<components::Market>(habitation)) {
@@ -16,6 +16,8 @@
  */
 #pragma once
 
+#include <memory_resource>
+
 #include <entt/entt.hpp>
 
 #include "common/game.h"
@@ -39,6 +41,14 @@ class ISimulationSystem {
     Game& GetGame() { return game; }
     Universe& GetUniverse() { return game.GetUniverse(); }
 
+    /// <summary>
+    /// Arena of the calling thread, for data that is thrown away by the end of the tick.
+    /// </summary>
+    /// Containers allocated from it must not be kept after `DoSystem` returns, copy them into a
+    /// component to keep them. Finding the arena takes a lock, so get it once per `DoSystem` rather
+    /// than once per entity.
+    std::pmr::memory_resource* GetTickArena() { return game.GetTickArenas().Local().GetResource(); }
+
  private:
     Game& game;
 };
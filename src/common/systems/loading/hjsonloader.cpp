@@ -18,31 +18,118 @@
 
 #include <spdlog/spdlog.h>
 
+#include <algorithm>
+#include <string>
+#include <utility>
 #include <vector>
 
+#include <tracy/Tracy.hpp>
+
 #include "common/components/name.h"
-#include "common/systems/loading/loadutil.h"
+#include "common/util/parallel.h"
 
 namespace cqsp::common::systems::loading {
-int HjsonLoader::LoadHjson(const Hjson::Value& values) {
-    int assets = 0;
-    std::vector<entt::entity> entity_list;
-    for (int i = 0; i < values.size(); i++) {
-        Hjson::Value value = values[i];
+Hjson::Value ApplyDefaults(const Hjson::Value& defaults, const Hjson::Value& value) {
+    if (defaults.type() != Hjson::Type::Map || value.type() != Hjson::Type::Map) {
+        return value;
+    }
+    // Keys are visited by index so that they keep the same order as they would after a merge
+    Hjson::Value result(Hjson::Type::Map);
+    for (int i = 0; i < static_cast<int>(defaults.size()); i++) {
+        std::string key = defaults.key(i);
+        const Hjson::Value& default_value = defaults[key];
+        const Hjson::Value& override_value = value[key];
+        if (!override_value.defined()) {
+            result[key] = default_value;
+        } else if (override_value.type() == Hjson::Type::Map && default_value.type() == Hjson::Type::Map) {
+            result[key] = ApplyDefaults(default_value, override_value);
+        } else {
+            result[key] = override_value;
+        }
+    }
+    for (int i = 0; i < static_cast<int>(value.size()); i++) {
+        std::string key = value.key(i);
+        if (!defaults[key].defined()) {
+            result[key] = value[key];
+        }
+    }
+    return result;
+}
+
+std::optional<HjsonLoader::Record> HjsonLoader::ReadRecord(const Hjson::Value& value, const Hjson::Value& defaults) {
+    if (value["identifier"].type() != Hjson::Type::String) {
+        return std::nullopt;
+    }
+    Record record;
+    record.identifier = value["identifier"].to_string();
+    if (value["name"].type() == Hjson::Type::String) {
+        record.name = value["name"].to_string();
+    }
+    if (value["description"].type() == Hjson::Type::String) {
+        record.description = value["description"].to_string();
+    }
+    record.value = ApplyDefaults(defaults, value);
+    return record;
+}
 
-        entt::entity entity = universe.create();
-        if (!LoadInitialValues(universe, entity, value)) {
+void HjsonLoader::Prepare(const Hjson::Value& values) {
+    ZoneScoped;
+    const Hjson::Value& defaults = GetDefaultValues();
+    const size_t count = values.size();
+    std::vector<std::optional<Record>> read(count);
+    auto read_range = [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            read[i] = ReadRecord(values[static_cast<int>(i)], defaults);
+        }
+    };
+    util::ParallelFor(count, parallel_threshold, read_range);
+
+    records.reserve(records.size() + count);
+    for (auto& record : read) {
+        if (!record) {
             SPDLOG_WARN("No identifier");
-            universe.destroy(entity);
             continue;
         }
+        records.push_back(std::move(*record));
+    }
+}
+
+int HjsonLoader::Commit() {
+    ZoneScoped;
+    std::vector<entt::entity> entities(records.size());
+    universe.create(entities.begin(), entities.end());
 
-        value = Hjson::Merge(GetDefaultValues(), value);
+    // Emplace the components every loader has in bulk, then the rest one by one
+    std::vector<components::Identifier> identifiers;
+    identifiers.reserve(records.size());
+    std::vector<entt::entity> named;
+    std::vector<components::Name> names;
+    std::vector<entt::entity> described;
+    std::vector<components::Description> descriptions;
+    for (size_t i = 0; i < records.size(); i++) {
+        identifiers.push_back(components::Identifier {std::move(records[i].identifier)});
+        if (records[i].name) {
+            named.push_back(entities[i]);
+            names.push_back(components::Name {std::move(*records[i].name)});
+        }
+        if (records[i].description) {
+            described.push_back(entities[i]);
+            descriptions.push_back(components::Description {std::move(*records[i].description)});
+        }
+    }
+    universe.insert<components::Identifier>(entities.begin(), entities.end(), identifiers.begin());
+    universe.insert<components::Name>(named.begin(), named.end(), names.begin());
+    universe.insert<components::Description>(described.begin(), described.end(), descriptions.begin());
 
+    int assets = 0;
+    std::vector<entt::entity> entity_list;
+    entity_list.reserve(entities.size());
+    for (size_t i = 0; i < records.size(); i++) {
+        entt::entity entity = entities[i];
         // Catch errors
         bool success = false;
         try {
-            success = LoadValue(value, entity);
+            success = LoadValue(records[i].value, entity);
         } catch (Hjson::index_out_of_bounds& ioob) {
             auto& id = universe.get<components::Identifier>(entity).identifier;
             SPDLOG_WARN("Index out of bounds for {}: {}", id, ioob.what());
@@ -58,6 +145,7 @@ int HjsonLoader::LoadHjson(const Hjson::Value& values) {
         entity_list.push_back(entity);
         assets++;
     }
+    records.clear();
 
     // Load all the assets again to parse?
     for (entt::entity entity : entity_list) {
@@ -66,4 +154,9 @@ int HjsonLoader::LoadHjson(const Hjson::Value& values) {
 
     return assets;
 }
+
+int HjsonLoader::LoadHjson(const Hjson::Value& values) {
+    Prepare(values);
+    return Commit();
+}
 }  // namespace cqsp::common::systems::loading
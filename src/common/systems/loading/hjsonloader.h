@@ -18,19 +18,61 @@
 
 #include <hjson.h>
 
+#include <optional>
+#include <string>
+#include <vector>
+
 #include "common/universe.h"
 
 namespace cqsp::common::systems::loading {
+/// <summary>
+/// Loads an hjson array of objects into one entity each.
+/// </summary>
+/// Loading happens in two phases. `Prepare` validates the elements and applies the default values,
+/// split across worker threads, and doesn't touch the universe. `Commit` then creates all the entities
+/// at once and calls `LoadValue` on each of them on the calling thread, in the order of the elements.
+/// `LoadHjson` does both.
 class HjsonLoader {
  public:
     explicit HjsonLoader(Universe& universe) : universe(universe) {}
     virtual ~HjsonLoader() = default;
     virtual const Hjson::Value& GetDefaultValues() = 0;
     int LoadHjson(const Hjson::Value& values);
+    /// <summary>
+    /// Reads the elements of `values` into records to be committed. This may be called several times
+    /// before committing, and can run on any thread, as long as it's not at the same time as `Commit`.
+    /// </summary>
+    void Prepare(const Hjson::Value& values);
+    /// <summary>
+    /// Creates the entities for every prepared record, and returns the number that loaded successfully.
+    /// </summary>
+    int Commit();
     virtual bool LoadValue(const Hjson::Value& values, entt::entity entity) = 0;
     virtual void PostLoad(const entt::entity& entity) {}
 
  protected:
     Universe& universe;
+
+ private:
+    struct Record {
+        std::string identifier;
+        std::optional<std::string> name;
+        std::optional<std::string> description;
+        // The element with the default values applied
+        Hjson::Value value;
+    };
+
+    static std::optional<Record> ReadRecord(const Hjson::Value& value, const Hjson::Value& defaults);
+
+    std::vector<Record> records;
+    // Fewer elements than this are read on the calling thread
+    static constexpr size_t parallel_threshold = 256;
 };
+
+/// <summary>
+/// Returns `value` with the keys that are only in `defaults` added to it.
+/// </summary>
+/// This gives the same result as `Hjson::Merge(defaults, value)`, but shares the values of both instead
+/// of deep copying them, so only maps that are in both are copied. The result must not be modified.
+Hjson::Value ApplyDefaults(const Hjson::Value& defaults, const Hjson::Value& value);
 }  // namespace cqsp::common::systems::loading
@@ -0,0 +1,148 @@
+/* Conquer Space
+ * Copyright (C) 2021-2023 Conquer Space
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "common/systems/loading/loadingpipeline.h"
+
+#include <spdlog/spdlog.h>
+
+#include <chrono>
+#include <exception>
+#include <future>
+#include <map>
+#include <utility>
+
+#include <tracy/Tracy.hpp>
+
+namespace cqsp::common::systems::loading {
+namespace {
+double MillisecondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+}  // namespace
+
+void LoadingPipeline::AddStage(const std::string& name, std::vector<std::string> inputs,
+                               std::vector<std::string> outputs, StageFunction commit, StageFunction prepare) {
+    stages.push_back(Stage {name, std::move(inputs), std::move(outputs), std::move(commit), std::move(prepare)});
+}
+
+std::vector<std::string> LoadingPipeline::GetCommitOrder() const {
+    std::vector<std::string> order;
+    for (size_t index : Schedule()) {
+        order.push_back(stages[index].name);
+    }
+    return order;
+}
+
+std::vector<size_t> LoadingPipeline::Schedule() const {
+    // Stages that make each piece of data
+    std::map<std::string, std::vector<size_t>> producers;
+    for (size_t i = 0; i < stages.size(); i++) {
+        for (const auto& output : stages[i].outputs) {
+            producers[output].push_back(i);
+        }
+    }
+
+    std::vector<std::vector<size_t>> dependents(stages.size());
+    std::vector<int> waiting_on(stages.size(), 0);
+    for (size_t i = 0; i < stages.size(); i++) {
+        for (const auto& input : stages[i].inputs) {
+            auto it = producers.find(input);
+            if (it == producers.end()) {
+                SPDLOG_WARN("Nothing loads {}, which {} needs", input, stages[i].name);
+                continue;
+            }
+            for (size_t producer : it->second) {
+                if (producer == i) {
+                    continue;
+                }
+                dependents[producer].push_back(i);
+                waiting_on[i]++;
+            }
+        }
+    }
+
+    // Always take the earliest added stage that is ready, so the order is stable
+    std::vector<size_t> order;
+    std::vector<bool> scheduled(stages.size(), false);
+    while (order.size() < stages.size()) {
+        size_t next = stages.size();
+        for (size_t i = 0; i < stages.size(); i++) {
+            if (!scheduled[i] && waiting_on[i] == 0) {
+                next = i;
+                break;
+            }
+        }
+        if (next == stages.size()) {
+            // Everything left is in a cycle, so break it at the earliest stage
+            for (size_t i = 0; i < stages.size(); i++) {
+                if (!scheduled[i]) {
+                    next = i;
+                    break;
+                }
+            }
+            SPDLOG_ERROR("Loading stage {} depends on itself through other stages", stages[next].name);
+        }
+        scheduled[next] = true;
+        order.push_back(next);
+        for (size_t dependent : dependents[next]) {
+            waiting_on[dependent]--;
+        }
+    }
+    return order;
+}
+
+std::vector<LoadingPipeline::StageTiming> LoadingPipeline::Run() {
+    ZoneScoped;
+    auto start = std::chrono::steady_clock::now();
+    std::vector<StageTiming> timings(stages.size());
+
+    std::vector<std::future<void>> prepared(stages.size());
+    for (size_t i = 0; i < stages.size(); i++) {
+        timings[i].name = stages[i].name;
+        if (!stages[i].prepare) {
+            continue;
+        }
+        prepared[i] = std::async(std::launch::async, [this, i, &timings]() {
+            auto prepare_start = std::chrono::steady_clock::now();
+            stages[i].prepare();
+            timings[i].prepare = MillisecondsSince(prepare_start);
+        });
+    }
+
+    std::vector<StageTiming> result;
+    for (size_t index : Schedule()) {
+        if (prepared[index].valid()) {
+            try {
+                prepared[index].get();
+            } catch (const std::exception& error) {
+                // Committing half prepared data would only make a broken universe, so the stage is skipped
+                SPDLOG_ERROR("Failed to prepare loading stage {}: {}", stages[index].name, error.what());
+                result.push_back(timings[index]);
+                continue;
+            }
+        }
+        auto commit_start = std::chrono::steady_clock::now();
+        stages[index].commit();
+        timings[index].commit = MillisecondsSince(commit_start);
+
+        SPDLOG_INFO("Loaded {} in {:.2f} ms (prepare {:.2f} ms, commit {:.2f} ms)", stages[index].name,
+                    timings[index].prepare + timings[index].commit, timings[index].prepare, timings[index].commit);
+        result.push_back(timings[index]);
+    }
+    SPDLOG_INFO("Ran {} loading stages in {:.2f} ms", stages.size(), MillisecondsSince(start));
+    return result;
+}
+}  // namespace cqsp::common::systems::loading
@@ -0,0 +1,81 @@
+/* Conquer Space
+ * Copyright (C) 2021-2023 Conquer Space
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace cqsp::common::systems::loading {
+/// <summary>
+/// Runs the stages of universe loading in the order that their data needs.
+/// </summary>
+/// Every stage names the data that it reads and the data that it makes, such as `goods` or `countries`,
+/// and a stage is committed after every stage that makes its inputs. Stages have two parts:
+/// - prepare, which reads and parses the source data. It can't touch the universe, so the prepare
+///   parts of every stage run in parallel.
+/// - commit, which creates the entities. The registry isn't thread safe, so stages commit one at a time,
+///   in dependency order, with ties broken by the order the stages were added. Entities are created in
+///   the same order on every run.
+///
+/// Loading takes about as long as the slowest prepare plus the commits, instead of the sum of everything.
+class LoadingPipeline {
+ public:
+    using StageFunction = std::function<void()>;
+
+    struct StageTiming {
+        std::string name;
+        // Milliseconds spent in each part, prepare is measured on its own thread
+        double prepare = 0;
+        double commit = 0;
+    };
+
+    /// <param name="inputs">Data that the stage reads, that other stages make</param>
+    /// <param name="outputs">Data that the stage makes</param>
+    /// <param name="commit">Writes into the universe</param>
+    /// <param name="prepare">Optional work that doesn't touch the universe, run before commit</param>
+    void AddStage(const std::string& name, std::vector<std::string> inputs, std::vector<std::string> outputs,
+                  StageFunction commit, StageFunction prepare = nullptr);
+
+    /// <summary>
+    /// Gets the names of the stages in the order that they are committed.
+    /// </summary>
+    /// Inputs that no stage makes are ignored. If the stages depend on each other in a cycle, the stages in
+    /// the cycle are committed in the order they were added.
+    std::vector<std::string> GetCommitOrder() const;
+
+    /// <summary>
+    /// Runs every stage, and logs how long each of them took.
+    /// </summary>
+    /// If a prepare step throws, the error is logged and that stage isn't committed. Later stages still run.
+    /// <returns>Timing of the stages, in commit order</returns>
+    std::vector<StageTiming> Run();
+
+ private:
+    struct Stage {
+        std::string name;
+        std::vector<std::string> inputs;
+        std::vector<std::string> outputs;
+        StageFunction commit;
+        StageFunction prepare;
+    };
+
+    std::vector<size_t> Schedule() const;
+
+    std::vector<Stage> stages;
+};
+}  // namespace cqsp::common::systems::loading
@@ -24,7 +24,9 @@
 #include "common/components/organizations.h"
 #include "common/components/surface.h"
 
-void cqsp::common::systems::loading::LoadProvinces(common::Universe& universe, const std::string& text) {
+std::vector<cqsp::common::systems::loading::ProvinceDefinition> cqsp::common::systems::loading::ParseProvinces(
+    const std::string& text) {
+    std::vector<ProvinceDefinition> provinces;
     // The text has to be csv, so treat it is csv
     std::istringstream f(text);
     std::string line;
@@ -42,11 +44,21 @@ void cqsp::common::systems::loading::LoadProvinces(common::Universe& universe, c
         std::string b = token;
         std::getline(f2, token, ',');
         std::string country = token;
+        provinces.push_back(ProvinceDefinition {identifier, country, std::stoi(r), std::stoi(g), std::stoi(b)});
+    }
+    return provinces;
+}
+
+void cqsp::common::systems::loading::LoadProvinces(common::Universe& universe,
+                                                   const std::vector<ProvinceDefinition>& provinces) {
+    for (const auto& province : provinces) {
+        const std::string& identifier = province.identifier;
+        const std::string& country = province.country;
         // Create
         entt::entity entity = universe.create();
         universe.emplace<components::Province>(entity, universe.countries[country]);
         universe.emplace<components::Identifier>(entity, identifier);
-        auto& color = universe.emplace<components::ProvinceColor>(entity, std::stoi(r), std::stoi(g), std::stoi(b));
+        auto& color = universe.emplace<components::ProvinceColor>(entity, province.r, province.g, province.b);
         if (universe.provinces.find(identifier) == universe.provinces.end()) {
             universe.provinces[identifier] = entity;
         } else {
@@ -60,3 +72,7 @@ void cqsp::common::systems::loading::LoadProvinces(common::Universe& universe, c
         universe.colors_province[entity] = (int)color;
     }
 }
+
+void cqsp::common::systems::loading::LoadProvinces(common::Universe& universe, const std::string& text) {
+    LoadProvinces(universe, ParseProvinces(text));
+}
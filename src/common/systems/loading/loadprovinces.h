@@ -17,9 +17,26 @@
 #pragma once
 
 #include <string>
+#include <vector>
 
 #include "common/universe.h"
 
 namespace cqsp::common::systems::loading {
+/// <summary>
+/// A line of the province definition csv.
+/// </summary>
+struct ProvinceDefinition {
+    std::string identifier;
+    std::string country;
+    int r;
+    int g;
+    int b;
+};
+
+/// <summary>
+/// Parses the province definitions, without touching the universe.
+/// </summary>
+std::vector<ProvinceDefinition> ParseProvinces(const std::string& text);
+void LoadProvinces(common::Universe& universe, const std::vector<ProvinceDefinition>& provinces);
 void LoadProvinces(common::Universe& universe, const std::string& text);
 }
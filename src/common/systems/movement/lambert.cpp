@@ -0,0 +1,202 @@
+/* Conquer Space
+ * Copyright (C) 2021-2023 Conquer Space
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "common/systems/movement/lambert.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+#include <tracy/Tracy.hpp>
+
+#include "common/components/units.h"
+#include "common/util/parallel.h"
+
+namespace cqsp::common::systems {
+namespace {
+namespace cqspt = cqsp::common::components::types;
+
+// Problems that are iterated together
+constexpr size_t block_size = 64;
+// Fewer problems than this are solved on the calling thread. A 32x32 porkchop grid is just enough to be split.
+constexpr size_t parallel_threshold = 1024;
+constexpr int max_iterations = 100;
+// Of the time of flight
+constexpr double tolerance = 1e-10;
+// Past this, the transfer takes more than a revolution. It is kept a bit below, because the Stumpff C function is
+// zero there.
+constexpr double z_max = cqspt::TWOPI * cqspt::TWOPI - 1e-3;
+// Deep enough into the hyperbolic transfers that the fastest ones are bracketed, without overflowing cosh
+constexpr double z_min = -1e4;
+// Below this, the closed forms of the Stumpff functions lose precision, so the series are used
+constexpr double series_limit = 1e-3;
+
+double StumpffC(double z) {
+    if (z > series_limit) {
+        return (1 - std::cos(std::sqrt(z))) / z;
+    }
+    if (z < -series_limit) {
+        return (std::cosh(std::sqrt(-z)) - 1) / -z;
+    }
+    return 1. / 2 - z / 24 + z * z / 720;
+}
+
+double StumpffS(double z) {
+    if (z > series_limit) {
+        double s = std::sqrt(z);
+        return (s - std::sin(s)) / (s * s * s);
+    }
+    if (z < -series_limit) {
+        double s = std::sqrt(-z);
+        return (std::sinh(s) - s) / (s * s * s);
+    }
+    return 1. / 6 - z / 120 + z * z / 5040;
+}
+
+double TransferY(double z, double r_sum, double A) {
+    return r_sum + A * (z * StumpffS(z) - 1) / std::sqrt(StumpffC(z));
+}
+
+// sqrt(GM) times the time of flight of the universal anomaly, minus the one that is wanted. It goes up with z.
+// Where y is negative there is no transfer, and it is counted as taking no time, which is what it goes to at y = 0.
+double Residual(double z, double r_sum, double A, double target) {
+    double y = TransferY(z, r_sum, A);
+    if (y <= 0) {
+        return -target;
+    }
+    double x = y / StumpffC(z);
+    return x * std::sqrt(x) * StumpffS(z) + A * std::sqrt(y) - target;
+}
+
+void SolveBlock(const LambertProblem* problems, LambertSolution* solutions, size_t count) {
+    std::array<double, block_size> r_sum;
+    std::array<double, block_size> A;
+    std::array<double, block_size> target;
+    std::array<double, block_size> lo;
+    std::array<double, block_size> hi;
+    std::array<double, block_size> f_lo;
+    std::array<double, block_size> f_hi;
+    std::array<double, block_size> z;
+    // Which end of the bracket was replaced last, for the Illinois method
+    std::array<int, block_size> side;
+    std::array<bool, block_size> done;
+
+    for (size_t i = 0; i < count; i++) {
+        const LambertProblem& problem = problems[i];
+        solutions[i] = LambertSolution();
+        const double r1 = glm::length(problem.r1);
+        const double r2 = glm::length(problem.r2);
+        const double cos_angle = std::clamp(glm::dot(problem.r1, problem.r2) / (r1 * r2), -1., 1.);
+        double angle = std::acos(cos_angle);
+        if (glm::dot(glm::cross(problem.r1, problem.r2), problem.normal) < 0) {
+            angle = cqspt::TWOPI - angle;
+        }
+        const double sin_angle = std::sin(angle);
+        r_sum[i] = r1 + r2;
+        A[i] = sin_angle * std::sqrt(r1 * r2 / (1 - cos_angle));
+        target[i] = std::sqrt(problem.GM) * problem.time_of_flight;
+        lo[i] = z_min;
+        hi[i] = z_max;
+        side[i] = 0;
+        z[i] = 0;
+        // Straight through the body, or half way around it, where the plane of the transfer isn't known
+        bool solvable = r1 > 0 && r2 > 0 && problem.GM > 0 && problem.time_of_flight > 0 && std::abs(sin_angle) > 1e-9;
+        if (solvable) {
+            f_lo[i] = Residual(lo[i], r_sum[i], A[i], target[i]);
+            f_hi[i] = Residual(hi[i], r_sum[i], A[i], target[i]);
+            // Faster than the fastest hyperbolic transfer, or slower than one revolution
+            solvable = f_lo[i] < 0 && f_hi[i] > 0;
+        }
+        done[i] = !solvable;
+    }
+
+    std::array<bool, block_size> converged {};
+    for (int iteration = 0; iteration < max_iterations; iteration++) {
+        size_t active = 0;
+        for (size_t i = 0; i < count; i++) {
+            if (done[i]) {
+                continue;
+            }
+            double next = (lo[i] * f_hi[i] - hi[i] * f_lo[i]) / (f_hi[i] - f_lo[i]);
+            // Bisect every third iteration, so that the bracket always shrinks even if the function is lopsided
+            if (iteration % 3 == 2 || !(next > lo[i] && next < hi[i])) {
+                next = (lo[i] + hi[i]) / 2;
+            }
+            const double f = Residual(next, r_sum[i], A[i], target[i]);
+            if (f < 0) {
+                if (side[i] < 0) {
+                    f_hi[i] /= 2;
+                }
+                lo[i] = next;
+                f_lo[i] = f;
+                side[i] = -1;
+            } else {
+                if (side[i] > 0) {
+                    f_lo[i] /= 2;
+                }
+                hi[i] = next;
+                f_hi[i] = f;
+                side[i] = 1;
+            }
+            z[i] = next;
+            converged[i] =
+                std::abs(f) <= tolerance * target[i] || hi[i] - lo[i] <= 1e-12 * std::max(1., std::abs(next));
+            done[i] = converged[i];
+            active += !done[i];
+        }
+        if (active == 0) {
+            break;
+        }
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        if (!converged[i]) {
+            continue;
+        }
+        const LambertProblem& problem = problems[i];
+        const double y = TransferY(z[i], r_sum[i], A[i]);
+        // Lagrange coefficients
+        const double f = 1 - y / glm::length(problem.r1);
+        const double g = A[i] * std::sqrt(y / problem.GM);
+        const double g_dot = 1 - y / glm::length(problem.r2);
+        if (y <= 0 || g == 0) {
+            continue;
+        }
+        solutions[i].v1 = (problem.r2 - f * problem.r1) / g;
+        solutions[i].v2 = (g_dot * problem.r2 - problem.r1) / g;
+        solutions[i].valid = std::isfinite(solutions[i].v1.x + solutions[i].v1.y + solutions[i].v1.z);
+    }
+}
+}  // namespace
+
+LambertSolution SolveLambert(const LambertProblem& problem) {
+    LambertSolution solution;
+    SolveBlock(&problem, &solution, 1);
+    return solution;
+}
+
+void SolveLambert(std::span<const LambertProblem> problems, std::span<LambertSolution> solutions) {
+    ZoneScoped;
+    const size_t count = problems.size();
+    auto solve_range = [&](size_t begin, size_t end) {
+        for (size_t block = begin; block < end; block += block_size) {
+            SolveBlock(problems.data() + block, solutions.data() + block, std::min(block_size, end - block));
+        }
+    };
+    // Whole blocks for every chunk
+    util::ParallelFor(count, parallel_threshold, solve_range, block_size);
+}
+}  // namespace cqsp::common::systems
@@ -0,0 +1,66 @@
+/* Conquer Space
+ * Copyright (C) 2021-2023 Conquer Space
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <span>
+
+#include <glm/glm.hpp>
+
+namespace cqsp::common::systems {
+/// <summary>
+/// Getting from `r1` to `r2` around a body in `time_of_flight` seconds.
+/// </summary>
+/// The positions are relative to the body, in kilometers.
+struct LambertProblem {
+    glm::dvec3 r1 {0, 0, 0};
+    glm::dvec3 r2 {0, 0, 0};
+    double time_of_flight = 0;
+    /// km^3 * s^-2
+    double GM = 0;
+    /// Which way the transfer goes around the body, by the right hand rule, such as the normal `cross(r, v)` of
+    /// the orbit that it leaves from. Only its direction matters.
+    glm::dvec3 normal {0, 0, 1};
+};
+
+struct LambertSolution {
+    /// Velocity needed at `r1`, km/s
+    glm::dvec3 v1 {0, 0, 0};
+    /// Velocity at `r2` when it gets there, km/s
+    glm::dvec3 v2 {0, 0, 0};
+    bool valid = false;
+};
+
+/// <summary>
+/// Solves Lambert's problem for the orbit that gets from one position to another in a given time, with less than
+/// one revolution.
+/// </summary>
+/// Uses universal variables, so elliptic and hyperbolic transfers are solved the same way. The universal anomaly is
+/// bracketed and solved with the Illinois method, which falls back to bisection, so it converges for every problem
+/// that has a solution instead of diverging like Newton's method can.
+///
+/// The transfer goes the short way from `r1` to `r2` if that goes around `normal`, and the long way if it doesn't.
+/// The solution is not valid if the positions are 180 degrees apart, because the plane of the transfer can't be
+/// known, or if there is no transfer with less than one revolution.
+LambertSolution SolveLambert(const LambertProblem& problem);
+
+/// <summary>
+/// Solves every problem, the same as `SolveLambert`.
+/// </summary>
+/// The problems are solved in blocks that keep their iterations in dense arrays and step them together, and large
+/// batches are split between threads. `solutions` has to be as large as `problems`.
+void SolveLambert(std::span<const LambertProblem> problems, std::span<LambertSolution> solutions);
+}  // namespace cqsp::common::systems
@@ -0,0 +1,218 @@
+/* Conquer Space
+ * Copyright (C) 2021-2023 Conquer Space
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "common/systems/movement/orbitevents.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include <tracy/Tracy.hpp>
+
+#include "common/components/bodies.h"
+#include "common/components/ships.h"
+
+namespace cqsp::common::systems {
+namespace {
+namespace cqspb = cqsp::common::components::bodies;
+namespace cqspt = cqsp::common::components::types;
+
+constexpr double infinity = std::numeric_limits<double>::infinity();
+constexpr double tick_length = components::StarDate::TIME_INCREMENT;
+// Below this, the crossing angles can't be solved for, and the radius barely changes anyway
+constexpr double min_eccentricity = 1e-9;
+
+double RadiusAt(const cqspt::Orbit& orbit, double time) { return glm::length(cqspt::OrbitTimeToVec3(orbit, time)); }
+
+// True anomaly where an orbit is at `radius`, between 0 and pi
+double CrossingAnomaly(const cqspt::Orbit& orbit, double radius) {
+    const double e = orbit.eccentricity;
+    const double p = orbit.semi_major_axis * (1 - e * e);
+    return std::acos(std::clamp((p / radius - 1) / e, -1., 1.));
+}
+
+// Seconds from `time` until an elliptic orbit next gets to the true anomaly
+double TimeToTrueAnomaly(const cqspt::Orbit& orbit, double v, double time) {
+    const double e = orbit.eccentricity;
+    double E = 2 * std::atan2(std::sqrt(1 - e) * std::sin(v / 2), std::sqrt(1 + e) * std::cos(v / 2));
+    double M = E - e * std::sin(E);
+    double M_now = cqspt::GetMtElliptic(orbit.M0, orbit.nu, time, orbit.epoch);
+    return cqspt::normalize_radian(M - M_now) / orbit.nu;
+}
+
+// Seconds since periapsis that a hyperbolic orbit is at the true anomaly. The epoch of a hyperbolic
+// orbit is when it passes the periapsis, see `TrueAnomalyHyperbolic`.
+double HyperbolicTimeFromPeriapsis(const cqspt::Orbit& orbit, double v) {
+    const double e = orbit.eccentricity;
+    const double a = orbit.semi_major_axis;
+    double H = 2 * std::atanh(std::sqrt((e - 1) / (e + 1)) * std::tan(v / 2));
+    return (e * std::sinh(H) - H) / std::sqrt(orbit.GM / -(a * a * a));
+}
+
+// Fastest an orbit goes relative to its reference body, which is at the periapsis
+double PeriapsisSpeed(const cqspt::Orbit& orbit) {
+    double periapsis = orbit.semi_major_axis * (1 - orbit.eccentricity);
+    if (periapsis <= 0) {
+        return 0;
+    }
+    return std::sqrt(orbit.GM * (1 + orbit.eccentricity) / periapsis);
+}
+}  // namespace
+
+double PredictSOIExit(const cqspt::Orbit& orbit, double soi, double time) {
+    if (!std::isfinite(soi) || orbit.semi_major_axis == 0) {
+        return infinity;
+    }
+    if (RadiusAt(orbit, time) >= soi) {
+        return time;
+    }
+    const double e = orbit.eccentricity;
+    if (e < 1) {
+        if (orbit.semi_major_axis * (1 + e) < soi || e < min_eccentricity) {
+            return infinity;
+        }
+        // On the way out from the periapsis
+        return time + TimeToTrueAnomaly(orbit, CrossingAnomaly(orbit, soi), time);
+    }
+    return std::max(time, orbit.epoch + HyperbolicTimeFromPeriapsis(orbit, CrossingAnomaly(orbit, soi)));
+}
+
+double PredictImpact(const cqspt::Orbit& orbit, double radius, double time) {
+    if (orbit.semi_major_axis == 0) {
+        return infinity;
+    }
+    if (RadiusAt(orbit, time) <= radius) {
+        return time;
+    }
+    const double e = orbit.eccentricity;
+    if (orbit.semi_major_axis * (1 - e) > radius || e < min_eccentricity) {
+        return infinity;
+    }
+    // On the way in to the periapsis
+    double v = CrossingAnomaly(orbit, radius);
+    if (e < 1) {
+        return time + TimeToTrueAnomaly(orbit, cqspt::TWOPI - v, time);
+    }
+    double impact = orbit.epoch + HyperbolicTimeFromPeriapsis(orbit, -v);
+    // A hyperbolic orbit that is past the periapsis is on its way out
+    return impact >= time ? impact : infinity;
+}
+
+SOIEntrySearch PredictSOIEntry(const cqspt::Orbit& orbit, const cqspt::Orbit& other, double soi, double time,
+                               double end, int max_steps) {
+    if (!std::isfinite(soi)) {
+        return {infinity, false};
+    }
+    const double speed = PeriapsisSpeed(orbit) + PeriapsisSpeed(other);
+    double t = time;
+    for (int step = 0; t <= end; step++) {
+        double gap = glm::distance(cqspt::OrbitTimeToVec3(orbit, t), cqspt::OrbitTimeToVec3(other, t)) - soi;
+        if (gap <= 0) {
+            return {t, true};
+        }
+        if (step == max_steps) {
+            return {t, false};
+        }
+        if (speed <= 0) {
+            // Neither of them moves
+            return {infinity, false};
+        }
+        t += std::max(gap / speed, tick_length);
+    }
+    return {infinity, false};
+}
+
+void OrbitEventQueue::Schedule(Universe& universe, entt::entity body, double time) {
+    uint32_t generation = ++generations[body];
+    if (!universe.all_of<cqspt::Orbit>(body) || universe.any_of<components::ships::Crash>(body)) {
+        return;
+    }
+    const auto& orbit = universe.get<cqspt::Orbit>(body);
+    const entt::entity parent = orbit.reference_body;
+    if (parent == entt::null || orbit.semi_major_axis == 0 || !universe.all_of<cqspb::Body>(parent)) {
+        return;
+    }
+    OrbitEvent next {infinity, body, OrbitEventType::Recheck, entt::null, generation};
+    if (std::abs(orbit.eccentricity - 1) < min_eccentricity) {
+        // Nearly parabolic orbits can't be solved with either set of formulas, so they are looked at every tick
+        next.time = time + tick_length;
+        events.push(next);
+        return;
+    }
+
+    const auto& parent_body = universe.get<cqspb::Body>(parent);
+    double exit = PredictSOIExit(orbit, parent_body.SOI, time);
+    if (exit < next.time) {
+        next.time = exit;
+        next.type = OrbitEventType::SoiExit;
+    }
+    double impact = PredictImpact(orbit, parent_body.radius, time);
+    if (impact < next.time) {
+        next.time = impact;
+        next.type = OrbitEventType::Impact;
+    }
+
+    if (universe.all_of<cqspb::OrbitalSystem>(parent)) {
+        const double horizon = time + prediction_horizon;
+        bool has_candidates = false;
+        for (entt::entity sibling : universe.get<cqspb::OrbitalSystem>(parent).children) {
+            if (sibling == body || !universe.all_of<cqspb::Body, cqspt::Orbit>(sibling)) {
+                continue;
+            }
+            has_candidates = true;
+            SOIEntrySearch entry =
+                PredictSOIEntry(orbit, universe.get<cqspt::Orbit>(sibling), universe.get<cqspb::Body>(sibling).SOI,
+                                time, std::min(next.time, horizon));
+            if (entry.time < next.time) {
+                next.time = entry.time;
+                // Where the search gave up is only a time to look again
+                next.type = entry.entered ? OrbitEventType::SoiEntry : OrbitEventType::Recheck;
+                next.other = entry.entered ? sibling : entt::null;
+            }
+        }
+        // Entries are only searched up to the horizon
+        if (has_candidates && next.time > horizon) {
+            next.time = horizon;
+            next.type = OrbitEventType::Recheck;
+            next.other = entt::null;
+        }
+    }
+    if (std::isfinite(next.time)) {
+        events.push(next);
+    }
+}
+
+std::vector<OrbitEvent> OrbitEventQueue::PopDue(const Universe& universe, double time) {
+    ZoneScoped;
+    std::vector<OrbitEvent> due;
+    while (!events.empty() && events.top().time <= time) {
+        OrbitEvent event = events.top();
+        events.pop();
+        auto generation = generations.find(event.body);
+        if (!universe.valid(event.body)) {
+            if (generation != generations.end()) {
+                generations.erase(generation);
+            }
+            continue;
+        }
+        if (generation == generations.end() || generation->second != event.generation) {
+            continue;
+        }
+        due.push_back(event);
+    }
+    return due;
+}
+}  // namespace cqsp::common::systems
@@ -0,0 +1,122 @@
+/* Conquer Space
+ * Copyright (C) 2021-2023 Conquer Space
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <cstdint>
+#include <queue>
+#include <unordered_map>
+#include <vector>
+
+#include "common/components/orbit.h"
+#include "common/stardate.h"
+#include "common/universe.h"
+
+namespace cqsp::common::systems {
+/// <summary>
+/// Time that an orbit first gets further than `soi` from its reference body, at or after `time`.
+/// </summary>
+/// All times are in seconds. This is infinity if the orbit never leaves, and `time` if it is already outside.
+double PredictSOIExit(const components::types::Orbit& orbit, double soi, double time);
+
+/// <summary>
+/// Time that an orbit first gets closer than `radius` to the center of its reference body, at or after `time`.
+/// </summary>
+/// This is infinity if the orbit never gets that close, and `time` if it is already below the radius.
+double PredictImpact(const components::types::Orbit& orbit, double radius, double time);
+
+struct SOIEntrySearch {
+    /// Seconds. Infinity if there is no entry before the end of the search.
+    double time;
+    /// False if the search gave up at `time` before finding the entry
+    bool entered;
+};
+
+/// <summary>
+/// Time between `time` and `end` that `orbit` first gets within `soi` of `other`, which orbits the same body.
+/// </summary>
+/// The orbits are stepped forward by the time it would take them to close the gap between them at the fastest
+/// they can go, so the search can't step over an entry, and takes large steps while they are far apart. Steps are
+/// never shorter than a tick, so a pass through the SOI that is shorter than a tick can be missed, the same as
+/// when checking every tick.
+///
+/// The search gives up after `max_steps` and returns how far it got, so that the caller looks again from there.
+SOIEntrySearch PredictSOIEntry(const components::types::Orbit& orbit, const components::types::Orbit& other,
+                               double soi, double time, double end, int max_steps = 4096);
+
+enum class OrbitEventType {
+    /// Leaves the SOI of its reference body
+    SoiExit,
+    /// Enters the SOI of a body that orbits the same body
+    SoiEntry,
+    /// Hits the surface of its reference body
+    Impact,
+    /// Nothing happens before the end of the prediction, so it has to be predicted again
+    Recheck,
+};
+
+struct OrbitEvent {
+    /// Seconds
+    double time;
+    entt::entity body;
+    OrbitEventType type;
+    /// Body whose SOI is entered
+    entt::entity other = entt::null;
+    uint32_t generation = 0;
+};
+
+/// <summary>
+/// Time ordered queue of the next SOI transition or impact of every orbit.
+/// </summary>
+/// Orbits only change when something happens to them, so the next event of an orbit is predicted once when it
+/// changes, and nothing has to be checked again until it is due. Every orbit has at most one event queued, the
+/// earliest one, because the orbit is predicted again after any of them.
+class OrbitEventQueue {
+ public:
+    /// <summary>
+    /// Predicts the next event of the orbit of `body` from `time`, and replaces the event it had queued.
+    /// </summary>
+    void Schedule(Universe& universe, entt::entity body, double time);
+
+    /// <summary>
+    /// Removes the events that are due at `time` and still current, in order of time.
+    /// </summary>
+    std::vector<OrbitEvent> PopDue(const Universe& universe, double time);
+
+    /// Next event that is queued, which may have been replaced since
+    const OrbitEvent* Peek() const { return events.empty() ? nullptr : &events.top(); }
+    /// Number of events queued, including replaced ones that haven't been popped yet
+    size_t size() const { return events.size(); }
+
+    /// How far ahead SOI entries are searched, in seconds
+    static constexpr double prediction_horizon =
+        components::StarDate::DAY * 30 * static_cast<double>(components::StarDate::TIME_INCREMENT);
+
+ private:
+    struct Later {
+        bool operator()(const OrbitEvent& a, const OrbitEvent& b) const {
+            if (a.time != b.time) {
+                return a.time > b.time;
+            }
+            return entt::to_integral(a.body) > entt::to_integral(b.body);
+        }
+    };
+
+    std::priority_queue<OrbitEvent, std::vector<OrbitEvent>, Later> events;
+    /// Generation of the latest event of every body, older events are ignored
+    std::unordered_map<entt::entity, uint32_t> generations;
+};
+}  // namespace cqsp::common::systems
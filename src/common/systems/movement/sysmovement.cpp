@@ -16,6 +16,9 @@
  */
 #include "common/systems/movement/sysmovement.h"
 
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
 #include <cmath>
 
 #include <tracy/Tracy.hpp>
@@ -30,17 +33,49 @@ namespace cqspc = cqsp::common::components;
 namespace cqsps = cqsp::common::components::ships;
 namespace cqspt = cqsp::common::components::types;
 
+SysOrbit::SysOrbit(Game& game) : ISimulationSystem(game) {
+    Universe& universe = GetUniverse();
+    universe.on_construct<cqspt::Orbit>().connect<&SysOrbit::OnOrbitChanged>(*this);
+    universe.on_update<cqspt::Orbit>().connect<&SysOrbit::OnOrbitChanged>(*this);
+}
+
+SysOrbit::~SysOrbit() {
+    Universe& universe = GetUniverse();
+    universe.on_construct<cqspt::Orbit>().disconnect(*this);
+    universe.on_update<cqspt::Orbit>().disconnect(*this);
+}
+
 void SysOrbit::DoSystem() {
     ZoneScoped;
     Universe& universe = GetGame().GetUniverse();
+    const double time = universe.date.ToSecond();
+    if (!scheduled) {
+        for (entt::entity body : universe.view<cqspt::Orbit>()) {
+            events.Schedule(universe, body, time);
+        }
+        scheduled = true;
+    } else {
+        for (entt::entity body : changed) {
+            if (universe.valid(body)) {
+                Reschedule(body, time);
+            }
+        }
+    }
+    changed.clear();
+
     ParseOrbitTree(entt::null, universe.sun);
+
+    // Handled after the whole tree has moved, so that the tree isn't changed while it's being walked
+    for (const OrbitEvent& event : events.PopDue(universe, time)) {
+        HandleEvent(event, time);
+    }
 }
 
 void LeaveSOI(Universe& universe, const entt::entity& body, entt::entity& parent, cqspt::Orbit& orb,
               cqspt::Kinematics& pos, cqspt::Kinematics& p_pos) {
     // Then change parent, then set the orbit
     auto& p_orb = universe.get<cqspt::Orbit>(parent);
-    if (p_orb.reference_body != entt::null) {
+    if (p_orb.reference_body == entt::null) {
         return;
     }
     // Then add to orbital system
@@ -63,6 +98,116 @@ void LeaveSOI(Universe& universe, const entt::entity& body, entt::entity& parent
     universe.emplace_or_replace<cqspc::bodies::DirtyOrbit>(body);
 }
 
+void LeaveSOI(Universe& universe, const entt::entity& body) {
+    auto& orb = universe.get<cqspt::Orbit>(body);
+    entt::entity parent = orb.reference_body;
+    LeaveSOI(universe, body, parent, orb, universe.get<cqspt::Kinematics>(body),
+             universe.get<cqspt::Kinematics>(parent));
+}
+
+namespace {
+// Moves `body` from the SOI of `parent` to the SOI of `entity`, which orbits `parent`
+void MoveToSOI(Universe& universe, const entt::entity& parent, const entt::entity& body, entt::entity entity) {
+    auto& pos = universe.get<cqspt::Kinematics>(body);
+    auto& orb = universe.get<cqspt::Orbit>(body);
+    const auto& body_comp = universe.get<cqspc::bodies::Body>(entity);
+    const auto& kinematics = universe.get<cqspt::Kinematics>(entity);
+    // Calculate position
+    orb = cqspt::Vec3ToOrbit(pos.position - kinematics.position, pos.velocity - kinematics.velocity, body_comp.GM,
+                             universe.date.ToSecond());
+    orb.reference_body = entity;
+    orb.CalculateVariables();
+    // Calculate position, and change the thing
+    pos.position = cqspt::toVec3(orb);
+    pos.velocity = cqspt::OrbitVelocityToVec3(orb, orb.v);
+    // Then change SOI
+    universe.get_or_emplace<cqspc::bodies::OrbitalSystem>(entity).push_back(body);
+    auto& vec = universe.get<cqspc::bodies::OrbitalSystem>(parent).children;
+    vec.erase(std::remove(vec.begin(), vec.end(), body), vec.end());
+    universe.emplace_or_replace<cqspc::bodies::DirtyOrbit>(body);
+}
+}  // namespace
+
+void SysOrbit::HandleEvent(const OrbitEvent& event, double time) {
+    Universe& universe = GetUniverse();
+    const entt::entity body = event.body;
+    if (!universe.all_of<cqspt::Orbit>(body)) {
+        return;
+    }
+    const entt::entity parent = universe.get<cqspt::Orbit>(body).reference_body;
+    if (!universe.valid(parent) || !universe.all_of<cqspc::bodies::Body, cqspt::Kinematics>(parent) ||
+        !universe.all_of<cqspt::Kinematics>(body)) {
+        Reschedule(body, time);
+        return;
+    }
+    const auto& p_bod = universe.get<cqspc::bodies::Body>(parent);
+    auto& pos = universe.get<cqspt::Kinematics>(body);
+
+    // The event was predicted from the orbit, so it's checked against where the body is now. If it isn't there
+    // yet, it is predicted again from the next tick.
+    const double next_tick = time + components::StarDate::TIME_INCREMENT;
+    switch (event.type) {
+        case OrbitEventType::SoiExit:
+            if (glm::length(pos.position) <= p_bod.SOI) {
+                events.Schedule(universe, body, next_tick);
+                return;
+            }
+            LeaveSOI(universe, body);
+            break;
+        case OrbitEventType::Impact: {
+            if (glm::length(pos.position) > p_bod.radius) {
+                events.Schedule(universe, body, next_tick);
+                return;
+            }
+            // Next time we need to account for the atmosphere
+            SPDLOG_INFO("Object {} collided with the ground", body);
+            // Then remove from the tree or something like that
+            universe.get_or_emplace<cqsps::Crash>(body);
+            pos.position = glm::vec3(0);
+            universe.get<cqspt::Orbit>(body).semi_major_axis = 0;
+            break;
+        }
+        case OrbitEventType::SoiEntry: {
+            const entt::entity other = event.other;
+            // The body it was going to enter could have moved somewhere else since
+            if (!universe.valid(other) ||
+                !universe.all_of<cqspc::bodies::Body, cqspt::Orbit, cqspt::Kinematics>(other) ||
+                universe.get<cqspt::Orbit>(other).reference_body != parent) {
+                Reschedule(body, time);
+                return;
+            }
+            const auto& kinematics = universe.get<cqspt::Kinematics>(other);
+            if (glm::distance(kinematics.position, pos.position) > universe.get<cqspc::bodies::Body>(other).SOI) {
+                events.Schedule(universe, body, next_tick);
+                return;
+            }
+            MoveToSOI(universe, parent, body, other);
+            break;
+        }
+        case OrbitEventType::Recheck:
+            break;
+    }
+    Reschedule(body, time);
+}
+
+void SysOrbit::Reschedule(entt::entity body, double time) {
+    Universe& universe = GetUniverse();
+    events.Schedule(universe, body, time);
+    if (!universe.all_of<cqspc::bodies::Body, cqspt::Orbit>(body)) {
+        return;
+    }
+    // Everything else around the body it orbits could now enter its SOI
+    entt::entity parent = universe.get<cqspt::Orbit>(body).reference_body;
+    if (parent == entt::null || !universe.all_of<cqspc::bodies::OrbitalSystem>(parent)) {
+        return;
+    }
+    for (entt::entity sibling : universe.get<cqspc::bodies::OrbitalSystem>(parent).children) {
+        if (sibling != body) {
+            events.Schedule(universe, sibling, time);
+        }
+    }
+}
+
 void SysOrbit::ParseOrbitTree(entt::entity parent, entt::entity body) {
     namespace cqspc = cqsp::common::components;
     namespace cqsps = cqsp::common::components::ships;
@@ -81,24 +226,7 @@ void SysOrbit::ParseOrbitTree(entt::entity parent, entt::entity body) {
 
     if (parent != entt::null) {
         auto& p_pos = universe.get_or_emplace<cqspt::Kinematics>(parent);
-        // If distance is above SOI, then be annoyed
         auto& p_bod = universe.get<cqspc::bodies::Body>(parent);
-        if (glm::length(pos.position) > p_bod.SOI) {
-            LeaveSOI(universe, body, parent, orb, pos, p_pos);
-        }
-
-        if (universe.any_of<cqsps::Crash>(body)) {
-            pos.position = glm::vec3(0);
-        }
-        // Next time we need to account for the atmosphere
-        if (glm::length(pos.position) <= p_bod.radius) {
-            // Crash
-            SPDLOG_INFO("Object {} collided with the ground", body);
-            // Then remove from the tree or something like that
-            universe.get_or_emplace<cqsps::Crash>(body);
-            pos.position = glm::vec3(0);
-            orb.semi_major_axis = 0;
-        }
 
         if (universe.any_of<cqspc::types::Impulse>(body)) {
             // Then add to the orbit the speed.
@@ -114,9 +242,9 @@ void SysOrbit::ParseOrbitTree(entt::entity parent, entt::entity body) {
             universe.emplace_or_replace<cqspc::bodies::DirtyOrbit>(body);
             // Remove impulse
             universe.remove<cqspc::types::Impulse>(body);
+            Reschedule(body, universe.date.ToSecond());
         }
         pos.center = p_pos.center + p_pos.position;
-        EnterSOI(universe, parent, body);
     }
 
     auto& future_pos = universe.get_or_emplace<cqspt::FuturePosition>(body);
@@ -150,22 +278,73 @@ void SysSurface::DoSystem() {
 
 void SysPath::DoSystem() {
     ZoneScoped;
-    namespace cqspc = cqsp::common::components;
-    namespace cqsps = cqsp::common::components::ships;
-    namespace cqspt = cqsp::common::components::types;
+    const double time = GetUniverse().date.ToSecond();
+    PlanTransfers(time);
+    ApplyBurns(time);
+}
+
+void SysPath::PlanTransfers(double time) {
+    ZoneScoped;
     Universe& universe = GetUniverse();
+    for (entt::entity body : universe.view<cqspt::MoveTarget, cqspt::Orbit>()) {
+        const entt::entity target = universe.get<cqspt::MoveTarget>(body).target;
+        const auto* schedule = universe.try_get<cqspt::ImpulseSchedule>(body);
+        if (schedule != nullptr && schedule->target == target) {
+            continue;
+        }
+        const auto& orbit = universe.get<cqspt::Orbit>(body);
+        const TransferWindow* transfer = nullptr;
+        if (universe.valid(target) && universe.all_of<cqspt::Orbit>(target) &&
+            universe.get<cqspt::Orbit>(target).reference_body == orbit.reference_body) {
+            transfer = &planner.Plan(orbit, universe.get<cqspt::Orbit>(target), time);
+        }
+        if (transfer == nullptr || !transfer->valid()) {
+            SPDLOG_WARN("No transfer from {} to {}", body, target);
+            universe.remove<cqspt::MoveTarget, cqspt::ImpulseSchedule>(body);
+            continue;
+        }
+        auto& plan = universe.emplace_or_replace<cqspt::ImpulseSchedule>(body);
+        plan.target = target;
+        plan.burns.push_back({transfer->departure, transfer->departure_impulse});
+        // Bodies are flown into, and entering their SOI takes over from there. Capturing around them isn't
+        // planned yet.
+        if (!universe.all_of<cqspc::bodies::Body>(target)) {
+            plan.burns.push_back({transfer->arrival, transfer->arrival_impulse});
+        }
+    }
+}
 
-    auto bodies = universe.view<cqspt::MoveTarget, cqspt::Kinematics>(entt::exclude<cqspt::Orbit>);
-    for (entt::entity body : bodies) {
-        cqspt::Kinematics& bodykin = universe.get<cqspt::Kinematics>(body);
-        cqspt::Kinematics& targetkin = universe.get<cqspt::Kinematics>(universe.get<cqspt::MoveTarget>(body).target);
-        glm::vec3 path = targetkin.position - bodykin.position;
+void SysPath::ApplyBurns(double time) {
+    ZoneScoped;
+    Universe& universe = GetUniverse();
+    for (entt::entity body : universe.view<cqspt::ImpulseSchedule>()) {
+        if (!universe.all_of<cqspt::MoveTarget>(body)) {
+            // The move was called off
+            universe.remove<cqspt::ImpulseSchedule>(body);
+            continue;
+        }
+        auto& burns = universe.get<cqspt::ImpulseSchedule>(body).burns;
+        auto due = std::find_if(burns.begin(), burns.end(), [time](const auto& burn) { return burn.time > time; });
+        if (due != burns.begin()) {
+            glm::dvec3 impulse(0, 0, 0);
+            for (auto burn = burns.begin(); burn != due; burn++) {
+                impulse += burn->impulse;
+            }
+            burns.erase(burns.begin(), due);
+            if (auto* existing = universe.try_get<cqspt::Impulse>(body); existing != nullptr) {
+                existing->impulse += impulse;
+            } else {
+                universe.emplace<cqspt::Impulse>(body, impulse);
+            }
+        }
+        if (burns.empty()) {
+            universe.remove<cqspt::ImpulseSchedule, cqspt::MoveTarget>(body);
+        }
     }
 }
 
 void EnterSOI(Universe& universe, const entt::entity& parent, const entt::entity& body) {
     auto& pos = universe.get<cqspc::types::Kinematics>(body);
-    auto& orb = universe.get<cqspc::types::Orbit>(body);
     // Check parents for SOI if we're intersecting with anything
     for (entt::entity entity : universe.get<cqspc::bodies::OrbitalSystem>(parent).children) {
         // Get the stuff
@@ -178,19 +357,8 @@ void EnterSOI(Universe& universe, const entt::entity& parent, const entt::entity
         }
         const auto& body_comp = universe.get<cqspc::bodies::Body>(entity);
         const auto& kinematics = universe.get<cqspc::types::Kinematics>(entity);
-        if (glm::distance(kinematics.position, pos.position) <= body_comp.radius) {
-            // Calculate position
-            orb = cqspt::Vec3ToOrbit(pos.position - kinematics.position, pos.velocity - kinematics.velocity,
-                                     body_comp.GM, universe.date.ToSecond());
-            orb.reference_body = entity;
-            orb.CalculateVariables();
-            // Calculate position, and change the thing
-            pos.position = cqspt::toVec3(orb);
-            pos.velocity = cqspt::OrbitVelocityToVec3(orb, orb.v);
-            // Then change SOI
-            universe.get_or_emplace<cqspc::bodies::OrbitalSystem>(entity).push_back(body);
-            auto& vec = universe.get<cqspc::bodies::OrbitalSystem>(parent).children;
-            vec.erase(std::remove(vec.begin(), vec.end(), body), vec.end());
+        if (glm::distance(kinematics.position, pos.position) <= body_comp.SOI) {
+            MoveToSOI(universe, parent, body, entity);
             break;
         }
     }
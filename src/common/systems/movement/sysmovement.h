@@ -19,17 +19,38 @@
 #include <vector>
 
 #include "common/systems/isimulationsystem.h"
+#include "common/systems/movement/orbitevents.h"
+#include "common/systems/movement/transferplanner.h"
 
 namespace cqsp {
 namespace common {
 namespace systems {
+/// <summary>
+/// Moves every orbit, and changes the SOI of orbits or crashes them when they are due to.
+/// </summary>
+/// SOI transitions and impacts aren't looked for every tick, they are predicted when an orbit is added or
+/// changes, and handled when they come up in the `OrbitEventQueue`.
 class SysOrbit : public ISimulationSystem {
  public:
-    explicit SysOrbit(Game& game) : ISimulationSystem(game) {}
+    explicit SysOrbit(Game& game);
+    ~SysOrbit();
     void DoSystem() override;
     int Interval() override { return 1; }
 
     void ParseOrbitTree(entt::entity parent, entt::entity body);
+
+    const OrbitEventQueue& GetEvents() const { return events; }
+
+ private:
+    void OnOrbitChanged(entt::registry&, entt::entity entity) { changed.push_back(entity); }
+    void HandleEvent(const OrbitEvent& event, double time);
+    /// Predicts the orbit again, and the orbits around the same body if it has an SOI of its own
+    void Reschedule(entt::entity body, double time);
+
+    OrbitEventQueue events;
+    /// Orbits that were added or replaced since the last tick
+    std::vector<entt::entity> changed;
+    bool scheduled = false;
 };
 
 /// <summary>
@@ -47,11 +68,25 @@ void LeaveSOI(Universe& universe, const entt::entity& body);
 /// <param name="body"></param>
 void EnterSOI(Universe& universe, const entt::entity& parent, const entt::entity& body);
 
+/// <summary>
+/// Moves ships to their `MoveTarget`.
+/// </summary>
+/// Ships on an orbit are given an `ImpulseSchedule` for the cheapest transfer to a target that orbits the same body,
+/// and its burns are added as an `Impulse` on the tick they are due, before `SysOrbit` applies them. Ships without
+/// an orbit are left where they are.
 class SysPath : public ISimulationSystem {
  public:
     explicit SysPath(Game& game) : ISimulationSystem(game) {}
     void DoSystem();
     int Interval() { return 1; }
+
+    const TransferPlanner& GetPlanner() const { return planner; }
+
+ private:
+    void PlanTransfers(double time);
+    void ApplyBurns(double time);
+
+    TransferPlanner planner;
 };
 
 class SysSurface : public ISimulationSystem {
@@ -0,0 +1,207 @@
+/* Conquer Space
+ * Copyright (C) 2021-2023 Conquer Space
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "common/systems/movement/transferplanner.h"
+
+#include <algorithm>
+#include <functional>
+
+#include <tracy/Tracy.hpp>
+
+#include "common/systems/movement/lambert.h"
+
+namespace cqsp::common::systems {
+namespace {
+namespace cqspt = cqsp::common::components::types;
+
+constexpr double infinity = std::numeric_limits<double>::infinity();
+constexpr double tick_length = components::StarDate::TIME_INCREMENT;
+// Times of flight that are searched when they aren't given, as fractions of the time of a Hohmann transfer
+constexpr double min_flight_fraction = 0.2;
+constexpr double max_flight_fraction = 2;
+// Longest departure window, in periods of the slower orbit, for orbits that have about the same period
+constexpr double max_window_periods = 4;
+
+double RoundToTick(double time) { return std::round(time / tick_length) * tick_length; }
+
+// `count` times from `begin` to `end`, rounded to ticks. Times that round to the same tick are only there once.
+std::vector<double> Steps(double begin, double end, int count) {
+    std::vector<double> steps;
+    steps.reserve(count);
+    for (int i = 0; i < count; i++) {
+        double fraction = count > 1 ? static_cast<double>(i) / (count - 1) : 0;
+        steps.push_back(RoundToTick(begin + (end - begin) * fraction));
+    }
+    steps.erase(std::unique(steps.begin(), steps.end()), steps.end());
+    return steps;
+}
+
+void StateAt(const cqspt::Orbit& orbit, double time, glm::dvec3& position, glm::dvec3& velocity) {
+    cqspt::Orbit moved = orbit;
+    cqspt::UpdateOrbit(moved, time);
+    position = cqspt::toVec3(moved);
+    velocity = cqspt::OrbitVelocityToVec3(moved, moved.v);
+}
+
+double Period(const cqspt::Orbit& orbit) {
+    const double a = orbit.semi_major_axis;
+    return cqspt::TWOPI * std::sqrt(a * a * a / orbit.GM);
+}
+
+double HohmannTime(const cqspt::Orbit& origin, const cqspt::Orbit& target) {
+    const double a = (origin.semi_major_axis + target.semi_major_axis) / 2;
+    return cqspt::PI * std::sqrt(a * a * a / origin.GM);
+}
+
+// Every position of the orbits relative to each other comes up once in this time
+double SynodicPeriod(const cqspt::Orbit& origin, const cqspt::Orbit& target) {
+    const double longest = max_window_periods * std::max(Period(origin), Period(target));
+    const double relative = std::abs(1 / Period(origin) - 1 / Period(target));
+    return relative > 1 / longest ? 1 / relative : longest;
+}
+
+// Fills `delta_v` with the transfers of the grid, and returns the best of them
+TransferWindow SolveGrid(const cqspt::Orbit& origin, const cqspt::Orbit& target,
+                         const std::vector<double>& departures, const std::vector<double>& flight_times,
+                         std::vector<double>& delta_v) {
+    const size_t flights = flight_times.size();
+    const size_t count = departures.size() * flights;
+    delta_v.assign(count, infinity);
+    if (count == 0) {
+        return TransferWindow();
+    }
+
+    std::vector<LambertProblem> problems(count);
+    std::vector<glm::dvec3> departure_velocity(departures.size());
+    std::vector<glm::dvec3> arrival_velocity(count);
+    for (size_t d = 0; d < departures.size(); d++) {
+        glm::dvec3 position;
+        StateAt(origin, departures[d], position, departure_velocity[d]);
+        for (size_t f = 0; f < flights; f++) {
+            const size_t i = d * flights + f;
+            LambertProblem& problem = problems[i];
+            problem.r1 = position;
+            StateAt(target, departures[d] + flight_times[f], problem.r2, arrival_velocity[i]);
+            problem.time_of_flight = flight_times[f];
+            problem.GM = origin.GM;
+            // Transfers go around the same way as the origin orbit
+            problem.normal = glm::cross(position, departure_velocity[d]);
+        }
+    }
+    std::vector<LambertSolution> solutions(count);
+    SolveLambert(problems, solutions);
+
+    TransferWindow best;
+    for (size_t i = 0; i < count; i++) {
+        if (!solutions[i].valid) {
+            continue;
+        }
+        const size_t d = i / flights;
+        const glm::dvec3 departure_impulse = solutions[i].v1 - departure_velocity[d];
+        const glm::dvec3 arrival_impulse = arrival_velocity[i] - solutions[i].v2;
+        delta_v[i] = glm::length(departure_impulse) + glm::length(arrival_impulse);
+        if (delta_v[i] < best.delta_v) {
+            best.departure = departures[d];
+            best.arrival = departures[d] + flight_times[i % flights];
+            best.departure_impulse = departure_impulse;
+            best.arrival_impulse = arrival_impulse;
+            best.delta_v = delta_v[i];
+        }
+    }
+    return best;
+}
+}  // namespace
+
+Porkchop ComputePorkchop(const cqspt::Orbit& origin, const cqspt::Orbit& target, double start,
+                         const PorkchopParameters& parameters) {
+    ZoneScoped;
+    Porkchop porkchop;
+    if (origin.eccentricity >= 1 || target.eccentricity >= 1 || origin.semi_major_axis <= 0 ||
+        target.semi_major_axis <= 0 || origin.GM <= 0) {
+        return porkchop;
+    }
+    start = std::ceil(start / tick_length) * tick_length;
+    const double window = parameters.window > 0 ? parameters.window : SynodicPeriod(origin, target);
+    const double hohmann = HohmannTime(origin, target);
+    double min_flight = parameters.min_flight > 0 ? parameters.min_flight : min_flight_fraction * hohmann;
+    double max_flight = parameters.max_flight > 0 ? parameters.max_flight : max_flight_fraction * hohmann;
+    min_flight = std::max(min_flight, tick_length);
+    max_flight = std::max(max_flight, min_flight);
+
+    porkchop.departures = Steps(start, start + window, parameters.departure_steps);
+    porkchop.flight_times = Steps(min_flight, max_flight, parameters.flight_steps);
+    porkchop.best = SolveGrid(origin, target, porkchop.departures, porkchop.flight_times, porkchop.delta_v);
+
+    // Each refinement searches one step either side of the best transfer with the same number of steps
+    const int departure_intervals = std::max(1, parameters.departure_steps - 1);
+    const int flight_intervals = std::max(1, parameters.flight_steps - 1);
+    double departure_step = window / departure_intervals;
+    double flight_step = (max_flight - min_flight) / flight_intervals;
+    std::vector<double> delta_v;
+    for (int i = 0; i < parameters.refinements && porkchop.best.valid(); i++) {
+        const double departure = porkchop.best.departure;
+        const double flight = porkchop.best.arrival - departure;
+        std::vector<double> departures =
+            Steps(std::max(start, departure - departure_step), departure + departure_step, parameters.departure_steps);
+        std::vector<double> flights =
+            Steps(std::max(tick_length, flight - flight_step), flight + flight_step, parameters.flight_steps);
+        TransferWindow refined = SolveGrid(origin, target, departures, flights, delta_v);
+        if (refined.delta_v < porkchop.best.delta_v) {
+            porkchop.best = refined;
+        }
+        departure_step = 2 * departure_step / departure_intervals;
+        flight_step = 2 * flight_step / flight_intervals;
+    }
+    return porkchop;
+}
+
+TransferPlanner::OrbitKey::OrbitKey(const cqspt::Orbit& orbit)
+    : semi_major_axis(orbit.semi_major_axis),
+      eccentricity(orbit.eccentricity),
+      inclination(orbit.inclination),
+      LAN(orbit.LAN),
+      w(orbit.w),
+      M0(orbit.M0),
+      epoch(orbit.epoch),
+      GM(orbit.GM) {}
+
+size_t TransferPlanner::KeyHash::operator()(const Key& key) const {
+    size_t seed = std::hash<int64_t>()(key.window);
+    for (const OrbitKey* orbit : {&key.origin, &key.target}) {
+        for (double value : {orbit->semi_major_axis, orbit->eccentricity, orbit->inclination, orbit->LAN, orbit->w,
+                             orbit->M0, orbit->epoch, orbit->GM}) {
+            seed ^= std::hash<double>()(value) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+        }
+    }
+    return seed;
+}
+
+const TransferWindow& TransferPlanner::Plan(const cqspt::Orbit& origin, const cqspt::Orbit& target, double time) {
+    const auto current = static_cast<int64_t>(std::floor(time / epoch_window));
+    if (current != window) {
+        cache.clear();
+        window = current;
+    }
+    Key key {OrbitKey(origin), OrbitKey(target), current};
+    auto cached = cache.find(key);
+    if (cached != cache.end()) {
+        hit_count++;
+        return cached->second;
+    }
+    Porkchop porkchop = ComputePorkchop(origin, target, (current + 1) * epoch_window, parameters);
+    return cache.emplace(key, porkchop.best).first->second;
+}
+}  // namespace cqsp::common::systems
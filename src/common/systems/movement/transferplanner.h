@@ -0,0 +1,139 @@
+/* Conquer Space
+ * Copyright (C) 2021-2023 Conquer Space
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <unordered_map>
+#include <vector>
+
+#include "common/components/orbit.h"
+#include "common/stardate.h"
+
+namespace cqsp::common::systems {
+/// <summary>
+/// Two burns that take an orbit to where another orbit is, and match its velocity there.
+/// </summary>
+struct TransferWindow {
+    /// Seconds
+    double departure = 0;
+    /// Seconds
+    double arrival = 0;
+    /// Change of velocity at the departure, km/s
+    glm::dvec3 departure_impulse {0, 0, 0};
+    /// Change of velocity at the arrival, km/s
+    glm::dvec3 arrival_impulse {0, 0, 0};
+    /// Total of both burns, infinity if there is no transfer
+    double delta_v = std::numeric_limits<double>::infinity();
+
+    bool valid() const { return std::isfinite(delta_v); }
+};
+
+struct PorkchopParameters {
+    int departure_steps = 32;
+    int flight_steps = 32;
+    /// Times that the grid is searched again around the best transfer, one step either way
+    int refinements = 1;
+    /// Seconds of departures to search, zero is the synodic period of the orbits
+    double window = 0;
+    /// Shortest time of flight in seconds, zero is a fraction of the time of a Hohmann transfer
+    double min_flight = 0;
+    /// Longest time of flight in seconds, zero is a multiple of the time of a Hohmann transfer
+    double max_flight = 0;
+};
+
+/// <summary>
+/// Delta-v of the transfers over a grid of departure times and times of flight.
+/// </summary>
+struct Porkchop {
+    std::vector<double> departures;
+    std::vector<double> flight_times;
+    /// Row of times of flight for every departure, infinity where there is no transfer
+    std::vector<double> delta_v;
+    /// Best transfer of the grid and its refinements
+    TransferWindow best;
+};
+
+/// <summary>
+/// Solves the transfers from `origin` to `target` for departures from `start`, which have to orbit the same body.
+/// </summary>
+/// Every time is a whole number of ticks, so that the burns line up with the ticks they are applied on. The Lambert
+/// problems of the grid are solved as one batch. Only elliptic orbits are planned for, the grid is empty otherwise.
+Porkchop ComputePorkchop(const components::types::Orbit& origin, const components::types::Orbit& target,
+                         double start, const PorkchopParameters& parameters = {});
+
+/// <summary>
+/// Finds transfers between orbits, and remembers them for the rest of the epoch window that they were asked for in.
+/// </summary>
+/// Transfers are searched from the start of the next window, so that a transfer found in a window departs after
+/// every time in it, and every ship on the same orbit that goes to the same target shares it. Time only goes
+/// forward, so the cache is cleared when the window moves on.
+class TransferPlanner {
+ public:
+    explicit TransferPlanner(const PorkchopParameters& parameters = {}) : parameters(parameters) {}
+
+    /// <summary>
+    /// Cheapest transfer from `origin` to `target` that departs after `time`.
+    /// </summary>
+    /// The transfer is invalid if there is none. The reference is only good until the next plan.
+    const TransferWindow& Plan(const components::types::Orbit& origin, const components::types::Orbit& target,
+                               double time);
+
+    /// Transfers in the cache
+    size_t size() const { return cache.size(); }
+    /// Transfers that were planned from the cache
+    size_t hits() const { return hit_count; }
+
+    /// Seconds
+    static constexpr double epoch_window =
+        components::StarDate::DAY * static_cast<double>(components::StarDate::TIME_INCREMENT);
+
+ private:
+    /// Elements of an orbit at its epoch, so that the same orbit is the same key
+    struct OrbitKey {
+        double semi_major_axis;
+        double eccentricity;
+        double inclination;
+        double LAN;
+        double w;
+        double M0;
+        double epoch;
+        double GM;
+
+        explicit OrbitKey(const components::types::Orbit& orbit);
+        bool operator==(const OrbitKey&) const = default;
+    };
+
+    struct Key {
+        OrbitKey origin;
+        OrbitKey target;
+        int64_t window;
+
+        bool operator==(const Key&) const = default;
+    };
+
+    struct KeyHash {
+        size_t operator()(const Key& key) const;
+    };
+
+    PorkchopParameters parameters;
+    std::unordered_map<Key, TransferWindow, KeyHash> cache;
+    int64_t window = std::numeric_limits<int64_t>::min();
+    size_t hit_count = 0;
+};
+}  // namespace cqsp::common::systems
@@ -17,6 +17,7 @@
 #include "common/systems/population/cityinformation.h"
 
 #include "common/components/population.h"
+#include "common/components/rollup.h"
 #include "common/components/surface.h"
 
 uint64_t cqsp::common::systems::GetCityPopulation(const Universe& universe, entt::entity city) {
@@ -24,6 +25,10 @@ uint64_t cqsp::common::systems::GetCityPopulation(const Universe& universe, entt
     if (!universe.any_of<cqspc::Settlement>(city)) {
         return 0;
     }
+    if (const auto* rollup = universe.try_get<cqspc::Rollup>(city)) {
+        return rollup->population;
+    }
+    // Not measured yet
     uint64_t pop_count = 0;
     auto& settlement = universe.get<cqspc::Settlement>(city);
     for (entt::entity pop : settlement.population) {
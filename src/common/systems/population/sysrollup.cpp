@@ -0,0 +1,167 @@
+/* Conquer Space
+ * Copyright (C) 2021-2023 Conquer Space
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "common/systems/population/sysrollup.h"
+
+#include <unordered_map>
+#include <utility>
+
+#include <tracy/Tracy.hpp>
+
+#include "common/components/coordinates.h"
+#include "common/components/economy.h"
+#include "common/components/organizations.h"
+#include "common/components/population.h"
+#include "common/components/surface.h"
+
+namespace cqsp::common::systems {
+namespace cqspc = cqsp::common::components;
+
+namespace {
+cqspc::Rollup MeasureCity(Universe& universe, entt::entity city) {
+    cqspc::Rollup rollup;
+    rollup.cities = 1;
+    for (entt::entity segment_entity : universe.get<cqspc::Settlement>(city).population) {
+        if (const auto* segment = universe.try_get<cqspc::PopulationSegment>(segment_entity)) {
+            rollup.population += segment->population;
+            rollup.labor_force += segment->labor_force;
+        }
+    }
+    if (universe.all_of<cqspc::Market>(city)) {
+        auto& market = universe.patch<cqspc::Market>(city);
+        rollup.production = market.previous_supply;
+        rollup.consumption = market.previous_demand;
+        rollup.gdp = (market.previous_supply * market.price).GetSum();
+        market.GDP = rollup.gdp;
+    }
+    return rollup;
+}
+
+/// Difference from `previous` to `current`. The counts wrap around if they go down, which cancels out
+/// when the difference is added.
+cqspc::Rollup Difference(const cqspc::Rollup& current, const cqspc::Rollup& previous) {
+    cqspc::Rollup difference;
+    difference.population = current.population - previous.population;
+    difference.labor_force = current.labor_force - previous.labor_force;
+    difference.gdp = current.gdp - previous.gdp;
+    difference.production = current.production - previous.production;
+    difference.consumption = current.consumption - previous.consumption;
+    difference.cities = current.cities - previous.cities;
+    return difference;
+}
+
+void AddToParents(Universe& universe, const cqspc::RollupParents& parents, const cqspc::Rollup& difference) {
+    for (entt::entity parent : {parents.province, parents.country, parents.planet}) {
+        if (parent == entt::null || !universe.valid(parent)) {
+            continue;
+        }
+        auto& rollup = universe.get_or_emplace<cqspc::Rollup>(parent);
+        rollup.population += difference.population;
+        rollup.labor_force += difference.labor_force;
+        rollup.gdp += difference.gdp;
+        rollup.production += difference.production;
+        rollup.consumption += difference.consumption;
+        rollup.cities += difference.cities;
+    }
+}
+}  // namespace
+
+SysRollup::SysRollup(Game& game) : ISimulationSystem(game) {
+    Universe& universe = GetUniverse();
+    // Whichever of the two goes first, the other one is still there
+    universe.on_destroy<cqspc::Rollup>().connect<&SysRollup::OnCityRemoved>(*this);
+    universe.on_destroy<cqspc::RollupParents>().connect<&SysRollup::OnCityRemoved>(*this);
+}
+
+SysRollup::~SysRollup() {
+    Universe& universe = GetUniverse();
+    universe.on_destroy<cqspc::Rollup>().disconnect(*this);
+    universe.on_destroy<cqspc::RollupParents>().disconnect(*this);
+}
+
+void SysRollup::OnCityRemoved(entt::registry&, entt::entity city) {
+    Universe& universe = GetUniverse();
+    // Only cities have both
+    if (!universe.all_of<cqspc::Rollup, cqspc::RollupParents>(city)) {
+        return;
+    }
+    AddToParents(universe, universe.get<cqspc::RollupParents>(city),
+                 Difference(cqspc::Rollup(), universe.get<cqspc::Rollup>(city)));
+}
+
+void SysRollup::DoSystem() {
+    ZoneScoped;
+    UpdateRollups(GetUniverse());
+}
+
+const cqspc::Rollup& GetRollup(const Universe& universe, entt::entity entity) {
+    static const cqspc::Rollup empty;
+    const auto* rollup = universe.try_get<cqspc::Rollup>(entity);
+    return rollup == nullptr ? empty : *rollup;
+}
+
+void UpdateRollups(Universe& universe) {
+    // Cities don't know their province, so look it up from the provinces
+    std::unordered_map<entt::entity, entt::entity> city_provinces;
+    for (entt::entity province : universe.view<cqspc::Province>()) {
+        for (entt::entity city : universe.get<cqspc::Province>(province).cities) {
+            city_provinces[city] = province;
+        }
+    }
+
+    for (entt::entity city : universe.view<cqspc::Settlement>()) {
+        cqspc::RollupParents parents;
+        auto province = city_provinces.find(city);
+        if (province != city_provinces.end()) {
+            parents.province = province->second;
+        }
+        if (const auto* governed = universe.try_get<cqspc::Governed>(city)) {
+            parents.country = governed->governor;
+        } else if (parents.province != entt::null) {
+            parents.country = universe.get<cqspc::Province>(parents.province).country;
+        }
+        if (const auto* coordinate = universe.try_get<cqspc::types::SurfaceCoordinate>(city)) {
+            parents.planet = coordinate->planet;
+        }
+
+        cqspc::Rollup measured = MeasureCity(universe, city);
+        const auto* previous = universe.try_get<cqspc::Rollup>(city);
+        const auto* previous_parents = universe.try_get<cqspc::RollupParents>(city);
+        if (previous != nullptr && previous_parents != nullptr && *previous_parents == parents) {
+            AddToParents(universe, parents, Difference(measured, *previous));
+        } else {
+            // New city, or it changed hands, so move all of it over
+            if (previous != nullptr && previous_parents != nullptr) {
+                AddToParents(universe, *previous_parents, Difference(cqspc::Rollup(), *previous));
+            }
+            AddToParents(universe, parents, measured);
+        }
+        universe.get_or_emplace<cqspc::Rollup>(city) = std::move(measured);
+        universe.get_or_emplace<cqspc::RollupParents>(city) = parents;
+    }
+
+    for (entt::entity planet : universe.view<cqspc::Rollup, cqspc::PlanetaryMarket, cqspc::Market>()) {
+        universe.patch<cqspc::Market>(planet).GDP = universe.get<cqspc::Rollup>(planet).gdp;
+    }
+}
+
+void RebuildRollups(Universe& universe) {
+    // Parents first, so that SysRollup doesn't take the cities out of rollups that are being cleared
+    universe.clear<cqspc::RollupParents>();
+    universe.clear<cqspc::Rollup>();
+    UpdateRollups(universe);
+}
+}  // namespace cqsp::common::systems
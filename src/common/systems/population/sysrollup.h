@@ -0,0 +1,55 @@
+/* Conquer Space
+ * Copyright (C) 2021-2023 Conquer Space
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include "common/components/rollup.h"
+#include "common/systems/isimulationsystem.h"
+
+namespace cqsp::common::systems {
+/// <summary>
+/// Sums up the population, labor force, GDP, production and consumption of every city into its province,
+/// country and planet.
+/// </summary>
+/// Cities are measured again every day, and only the difference from the last measurement is added to the
+/// rollups above them, so a rollup never has to be summed from its cities. This has to run after `SysMarket`,
+/// so that the supply and demand of the day are in the previous supply and demand of the markets.
+/// When a city is destroyed, what it added is taken out of the rollups above it.
+class SysRollup : public ISimulationSystem {
+ public:
+    explicit SysRollup(Game& game);
+    ~SysRollup();
+    void DoSystem() override;
+
+ private:
+    void OnCityRemoved(entt::registry&, entt::entity city);
+};
+
+/// <summary>
+/// Rollup of a city, province, country or planet as of the last day, or an empty rollup if there isn't one.
+/// </summary>
+const components::Rollup& GetRollup(const Universe& universe, entt::entity entity);
+
+/// <summary>
+/// Measures every city and adds the difference to the rollups above it.
+/// </summary>
+void UpdateRollups(Universe& universe);
+
+/// <summary>
+/// Throws away every rollup and sums them up again from the cities.
+/// </summary>
+void RebuildRollups(Universe& universe);
+}  // namespace cqsp::common::systems
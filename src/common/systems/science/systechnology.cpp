@@ -16,6 +16,7 @@
  */
 #include "common/systems/science/systechnology.h"
 
+#include <memory_resource>
 #include <vector>
 
 #include <tracy/Tracy.hpp>
@@ -27,9 +28,10 @@ void cqsp::common::systems::SysTechProgress::DoSystem() {
     ZoneScoped;
     auto field = GetUniverse().view<components::science::ScientificResearch>();
 
+    std::pmr::vector<entt::entity> completed_techs(GetTickArena());
     for (entt::entity entity : field) {
         auto& research = GetUniverse().get<components::science::ScientificResearch>(entity);
-        std::vector<entt::entity> completed_techs;
+        completed_techs.clear();
         for (auto& res : research.current_research) {
             res.second += Interval();
             // Get the research amount
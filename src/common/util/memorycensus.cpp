@@ -0,0 +1,345 @@
+/* Conquer Space
+ * Copyright (C) 2021-2023 Conquer Space
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "common/util/memorycensus.h"
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <memory>
+#include <set>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+
+#include <tracy/Tracy.hpp>
+
+#include "common/components/area.h"
+#include "common/components/auction.h"
+#include "common/components/bodies.h"
+#include "common/components/coordinates.h"
+#include "common/components/economy.h"
+#include "common/components/event.h"
+#include "common/components/history.h"
+#include "common/components/name.h"
+#include "common/components/orbit.h"
+#include "common/components/organizations.h"
+#include "common/components/population.h"
+#include "common/components/resource.h"
+#include "common/components/science.h"
+#include "common/components/ships.h"
+#include "common/components/surface.h"
+
+namespace cqsp::common::util {
+namespace {
+namespace cqspc = cqsp::common::components;
+
+// The heap sizes are estimates, the node layouts are those of the common standard libraries:
+// the value and three pointers and a color for map and set nodes.
+template <typename Value>
+constexpr size_t TreeNodeBytes() {
+    return sizeof(Value) + 4 * sizeof(void*);
+}
+
+size_t HeapBytes(const std::string& string) {
+    // Short strings are stored inside the string
+    return string.capacity() + 1 > sizeof(std::string) ? string.capacity() + 1 : 0;
+}
+
+template <typename T>
+size_t HeapBytes(const std::vector<T>& vector) {
+    return vector.capacity() * sizeof(T);
+}
+
+size_t HeapBytes(const std::vector<std::string>& vector) {
+    size_t bytes = vector.capacity() * sizeof(std::string);
+    for (const std::string& string : vector) {
+        bytes += HeapBytes(string);
+    }
+    return bytes;
+}
+
+template <typename T>
+size_t HeapBytes(const std::set<T>& set) {
+    return set.size() * TreeNodeBytes<T>();
+}
+
+template <typename K, typename V>
+size_t HeapBytes(const std::map<K, V>& map) {
+    return map.size() * TreeNodeBytes<std::pair<const K, V>>();
+}
+
+template <typename K, typename V>
+size_t HeapBytes(const std::map<K, std::vector<V>>& map) {
+    size_t bytes = map.size() * TreeNodeBytes<std::pair<const K, std::vector<V>>>();
+    for (const auto& [key, vector] : map) {
+        bytes += HeapBytes(vector);
+    }
+    return bytes;
+}
+
+size_t HeapBytes(const cqspc::ResourceLedger& ledger) {
+    return ledger.size() * TreeNodeBytes<std::pair<const entt::entity, double>>();
+}
+
+size_t HeapBytes(const cqspc::Name& name) { return HeapBytes(name.name); }
+size_t HeapBytes(const cqspc::Identifier& identifier) { return HeapBytes(identifier.identifier); }
+size_t HeapBytes(const cqspc::Description& description) { return HeapBytes(description.description); }
+
+size_t HeapBytes(const cqspc::MarketInformation& info) {
+    size_t bytes = 0;
+    for (const cqspc::ResourceLedger* ledger :
+         {&info.demand, &info.sd_ratio, &info.ds_ratio, &info.supply, &info.volume, &info.price,
+          &info.previous_demand, &info.previous_supply, &info.latent_supply, &info.last_latent_demand,
+          &info.latent_demand}) {
+        bytes += HeapBytes(*ledger);
+    }
+    return bytes;
+}
+
+size_t HeapBytes(const cqspc::Market& market) {
+    size_t bytes = HeapBytes(static_cast<const cqspc::MarketInformation&>(market));
+    bytes += HeapBytes(market.history);
+    for (const cqspc::MarketInformation& info : market.history) {
+        bytes += HeapBytes(info);
+    }
+    bytes += HeapBytes(market.market_information);
+    bytes += HeapBytes(market.last_market_information);
+    bytes += HeapBytes(market.participants);
+    bytes += (market.connected_markets.capacity() + market.connected_markets.extent()) * sizeof(entt::entity);
+    return bytes;
+}
+
+size_t HeapBytes(const cqspc::MarketHistory& history) {
+    return HeapBytes(history.price_history) + HeapBytes(history.sd_ratio) + HeapBytes(history.supply) +
+           HeapBytes(history.demand) + HeapBytes(history.volume) + HeapBytes(history.gdp);
+}
+
+size_t HeapBytes(const cqspc::AuctionHouse& auction) {
+    size_t bytes = HeapBytes(auction.sell_orders) + HeapBytes(auction.buy_orders);
+    for (const auto& [good, orders] : auction.sell_orders) {
+        bytes += orders.capacity() * sizeof(cqspc::Order);
+    }
+    for (const auto& [good, orders] : auction.buy_orders) {
+        bytes += orders.capacity() * sizeof(cqspc::Order);
+    }
+    return bytes;
+}
+
+size_t HeapBytes(const cqspc::ResourceIO& io) { return HeapBytes(io.input) + HeapBytes(io.output); }
+size_t HeapBytes(const cqspc::Recipe& recipe) { return HeapBytes(recipe.input) + HeapBytes(recipe.capitalcost); }
+size_t HeapBytes(const cqspc::RecipeCost& cost) { return HeapBytes(cost.fixed) + HeapBytes(cost.scaling); }
+size_t HeapBytes(const cqspc::ResourceDistribution& distribution) { return HeapBytes(distribution.dist); }
+size_t HeapBytes(const cqspc::IndustrialZone& zone) { return HeapBytes(zone.industries); }
+
+size_t HeapBytes(const cqspc::science::Field& field) { return HeapBytes(field.parents) + HeapBytes(field.adjacent); }
+size_t HeapBytes(const cqspc::science::Science& science) { return HeapBytes(science.fields); }
+size_t HeapBytes(const cqspc::science::Lab& lab) { return HeapBytes(lab.science_contribution); }
+size_t HeapBytes(const cqspc::science::ScientificProgress& progress) { return HeapBytes(progress.science_progress); }
+size_t HeapBytes(const cqspc::science::ScientificResearch& research) {
+    return HeapBytes(research.current_research) + HeapBytes(research.potential_research);
+}
+size_t HeapBytes(const cqspc::science::TechnologicalProgress& progress) {
+    return HeapBytes(progress.researched_techs) + HeapBytes(progress.researched_recipes) +
+           HeapBytes(progress.researched_mining);
+}
+size_t HeapBytes(const cqspc::science::Technology& technology) {
+    return HeapBytes(technology.fields) + HeapBytes(technology.actions);
+}
+
+size_t HeapBytes(const cqspc::Settlement& settlement) { return HeapBytes(settlement.population); }
+size_t HeapBytes(const cqspc::Habitation& habitation) { return HeapBytes(habitation.settlements); }
+size_t HeapBytes(const cqspc::Province& province) { return HeapBytes(province.cities); }
+size_t HeapBytes(const cqspc::ProvincedPlanet& planet) {
+    return HeapBytes(planet.province_texture) + HeapBytes(planet.province_map);
+}
+size_t HeapBytes(const cqspc::CountryCityList& list) {
+    return HeapBytes(list.city_list) + HeapBytes(list.province_list);
+}
+
+size_t HeapBytes(const cqspc::bodies::OrbitalSystem& system) { return HeapBytes(system.children); }
+size_t HeapBytes(const cqspc::bodies::TerrainData& terrain) { return HeapBytes(terrain.data); }
+size_t HeapBytes(const cqspc::bodies::TexturedTerrain& terrain) {
+    return HeapBytes(terrain.terrain_name) + HeapBytes(terrain.normal_name) + HeapBytes(terrain.roughness_name);
+}
+
+size_t HeapBytes(const cqspc::ships::Fleet& fleet) { return HeapBytes(fleet.subfleets) + HeapBytes(fleet.ships); }
+
+size_t HeapBytes(const cqsp::common::event::EventQueue& queue) {
+    size_t bytes = HeapBytes(queue.events);
+    for (const auto& event : queue.events) {
+        // The event and the control block of the shared pointer
+        bytes += sizeof(cqsp::common::event::Event) + 2 * sizeof(void*);
+        bytes += HeapBytes(event->title) + HeapBytes(event->content) + HeapBytes(event->image);
+        bytes += HeapBytes(event->actions);
+        for (const auto& action : event->actions) {
+            bytes += sizeof(cqsp::common::event::EventResult) + 2 * sizeof(void*);
+            bytes += HeapBytes(action->name) + HeapBytes(action->tooltip);
+        }
+    }
+    return bytes;
+}
+
+template <typename T>
+concept HasHeap = requires(const T& component) { HeapBytes(component); };
+
+struct PoolType {
+    const char* name;
+    const char* system;
+    size_t component_size;
+    size_t (*heap_bytes)(Universe& universe);
+};
+
+template <typename T>
+std::pair<entt::id_type, PoolType> Pool(const char* name, const char* system) {
+    PoolType type {name, system, std::is_empty_v<T> ? 0 : sizeof(T), nullptr};
+    if constexpr (HasHeap<T>) {
+        type.heap_bytes = [](Universe& universe) {
+            size_t bytes = 0;
+            for (auto&& [entity, component] : universe.view<T>().each()) {
+                bytes += HeapBytes(component);
+            }
+            return bytes;
+        };
+    }
+    return {entt::type_hash<T>::value(), type};
+}
+
+const std::unordered_map<entt::id_type, PoolType>& GetPoolTypes() {
+    namespace cqspb = cqspc::bodies;
+    namespace cqsps = cqspc::science;
+    namespace cqspt = cqspc::types;
+    static const std::unordered_map<entt::id_type, PoolType> types = {
+        Pool<cqspc::Name>("Name", "names"),
+        Pool<cqspc::Identifier>("Identifier", "names"),
+        Pool<cqspc::Description>("Description", "names"),
+
+        Pool<cqspc::Market>("Market", "economy"),
+        Pool<cqspc::MarketHistory>("MarketHistory", "economy"),
+        Pool<cqspc::AuctionHouse>("AuctionHouse", "economy"),
+        Pool<cqspc::Wallet>("Wallet", "economy"),
+        Pool<cqspc::Price>("Price", "economy"),
+        Pool<cqspc::CostTable>("CostTable", "economy"),
+        Pool<cqspc::ResourceStockpile>("ResourceStockpile", "economy"),
+        Pool<cqspc::ResourceConsumption>("ResourceConsumption", "economy"),
+        Pool<cqspc::ResourceProduction>("ResourceProduction", "economy"),
+        Pool<cqspc::ResourceIO>("ResourceIO", "economy"),
+        Pool<cqspc::ResourceDistribution>("ResourceDistribution", "economy"),
+        Pool<cqspc::Recipe>("Recipe", "economy"),
+        Pool<cqspc::RecipeCost>("RecipeCost", "economy"),
+        Pool<cqspc::IndustrialZone>("IndustrialZone", "economy"),
+
+        Pool<cqsps::Field>("Field", "science"),
+        Pool<cqsps::Science>("Science", "science"),
+        Pool<cqsps::Lab>("Lab", "science"),
+        Pool<cqsps::ScientificProgress>("ScientificProgress", "science"),
+        Pool<cqsps::ScientificResearch>("ScientificResearch", "science"),
+        Pool<cqsps::TechnologicalProgress>("TechnologicalProgress", "science"),
+        Pool<cqsps::Technology>("Technology", "science"),
+
+        Pool<cqspc::PopulationSegment>("PopulationSegment", "population"),
+        Pool<cqspc::Settlement>("Settlement", "population"),
+        Pool<cqspc::Habitation>("Habitation", "population"),
+
+        Pool<cqspc::Province>("Province", "provinces"),
+        Pool<cqspc::ProvincedPlanet>("ProvincedPlanet", "provinces"),
+        Pool<cqspc::CountryCityList>("CountryCityList", "provinces"),
+
+        Pool<cqspb::OrbitalSystem>("OrbitalSystem", "bodies"),
+        Pool<cqspb::TerrainData>("TerrainData", "bodies"),
+        Pool<cqspb::TexturedTerrain>("TexturedTerrain", "bodies"),
+        Pool<cqspt::Orbit>("Orbit", "bodies"),
+        Pool<cqspt::Kinematics>("Kinematics", "bodies"),
+
+        Pool<cqspc::ships::Fleet>("Fleet", "ships"),
+        Pool<cqsp::common::event::EventQueue>("EventQueue", "events"),
+    };
+    return types;
+}
+}  // namespace
+
+size_t MemoryCensus::TotalBytes() const {
+    size_t bytes = entity_bytes;
+    for (const PoolCensus& pool : pools) {
+        bytes += pool.TotalBytes();
+    }
+    return bytes;
+}
+
+std::map<std::string, size_t> MemoryCensus::SystemTotals() const {
+    std::map<std::string, size_t> totals;
+    for (const PoolCensus& pool : pools) {
+        totals[pool.system] += pool.TotalBytes();
+    }
+    return totals;
+}
+
+MemoryCensus TakeMemoryCensus(Universe& universe) {
+    ZoneScoped;
+    MemoryCensus census;
+    census.entities = universe.size();
+    census.alive = universe.alive();
+    census.entity_bytes = census.entities * sizeof(entt::entity);
+
+    const auto& types = GetPoolTypes();
+    for (auto&& [id, storage] : universe.storage()) {
+        PoolCensus pool;
+        pool.size = storage.size();
+        pool.capacity = storage.capacity();
+        pool.pool_bytes = (storage.capacity() + storage.extent()) * sizeof(entt::entity);
+        auto type = types.find(id);
+        if (type != types.end()) {
+            pool.name = type->second.name;
+            pool.system = type->second.system;
+            pool.pool_bytes += storage.capacity() * type->second.component_size;
+            if (type->second.heap_bytes != nullptr) {
+                pool.heap_bytes = type->second.heap_bytes(universe);
+            }
+        } else {
+            pool.name = std::string(storage.type().name());
+            pool.system = "other";
+        }
+        census.pools.push_back(std::move(pool));
+    }
+    std::sort(census.pools.begin(), census.pools.end(), [](const PoolCensus& a, const PoolCensus& b) {
+        return a.TotalBytes() > b.TotalBytes();
+    });
+    return census;
+}
+
+std::vector<std::string> FormatMemoryCensus(const MemoryCensus& census, size_t pool_count) {
+    auto kib = [](size_t bytes) { return static_cast<double>(bytes) / 1024.; };
+    std::vector<std::string> lines;
+    lines.push_back(fmt::format("Universe: {:.1f} KiB, {} entities ({} alive), {} pools", kib(census.TotalBytes()),
+                                census.entities, census.alive, census.pools.size()));
+
+    // Largest systems first
+    auto totals = census.SystemTotals();
+    std::vector<std::pair<std::string, size_t>> systems(totals.begin(), totals.end());
+    std::sort(systems.begin(), systems.end(), [](const auto& a, const auto& b) { return a.second > b.second; });
+    for (const auto& [system, bytes] : systems) {
+        lines.push_back(fmt::format("  {}: {:.1f} KiB", system, kib(bytes)));
+    }
+
+    for (size_t i = 0; i < std::min(pool_count, census.pools.size()); i++) {
+        const PoolCensus& pool = census.pools[i];
+        lines.push_back(fmt::format("  {} ({}): {}/{} components, {:.1f} KiB pool, {:.1f} KiB heap", pool.name,
+                                    pool.system, pool.size, pool.capacity, kib(pool.pool_bytes),
+                                    kib(pool.heap_bytes)));
+    }
+    return lines;
+}
+}  // namespace cqsp::common::util
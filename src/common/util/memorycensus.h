@@ -0,0 +1,73 @@
+/* Conquer Space
+ * Copyright (C) 2021-2023 Conquer Space
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "common/universe.h"
+
+namespace cqsp::common::util {
+/// <summary>
+/// Memory used by the pool of one component type.
+/// </summary>
+struct PoolCensus {
+    std::string name;
+    /// The part of the game the component belongs to, such as economy or science
+    std::string system;
+    size_t size = 0;
+    size_t capacity = 0;
+    /// Memory of the pool itself, the packed components and the sparse set indexing them
+    size_t pool_bytes = 0;
+    /// Estimated memory the components own on the heap, such as the nodes of the maps inside them
+    size_t heap_bytes = 0;
+
+    size_t TotalBytes() const { return pool_bytes + heap_bytes; }
+};
+
+/// <summary>
+/// Snapshot of how much memory the universe registry uses.
+/// </summary>
+struct MemoryCensus {
+    size_t entities = 0;
+    size_t alive = 0;
+    /// Memory of the entity list itself
+    size_t entity_bytes = 0;
+    /// Ordered from the largest to the smallest
+    std::vector<PoolCensus> pools;
+
+    size_t TotalBytes() const;
+    /// Total memory of the pools of every system, by system name
+    std::map<std::string, size_t> SystemTotals() const;
+};
+
+/// <summary>
+/// Measures every component pool in the universe.
+/// </summary>
+/// Components that the census knows about are reported with their payload and heap memory. Pools of
+/// other components are reported under the `other` system, with only the memory of their entity
+/// arrays, since the size of the component isn't known.
+/// This walks every component with containers inside, so it isn't meant to be run every tick.
+MemoryCensus TakeMemoryCensus(Universe& universe);
+
+/// <summary>
+/// Writes the census as lines of text, for the debug console and the log.
+/// </summary>
+/// <param name="pool_count">Number of the largest pools to list</param>
+std::vector<std::string> FormatMemoryCensus(const MemoryCensus& census, size_t pool_count = 10);
+}  // namespace cqsp::common::util
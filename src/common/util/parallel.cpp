@@ -0,0 +1,142 @@
+/* Conquer Space
+ * Copyright (C) 2021-2023 Conquer Space
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "common/util/parallel.h"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <memory>
+#include <utility>
+
+namespace cqsp::common::util {
+namespace {
+thread_local bool is_worker = false;
+
+// Chunks of one loop, that the pool and the calling thread take in turns
+struct ParallelJob {
+    const std::function<void(size_t, size_t)>* function;
+    size_t count;
+    size_t chunk;
+    size_t chunks;
+    std::atomic<size_t> next {0};
+
+    std::mutex mutex;
+    std::condition_variable finished;
+    size_t done = 0;
+    std::exception_ptr error;
+
+    // Runs chunks until there are none left
+    void Run() {
+        for (size_t index = next++; index < chunks; index = next++) {
+            size_t begin = index * chunk;
+            try {
+                (*function)(begin, std::min(begin + chunk, count));
+            } catch (...) {
+                std::lock_guard lock(mutex);
+                if (!error) {
+                    error = std::current_exception();
+                }
+            }
+            std::lock_guard lock(mutex);
+            if (++done == chunks) {
+                finished.notify_all();
+            }
+        }
+    }
+};
+}  // namespace
+
+ThreadPool::ThreadPool(size_t threads) {
+    workers.reserve(threads);
+    for (size_t i = 0; i < threads; i++) {
+        workers.emplace_back(&ThreadPool::Work, this);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard lock(mutex);
+        stopping = true;
+    }
+    available.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+ThreadPool& ThreadPool::Get() {
+    static ThreadPool pool(std::max(1u, std::thread::hardware_concurrency()) - 1);
+    return pool;
+}
+
+void ThreadPool::Submit(std::function<void()> task) {
+    {
+        std::lock_guard lock(mutex);
+        tasks.push_back(std::move(task));
+    }
+    available.notify_one();
+}
+
+bool ThreadPool::InWorker() { return is_worker; }
+
+void ThreadPool::Work() {
+    is_worker = true;
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock lock(mutex);
+            available.wait(lock, [this]() { return stopping || !tasks.empty(); });
+            if (tasks.empty()) {
+                return;
+            }
+            task = std::move(tasks.front());
+            tasks.pop_front();
+        }
+        task();
+    }
+}
+
+void ParallelFor(size_t count, size_t min_parallel, const std::function<void(size_t, size_t)>& function,
+                 size_t grain) {
+    if (count == 0) {
+        return;
+    }
+    ThreadPool& pool = ThreadPool::Get();
+    if (count < min_parallel || pool.size() == 0 || ThreadPool::InWorker()) {
+        function(0, count);
+        return;
+    }
+    grain = std::max<size_t>(grain, 1);
+    const size_t threads = pool.size() + 1;
+    auto job = std::make_shared<ParallelJob>();
+    job->function = &function;
+    job->count = count;
+    job->chunk = ((count + threads - 1) / threads + grain - 1) / grain * grain;
+    job->chunks = (count + job->chunk - 1) / job->chunk;
+    // Helpers that start after every chunk is taken return straight away, the job is kept alive for them
+    for (size_t i = 1; i < job->chunks; i++) {
+        pool.Submit([job]() { job->Run(); });
+    }
+    job->Run();
+
+    std::unique_lock lock(job->mutex);
+    job->finished.wait(lock, [&job]() { return job->done == job->chunks; });
+    if (job->error) {
+        std::rethrow_exception(job->error);
+    }
+}
+}  // namespace cqsp::common::util
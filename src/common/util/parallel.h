@@ -0,0 +1,71 @@
+/* Conquer Space
+ * Copyright (C) 2021-2023 Conquer Space
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace cqsp::common::util {
+/// <summary>
+/// Worker threads that are started once and take tasks from a shared queue.
+/// </summary>
+class ThreadPool {
+ public:
+    explicit ThreadPool(size_t threads);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /// <summary>
+    /// Pool that `ParallelFor` runs on, with one thread less than the hardware has, because the thread that
+    /// calls `ParallelFor` works too.
+    /// </summary>
+    static ThreadPool& Get();
+
+    void Submit(std::function<void()> task);
+
+    size_t size() const { return workers.size(); }
+
+    /// Whether the calling thread is a worker of any pool
+    static bool InWorker();
+
+ private:
+    void Work();
+
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> tasks;
+    std::mutex mutex;
+    std::condition_variable available;
+    bool stopping = false;
+};
+
+/// <summary>
+/// Calls `function(begin, end)` over chunks that cover [0, count), on the calling thread and the shared pool.
+/// </summary>
+/// Everything runs on the calling thread if there are fewer than `min_parallel` elements, or if it is called from
+/// a pool worker, so nested loops don't wait on the pool they run on. The calling thread takes chunks as well, so
+/// the loop finishes even when the pool is busy with other loops. Chunk sizes are a multiple of `grain`. The first
+/// exception that a chunk throws is rethrown once every chunk has finished.
+void ParallelFor(size_t count, size_t min_parallel, const std::function<void(size_t, size_t)>& function,
+                 size_t grain = 1);
+}  // namespace cqsp::common::util
@@ -19,4 +19,4 @@
 #include <spdlog/spdlog.h>
 
 // Define the thing
-std::map<std::string, int> profiler_information_map;
+thread_local std::map<std::string, int> profiler_information_map;
@@ -20,7 +20,9 @@
 #include <map>
 #include <string>
 
-extern std::map<std::string, int> profiler_information_map;
+/// Microseconds that the last run of each timed block took on this thread. Forecasts run the simulation on
+/// their own threads, so every thread keeps its own times, and the debug window shows the ones of the game.
+extern thread_local std::map<std::string, int> profiler_information_map;
 #define BEGIN_TIMED_BLOCK(NAME) \
     std::chrono::high_resolution_clock::time_point block_start_##NAME = std::chrono::high_resolution_clock::now();
 
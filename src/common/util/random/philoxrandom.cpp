@@ -0,0 +1,131 @@
+/* Conquer Space
+ * Copyright (C) 2021-2023 Conquer Space
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "common/util/random/philoxrandom.h"
+
+#include <cmath>
+#include <limits>
+#include <numbers>
+
+namespace cqsp::common::util {
+namespace {
+constexpr uint32_t philox_m0 = 0xD2511F53;
+constexpr uint32_t philox_m1 = 0xCD9E8D57;
+constexpr uint32_t philox_w0 = 0x9E3779B9;
+constexpr uint32_t philox_w1 = 0xBB67AE85;
+
+// 53 random bits as a double in [0, 1)
+double ToUnitDouble(uint64_t bits) { return static_cast<double>(bits >> 11) * 0x1.0p-53; }
+
+// Converts two uniform numbers into two normally distributed numbers with the Box-Muller transform
+void BoxMuller(uint64_t a, uint64_t b, double mean, double sd, double& first, double& second) {
+    // 1 - u is in (0, 1], so that the log is finite
+    double radius = std::sqrt(-2 * std::log(1 - ToUnitDouble(a))) * sd;
+    double angle = 2 * std::numbers::pi * ToUnitDouble(b);
+    first = mean + radius * std::cos(angle);
+    second = mean + radius * std::sin(angle);
+}
+}  // namespace
+
+std::array<uint32_t, 4> Philox4x32(std::array<uint32_t, 4> counter, std::array<uint32_t, 2> key) {
+    for (int round = 0; round < 10; round++) {
+        uint64_t product0 = static_cast<uint64_t>(philox_m0) * counter[0];
+        uint64_t product1 = static_cast<uint64_t>(philox_m1) * counter[2];
+        counter = {static_cast<uint32_t>(product1 >> 32) ^ counter[1] ^ key[0], static_cast<uint32_t>(product1),
+                   static_cast<uint32_t>(product0 >> 32) ^ counter[3] ^ key[1], static_cast<uint32_t>(product0)};
+        key[0] += philox_w0;
+        key[1] += philox_w1;
+    }
+    return counter;
+}
+
+PhiloxRandom::PhiloxRandom(int _seed, uint32_t system, uint32_t entity, uint64_t tick)
+    : IRandom(_seed),
+      key {static_cast<uint32_t>(_seed), system},
+      counter {0, entity, static_cast<uint32_t>(tick), static_cast<uint32_t>(tick >> 32)} {}
+
+std::array<uint32_t, 4> PhiloxRandom::NextBlock() {
+    std::array<uint32_t, 4> result = Philox4x32(counter, key);
+    counter[0]++;
+    return result;
+}
+
+uint32_t PhiloxRandom::NextUInt32() {
+    if (used == 4) {
+        block = NextBlock();
+        used = 0;
+    }
+    return block[used++];
+}
+
+uint64_t PhiloxRandom::NextUInt64() {
+    uint64_t high = NextUInt32();
+    return (high << 32) | NextUInt32();
+}
+
+double PhiloxRandom::NextDouble() { return ToUnitDouble(NextUInt64()); }
+
+int PhiloxRandom::GetRandomInt(int min, int max) {
+    uint64_t range = static_cast<uint64_t>(static_cast<int64_t>(max) - min) + 1;
+    // Reject the top of the range that doesn't divide evenly, so that every number is equally likely
+    uint64_t limit = std::numeric_limits<uint64_t>::max() - std::numeric_limits<uint64_t>::max() % range;
+    uint64_t value;
+    do {
+        value = NextUInt64();
+    } while (value >= limit);
+    return static_cast<int>(min + static_cast<int64_t>(value % range));
+}
+
+int PhiloxRandom::GetRandomNormal(double mean, double sd) {
+    double first, second;
+    BoxMuller(NextUInt64(), NextUInt64(), mean, sd, first, second);
+    return static_cast<int>(std::round(first));
+}
+
+std::unique_ptr<IRandom> PhiloxRandom::Split(uint32_t system, uint32_t entity, uint64_t tick) {
+    return std::make_unique<PhiloxRandom>(Stream(system, entity, tick));
+}
+
+PhiloxRandom PhiloxRandom::Stream(uint32_t system, uint32_t entity, uint64_t tick) const {
+    return PhiloxRandom(seed, system, entity, tick);
+}
+
+void PhiloxRandom::FillUniform(std::span<double> out) {
+    // Whole blocks are two doubles each, and don't depend on each other so the loop can be vectorized
+    size_t i = 0;
+    for (; i + 2 <= out.size(); i += 2) {
+        std::array<uint32_t, 4> bits = NextBlock();
+        out[i] = ToUnitDouble((static_cast<uint64_t>(bits[0]) << 32) | bits[1]);
+        out[i + 1] = ToUnitDouble((static_cast<uint64_t>(bits[2]) << 32) | bits[3]);
+    }
+    for (; i < out.size(); i++) {
+        out[i] = NextDouble();
+    }
+}
+
+void PhiloxRandom::FillNormal(std::span<double> out, double mean, double sd) {
+    size_t i = 0;
+    for (; i + 2 <= out.size(); i += 2) {
+        std::array<uint32_t, 4> bits = NextBlock();
+        BoxMuller((static_cast<uint64_t>(bits[0]) << 32) | bits[1], (static_cast<uint64_t>(bits[2]) << 32) | bits[3],
+                  mean, sd, out[i], out[i + 1]);
+    }
+    if (i < out.size()) {
+        double unused;
+        BoxMuller(NextUInt64(), NextUInt64(), mean, sd, out[i], unused);
+    }
+}
+}  // namespace cqsp::common::util
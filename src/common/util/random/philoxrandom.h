@@ -0,0 +1,72 @@
+/* Conquer Space
+ * Copyright (C) 2021-2023 Conquer Space
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <span>
+
+#include "common/util/random/random.h"
+
+namespace cqsp::common::util {
+/// <summary>
+/// Philox4x32-10 block function, from Salmon et al., "Parallel Random Numbers: As Easy as 1, 2, 3".
+/// </summary>
+/// Scrambles a 128 bit counter with a 64 bit key into 128 random bits. Every output only depends on
+/// its counter and key, so any block can be computed without computing the ones before it.
+std::array<uint32_t, 4> Philox4x32(std::array<uint32_t, 4> counter, std::array<uint32_t, 2> key);
+
+/// <summary>
+/// Counter based random number generator.
+/// </summary>
+/// The key is the seed and the system, and the counter is made of the entity, the tick and the number of
+/// blocks drawn so far. That makes every (system, entity, tick) stream independent of each other, and of
+/// the order they are used in.
+class PhiloxRandom : public IRandom {
+ public:
+    explicit PhiloxRandom(int _seed) : PhiloxRandom(_seed, 0, 0, 0) {}
+    PhiloxRandom(int _seed, uint32_t system, uint32_t entity, uint64_t tick);
+
+    int GetRandomInt(int min, int max) override;
+    int GetRandomNormal(double mean, double sd) override;
+
+    std::unique_ptr<IRandom> Split(uint32_t system, uint32_t entity, uint64_t tick) override;
+    /// <summary>
+    /// Same as `Split`, without the allocation.
+    /// </summary>
+    PhiloxRandom Stream(uint32_t system, uint32_t entity, uint64_t tick) const;
+
+    void FillUniform(std::span<double> out) override;
+    void FillNormal(std::span<double> out, double mean, double sd) override;
+
+    uint32_t NextUInt32();
+    uint64_t NextUInt64();
+    /// Uniform number in [0, 1)
+    double NextDouble();
+
+ private:
+    std::array<uint32_t, 4> NextBlock();
+
+    std::array<uint32_t, 2> key;
+    // The first word is the block index, the rest is the entity and the tick
+    std::array<uint32_t, 4> counter;
+    std::array<uint32_t, 4> block;
+    // Number of words of `block` that have been used
+    int used = 4;
+};
+}  // namespace cqsp::common::util
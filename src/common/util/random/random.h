@@ -16,6 +16,10 @@
  */
 #pragma once
 
+#include <cstdint>
+#include <memory>
+#include <span>
+
 namespace cqsp::common::util {
 class IRandom {
  public:
@@ -24,7 +28,37 @@ class IRandom {
     virtual int GetRandomInt(int, int) = 0;
     virtual int GetRandomNormal(double, double) = 0;
 
+    /// <summary>
+    /// Makes a generator for one system working on one entity during one tick.
+    /// </summary>
+    /// The stream only depends on the seed and the three keys, not on how much has been drawn from this
+    /// generator, so work can be split between threads and still get the same numbers.
+    /// <param name="system">Id of the system, see `RandomStreamId`</param>
+    virtual std::unique_ptr<IRandom> Split(uint32_t system, uint32_t entity, uint64_t tick) = 0;
+
+    /// <summary>
+    /// Fills `out` with uniformly distributed numbers in [0, 1)
+    /// </summary>
+    virtual void FillUniform(std::span<double> out) = 0;
+
+    /// <summary>
+    /// Fills `out` with normally distributed numbers
+    /// </summary>
+    virtual void FillNormal(std::span<double> out, double mean, double sd) = 0;
+
  protected:
     int seed;
 };
+
+/// <summary>
+/// Turns the name of a system into an id for `IRandom::Split`.
+/// </summary>
+constexpr uint32_t RandomStreamId(const char* name) {
+    // FNV-1a
+    uint32_t hash = 2166136261u;
+    for (; *name != '\0'; name++) {
+        hash = (hash ^ static_cast<uint8_t>(*name)) * 16777619u;
+    }
+    return hash;
+}
 }  // namespace cqsp::common::util
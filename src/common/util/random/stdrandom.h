@@ -16,6 +16,7 @@
  */
 #pragma once
 
+#include <memory>
 #include <random>
 
 #include "common/util/random/random.h"
@@ -25,16 +26,38 @@ class StdRandom : public IRandom {
  public:
     explicit StdRandom(int _seed) : IRandom(_seed), random_gen(_seed) {}
 
-    int GetRandomInt(int min, int max) {
+    int GetRandomInt(int min, int max) override {
         std::uniform_int_distribution<> dist(min, max);
         return dist(random_gen);
     }
 
-    int GetRandomNormal(double mean, double sd) {
+    int GetRandomNormal(double mean, double sd) override {
         std::normal_distribution<> norm {mean, sd};
         return static_cast<int>(round(norm(random_gen)));
     }
 
+    std::unique_ptr<IRandom> Split(uint32_t system, uint32_t entity, uint64_t tick) override {
+        std::seed_seq seq {static_cast<uint32_t>(seed), system, entity, static_cast<uint32_t>(tick),
+                           static_cast<uint32_t>(tick >> 32)};
+        uint32_t split_seed;
+        seq.generate(&split_seed, &split_seed + 1);
+        return std::make_unique<StdRandom>(static_cast<int>(split_seed));
+    }
+
+    void FillUniform(std::span<double> out) override {
+        std::uniform_real_distribution<> dist(0, 1);
+        for (double& value : out) {
+            value = dist(random_gen);
+        }
+    }
+
+    void FillNormal(std::span<double> out, double mean, double sd) override {
+        std::normal_distribution<> norm {mean, sd};
+        for (double& value : out) {
+            value = norm(random_gen);
+        }
+    }
+
  private:
     std::mt19937 random_gen;
 };
@@ -0,0 +1,271 @@
+/* Conquer Space
+ * Copyright (C) 2021-2023 Conquer Space
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "common/util/statedigest.h"
+
+#include <fmt/format.h>
+
+#include <bit>
+#include <istream>
+#include <ostream>
+
+#include <tracy/Tracy.hpp>
+
+#include "common/components/coordinates.h"
+#include "common/components/economy.h"
+#include "common/components/orbit.h"
+#include "common/components/population.h"
+#include "common/components/resource.h"
+
+namespace cqsp::common::util {
+namespace {
+namespace cqspc = cqsp::common::components;
+namespace cqspt = cqsp::common::components::types;
+
+// splitmix64 finalizer
+uint64_t Mix(uint64_t value) {
+    value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9;
+    value = (value ^ (value >> 27)) * 0x94d049bb133111eb;
+    return value ^ (value >> 31);
+}
+
+uint64_t HashName(const std::string& name) {
+    DigestHasher hasher;
+    for (char c : name) {
+        hasher.Add(static_cast<uint64_t>(static_cast<unsigned char>(c)));
+    }
+    return hasher.Get();
+}
+
+void HashMarket(DigestHasher& hasher, const cqspc::Market& market) {
+    for (const cqspc::ResourceLedger* ledger :
+         {&market.demand, &market.sd_ratio, &market.ds_ratio, &market.supply, &market.volume, &market.price,
+          &market.previous_demand, &market.previous_supply, &market.latent_supply, &market.last_latent_demand,
+          &market.latent_demand}) {
+        hasher.Add(*ledger);
+    }
+    // The history is copied from the values above, so its length is enough to catch a missed tick
+    hasher.Add(static_cast<uint64_t>(market.history.size()));
+    hasher.Add(market.GDP);
+}
+
+void HashWallet(DigestHasher& hasher, const cqspc::Wallet& wallet) { hasher.Add(wallet.GetBalance()); }
+
+void HashIndustrySize(DigestHasher& hasher, const cqspc::IndustrySize& size) {
+    hasher.Add(size.size);
+    hasher.Add(size.utilization);
+    hasher.Add(size.wages);
+}
+
+void HashPopulationSegment(DigestHasher& hasher, const cqspc::PopulationSegment& segment) {
+    hasher.Add(segment.population);
+    hasher.Add(segment.labor_force);
+}
+
+void HashStockpile(DigestHasher& hasher, const cqspc::ResourceStockpile& ledger) { hasher.Add(ledger); }
+void HashConsumption(DigestHasher& hasher, const cqspc::ResourceConsumption& ledger) { hasher.Add(ledger); }
+void HashCostTable(DigestHasher& hasher, const cqspc::CostTable& ledger) { hasher.Add(ledger); }
+
+void HashOrbit(DigestHasher& hasher, const cqspt::Orbit& orbit) {
+    for (double value : {orbit.eccentricity, orbit.semi_major_axis, orbit.inclination, orbit.LAN, orbit.w,
+                         orbit.M0, orbit.epoch, orbit.v, orbit.T, orbit.nu, orbit.GM}) {
+        hasher.Add(value);
+    }
+    hasher.Add(orbit.reference_body);
+}
+
+void HashKinematics(DigestHasher& hasher, const cqspt::Kinematics& kinematics) {
+    for (int i = 0; i < 3; i++) {
+        hasher.Add(kinematics.position[i]);
+        hasher.Add(kinematics.velocity[i]);
+        hasher.Add(kinematics.center[i]);
+    }
+}
+}  // namespace
+
+void DigestHasher::Add(uint64_t value) { state = Mix(state ^ Mix(value)); }
+
+void DigestHasher::Add(double value) {
+    // Both zeros are the same number
+    Add(value == 0 ? uint64_t {0} : std::bit_cast<uint64_t>(value));
+}
+
+void DigestHasher::Add(const components::ResourceLedger& ledger) {
+    // Ledgers are ordered by good, so two equal ledgers are hashed in the same order
+    Add(static_cast<uint64_t>(ledger.size()));
+    for (auto it = ledger.cbegin(); it != ledger.cend(); it++) {
+        Add(it->first);
+        Add(it->second);
+    }
+}
+
+StateDigest::StateDigest(Universe& universe) : universe(universe) {
+    Track<cqspc::Market>("Market", HashMarket);
+    Track<cqspc::IndustrySize>("IndustrySize", HashIndustrySize);
+    Track<cqspc::PopulationSegment>("PopulationSegment", HashPopulationSegment);
+    Track<cqspc::ResourceConsumption>("ResourceConsumption", HashConsumption);
+    Track<cqspc::CostTable>("CostTable", HashCostTable);
+    // Wallets and stockpiles are changed by every trade, from too many places to patch each of them
+    Track<cqspc::Wallet>("Wallet", HashWallet, true);
+    Track<cqspc::ResourceStockpile>("ResourceStockpile", HashStockpile, true);
+    // Every body moves every tick, so there's nothing to skip
+    Track<cqspt::Orbit>("Orbit", HashOrbit, true);
+    Track<cqspt::Kinematics>("Kinematics", HashKinematics, true);
+    Update();
+}
+
+StateDigest::~StateDigest() {
+    for (auto& pool : pools) {
+        pool->disconnect(*pool);
+    }
+}
+
+void StateDigest::Pool::Rehash(entt::entity entity) {
+    auto it = hashes.find(entity);
+    if (it != hashes.end()) {
+        digest -= it->second;
+        hashes.erase(it);
+    }
+    if (!contains(entity)) {
+        return;
+    }
+    DigestHasher hasher;
+    hasher.Add(entity);
+    hash(hasher, entity);
+    uint64_t value = Mix(hasher.Get());
+    hashes[entity] = value;
+    digest += value;
+}
+
+void StateDigest::Update() {
+    ZoneScoped;
+    std::vector<entt::entity> entities;
+    for (auto& pool : pools) {
+        // Removed components are only in the dirty list
+        for (entt::entity entity : pool->dirty) {
+            pool->Rehash(entity);
+        }
+        pool->dirty.clear();
+        if (pool->written_in_place) {
+            entities.clear();
+            pool->entities(entities);
+            for (entt::entity entity : entities) {
+                pool->Rehash(entity);
+            }
+        }
+    }
+}
+
+void StateDigest::Rehash() {
+    std::vector<entt::entity> entities;
+    for (auto& pool : pools) {
+        pool->hashes.clear();
+        pool->dirty.clear();
+        pool->digest = 0;
+        entities.clear();
+        pool->entities(entities);
+        for (entt::entity entity : entities) {
+            pool->Rehash(entity);
+        }
+    }
+}
+
+uint64_t StateDigest::Get() const {
+    uint64_t digest = 0;
+    for (const auto& pool : pools) {
+        digest += Mix(HashName(pool->name) ^ pool->digest);
+    }
+    return digest;
+}
+
+DigestSnapshot StateDigest::Snapshot() const {
+    DigestSnapshot snapshot;
+    for (const auto& pool : pools) {
+        // Empty pools are left out, the same as in a written snapshot
+        if (pool->hashes.empty()) {
+            continue;
+        }
+        snapshot[pool->name].insert(pool->hashes.begin(), pool->hashes.end());
+    }
+    return snapshot;
+}
+
+std::string Divergence::ToString() const {
+    switch (kind) {
+        case Kind::OnlyInFirst:
+            return fmt::format("{} of entity {} is only in the first run", component, entt::to_integral(entity));
+        case Kind::OnlyInSecond:
+            return fmt::format("{} of entity {} is only in the second run", component, entt::to_integral(entity));
+        default:
+            return fmt::format("{} of entity {} is different", component, entt::to_integral(entity));
+    }
+}
+
+std::optional<Divergence> FindDivergence(const DigestSnapshot& first, const DigestSnapshot& second) {
+    static const std::map<entt::entity, uint64_t> empty;
+    auto first_pool = first.begin();
+    auto second_pool = second.begin();
+    while (first_pool != first.end() || second_pool != second.end()) {
+        // A pool that one of the runs doesn't track is compared as an empty pool
+        const std::string& name = (second_pool == second.end() ||
+                                   (first_pool != first.end() && first_pool->first < second_pool->first))
+                                      ? first_pool->first
+                                      : second_pool->first;
+        bool in_first = first_pool != first.end() && first_pool->first == name;
+        bool in_second = second_pool != second.end() && second_pool->first == name;
+        const auto& a = in_first ? first_pool->second : empty;
+        const auto& b = in_second ? second_pool->second : empty;
+
+        auto it_a = a.begin();
+        auto it_b = b.begin();
+        while (it_a != a.end() || it_b != b.end()) {
+            if (it_b == b.end() || (it_a != a.end() && it_a->first < it_b->first)) {
+                return Divergence {name, it_a->first, Divergence::Kind::OnlyInFirst};
+            }
+            if (it_a == a.end() || it_b->first < it_a->first) {
+                return Divergence {name, it_b->first, Divergence::Kind::OnlyInSecond};
+            }
+            if (it_a->second != it_b->second) {
+                return Divergence {name, it_a->first, Divergence::Kind::Different};
+            }
+            ++it_a;
+            ++it_b;
+        }
+        if (in_first) ++first_pool;
+        if (in_second) ++second_pool;
+    }
+    return std::nullopt;
+}
+
+void WriteDigestSnapshot(std::ostream& stream, const DigestSnapshot& snapshot) {
+    for (const auto& [name, hashes] : snapshot) {
+        for (const auto& [entity, hash] : hashes) {
+            stream << name << ' ' << entt::to_integral(entity) << ' ' << hash << '\n';
+        }
+    }
+}
+
+DigestSnapshot ReadDigestSnapshot(std::istream& stream) {
+    DigestSnapshot snapshot;
+    std::string name;
+    entt::id_type entity;
+    uint64_t hash;
+    while (stream >> name >> entity >> hash) {
+        snapshot[name][static_cast<entt::entity>(entity)] = hash;
+    }
+    return snapshot;
+}
+}  // namespace cqsp::common::util
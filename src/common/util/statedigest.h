@@ -0,0 +1,167 @@
+/* Conquer Space
+ * Copyright (C) 2021-2023 Conquer Space
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <iosfwd>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "common/components/resource.h"
+#include "common/universe.h"
+
+namespace cqsp::common::util {
+/// <summary>
+/// Hashes the fields of a component.
+/// </summary>
+class DigestHasher {
+ public:
+    void Add(uint64_t value);
+    void Add(double value);
+    void Add(entt::entity entity) { Add(static_cast<uint64_t>(entt::to_integral(entity))); }
+    void Add(const components::ResourceLedger& ledger);
+
+    uint64_t Get() const { return state; }
+
+ private:
+    uint64_t state = 0x6a09e667f3bcc909;
+};
+
+/// <summary>
+/// Hash of every tracked component, by component name and entity.
+/// </summary>
+using DigestSnapshot = std::map<std::string, std::map<entt::entity, uint64_t>>;
+
+/// <summary>
+/// Running hash of the state of the universe, to check that two runs of the simulation are the same.
+/// </summary>
+/// The hash of every tracked component is cached per entity, and the digest is the sum of them, so a
+/// change to one component only needs that component to be hashed again. Components that are added,
+/// patched, replaced or removed are picked up through the signals of the registry, so systems that change a
+/// tracked component through a reference get it with `patch` instead of `get`, which marks it as changed.
+/// Components that are written in too many places for that, or that change on every entity every tick, are
+/// tracked as written in place, and are hashed again on every update.
+class StateDigest {
+ public:
+    using HashFunction = std::function<void(DigestHasher&, entt::entity)>;
+
+    /// <summary>
+    /// Tracks the components that the simulation changes, such as markets, wallets and orbits.
+    /// </summary>
+    explicit StateDigest(Universe& universe);
+    ~StateDigest();
+    StateDigest(const StateDigest&) = delete;
+    StateDigest& operator=(const StateDigest&) = delete;
+
+    template <typename T>
+    void Track(const std::string& name, void (*hash)(DigestHasher&, const T&), bool written_in_place = false) {
+        auto pool = std::make_unique<Pool>();
+        pool->name = name;
+        pool->written_in_place = written_in_place;
+        pool->hash = [this, hash](DigestHasher& hasher, entt::entity entity) {
+            hash(hasher, universe.get<T>(entity));
+        };
+        pool->contains = [this](entt::entity entity) { return universe.valid(entity) && universe.all_of<T>(entity); };
+        pool->entities = [this](std::vector<entt::entity>& out) {
+            for (entt::entity entity : universe.view<T>()) {
+                out.push_back(entity);
+            }
+        };
+        universe.on_construct<T>().template connect<&Pool::OnChange>(*pool);
+        universe.on_update<T>().template connect<&Pool::OnChange>(*pool);
+        universe.on_destroy<T>().template connect<&Pool::OnChange>(*pool);
+        pool->disconnect = [this](Pool& self) {
+            universe.on_construct<T>().disconnect(self);
+            universe.on_update<T>().disconnect(self);
+            universe.on_destroy<T>().disconnect(self);
+        };
+        // Components that are already there
+        std::vector<entt::entity> existing;
+        pool->entities(existing);
+        pool->dirty.insert(existing.begin(), existing.end());
+        pools.push_back(std::move(pool));
+    }
+
+    /// <summary>
+    /// Hashes the components that changed since the last update.
+    /// </summary>
+    void Update();
+
+    /// <summary>
+    /// Hashes every tracked component again.
+    /// </summary>
+    void Rehash();
+
+    /// Digest as of the last update
+    uint64_t Get() const;
+
+    DigestSnapshot Snapshot() const;
+
+ private:
+    struct Pool {
+        std::string name;
+        bool written_in_place;
+        HashFunction hash;
+        std::function<bool(entt::entity)> contains;
+        std::function<void(std::vector<entt::entity>&)> entities;
+        std::function<void(Pool&)> disconnect;
+
+        std::unordered_map<entt::entity, uint64_t> hashes;
+        std::unordered_set<entt::entity> dirty;
+        uint64_t digest = 0;
+
+        void OnChange(entt::registry&, entt::entity entity) { dirty.insert(entity); }
+        void Rehash(entt::entity entity);
+    };
+
+    Universe& universe;
+    std::vector<std::unique_ptr<Pool>> pools;
+};
+
+/// <summary>
+/// First difference between two runs.
+/// </summary>
+struct Divergence {
+    std::string component;
+    entt::entity entity = entt::null;
+    enum class Kind {
+        /// Both runs have the component but it's different
+        Different,
+        /// Only the first run has the component
+        OnlyInFirst,
+        /// Only the second run has the component
+        OnlyInSecond,
+    } kind = Kind::Different;
+
+    std::string ToString() const;
+};
+
+/// <summary>
+/// Finds the first component that differs between two snapshots, in order of component name and then entity.
+/// </summary>
+std::optional<Divergence> FindDivergence(const DigestSnapshot& first, const DigestSnapshot& second);
+
+/// Writes the snapshot as text, so that runs in different processes can be compared
+void WriteDigestSnapshot(std::ostream& stream, const DigestSnapshot& snapshot);
+DigestSnapshot ReadDigestSnapshot(std::istream& stream);
+}  // namespace cqsp::common::util
@@ -0,0 +1,70 @@
+/* Conquer Space
+ * Copyright (C) 2021-2023 Conquer Space
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "common/util/tickarena.h"
+
+namespace cqsp::common::util {
+TickArena::TickArena(size_t initial_size) : buffer(initial_size) {
+    arena.emplace(buffer.data(), buffer.size(), &overflow);
+}
+
+void TickArena::Reset() {
+    if (overflow.allocated == 0) {
+        arena->release();
+        return;
+    }
+    // Grow so that everything this tick used fits in the buffer, with some room to spare
+    size_t size = (buffer.size() + overflow.allocated) * 3 / 2;
+    arena.reset();
+    overflow.allocated = 0;
+    buffer = std::vector<std::byte>(size);
+    arena.emplace(buffer.data(), buffer.size(), &overflow);
+}
+
+void* TickArena::OverflowResource::do_allocate(size_t bytes, size_t alignment) {
+    allocated += bytes;
+    return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+}
+
+void TickArena::OverflowResource::do_deallocate(void* p, size_t bytes, size_t alignment) {
+    std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+}
+
+TickArena& TickArenas::Local() {
+    std::scoped_lock lock(mutex);
+    auto& arena = arenas[std::this_thread::get_id()];
+    if (!arena) {
+        arena = std::make_unique<TickArena>();
+    }
+    return *arena;
+}
+
+void TickArenas::Reset() {
+    std::scoped_lock lock(mutex);
+    for (auto& [thread, arena] : arenas) {
+        arena->Reset();
+    }
+}
+
+size_t TickArenas::GetCapacity() {
+    std::scoped_lock lock(mutex);
+    size_t capacity = 0;
+    for (auto& [thread, arena] : arenas) {
+        capacity += arena->GetCapacity();
+    }
+    return capacity;
+}
+}  // namespace cqsp::common::util
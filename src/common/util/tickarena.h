@@ -0,0 +1,91 @@
+/* Conquer Space
+ * Copyright (C) 2021-2023 Conquer Space
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace cqsp::common::util {
+/// <summary>
+/// Monotonic memory for data that only lives for one tick.
+/// </summary>
+/// Allocations bump a pointer into one buffer, freeing does nothing, and everything is released at
+/// once by `Reset`. If a tick needs more memory than the buffer has, the extra memory comes from the
+/// heap, and the buffer grows on the next reset so that following ticks fit in it again.
+/// Containers that use the arena must be destroyed before the arena is reset.
+class TickArena {
+ public:
+    explicit TickArena(size_t initial_size = 64 * 1024);
+
+    std::pmr::memory_resource* GetResource() { return &*arena; }
+
+    /// <summary>
+    /// Frees everything allocated from the arena.
+    /// </summary>
+    void Reset();
+
+    /// Size of the buffer that allocations are made in before going to the heap
+    size_t GetCapacity() const { return buffer.size(); }
+    /// Memory taken from the heap since the last reset, because the buffer was full
+    size_t GetOverflow() const { return overflow.allocated; }
+
+ private:
+    /// Upstream of the arena, that counts how much the arena has taken from the heap
+    class OverflowResource : public std::pmr::memory_resource {
+     public:
+        size_t allocated = 0;
+
+     private:
+        void* do_allocate(size_t bytes, size_t alignment) override;
+        void do_deallocate(void* p, size_t bytes, size_t alignment) override;
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+    };
+
+    std::vector<std::byte> buffer;
+    OverflowResource overflow;
+    // Rebuilt when the buffer grows, monotonic_buffer_resource can't be moved
+    std::optional<std::pmr::monotonic_buffer_resource> arena;
+};
+
+/// <summary>
+/// One tick arena for each thread that runs simulation systems.
+/// </summary>
+class TickArenas {
+ public:
+    /// <summary>
+    /// Gets the arena of the calling thread, creating it the first time.
+    /// </summary>
+    TickArena& Local();
+
+    /// <summary>
+    /// Resets every arena. No system can be running while this is called.
+    /// </summary>
+    void Reset();
+
+    size_t GetCapacity();
+
+ private:
+    std::mutex mutex;
+    std::unordered_map<std::thread::id, std::unique_ptr<TickArena>> arenas;
+};
+}  // namespace cqsp::common::util
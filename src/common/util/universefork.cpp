@@ -0,0 +1,282 @@
+/* Conquer Space
+ * Copyright (C) 2021-2023 Conquer Space
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "common/util/universefork.h"
+
+#include <spdlog/spdlog.h>
+
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+
+#include <tracy/Tracy.hpp>
+
+#include "common/components/area.h"
+#include "common/components/auction.h"
+#include "common/components/bodies.h"
+#include "common/components/coordinates.h"
+#include "common/components/economy.h"
+#include "common/components/history.h"
+#include "common/components/infrastructure.h"
+#include "common/components/lod.h"
+#include "common/components/name.h"
+#include "common/components/orbit.h"
+#include "common/components/organizations.h"
+#include "common/components/player.h"
+#include "common/components/population.h"
+#include "common/components/ports.h"
+#include "common/components/resource.h"
+#include "common/components/rollup.h"
+#include "common/components/science.h"
+#include "common/components/ships.h"
+#include "common/components/surface.h"
+
+namespace cqsp::common::util {
+namespace {
+namespace cqspc = cqsp::common::components;
+
+using CopyFunction = size_t (*)(Universe& source, Universe& fork);
+
+template <typename T>
+size_t CopyPool(Universe& source, Universe& fork) {
+    auto& pool = source.storage<T>();
+    const entt::sparse_set& entities = pool;
+    // The reverse iterators go through the packed array from the front, so the fork is packed the same way
+    if constexpr (std::is_empty_v<T>) {
+        fork.insert<T>(entities.rbegin(), entities.rend());
+    } else {
+        fork.insert<T>(entities.rbegin(), entities.rend(), pool.rbegin());
+    }
+    return entities.size();
+}
+
+// The simulation only looks at the last day of the history, and the connected markets can't be copied
+size_t CopyMarkets(Universe& source, Universe& fork) {
+    const entt::sparse_set& entities = source.storage<cqspc::Market>();
+    fork.storage<cqspc::Market>().reserve(entities.size());
+    for (auto it = entities.rbegin(); it != entities.rend(); it++) {
+        const cqspc::Market& market = source.get<cqspc::Market>(*it);
+        auto& copy = fork.emplace<cqspc::Market>(*it);
+        static_cast<cqspc::MarketInformation&>(copy) = market;
+        if (!market.history.empty()) {
+            copy.history.push_back(market.history.back());
+        }
+        copy.market_information = market.market_information;
+        copy.last_market_information = market.last_market_information;
+        copy.participants = market.participants;
+        for (entt::entity connected : market.connected_markets) {
+            copy.connected_markets.emplace(connected);
+        }
+        copy.GDP = market.GDP;
+    }
+    return entities.size();
+}
+
+template <typename T>
+std::pair<entt::id_type, CopyFunction> Copy() {
+    return {entt::type_hash<T>::value(), &CopyPool<T>};
+}
+
+template <typename T>
+std::pair<entt::id_type, CopyFunction> Skip() {
+    return {entt::type_hash<T>::value(), nullptr};
+}
+
+// Every component the simulation knows about. Skipped components are only read by the client or the loader.
+const std::unordered_map<entt::id_type, CopyFunction>& GetForkTypes() {
+    namespace cqspb = cqspc::bodies;
+    namespace cqspi = cqspc::infrastructure;
+    namespace cqsps = cqspc::science;
+    namespace cqspt = cqspc::types;
+    static const std::unordered_map<entt::id_type, CopyFunction> types = {
+        Copy<cqspc::Name>(),
+        Copy<cqspc::Identifier>(),
+        Skip<cqspc::Description>(),
+
+        {entt::type_hash<cqspc::Market>::value(), &CopyMarkets},
+        Skip<cqspc::MarketHistory>(),
+        Copy<cqspc::PlanetaryMarket>(),
+        Copy<cqspc::AuctionHouse>(),
+        Copy<cqspc::Wallet>(),
+        Copy<cqspc::Price>(),
+        Copy<cqspc::Currency>(),
+        Copy<cqspc::CostTable>(),
+        Copy<cqspc::MarketAgent>(),
+        Copy<cqspc::MarketCenter>(),
+        Copy<cqspc::InternationalPort>(),
+        Copy<cqspc::Commercial>(),
+        Copy<cqspc::Employer>(),
+        Copy<cqspc::LaborInformation>(),
+        Copy<cqspc::FactoryProducing>(),
+        Copy<cqspc::Owned>(),
+
+        Copy<cqspc::Matter>(),
+        Copy<cqspc::Energy>(),
+        Copy<cqspc::Unit>(),
+        Copy<cqspc::Good>(),
+        Copy<cqspc::ConsumerGood>(),
+        Copy<cqspc::Mineral>(),
+        Copy<cqspc::CapitalGood>(),
+        Copy<cqspc::Recipe>(),
+        Copy<cqspc::RecipeCost>(),
+        Copy<cqspc::IndustrySize>(),
+        Copy<cqspc::CostBreakdown>(),
+        Copy<cqspc::ResourceIO>(),
+        Copy<cqspc::FactoryTimer>(),
+        Copy<cqspc::ResourceConsumption>(),
+        Copy<cqspc::ResourceProduction>(),
+        Copy<cqspc::ResourceConverter>(),
+        Copy<cqspc::ResourceStockpile>(),
+        Copy<cqspc::FailedResourceTransfer>(),
+        Copy<cqspc::FailedResourceProduction>(),
+        Copy<cqspc::FailedResourceConsumption>(),
+        Copy<cqspc::ResourceDistribution>(),
+
+        Copy<cqspc::IndustrialZone>(),
+        Copy<cqspc::Production>(),
+        Copy<cqspc::Factory>(),
+        Copy<cqspc::Mine>(),
+        Copy<cqspc::Service>(),
+        Copy<cqspc::Farm>(),
+        Copy<cqspc::RawResourceGen>(),
+
+        Copy<cqspi::Infrastructure>(),
+        Copy<cqspi::CityInfrastructure>(),
+        Copy<cqspi::PowerPlant>(),
+        Copy<cqspi::PowerConsumption>(),
+        Copy<cqspi::CityPower>(),
+        Copy<cqspi::BrownOut>(),
+        Copy<cqspi::SpacePort>(),
+        Copy<cqspi::Highway>(),
+
+        Copy<cqsps::Field>(),
+        Copy<cqsps::Science>(),
+        Copy<cqsps::Lab>(),
+        Copy<cqsps::ScientificProgress>(),
+        Copy<cqsps::ScienceProject>(),
+        Copy<cqsps::ScientificResearch>(),
+        Copy<cqsps::TechnologicalProgress>(),
+        Copy<cqsps::Technology>(),
+
+        Copy<cqspc::PopulationSegment>(),
+        Copy<cqspc::Hunger>(),
+        Copy<cqspc::Settlement>(),
+        Copy<cqspc::Habitation>(),
+        Copy<cqspc::Surface>(),
+        Copy<cqspc::TimeZone>(),
+        Copy<cqspc::CityTimeZone>(),
+        Copy<cqspc::Province>(),
+        Copy<cqspc::ProvinceColor>(),
+        Copy<cqspc::CapitalCity>(),
+        Skip<cqspc::ProvincedPlanet>(),
+
+        Copy<cqspc::Governed>(),
+        Copy<cqspc::Organization>(),
+        Copy<cqspc::Country>(),
+        Copy<cqspc::CountryCityList>(),
+        Copy<cqspc::Player>(),
+        Copy<cqspc::Rollup>(),
+        Copy<cqspc::RollupParents>(),
+        Copy<cqspc::SimulationLod>(),
+        Copy<cqspc::FullDetail>(),
+        Copy<cqspc::LodFocus>(),
+
+        Copy<cqspb::Body>(),
+        Copy<cqspb::NautralObject>(),
+        Copy<cqspb::OrbitalSystem>(),
+        Copy<cqspb::DirtyOrbit>(),
+        Copy<cqspb::Terrain>(),
+        Copy<cqspb::Star>(),
+        Copy<cqspb::Planet>(),
+        Copy<cqspb::LightEmitter>(),
+        Skip<cqspb::TerrainData>(),
+        Skip<cqspb::TexturedTerrain>(),
+
+        Copy<cqspt::Orbit>(),
+        Copy<cqspt::OrbitDirty>(),
+        Copy<cqspt::Kinematics>(),
+        Copy<cqspt::FuturePosition>(),
+        Copy<cqspt::Impulse>(),
+        Copy<cqspt::GalacticCoordinate>(),
+        Copy<cqspt::PolarCoordinate>(),
+        Copy<cqspt::MoveTarget>(),
+        Copy<cqspt::ImpulseSchedule>(),
+        Copy<cqspt::SurfaceCoordinate>(),
+
+        Copy<cqspc::ships::Ship>(),
+        Copy<cqspc::ships::Crash>(),
+        Copy<cqspc::ships::Fleet>(),
+        Copy<cqspc::ships::Command>(),
+        Copy<cqspc::LaunchVehicle>(),
+    };
+    return types;
+}
+}  // namespace
+
+ForkStats ForkUniverse(Universe& source, Universe& fork, uint32_t stream) {
+    ZoneScoped;
+    ForkStats stats;
+    // Entities are created in order of their index, so that every hole only goes through the free list once
+    const entt::entity* entities = source.data();
+    for (size_t i = 0; i < source.size(); i++) {
+        if (source.valid(entities[i])) {
+            fork.create(entities[i]);
+            stats.entities++;
+        }
+    }
+
+    const auto& types = GetForkTypes();
+    for (auto&& [id, storage] : source.storage()) {
+        if (storage.empty()) {
+            continue;
+        }
+        auto type = types.find(id);
+        if (type == types.end() || type->second == nullptr) {
+            if (type == types.end()) {
+                SPDLOG_DEBUG("Leaving {} out of the fork", storage.type().name());
+            }
+            stats.skipped_pools++;
+            continue;
+        }
+        stats.components += type->second(source, fork);
+        stats.pools++;
+    }
+
+    fork.date = source.date;
+    fork.goods = source.goods;
+    fork.consumergoods = source.consumergoods;
+    fork.recipes = source.recipes;
+    fork.terrain_data = source.terrain_data;
+    fork.name_generators = source.name_generators;
+    fork.fields = source.fields;
+    fork.technologies = source.technologies;
+    fork.planets = source.planets;
+    fork.time_zones = source.time_zones;
+    fork.countries = source.countries;
+    fork.provinces = source.provinces;
+    fork.cities = source.cities;
+    fork.province_colors = source.province_colors;
+    fork.colors_province = source.colors_province;
+    fork.sun = source.sun;
+    fork.uuid = source.uuid;
+    fork.random = source.random->Split(RandomStreamId("Fork"), stream, source.date.GetDate());
+    // The copied generators still point at the source's random
+    for (auto& [name, generator] : fork.name_generators) {
+        generator.SetRandom(fork.random.get());
+    }
+    return stats;
+}
+}  // namespace cqsp::common::util
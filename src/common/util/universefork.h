@@ -0,0 +1,51 @@
+/* Conquer Space
+ * Copyright (C) 2021-2023 Conquer Space
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <cstdint>
+
+#include "common/universe.h"
+
+namespace cqsp::common::util {
+/// <summary>
+/// What was copied into a fork.
+/// </summary>
+struct ForkStats {
+    size_t entities = 0;
+    size_t components = 0;
+    size_t pools = 0;
+    /// Pools that are not empty in the source but were left out of the fork
+    size_t skipped_pools = 0;
+};
+
+/// <summary>
+/// Copies what the simulation works on from `source` into `fork`, so that the fork can be simulated
+/// on its own, such as on another thread.
+/// </summary>
+/// `fork` has to be an empty universe. Entities keep their identifiers, so entities stored in components
+/// and in the lookup tables of the universe still point to the same things.
+///
+/// Components are copied a whole pool at a time, in the same order as in the source, so views over the
+/// fork are iterated in the same order. Components that the simulation doesn't read, such as terrain,
+/// province maps, descriptions and events, are left out, and markets only keep their latest history
+/// entry. Components that the fork doesn't know about are left out as well.
+///
+/// The source is only read, but it must not be ticked while it is being forked.
+/// <param name="stream">Which random stream the fork draws from, so that forks of the same universe
+/// can be told apart</param>
+ForkStats ForkUniverse(Universe& source, Universe& fork, uint32_t stream = 0);
+}  // namespace cqsp::common::util
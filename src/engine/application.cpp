@@ -62,6 +62,11 @@ int Application::init() {
     GlInit();
 
     manager.LoadDefaultTexture();
+    const Hjson::Value& memory = m_client_options.GetOptions()["memory"];
+    asset::ResidencyBudget budget;
+    budget.cpu = static_cast<uint64_t>(memory["cpu_budget"].to_int64()) * 1024 * 1024;
+    budget.gpu = static_cast<uint64_t>(memory["gpu_budget"].to_int64()) * 1024 * 1024;
+    manager.GetResidency().SetBudget(budget);
     SetIcon();
 
     InitAudio();
@@ -224,9 +229,18 @@ int Application::destroy() {
     ENGINE_LOG_INFO("Deleted audio interface");
 
     ENGINE_LOG_INFO("Clearing assets");
+    ENGINE_LOG_INFO("Lazy assets: {} loads, {} evictions", manager.GetResidency().GetLoadCount(),
+                    manager.GetResidency().GetEvictionCount());
     manager.ClearAssets();
     ENGINE_LOG_INFO("Cleared assets");
 
+    if (m_program_cache != nullptr) {
+        ENGINE_LOG_INFO("Shader program cache: {} hits, {} misses", m_program_cache->GetHits(),
+                        m_program_cache->GetMisses());
+        asset::SetProgramBinaryCache(nullptr);
+        m_program_cache.reset();
+    }
+
     ENGINE_LOG_INFO("Deleting audio interface");
     delete m_audio_interface;
     ENGINE_LOG_INFO("Deleted audio interface");
@@ -346,6 +360,9 @@ void Application::run() {
         m_scene_manager.Render(deltaTime);
         END_TIMED_BLOCK(Scene_Render);
 
+        // Everything used this frame has been touched, so the rest can be evicted
+        manager.Update();
+
         // Shut the opengl debugger up
         int drawFboId = 0;
         glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &drawFboId);
@@ -440,6 +457,18 @@ void Application::DrawTextNormalized(const std::string& text, float x, float y)
     }
 }
 
+void Application::BeginTextBatch() {
+    if (m_font != nullptr) {
+        cqsp::asset::BeginTextBatch(*m_font);
+    }
+}
+
+void Application::EndTextBatch() {
+    if (fontShader != nullptr && m_font != nullptr) {
+        cqsp::asset::EndTextBatch(*fontShader, *m_font);
+    }
+}
+
 double Application::GetTime() { return glfwGetTime(); }
 
 bool Application::Screenshot(const char* path) {
@@ -510,6 +539,11 @@ void Application::GlInit() {
     ENGINE_LOG_INFO("GL Renderer: {}", glGetString(GL_RENDERER));
     ENGINE_LOG_INFO("GL shading language: {}", glGetString(GL_SHADING_LANGUAGE_VERSION));
     ENGINE_LOG_INFO(" --- End of GL information ---");
+
+    // Shader programs are linked from cached binaries when the driver allows it
+    m_program_cache = std::make_unique<asset::ProgramBinaryCache>(
+        (std::filesystem::path(common::util::GetCqspAppDataPath()) / "shader_cache").string());
+    asset::SetProgramBinaryCache(m_program_cache.get());
 }
 
 void Application::LoggerInit() {
@@ -33,6 +33,7 @@
 #include "engine/clientoptions.h"
 #include "engine/engine.h"
 #include "engine/gamestate.h"
+#include "engine/graphics/programcache.h"
 #include "engine/graphics/text.h"
 #include "engine/gui.h"
 #include "engine/scene.h"
@@ -128,6 +129,14 @@ class Application {
     // Draw text based on normalized device coordinates
     void DrawTextNormalized(const std::string& text, float x, float y);
 
+    /// <summary>
+    /// Collects all text drawn until @ref EndTextBatch and draws it with a single draw call.
+    /// </summary>
+    /// Text is drawn on top of everything else drawn in between, so only batch text that doesn't need to
+    /// be layered with other things.
+    void BeginTextBatch();
+    void EndTextBatch();
+
     void SetFont(cqsp::asset::Font* font) { m_font = font; }
     void SetFontShader(cqsp::asset::ShaderProgram* shader) { fontShader = shader; }
 
@@ -237,6 +246,8 @@ class Application {
 
     cqsp::asset::AssetManager manager;
 
+    std::unique_ptr<cqsp::asset::ProgramBinaryCache> m_program_cache;
+
     std::unique_ptr<cqsp::engine::GameState> m_game;
 
     cqsp::asset::Font* m_font = nullptr;
@@ -24,6 +24,7 @@
 #include <filesystem>
 #include <iostream>
 #include <regex>
+#include <span>
 #include <utility>
 #include <vector>
 
@@ -31,6 +32,7 @@
 
 #include "common/util/paths.h"
 #include "engine/asset/vfs/nativevfs.h"
+#include "engine/asset/vfs/packvfs.h"
 #include "engine/audio/alaudioasset.h"
 #include "engine/enginelogger.h"
 
@@ -82,6 +84,160 @@ class FontPrototype : public AssetPrototype {
 
     int GetPrototypeType() { return PrototypeType::FONT; }
 };
+
+class LazyTextureLoader : public ResidentLoader {
+ public:
+    LazyTextureLoader(std::shared_ptr<VirtualMounter> mounter, std::string path, TextureLoadingOptions options)
+        : mounter(std::move(mounter)), path(std::move(path)), options(options) {}
+
+    ~LazyTextureLoader() { FreePixels(); }
+
+    bool Decode() override {
+        ZoneScoped;
+        auto file = mounter->Open(path, FileModes::Binary);
+        if (file == nullptr) {
+            return false;
+        }
+        std::vector<uint8_t> fallback;
+        std::span<const uint8_t> view = ViewVFile(file.get(), fallback);
+        pixels = stbi_load_from_memory(view.data(), static_cast<int>(view.size()), &width, &height, &components, 0);
+        return pixels != nullptr;
+    }
+
+    ResidentSize Upload(Asset* asset) override {
+        ZoneScoped;
+        Texture* texture = dynamic_cast<Texture*>(asset);
+        asset::CreateTexture(*texture, pixels, width, height, components, options);
+        FreePixels();
+        // The mipmap chain adds another third
+        uint64_t bytes = static_cast<uint64_t>(width) * height * components;
+        return ResidentSize {0, bytes + bytes / 3};
+    }
+
+    void Evict(Asset* asset) override { dynamic_cast<Texture*>(asset)->Release(); }
+
+ private:
+    void FreePixels() {
+        if (pixels != nullptr) {
+            stbi_image_free(pixels);
+            pixels = nullptr;
+        }
+    }
+
+    std::shared_ptr<VirtualMounter> mounter;
+    std::string path;
+    TextureLoadingOptions options;
+
+    unsigned char* pixels = nullptr;
+    int width = 0;
+    int height = 0;
+    int components = 0;
+};
+
+class LazyBinaryLoader : public ResidentLoader {
+ public:
+    LazyBinaryLoader(std::shared_ptr<VirtualMounter> mounter, std::string path)
+        : mounter(std::move(mounter)), path(std::move(path)) {}
+
+    bool Decode() override {
+        ZoneScoped;
+        auto file = mounter->Open(path, FileModes::Binary);
+        if (file == nullptr) {
+            return false;
+        }
+        std::vector<uint8_t> fallback;
+        std::span<const uint8_t> view = ViewVFile(file.get(), fallback);
+        data.assign(view.begin(), view.end());
+        return true;
+    }
+
+    ResidentSize Upload(Asset* asset) override {
+        BinaryAsset* binary = dynamic_cast<BinaryAsset*>(asset);
+        binary->data = std::move(data);
+        data = std::vector<uint8_t>();
+        return ResidentSize {binary->data.size(), 0};
+    }
+
+    void Evict(Asset* asset) override {
+        // Swap so that the memory is actually given back
+        std::vector<uint8_t>().swap(dynamic_cast<BinaryAsset*>(asset)->data);
+    }
+
+ private:
+    std::shared_ptr<VirtualMounter> mounter;
+    std::string path;
+    std::vector<uint8_t> data;
+};
+
+/// Rough size of a parsed hjson tree, counting the nodes and the strings in them
+uint64_t EstimateSize(const Hjson::Value& value) {
+    uint64_t size = sizeof(Hjson::Value);
+    switch (value.type()) {
+        case Hjson::Type::String:
+            size += value.to_string().size();
+            break;
+        case Hjson::Type::Vector:
+            for (int i = 0; i < static_cast<int>(value.size()); i++) {
+                size += EstimateSize(value[i]);
+            }
+            break;
+        case Hjson::Type::Map:
+            for (const auto& [key, child] : value) {
+                size += key.size() + EstimateSize(child);
+            }
+            break;
+        default:
+            break;
+    }
+    return size;
+}
+
+uint64_t EstimateSize(const HjsonAsset& asset) { return EstimateSize(asset.data); }
+uint64_t EstimateSize(const TextAsset& asset) { return asset.data.capacity(); }
+
+/// Loads an already loaded text or hjson asset again, after it has been released
+template <class T>
+class ReloadingLoader : public ResidentLoader {
+ public:
+    ReloadingLoader(std::shared_ptr<VirtualMounter> mounter, AssetLoader::LoaderFunction load, std::string path,
+                    std::string key, Hjson::Value hints)
+        : mounter(std::move(mounter)),
+          load(std::move(load)),
+          path(std::move(path)),
+          key(std::move(key)),
+          hints(std::move(hints)) {}
+
+    bool Decode() override {
+        ZoneScoped;
+        loaded = load(mounter.get(), path, key, hints);
+        return dynamic_cast<T*>(loaded.get()) != nullptr;
+    }
+
+    ResidentSize Upload(Asset* asset) override {
+        T* target = dynamic_cast<T*>(asset);
+        target->data = std::move(dynamic_cast<T*>(loaded.get())->data);
+        loaded.reset();
+        return ResidentSize {EstimateSize(*target), 0};
+    }
+
+    void Evict(Asset* asset) override { dynamic_cast<T*>(asset)->data = decltype(T::data)(); }
+
+ private:
+    std::shared_ptr<VirtualMounter> mounter;
+    AssetLoader::LoaderFunction load;
+    std::string path;
+    std::string key;
+    Hjson::Value hints;
+
+    std::unique_ptr<Asset> loaded;
+};
+
+/// Parses the file straight from its mapped view, without copying it into a string first
+Hjson::Value UnmarshalVFile(IVirtualFile* file, const Hjson::DecoderOptions& options = Hjson::DecoderOptions()) {
+    std::vector<uint8_t> fallback;
+    std::span<const uint8_t> view = ViewVFile(file, fallback);
+    return Hjson::Unmarshal(reinterpret_cast<const char*>(view.data()), view.size(), options);
+}
 }  // namespace
 
 bool Package::HasAsset(const char* asset) { return assets.contains(asset); }
@@ -163,7 +319,23 @@ void AssetManager::LoadDefaultTexture() {
     asset::CreateTexture(empty_texture, texture_bytes, 2, 2, 3, f);
 }
 
-void AssetManager::ClearAssets() { ZoneScoped packages.clear(); }
+void AssetManager::ClearAssets() {
+    ZoneScoped;
+    residency.Clear();
+    packages.clear();
+}
+
+uint64_t AssetManager::ReleaseAssets(const std::string& name) {
+    uint64_t released = 0;
+    for (auto& [package_name, package] : packages) {
+        if (!package->HasAsset(name)) {
+            continue;
+        }
+        ResidentSize size = residency.Release(package->assets[name].get());
+        released += size.cpu + size.gpu;
+    }
+    return released;
+}
 
 void AssetManager::SaveModList() {
     Hjson::Value enabled_mods;
@@ -219,8 +391,12 @@ void AssetLoader::LoadMods() {
 
     ENGINE_LOG_INFO("Loading potential mods");
 
-    // Load core
-    mod_load(LoadModPrototype((data_path / "core").string()));
+    // Load core, preferring a built pack over the loose files
+    std::filesystem::path core_path = data_path / "core.cqpk";
+    if (!std::filesystem::is_regular_file(core_path)) {
+        core_path = data_path / "core";
+    }
+    mod_load(LoadModPrototype(core_path.string()));
 
     // Enable core by default
     all_mods["core"] = true;
@@ -329,6 +505,7 @@ std::unique_ptr<Package> AssetLoader::LoadPackage(const std::string& path) {
     // Place into string
     // This will also serve as the namespace name, so no spaces, periods, semicolons please
     std::unique_ptr<Package> package = std::make_unique<Package>();
+    package->residency = &manager->residency;
     package->name = info["name"].to_string();
     package->version = info["version"].to_string();
     package->title = info["title"].to_string();
@@ -336,7 +513,7 @@ std::unique_ptr<Package> AssetLoader::LoadPackage(const std::string& path) {
 
     // Mount to name
     std::string mount_point = package->name;
-    mounter.AddMountPoint(mount_point, vfs);
+    mounter->AddMountPoint(mount_point, vfs);
 
     ENGINE_LOG_INFO("Mounted package {}", package->name);
 
@@ -345,10 +522,10 @@ std::unique_ptr<Package> AssetLoader::LoadPackage(const std::string& path) {
     std::filesystem::path script_path(package_path / "scripts");
     // Check if files exist
     // Load scripts
-    if (mounter.IsDirectory(mount_point, "scripts") && mounter.IsFile(mount_point, "scripts/base.lua")) {
+    if (mounter->IsDirectory(mount_point, "scripts") && mounter->IsFile(mount_point, "scripts/base.lua")) {
         // Load base.lua for the base folder
-        package->assets["base"] = LoadText(&mounter, mount_point + "/scripts/base.lua", "base", Hjson::Value());
-        package->assets["scripts"] = LoadScriptDirectory(&mounter, mount_point + "/scripts", Hjson::Value());
+        package->assets["base"] = LoadText(mounter.get(), mount_point + "/scripts/base.lua", "base", Hjson::Value());
+        package->assets["scripts"] = LoadScriptDirectory(mounter.get(), mount_point + "/scripts", Hjson::Value());
         ENGINE_LOG_INFO("Loaded scripts");
     } else {
         ENGINE_LOG_INFO("No script file for package {}", package->name);
@@ -377,15 +554,18 @@ std::unique_ptr<Asset> AssetLoader::LoadAsset(const AssetType& type, const std::
         return nullptr;
     }
     // Ensure path exists
-    if (!mounter.Exists(path)) {
+    if (!mounter->Exists(path)) {
         ENGINE_LOG_WARN("{} at {} does not exist, errors may ensue", key, path);
     }
-    return std::move(loading_functions[type](&mounter, path, key, hints));
+    return std::move(loading_functions[type](mounter.get(), path, key, hints));
 }
 
 void AssetLoader::PlaceAsset(Package& package, const AssetType& type, const std::string& path, const std::string& key,
                              const Hjson::Value& hints) {
     ZoneScoped;
+    if (PlaceLazyAsset(package, type, path, key, hints)) {
+        return;
+    }
     ENGINE_LOG_TRACE("Loading asset {}", path);
     auto asset = LoadAsset(type, path, key, hints);
     if (asset == nullptr) {
@@ -393,7 +573,64 @@ void AssetLoader::PlaceAsset(Package& package, const AssetType& type, const std:
         return;
     }
     asset->path = path;
+    if (package.assets.contains(key)) {
+        manager->residency.Unregister(package.assets[key].get());
+    }
+    MakeReleasable(asset.get(), type, path, key, hints);
+    package.assets[key] = std::move(asset);
+}
+
+void AssetLoader::MakeReleasable(Asset* asset, const AssetType& type, const std::string& path,
+                                 const std::string& key, const Hjson::Value& hints) {
+    std::unique_ptr<ResidentLoader> loader;
+    ResidentSize size;
+    if (type == AssetType::HJSON) {
+        loader = std::make_unique<ReloadingLoader<HjsonAsset>>(mounter, &AssetLoader::LoadHjson, path, key, hints);
+        size.cpu = EstimateSize(*dynamic_cast<HjsonAsset*>(asset));
+    } else if (type == AssetType::TEXT) {
+        loader = std::make_unique<ReloadingLoader<TextAsset>>(mounter, &AssetLoader::LoadText, path, key, hints);
+        size.cpu = EstimateSize(*dynamic_cast<TextAsset*>(asset));
+    } else {
+        return;
+    }
+    manager->residency.RegisterResident(asset, std::move(loader), size);
+}
+
+bool AssetLoader::PlaceLazyAsset(Package& package, const AssetType& type, const std::string& path,
+                                 const std::string& key, const Hjson::Value& hints) {
+    Hjson::Value lazy = hints["lazy"];
+    if (lazy.defined() && lazy.type() == Hjson::Type::Bool && !static_cast<bool>(lazy)) {
+        return false;
+    }
+    std::unique_ptr<Asset> asset;
+    std::unique_ptr<ResidentLoader> loader;
+    switch (type) {
+        case AssetType::TEXTURE: {
+            TextureLoadingOptions options;
+            Hjson::Value pixellated = hints["magfilter"];
+            if (pixellated.defined() && pixellated.type() == Hjson::Type::Bool) {
+                options.mag_filter = static_cast<bool>(pixellated);
+            }
+            asset = std::make_unique<Texture>();
+            loader = std::make_unique<LazyTextureLoader>(mounter, path, options);
+            break;
+        }
+        case AssetType::BINARY:
+            asset = std::make_unique<BinaryAsset>();
+            loader = std::make_unique<LazyBinaryLoader>(mounter, path);
+            break;
+        default:
+            return false;
+    }
+    ENGINE_LOG_TRACE("Registering lazy asset {}", path);
+    asset->path = path;
+    manager->residency.Register(asset.get(), std::move(loader));
+    // Replacing an asset of the same key, so the old one isn't managed anymore
+    if (package.assets.contains(key)) {
+        manager->residency.Unregister(package.assets[key].get());
+    }
     package.assets[key] = std::move(asset);
+    return true;
 }
 
 void AssetLoader::BuildNextAsset() {
@@ -433,7 +670,7 @@ void AssetLoader::BuildNextAsset() {
             FontPrototype* prototype = dynamic_cast<FontPrototype*>(temp.prototype);
             Font* asset = dynamic_cast<Font*>(prototype->asset);
 
-            asset::LoadFontData(*asset, prototype->fontBuffer.data(), prototype->size);
+            asset::LoadFontData(*asset, std::move(prototype->fontBuffer));
         } break;
         case PrototypeType::CUBEMAP: {
             CubemapPrototype* prototype = dynamic_cast<CubemapPrototype*>(temp.prototype);
@@ -499,10 +736,10 @@ std::unique_ptr<Asset> AssetLoader::LoadTexture(VirtualMounter* mount, const std
     }
 
     auto file = mount->Open(path, FileModes::Binary);
-    uint64_t file_size = file->Size();
-    auto buffer = ReadAllFromVFile(file.get());
-    prototype->data = stbi_load_from_memory(buffer.data(), file_size, &prototype->width, &prototype->height,
-                                            &prototype->components, 0);
+    std::vector<uint8_t> fallback;
+    std::span<const uint8_t> view = ViewVFile(file.get(), fallback);
+    prototype->data = stbi_load_from_memory(view.data(), static_cast<int>(view.size()), &prototype->width,
+                                            &prototype->height, &prototype->components, 0);
     if (prototype->data != nullptr) {
         QueueHolder holder(prototype);
 
@@ -520,7 +757,9 @@ std::unique_ptr<cqsp::asset::Asset> AssetLoader::LoadBinaryAsset(cqsp::asset::Vi
                                                                  const Hjson::Value& hints) {
     std::unique_ptr<BinaryAsset> asset = std::make_unique<BinaryAsset>();
     auto file = mount->Open(path);
-    asset->data = ReadAllFromVFile(file.get());
+    std::vector<uint8_t> fallback;
+    std::span<const uint8_t> view = ViewVFile(file.get(), fallback);
+    asset->data.assign(view.begin(), view.end());
     return asset;
 }
 
@@ -541,7 +780,7 @@ std::unique_ptr<Asset> AssetLoader::LoadHjson(VirtualMounter* mount, const std::
             Hjson::Value result;
             // Since it's a directory, we will assume it's an array, and push back the values.
             try {
-                result = Hjson::Unmarshal(ReadAllFromVFileToString(file.get()), dec_opt);
+                result = UnmarshalVFile(file.get(), dec_opt);
                 if (result.type() == Hjson::Type::Vector) {
                     // Append all the values in place
                     for (int k = 0; k < result.size(); k++) {
@@ -558,7 +797,7 @@ std::unique_ptr<Asset> AssetLoader::LoadHjson(VirtualMounter* mount, const std::
         auto file = mount->Open(path);
         // Read the file
         try {
-            asset->data = Hjson::Unmarshal(ReadAllFromVFileToString(file.get()), dec_opt);
+            asset->data = UnmarshalVFile(file.get(), dec_opt);
         } catch (Hjson::syntax_error& ex) {
             ENGINE_LOG_ERROR("Failed to load hjson {}: {}", path, ex.what());
         }
@@ -615,10 +854,12 @@ std::unique_ptr<Asset> AssetLoader::LoadFont(VirtualMounter* mount, const std::s
 
     std::unique_ptr<Font> asset = std::make_unique<Font>();
     auto file = mount->Open(path);
-    auto bytes = ReadAllFromVFile(file.get());
+    std::vector<uint8_t> fallback;
+    std::span<const uint8_t> view = ViewVFile(file.get(), fallback);
 
     FontPrototype* prototype = new FontPrototype();
-    prototype->fontBuffer = std::move(bytes);
+    // The font keeps its data around for freetype, so this is the only copy
+    prototype->fontBuffer.assign(view.begin(), view.end());
     prototype->size = file->Size();
     prototype->key = key;
     prototype->asset = asset.get();
@@ -637,8 +878,9 @@ std::unique_ptr<Asset> AssetLoader::LoadAudio(VirtualMounter* mount, const std::
         return nullptr;
     }
     auto file = mount->Open(path);
-    auto data = ReadAllFromVFile(file.get());
-    auto asset = LoadOgg(data.data(), file->Size());
+    std::vector<uint8_t> fallback;
+    std::span<const uint8_t> view = ViewVFile(file.get(), fallback);
+    auto asset = LoadOgg(view.data(), static_cast<int>(view.size()));
     return std::move(asset);
 }
 
@@ -651,7 +893,7 @@ std::unique_ptr<Asset> AssetLoader::LoadCubemap(VirtualMounter* mount, const std
     // Read file, which will be hjson, and load those files too
     Hjson::Value images_hjson;
     auto hjson_file = mount->Open(path);
-    images_hjson = Hjson::Unmarshal(ReadAllFromVFileToString(hjson_file.get()));
+    images_hjson = UnmarshalVFile(hjson_file.get());
 
     CubemapPrototype* prototype = new CubemapPrototype();
 
@@ -676,10 +918,12 @@ std::unique_ptr<Asset> AssetLoader::LoadCubemap(VirtualMounter* mount, const std
         }
         ZoneNamed(CubemapRead, true);
         auto file = mount->Open(image_path);
-        auto file_data = ReadAllFromVFile(file.get());
+        std::vector<uint8_t> fallback;
+        std::span<const uint8_t> file_data = ViewVFile(file.get(), fallback);
         ZoneNamed(CubemapLoad, true);
-        unsigned char* image_data = stbi_load_from_memory(file_data.data(), file->Size(), &prototype->width,
-                                                          &prototype->height, &prototype->components, 0);
+        unsigned char* image_data = stbi_load_from_memory(file_data.data(), static_cast<int>(file_data.size()),
+                                                          &prototype->width, &prototype->height,
+                                                          &prototype->components, 0);
         prototype->data.push_back(image_data);
     }
     prototype->asset = asset.get();
@@ -799,7 +1043,7 @@ void AssetLoader::LoadResources(Package& package, const std::string& package_mou
     ZoneScoped;
     // Load the package
     // Open the root directory
-    auto directory = mounter.OpenDirectory(package_mount_path + "/");
+    auto directory = mounter->OpenDirectory(package_mount_path + "/");
     ENGINE_LOG_INFO("Loading {}", package_mount_path);
     for (int i = 0; i < directory->GetSize(); i++) {
         auto resource_file = directory->GetFile(i);
@@ -813,19 +1057,18 @@ void AssetLoader::LoadResources(Package& package, const std::string& package_mou
         Hjson::DecoderOptions dec_opt;
         dec_opt.comments = false;
         dec_opt.duplicateKeyException = true;
-        std::string asset_data = ReadAllFromVFileToString(resource_file.get());
         Hjson::Value asset_value;
 
         // Try to load and check for duplicate options, sadly hjson doesn't provide good
         // ways to see which keys are duplicated, except by exception, so we'll have
         // to do this as a hack for now
         try {
-            asset_value = Hjson::Unmarshal(asset_data, dec_opt);
+            asset_value = UnmarshalVFile(resource_file.get(), dec_opt);
         } catch (Hjson::syntax_error& se) {
             ENGINE_LOG_WARN(se.what());
             // Then try again without the options
             dec_opt.duplicateKeyException = false;
-            asset_value = Hjson::Unmarshal(asset_data, dec_opt);
+            asset_value = UnmarshalVFile(resource_file.get(), dec_opt);
         }
 
         max_loading += asset_value.size();
@@ -852,7 +1095,7 @@ void AssetLoader::LoadResourceHjsonFile(Package& package, const std::string& pac
         ENGINE_LOG_TRACE("Loading path {}", path);
 
         // Check if the file exists, just in case
-        if (!mounter.Exists(path)) {
+        if (!mounter->Exists(path)) {
             ENGINE_LOG_WARN("Cannot find asset {} at {}", key, path);
             // Check if it's required
             if (!val["required"].empty() && val["required"]) {
@@ -872,15 +1115,30 @@ void AssetLoader::LoadResourceHjsonFile(Package& package, const std::string& pac
 }
 bool AssetLoader::HjsonPrototypeDirectory(Package& package, const std::string& path, const std::string& name) {
     ZoneScoped;
-    if (!mounter.IsDirectory(path)) {
+    if (!mounter->IsDirectory(path)) {
         return false;
     }
-    package.assets[name] = LoadHjson(&mounter, path, name, Hjson::Value());
+    auto asset = LoadHjson(mounter.get(), path, name, Hjson::Value());
+    asset->path = path;
+    if (package.assets.contains(name)) {
+        manager->residency.Unregister(package.assets[name].get());
+    }
+    MakeReleasable(asset.get(), AssetType::HJSON, path, name, Hjson::Value());
+    package.assets[name] = std::move(asset);
     return true;
 }
 
 IVirtualFileSystem* AssetLoader::GetVfs(const std::string& path) {
-    // Return native filesystem for now.
-    return new NativeFileSystem(path);
+    // Packages are either a directory, or a pack built by cqsp-pack
+    // Both index their contents here, so that asset discovery afterwards doesn't touch the disk
+    std::error_code ec;
+    IVirtualFileSystem* vfs = nullptr;
+    if (std::filesystem::is_regular_file(path, ec)) {
+        vfs = new PackFileSystem(path);
+    } else {
+        vfs = new NativeFileSystem(path);
+    }
+    vfs->Initialize();
+    return vfs;
 }
 }  // namespace cqsp::asset
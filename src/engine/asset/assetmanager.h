@@ -29,6 +29,7 @@
 #include <vector>
 
 #include "engine/asset/asset.h"
+#include "engine/asset/residency.h"
 #include "engine/asset/textasset.h"
 #include "engine/asset/vfs/vfs.h"
 #include "engine/engine.h"
@@ -128,8 +129,23 @@ class Package {
     std::string title;
     std::string author;
 
+    /// <summary>
+    /// Gets an asset, loading it first if it has been evicted.
+    /// </summary>
     template <class T, typename V>
     T* GetAsset(const V asset) {
+        T* ptr = FindAsset<T>(asset);
+        if (ptr != nullptr && residency != nullptr) {
+            residency->Touch(ptr);
+        }
+        return ptr;
+    }
+
+    /// <summary>
+    /// Gets the handle of an asset without loading it.
+    /// </summary>
+    template <class T, typename V>
+    T* FindAsset(const V asset) {
         if (!HasAsset(asset)) {
             ENGINE_LOG_ERROR("Invalid key {}", asset);
         }
@@ -145,6 +161,8 @@ class Package {
 
  private:
     std::map<std::string, std::unique_ptr<Asset>> assets;
+    // Residency of the lazily loaded and releasable assets in this package
+    ResidencyManager* residency = nullptr;
 
     void ClearAssets();
 
@@ -171,7 +189,7 @@ class AssetManager {
     ShaderProgram_t MakeShader(const std::string& vert, const std::string& frag, const std::string& geom);
 
     /// <summary>
-    /// Gets an asset.
+    /// Gets an asset, loading it first if it isn't in memory.
     /// </summary>
     /// To get an asset, it defaults finding the asset in `core` if you do not specify a package,
     /// or else if the asset is from another asset pack, you can specify
@@ -181,6 +199,22 @@ class AssetManager {
     /// <returns></returns>
     template <class T>
     T* GetAsset(const std::string& key) {
+        T* ptr = FindAsset<T>(key);
+        // The empty texture is owned by the manager, not by any package, so it has no residency to track
+        if (ptr != nullptr && static_cast<Asset*>(ptr) != static_cast<Asset*>(&empty_texture)) {
+            residency.Touch(ptr);
+            ptr->accessed++;
+        }
+        return ptr;
+    }
+
+    /// <summary>
+    /// Gets the handle of an asset without loading it.
+    /// </summary>
+    /// Lazily loaded assets may not be in memory yet. Use @ref GetResidency to request them
+    /// before they are used.
+    template <class T>
+    T* FindAsset(const std::string& key) {
         static_assert(std::is_base_of<Asset, T>::value, "Class is not child of cqsp::asset::Asset");
         std::size_t separation = key.find(":");
         // Default name is core
@@ -190,11 +224,13 @@ class AssetManager {
         }
 
         // Check if package exists
-        if (packages.count(package_name) == 0) {
+        auto package_it = packages.find(package_name);
+        if (package_it == packages.end()) {
             ENGINE_LOG_ERROR("Cannot find package {}", package_name);
+            return nullptr;
         }
         std::string pkg_key = key.substr(separation + 1, key.length());
-        auto& package = packages[package_name];
+        auto& package = package_it->second;
         // Probably a better way to do this, to be honest
         // Load default texture
         if (!package->HasAsset(pkg_key)) {
@@ -204,14 +240,30 @@ class AssetManager {
             }
         }
         // Check if asset exists
-        T* ptr = package->GetAsset<T>(pkg_key);
+        T* ptr = package->FindAsset<T>(pkg_key);
         if (ptr == nullptr) {
             SPDLOG_WARN("Asset {} is wrong type", key);
         }
-        ptr->accessed++;
         return ptr;
     }
 
+    /// <summary>
+    /// Drops the data of the asset called `name` in every package, for data that has been copied somewhere
+    /// else, such as into the universe. The data is loaded again the next time the asset is used.
+    /// </summary>
+    /// <returns>Approximate number of bytes freed</returns>
+    uint64_t ReleaseAssets(const std::string& name);
+
+    /// <summary>
+    /// Decides which lazily loaded assets are kept in memory.
+    /// </summary>
+    ResidencyManager& GetResidency() { return residency; }
+
+    /// <summary>
+    /// Finishes background asset loads and evicts assets that are over the memory budget. Call once a frame.
+    /// </summary>
+    void Update() { residency.Update(); }
+
     void LoadDefaultTexture();
     void ClearAssets();
 
@@ -230,6 +282,8 @@ class AssetManager {
  private:
     std::map<std::string, std::unique_ptr<Package>> packages;
     asset::Texture empty_texture;
+    // After the packages, so that it's destroyed while the assets it manages are still alive
+    ResidencyManager residency;
     friend class AssetLoader;
 };
 
@@ -293,6 +347,12 @@ class AssetLoader {
     /// <returns></returns>
     std::vector<std::string>& GetMissingAssets() { return missing_assets; }
 
+    /// <summary>
+    /// Drops the cached file metadata of every mounted package, so that files that changed on disk
+    /// are seen again.
+    /// </summary>
+    void InvalidateFiles() { mounter->Invalidate(); }
+
     /// <summary>
     /// Get where the mod.hjson file is.
     /// </summary>
@@ -318,8 +378,8 @@ class AssetLoader {
     ///
     /// This has no hints
     /// </summary>
-    std::unique_ptr<cqsp::asset::Asset> LoadText(cqsp::asset::VirtualMounter* mount, const std::string& path,
-                                                 const std::string& key, const Hjson::Value& hints);
+    static std::unique_ptr<cqsp::asset::Asset> LoadText(cqsp::asset::VirtualMounter* mount, const std::string& path,
+                                                        const std::string& key, const Hjson::Value& hints);
     /// <summary>
     /// Loads a directory of text files into a map of strings keyed by their relative path to the
     /// resource.hjson file.
@@ -331,6 +391,8 @@ class AssetLoader {
     /// Textures have one hint, the `magfilter` hint. If it is present, and set to true, it will enable
     /// closest magfilter, which will make the texture look pixellated.
     /// If it is not present, then it will be linear mag.
+    ///
+    /// Textures are only loaded once they are used, unless the `lazy` hint is set to false.
     /// </summary>
     std::unique_ptr<cqsp::asset::Asset> LoadTexture(cqsp::asset::VirtualMounter* mount, const std::string& path,
                                                     const std::string& key, const Hjson::Value& hints);
@@ -352,8 +414,8 @@ class AssetLoader {
     /// If it refers to directory, and a file that is loaded is not in a hjson array, it will not load that specific
     /// file, but it will not fail.
     /// </summary>
-    std::unique_ptr<cqsp::asset::Asset> LoadHjson(cqsp::asset::VirtualMounter* mount, const std::string& path,
-                                                  const std::string& key, const Hjson::Value& hints);
+    static std::unique_ptr<cqsp::asset::Asset> LoadHjson(cqsp::asset::VirtualMounter* mount, const std::string& path,
+                                                         const std::string& key, const Hjson::Value& hints);
 
     /// <summary>
     /// Shaders have one option, the `type` hint, to specify what type of shader it is.
@@ -456,6 +518,21 @@ class AssetLoader {
 
     ShaderProgram_t MakeShader(const std::string& key);
 
+    /// <summary>
+    /// Registers an empty asset that is only loaded once it's used. Textures and binary assets are
+    /// loaded this way, unless the `lazy` hint is set to false.
+    /// </summary>
+    /// <returns>false if the asset type can't be loaded lazily</returns>
+    bool PlaceLazyAsset(Package& package, const AssetType& type, const std::string& path, const std::string& key,
+                        const Hjson::Value& hints);
+
+    /// <summary>
+    /// Lets text and hjson assets be released once they have been read, and loaded again from `path`
+    /// when they are needed.
+    /// </summary>
+    void MakeReleasable(Asset* asset, const AssetType& type, const std::string& path, const std::string& key,
+                        const Hjson::Value& hints);
+
     /// <summary>
     /// Conducts checks to determine if the asset was loaded correctly. Wraps Load asset,
     /// and contains the same parameters
@@ -541,7 +618,8 @@ class AssetLoader {
     /// </summary>
     /// \see @ref LoadScriptDirectory LoadCubemap LoadAudio LoadText LoadTexture LoadHjson LoadShader LoadFont
     std::map<AssetType, LoaderFunction> loading_functions;
-    VirtualMounter mounter;
+    // Shared with the lazily loaded assets, which read their files long after loading is done
+    std::shared_ptr<VirtualMounter> mounter = std::make_shared<VirtualMounter>();
 };
 }  // namespace asset
 }  // namespace cqsp
@@ -0,0 +1,283 @@
+/* Conquer Space
+ * Copyright (C) 2021-2023 Conquer Space
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "engine/asset/residency.h"
+
+#include <algorithm>
+#include <chrono>
+#include <utility>
+
+#include <tracy/Tracy.hpp>
+
+#include "engine/enginelogger.h"
+
+namespace cqsp::asset {
+ResidencyManager::~ResidencyManager() { Clear(); }
+
+void ResidencyManager::Register(Asset* asset, std::unique_ptr<ResidentLoader> loader) {
+    std::lock_guard lock(mutex);
+    Entry& entry = entries[asset];
+    entry.asset = asset;
+    entry.loader = std::move(loader);
+}
+
+void ResidencyManager::RegisterResident(Asset* asset, std::unique_ptr<ResidentLoader> loader,
+                                        const ResidentSize& size) {
+    std::lock_guard lock(mutex);
+    Entry& entry = entries[asset];
+    entry.asset = asset;
+    entry.loader = std::move(loader);
+    entry.state = State::Resident;
+    entry.pinned = true;
+    entry.size = size;
+    entry.last_used = frame;
+    usage.cpu += size.cpu;
+    usage.gpu += size.gpu;
+}
+
+void ResidencyManager::Unregister(Asset* asset) {
+    std::lock_guard lock(mutex);
+    auto it = entries.find(asset);
+    if (it == entries.end()) {
+        return;
+    }
+    Entry& entry = it->second;
+    if (entry.state == State::Decoding) {
+        entry.decoding.wait();
+        if (entry.background) {
+            decodes_in_flight--;
+        }
+    }
+    if (entry.state == State::Resident) {
+        Evict(entry);
+    }
+    std::erase(queue, &entry);
+    entries.erase(it);
+}
+
+bool ResidencyManager::IsManaged(const Asset* asset) const {
+    std::lock_guard lock(mutex);
+    return entries.contains(asset);
+}
+
+bool ResidencyManager::IsResident(const Asset* asset) const {
+    std::lock_guard lock(mutex);
+    auto it = entries.find(asset);
+    return it == entries.end() || it->second.state == State::Resident;
+}
+
+bool ResidencyManager::Touch(Asset* asset) {
+    std::unique_lock lock(mutex);
+    auto it = entries.find(asset);
+    if (it == entries.end()) {
+        return true;
+    }
+    it->second.last_used = frame;
+    return MakeResident(lock, asset);
+}
+
+bool ResidencyManager::Request(Asset* asset) {
+    std::lock_guard lock(mutex);
+    auto it = entries.find(asset);
+    if (it == entries.end()) {
+        return true;
+    }
+    Entry& entry = it->second;
+    entry.last_used = frame;
+    if (entry.state == State::Evicted) {
+        Queue(entry);
+    }
+    return entry.state == State::Resident;
+}
+
+void ResidencyManager::Prefetch(Asset* asset) {
+    std::lock_guard lock(mutex);
+    auto it = entries.find(asset);
+    if (it == entries.end() || it->second.state != State::Evicted) {
+        return;
+    }
+    Queue(it->second);
+}
+
+void ResidencyManager::Update() {
+    ZoneScoped;
+    std::lock_guard lock(mutex);
+    // Upload whatever finished decoding, then start the next ones in line
+    for (auto& [asset, entry] : entries) {
+        // Decodes started by Touch are finished by the thread that started them
+        if (entry.state == State::Decoding && entry.background &&
+            entry.decoding.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+            decodes_in_flight--;
+            FinishDecode(entry, entry.decoding.get());
+        }
+    }
+    auto next = queue.begin();
+    for (; next != queue.end() && decodes_in_flight < max_decodes_in_flight; next++) {
+        Entry& entry = **next;
+        ResidentLoader* loader = entry.loader.get();
+        entry.decoding = std::async(std::launch::async, [loader]() { return loader->Decode(); }).share();
+        entry.state = State::Decoding;
+        entry.background = true;
+        decodes_in_flight++;
+    }
+    queue.erase(queue.begin(), next);
+
+    EnforceBudget();
+    frame++;
+}
+
+void ResidencyManager::SetBudget(const ResidencyBudget& _budget) {
+    std::lock_guard lock(mutex);
+    budget = _budget;
+}
+
+void ResidencyManager::EnforceBudget() {
+    if (!OverBudget()) {
+        return;
+    }
+    std::vector<Entry*> candidates;
+    for (auto& [asset, entry] : entries) {
+        if (entry.state == State::Resident && !entry.pinned && entry.last_used < frame) {
+            candidates.push_back(&entry);
+        }
+    }
+    std::sort(candidates.begin(), candidates.end(),
+              [](const Entry* a, const Entry* b) { return a->last_used < b->last_used; });
+    for (Entry* entry : candidates) {
+        if (!OverBudget()) {
+            break;
+        }
+        Evict(*entry);
+    }
+}
+
+ResidentSize ResidencyManager::Release(Asset* asset) {
+    std::lock_guard lock(mutex);
+    auto it = entries.find(asset);
+    if (it == entries.end() || it->second.state != State::Resident) {
+        return ResidentSize();
+    }
+    ResidentSize size = it->second.size;
+    Evict(it->second);
+    return size;
+}
+
+void ResidencyManager::Clear() {
+    std::lock_guard lock(mutex);
+    for (auto& [asset, entry] : entries) {
+        if (entry.state == State::Decoding) {
+            entry.decoding.wait();
+        }
+        if (entry.state == State::Resident) {
+            Evict(entry);
+        }
+    }
+    entries.clear();
+    queue.clear();
+    decodes_in_flight = 0;
+    usage = ResidentSize();
+}
+
+size_t ResidencyManager::GetManagedCount() const {
+    std::lock_guard lock(mutex);
+    return entries.size();
+}
+
+size_t ResidencyManager::GetResidentCount() const {
+    std::lock_guard lock(mutex);
+    return std::count_if(entries.begin(), entries.end(),
+                         [](const auto& pair) { return pair.second.state == State::Resident; });
+}
+
+bool ResidencyManager::MakeResident(std::unique_lock<std::mutex>& lock, Asset* asset) {
+    Entry* entry = &entries.at(asset);
+    switch (entry->state) {
+        case State::Resident:
+            return true;
+        case State::Failed:
+            return false;
+        case State::Queued:
+            std::erase(queue, entry);
+            [[fallthrough]];
+        case State::Evicted: {
+            ResidentLoader* loader = entry->loader.get();
+            std::packaged_task<bool()> task([loader]() { return loader->Decode(); });
+            entry->decoding = task.get_future().share();
+            entry->state = State::Decoding;
+            entry->background = false;
+            lock.unlock();
+            task();
+            lock.lock();
+            break;
+        }
+        case State::Decoding: {
+            // Already loading, so wait for that instead of decoding it twice
+            std::shared_future<bool> decoding = entry->decoding;
+            lock.unlock();
+            decoding.wait();
+            lock.lock();
+            break;
+        }
+    }
+
+    // Another thread may have finished the load, or unregistered the asset, while the lock was released
+    auto it = entries.find(asset);
+    if (it == entries.end()) {
+        return false;
+    }
+    entry = &it->second;
+    if (entry->state == State::Decoding &&
+        entry->decoding.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+        if (entry->background) {
+            decodes_in_flight--;
+        }
+        FinishDecode(*entry, entry->decoding.get());
+    }
+    return entry->state == State::Resident;
+}
+
+void ResidencyManager::Queue(Entry& entry) {
+    entry.state = State::Queued;
+    queue.push_back(&entry);
+}
+
+void ResidencyManager::FinishDecode(Entry& entry, bool decoded) {
+    ZoneScoped;
+    if (!decoded) {
+        ENGINE_LOG_WARN("Failed to load asset {}", entry.asset->path);
+        entry.state = State::Failed;
+        return;
+    }
+    entry.size = entry.loader->Upload(entry.asset);
+    entry.state = State::Resident;
+    usage.cpu += entry.size.cpu;
+    usage.gpu += entry.size.gpu;
+    loads++;
+}
+
+void ResidencyManager::Evict(Entry& entry) {
+    entry.loader->Evict(entry.asset);
+    entry.state = State::Evicted;
+    usage.cpu -= entry.size.cpu;
+    usage.gpu -= entry.size.gpu;
+    entry.size = ResidentSize();
+    evictions++;
+}
+
+bool ResidencyManager::OverBudget() const {
+    return (budget.cpu != 0 && usage.cpu > budget.cpu) || (budget.gpu != 0 && usage.gpu > budget.gpu);
+}
+}  // namespace cqsp::asset
@@ -0,0 +1,196 @@
+/* Conquer Space
+ * Copyright (C) 2021-2023 Conquer Space
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "engine/asset/asset.h"
+
+namespace cqsp::asset {
+/// <summary>
+/// Memory that a resident asset takes up, in bytes.
+/// </summary>
+struct ResidentSize {
+    uint64_t cpu = 0;
+    uint64_t gpu = 0;
+};
+
+/// <summary>
+/// Memory that resident assets are allowed to take up, in bytes. 0 means there's no limit.
+/// </summary>
+struct ResidencyBudget {
+    uint64_t cpu = 0;
+    uint64_t gpu = 0;
+};
+
+/// <summary>
+/// Brings the data of one lazily loaded asset in and out of memory.
+/// </summary>
+/// Loading is split in two, so that the slow part can be done in the background.
+class ResidentLoader {
+ public:
+    virtual ~ResidentLoader() = default;
+
+    /// <summary>
+    /// Reads and decodes the source of the asset. This can run on any thread, so it must not touch
+    /// the asset itself or the GL context.
+    /// </summary>
+    /// <returns>false if the asset couldn't be loaded</returns>
+    virtual bool Decode() = 0;
+
+    /// <summary>
+    /// Moves the decoded data into the asset, on the main thread. This is where GPU uploads go.
+    /// </summary>
+    virtual ResidentSize Upload(Asset* asset) = 0;
+
+    /// <summary>
+    /// Frees the data of the asset, leaving the asset object itself alive so that pointers to it stay valid.
+    /// </summary>
+    virtual void Evict(Asset* asset) = 0;
+};
+
+/// <summary>
+/// Keeps track of which lazily loaded assets are in memory, and evicts the least recently used ones
+/// when they go over budget.
+/// </summary>
+/// Assets are registered as empty handles when their package is loaded, and are only decoded the first time
+/// they are used. Anything that holds on to a pointer to a managed asset has to call @ref Touch or
+/// @ref Request every frame that it uses it, otherwise the asset may be evicted under it.
+///
+/// The manager can be used from any thread, but assets that upload to the GPU have to be touched
+/// on the main thread, and @ref Update has to be called from there.
+class ResidencyManager {
+ public:
+    ResidencyManager() = default;
+    ~ResidencyManager();
+
+    ResidencyManager(const ResidencyManager&) = delete;
+    ResidencyManager& operator=(const ResidencyManager&) = delete;
+
+    /// <summary>
+    /// Starts managing the asset. It isn't loaded until it's used.
+    /// </summary>
+    void Register(Asset* asset, std::unique_ptr<ResidentLoader> loader);
+
+    /// <summary>
+    /// Starts managing an asset that is already loaded, so that it can be released and loaded again later.
+    /// </summary>
+    /// These are only evicted by @ref Release, never to fit the budget, because they can be read
+    /// from other threads, such as while loading a game.
+    void RegisterResident(Asset* asset, std::unique_ptr<ResidentLoader> loader, const ResidentSize& size);
+
+    /// <summary>
+    /// Stops managing the asset, and waits for any background load of it to finish.
+    /// </summary>
+    void Unregister(Asset* asset);
+
+    bool IsManaged(const Asset* asset) const;
+
+    /// Unmanaged assets are always resident
+    bool IsResident(const Asset* asset) const;
+
+    /// <summary>
+    /// Marks the asset as used this frame, and loads it right away if it isn't in memory.
+    /// </summary>
+    /// The asset is decoded without holding the lock, so other threads can keep using the manager meanwhile.
+    /// <returns>false if the asset failed to load</returns>
+    bool Touch(Asset* asset);
+
+    /// <summary>
+    /// Marks the asset as used this frame, and starts loading it in the background if it isn't in memory.
+    /// </summary>
+    /// For things that can be drawn for a few frames without the asset, such as planet textures.
+    /// <returns>true if the asset is resident now</returns>
+    bool Request(Asset* asset);
+
+    /// <summary>
+    /// Hints that the asset will be used soon, so that it's loaded in the background.
+    /// </summary>
+    void Prefetch(Asset* asset);
+
+    /// <summary>
+    /// Finishes background loads and evicts assets until everything fits into the budget. Call once a frame.
+    /// </summary>
+    void Update();
+
+    void SetBudget(const ResidencyBudget& budget);
+    const ResidencyBudget& GetBudget() const { return budget; }
+
+    /// <summary>
+    /// Evicts the least recently used assets until usage fits into the budget.
+    /// </summary>
+    /// Assets used in the current frame are never evicted, so usage can stay over budget if a single
+    /// frame needs more than the budget.
+    void EnforceBudget();
+
+    /// <summary>
+    /// Evicts the asset right away, whether or not it's over budget. It's loaded again the next time it's used.
+    /// </summary>
+    /// <returns>The memory that was freed</returns>
+    ResidentSize Release(Asset* asset);
+
+    /// Drops every managed asset, waiting for background loads. Call before the assets are destroyed.
+    void Clear();
+
+    uint64_t GetCpuUsage() const { return usage.cpu; }
+    uint64_t GetGpuUsage() const { return usage.gpu; }
+    size_t GetManagedCount() const;
+    size_t GetResidentCount() const;
+    int GetLoadCount() const { return loads; }
+    int GetEvictionCount() const { return evictions; }
+
+ private:
+    enum class State { Evicted, Queued, Decoding, Resident, Failed };
+
+    struct Entry {
+        Asset* asset = nullptr;
+        std::unique_ptr<ResidentLoader> loader;
+        State state = State::Evicted;
+        std::shared_future<bool> decoding;
+        // Decoding in the background, rather than by a thread waiting in Touch
+        bool background = false;
+        ResidentSize size;
+        uint64_t last_used = 0;
+        // Only evicted when released
+        bool pinned = false;
+    };
+
+    bool MakeResident(std::unique_lock<std::mutex>& lock, Asset* asset);
+    void Queue(Entry& entry);
+    void FinishDecode(Entry& entry, bool decoded);
+    void Evict(Entry& entry);
+    bool OverBudget() const;
+
+    mutable std::mutex mutex;
+    std::unordered_map<const Asset*, Entry> entries;
+    ResidencyBudget budget;
+    ResidentSize usage;
+    uint64_t frame = 1;
+    int loads = 0;
+    int evictions = 0;
+    // Assets waiting for a background load, oldest request first
+    std::vector<Entry*> queue;
+    int decodes_in_flight = 0;
+    // Keeps a burst of requests from starting a thread for every asset at once
+    static constexpr int max_decodes_in_flight = 2;
+};
+}  // namespace cqsp::asset
@@ -0,0 +1,154 @@
+/* Conquer Space
+ * Copyright (C) 2021-2023 Conquer Space
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "engine/asset/vfs/blockcompression.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+namespace cqsp::asset {
+namespace {
+constexpr int hash_bits = 16;
+constexpr size_t min_match = 4;
+constexpr size_t max_offset = 65535;
+// The format needs the end of the block to be literals
+constexpr size_t end_literals = 5;
+constexpr size_t match_start_limit = 12;
+
+uint32_t Read32(const uint8_t* data) {
+    uint32_t value;
+    std::memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+void WriteLength(std::vector<uint8_t>& out, size_t length) {
+    while (length >= 255) {
+        out.push_back(255);
+        length -= 255;
+    }
+    out.push_back(static_cast<uint8_t>(length));
+}
+
+/// Writes the literals in [begin, begin + literal_length), followed by a match if match_length is not 0
+void WriteSequence(std::vector<uint8_t>& out, const uint8_t* literals, size_t literal_length, size_t offset,
+                   size_t match_length) {
+    size_t match_code = match_length == 0 ? 0 : match_length - min_match;
+    uint8_t token =
+        static_cast<uint8_t>((std::min<size_t>(literal_length, 15) << 4) | std::min<size_t>(match_code, 15));
+    out.push_back(token);
+    if (literal_length >= 15) {
+        WriteLength(out, literal_length - 15);
+    }
+    out.insert(out.end(), literals, literals + literal_length);
+    if (match_length == 0) {
+        return;
+    }
+    out.push_back(static_cast<uint8_t>(offset & 0xFF));
+    out.push_back(static_cast<uint8_t>(offset >> 8));
+    if (match_code >= 15) {
+        WriteLength(out, match_code - 15);
+    }
+}
+
+bool ReadLength(std::span<const uint8_t> input, size_t& ip, size_t& length) {
+    uint8_t byte;
+    do {
+        if (ip >= input.size()) {
+            return false;
+        }
+        byte = input[ip++];
+        length += byte;
+    } while (byte == 255);
+    return true;
+}
+}  // namespace
+
+std::vector<uint8_t> CompressBlock(std::span<const uint8_t> input) {
+    std::vector<uint8_t> out;
+    out.reserve(input.size() / 2 + 16);
+    const uint8_t* data = input.data();
+    const size_t size = input.size();
+
+    std::vector<uint32_t> table(1 << hash_bits, std::numeric_limits<uint32_t>::max());
+    size_t anchor = 0;
+    size_t i = 0;
+    const size_t limit = size < match_start_limit ? 0 : size - match_start_limit;
+    while (i < limit) {
+        uint32_t sequence = Read32(data + i);
+        uint32_t hash = (sequence * 2654435761u) >> (32 - hash_bits);
+        uint32_t candidate = table[hash];
+        table[hash] = static_cast<uint32_t>(i);
+        if (candidate == std::numeric_limits<uint32_t>::max() || i - candidate > max_offset ||
+            Read32(data + candidate) != sequence) {
+            i++;
+            continue;
+        }
+        size_t length = min_match;
+        while (i + length < size - end_literals && data[candidate + length] == data[i + length]) {
+            length++;
+        }
+        WriteSequence(out, data + anchor, i - anchor, i - candidate, length);
+        i += length;
+        anchor = i;
+    }
+    // Everything that is left over goes into the last sequence
+    WriteSequence(out, data + anchor, size - anchor, 0, 0);
+    return out;
+}
+
+bool DecompressBlock(std::span<const uint8_t> input, std::span<uint8_t> output) {
+    size_t ip = 0;
+    size_t op = 0;
+    while (ip < input.size()) {
+        uint8_t token = input[ip++];
+        size_t literal_length = token >> 4;
+        if (literal_length == 15 && !ReadLength(input, ip, literal_length)) {
+            return false;
+        }
+        if (literal_length > input.size() - ip || literal_length > output.size() - op) {
+            return false;
+        }
+        std::memcpy(output.data() + op, input.data() + ip, literal_length);
+        ip += literal_length;
+        op += literal_length;
+        if (ip == input.size()) {
+            // The last sequence has no match
+            break;
+        }
+
+        if (input.size() - ip < 2) {
+            return false;
+        }
+        size_t offset = input[ip] | (input[ip + 1] << 8);
+        ip += 2;
+        size_t match_length = token & 0xF;
+        if (match_length == 15 && !ReadLength(input, ip, match_length)) {
+            return false;
+        }
+        match_length += min_match;
+        if (offset == 0 || offset > op || match_length > output.size() - op) {
+            return false;
+        }
+        // Matches can overlap with the output they're copying, so copy byte by byte
+        for (size_t k = 0; k < match_length; k++) {
+            output[op + k] = output[op - offset + k];
+        }
+        op += match_length;
+    }
+    return op == output.size();
+}
+}  // namespace cqsp::asset
@@ -0,0 +1,37 @@
+/* Conquer Space
+ * Copyright (C) 2021-2023 Conquer Space
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace cqsp::asset {
+/// <summary>
+/// Compresses a block of data with a small LZ77 compressor, in the LZ4 block format.
+/// </summary>
+/// It compresses worse than zlib, but decompresses at memory speed, which matters more for
+/// assets that are loaded on every startup.
+std::vector<uint8_t> CompressBlock(std::span<const uint8_t> input);
+
+/// <summary>
+/// Decompresses a block made by @ref CompressBlock.
+/// </summary>
+/// <param name="output">Buffer with exactly the size of the uncompressed data</param>
+/// <returns>false if the block is corrupt or doesn't fill up `output`</returns>
+bool DecompressBlock(std::span<const uint8_t> input, std::span<uint8_t> output);
+}  // namespace cqsp::asset
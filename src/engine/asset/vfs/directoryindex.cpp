@@ -0,0 +1,84 @@
+/* Conquer Space
+ * Copyright (C) 2021-2023 Conquer Space
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "engine/asset/vfs/directoryindex.h"
+
+#include <algorithm>
+#include <filesystem>
+
+#include <tracy/Tracy.hpp>
+
+#include "engine/asset/vfs/vfs.h"
+
+namespace cqsp::asset {
+bool DirectoryIndex::Build(const std::string& root) {
+    ZoneScoped;
+    Clear();
+    std::error_code ec;
+    std::filesystem::recursive_directory_iterator it(root, ec);
+    if (ec) {
+        return false;
+    }
+    nodes.emplace("", Node {true, 0});
+    for (const std::filesystem::recursive_directory_iterator end; it != end; it.increment(ec)) {
+        if (ec) {
+            break;
+        }
+        const auto& dir_entry = *it;
+        std::string path = NormalizePath(dir_entry.path().lexically_relative(root).generic_string());
+        // The status is cached by the iterator on most platforms, so these don't go back to the disk
+        if (dir_entry.is_directory(ec)) {
+            nodes.emplace(std::move(path), Node {true, 0});
+        } else if (dir_entry.is_regular_file(ec)) {
+            uint64_t size = dir_entry.file_size(ec);
+            nodes.emplace(path, Node {false, ec ? 0 : size});
+            files.push_back(std::move(path));
+        }
+    }
+    std::sort(files.begin(), files.end());
+    built = true;
+    return true;
+}
+
+void DirectoryIndex::Clear() {
+    nodes.clear();
+    files.clear();
+    built = false;
+}
+
+const DirectoryIndex::Node* DirectoryIndex::Find(std::string_view path) const {
+    auto it = nodes.find(path);
+    if (it == nodes.end()) {
+        return nullptr;
+    }
+    return &it->second;
+}
+
+std::vector<std::string> DirectoryIndex::ListFiles(std::string_view directory) const {
+    std::vector<std::string> result;
+    std::string prefix(directory);
+    if (!prefix.empty()) {
+        prefix += '/';
+    }
+    for (auto it = std::lower_bound(files.begin(), files.end(), prefix); it != files.end(); ++it) {
+        if (!it->starts_with(prefix)) {
+            break;
+        }
+        result.push_back(it->substr(prefix.size()));
+    }
+    return result;
+}
+}  // namespace cqsp::asset
@@ -0,0 +1,72 @@
+/* Conquer Space
+ * Copyright (C) 2021-2023 Conquer Space
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace cqsp::asset {
+/// <summary>
+/// Index of every file and directory under a directory on disk, built with a single walk.
+/// </summary>
+/// Paths are normalized with @ref NormalizePath and relative to the root, and the root itself is
+/// the empty path. The index doesn't see changes made on disk after it was built, so call `Build`
+/// again when files change.
+class DirectoryIndex {
+ public:
+    struct Node {
+        bool directory = false;
+        // Size of the file in bytes, 0 for directories
+        uint64_t size = 0;
+    };
+
+    /// <summary>
+    /// Walks the directory and replaces the contents of the index with what is there.
+    /// </summary>
+    /// <returns>false if root isn't a directory, and the index is left empty</returns>
+    bool Build(const std::string& root);
+    void Clear();
+
+    bool IsBuilt() const { return built; }
+
+    /// <summary>
+    /// Finds a normalized path, or returns nullptr if nothing is there.
+    /// </summary>
+    const Node* Find(std::string_view path) const;
+
+    /// <summary>
+    /// Lists every file under the directory, recursively, relative to the directory.
+    /// </summary>
+    std::vector<std::string> ListFiles(std::string_view directory) const;
+
+    size_t size() const { return nodes.size(); }
+
+ private:
+    struct StringHash {
+        using is_transparent = void;
+        size_t operator()(std::string_view str) const { return std::hash<std::string_view>()(str); }
+    };
+
+    std::unordered_map<std::string, Node, StringHash, std::equal_to<>> nodes;
+    // Every file path in sorted order, so a directory listing is one range
+    std::vector<std::string> files;
+    bool built = false;
+};
+}  // namespace cqsp::asset
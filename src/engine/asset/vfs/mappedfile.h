@@ -0,0 +1,55 @@
+/* Conquer Space
+ * Copyright (C) 2021-2023 Conquer Space
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <string>
+
+namespace cqsp {
+namespace asset {
+/// <summary>
+/// Read only memory mapping of a whole file.
+/// </summary>
+/// The mapping is released when the object is destroyed, so views into it must not outlive it.
+class MappedFile {
+ public:
+    MappedFile() = default;
+    explicit MappedFile(const std::string& path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    /// <summary>
+    /// True if the file was mapped. Empty files count as mapped, with an empty view.
+    /// </summary>
+    bool IsOpen() const { return is_open; }
+    std::span<const uint8_t> View() const { return std::span<const uint8_t>(data, size); }
+    uint64_t Size() const { return size; }
+
+ private:
+    void Close();
+
+    const uint8_t* data = nullptr;
+    uint64_t size = 0;
+    bool is_open = false;
+};
+}  // namespace asset
+}  // namespace cqsp
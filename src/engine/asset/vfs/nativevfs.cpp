@@ -26,6 +26,14 @@
 
 cqsp::asset::NativeFileSystem::NativeFileSystem(std::string _root) : root(std::move(_root)) {}
 
+bool cqsp::asset::NativeFileSystem::Initialize() { return index.Build(root); }
+
+void cqsp::asset::NativeFileSystem::Invalidate() {
+    if (index.IsBuilt()) {
+        index.Build(root);
+    }
+}
+
 std::shared_ptr<cqsp::asset::IVirtualFile> cqsp::asset::NativeFileSystem::Open(const std::string& file_path,
                                                                                FileModes modes) {
     std::string file_pos = file_path;
@@ -42,30 +50,46 @@ std::shared_ptr<cqsp::asset::IVirtualFile> cqsp::asset::NativeFileSystem::Open(c
     if (!file_name.empty() && file_name.at(0) == '/') {
         file_name = file_name.erase(0, 1);
     }
-    std::shared_ptr<NativeFile> nfile = std::make_shared<NativeFile>(this, file_name);
-    // Always open binary for carrige return purposes.
-    // TODO(EhWhoAmI): Make this able to read text without carrige return.
-    nfile->file.open(path, std::ios::binary);
-    // Get the size
-    nfile->file.seekg(0, std::ios::end);
-    nfile->size = nfile->file.tellg();
-    nfile->file.seekg(0);
-
-    // Check if file is good, and return pointer to file
-    if (nfile->file.good()) {
-        return nfile;
+    // Get the size, this also fails if it isn't a regular file
+    uint64_t size = 0;
+    if (index.IsBuilt()) {
+        const DirectoryIndex::Node* node = index.Find(NormalizePath(file_pos));
+        if (node == nullptr || node->directory) {
+            return nullptr;
+        }
+        size = node->size;
     } else {
-        return nullptr;
+        std::error_code ec;
+        size = std::filesystem::file_size(path, ec);
+        if (ec) {
+            return nullptr;
+        }
     }
+    std::shared_ptr<NativeFile> nfile = std::make_shared<NativeFile>(this, file_name);
+    nfile->native_path = std::move(path);
+    nfile->size = size;
+    return nfile;
 }
 
 void cqsp::asset::NativeFileSystem::Close(std::shared_ptr<IVirtualFile>& vf) {
     // Cast the pointer
     NativeFile* f = dynamic_cast<NativeFile*>(vf.get());
     f->file.close();
+    f->mapping = MappedFile();
 }
 
 std::shared_ptr<cqsp::asset::IVirtualDirectory> cqsp::asset::NativeFileSystem::OpenDirectory(const std::string& dir) {
+    if (index.IsBuilt()) {
+        std::string normalized = NormalizePath(dir);
+        const DirectoryIndex::Node* node = index.Find(normalized);
+        if (node == nullptr || !node->directory) {
+            return nullptr;
+        }
+        std::shared_ptr<NativeDirectory> native_dir = std::make_shared<NativeDirectory>(this, dir);
+        native_dir->paths = index.ListFiles(normalized);
+        return native_dir;
+    }
+
     // get the directory
     std::string path = std::filesystem::absolute(std::filesystem::path(root) / dir).string();
     if (!std::filesystem::is_directory(path)) {
@@ -95,14 +119,25 @@ std::shared_ptr<cqsp::asset::IVirtualDirectory> cqsp::asset::NativeFileSystem::O
 }
 
 bool cqsp::asset::NativeFileSystem::IsFile(const std::string& path) {
+    if (index.IsBuilt()) {
+        const DirectoryIndex::Node* node = index.Find(NormalizePath(path));
+        return node != nullptr && !node->directory;
+    }
     return std::filesystem::is_regular_file(std::filesystem::path(root) / path);
 }
 
 bool cqsp::asset::NativeFileSystem::IsDirectory(const std::string& path) {
+    if (index.IsBuilt()) {
+        const DirectoryIndex::Node* node = index.Find(NormalizePath(path));
+        return node != nullptr && node->directory;
+    }
     return std::filesystem::is_directory(std::filesystem::path(root) / path);
 }
 
 bool cqsp::asset::NativeFileSystem::Exists(const std::string& path) {
+    if (index.IsBuilt()) {
+        return index.Find(NormalizePath(path)) != nullptr;
+    }
     return std::filesystem::exists(std::filesystem::path(root) / path);
 }
 
@@ -110,10 +145,19 @@ const std::string& cqsp::asset::NativeFile::Path() { return path; }
 
 uint64_t cqsp::asset::NativeFile::Size() { return size; }
 
+std::ifstream& cqsp::asset::NativeFile::Stream() {
+    if (!file.is_open()) {
+        // Always open binary for carrige return purposes.
+        // TODO(EhWhoAmI): Make this able to read text without carrige return.
+        file.open(native_path, std::ios::binary);
+    }
+    return file;
+}
+
 void cqsp::asset::NativeFile::Read(uint8_t* buffer, int num_bytes) {
     // Text mode is mildly screwed up, because of carrige return on windows.
     // Flawfinder: ignore
-    file.read(reinterpret_cast<char*>(buffer), static_cast<std::streamsize>(num_bytes));
+    Stream().read(reinterpret_cast<char*>(buffer), static_cast<std::streamsize>(num_bytes));
 }
 
 bool cqsp::asset::NativeFile::Seek(long offset, Offset origin) {
@@ -129,11 +173,18 @@ bool cqsp::asset::NativeFile::Seek(long offset, Offset origin) {
             seek = std::ios_base::end;
             break;
     }
-    file.seekg(offset, seek);
+    Stream().seekg(offset, seek);
     return true;
 }
 
-uint64_t cqsp::asset::NativeFile::Tell() { return file.tellg(); }
+uint64_t cqsp::asset::NativeFile::Tell() { return Stream().tellg(); }
+
+std::span<const uint8_t> cqsp::asset::NativeFile::Map() {
+    if (!mapping.IsOpen()) {
+        mapping = MappedFile(native_path);
+    }
+    return mapping.View();
+}
 
 uint64_t cqsp::asset::NativeDirectory::GetSize() { return paths.size(); }
 
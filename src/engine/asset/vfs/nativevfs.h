@@ -21,6 +21,8 @@
 #include <string>
 #include <vector>
 
+#include "engine/asset/vfs/directoryindex.h"
+#include "engine/asset/vfs/mappedfile.h"
 #include "engine/asset/vfs/vfs.h"
 
 namespace cqsp {
@@ -42,15 +44,22 @@ class NativeFile : public IVirtualFile {
 
     bool Seek(long offset, Offset origin) override;
     uint64_t Tell() override;
+    std::span<const uint8_t> Map() override;
 
     IVirtualFileSystem* GetFileSystem() override { return reinterpret_cast<IVirtualFileSystem*>(nfs); }
 
     friend NativeFileSystem;
 
  private:
+    /// Opens the stream the first time it is needed, files that are only mapped never open it
+    std::ifstream& Stream();
+
     std::string path;
+    // Path on the disk
+    std::string native_path;
     std::ifstream file;
-    int size;
+    uint64_t size;
+    MappedFile mapping;
 
     NativeFileSystem* const nfs;
 };
@@ -60,7 +69,11 @@ class NativeFileSystem : public IVirtualFileSystem {
     explicit NativeFileSystem(std::string root);
     ~NativeFileSystem() = default;
 
-    bool Initialize() override { return true; }
+    /// <summary>
+    /// Indexes the directory, so that lookups are answered from memory instead of asking the OS
+    /// every time. Without this, every lookup goes to the disk.
+    /// </summary>
+    bool Initialize() override;
 
     std::shared_ptr<IVirtualFile> Open(const std::string& path, FileModes) override;
     void Close(std::shared_ptr<IVirtualFile>&) override;
@@ -69,10 +82,15 @@ class NativeFileSystem : public IVirtualFileSystem {
     bool IsFile(const std::string& path) override;
     bool IsDirectory(const std::string& path) override;
     bool Exists(const std::string& path) override;
+    /// <summary>
+    /// Rebuilds the index if there is one.
+    /// </summary>
+    void Invalidate() override;
     const std::string& GetRoot() { return root; }
 
  private:
     std::string root;
+    DirectoryIndex index;
     friend NativeDirectory;
 };
 
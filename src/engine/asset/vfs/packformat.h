@@ -0,0 +1,71 @@
+/* Conquer Space
+ * Copyright (C) 2021-2023 Conquer Space
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+
+namespace cqsp::asset::pack {
+// Layout of a pack file, all values are little endian:
+//
+// Header
+// Entry data, each entry aligned to `Header::alignment`
+// Hash buckets, `bucket_count` indices of the first entry in each bucket
+// Entries, sorted by path
+// Path names, not null terminated
+constexpr char magic[4] = {'C', 'Q', 'P', 'K'};
+constexpr uint32_t version = 1;
+constexpr uint32_t empty_bucket = 0xFFFFFFFF;
+
+enum EntryFlags : uint32_t {
+    Compressed = 1 << 0  // Data is compressed with @ref CompressBlock
+};
+
+struct Header {
+    char magic[4];
+    uint32_t version;
+    uint32_t entry_count;
+    // Always a power of two
+    uint32_t bucket_count;
+    uint64_t buckets_offset;
+    uint64_t entries_offset;
+    uint64_t names_offset;
+    uint64_t names_size;
+    uint32_t alignment;
+    uint32_t reserved[3];
+};
+
+struct Entry {
+    uint64_t hash;
+    uint64_t offset;
+    // Size of the file
+    uint64_t size;
+    // Size of the data in the pack, which is different from `size` if it's compressed
+    uint64_t stored_size;
+    uint32_t name_offset;
+    uint32_t name_length;
+    uint32_t flags;
+    // Next entry in the same hash bucket
+    uint32_t next;
+};
+
+static_assert(sizeof(Header) == 64, "Pack header has to be 64 bytes");
+static_assert(sizeof(Entry) == 48, "Pack entries have to be 48 bytes");
+
+/// FNV-1a hash of a normalized path
+uint64_t HashPath(std::string_view path);
+}  // namespace cqsp::asset::pack
@@ -0,0 +1,208 @@
+/* Conquer Space
+ * Copyright (C) 2021-2023 Conquer Space
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "engine/asset/vfs/packvfs.h"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+#include <tracy/Tracy.hpp>
+
+#include "engine/asset/vfs/blockcompression.h"
+#include "engine/enginelogger.h"
+
+namespace cqsp::asset {
+void PackFile::Read(uint8_t* buffer, int num_bytes) {
+    std::span<const uint8_t> data = Map();
+    if (num_bytes <= 0 || position >= data.size()) {
+        return;
+    }
+    size_t count = std::min<uint64_t>(num_bytes, data.size() - position);
+    std::memcpy(buffer, data.data() + position, count);
+    position += count;
+}
+
+bool PackFile::Seek(long offset, Offset origin) {
+    int64_t base = 0;
+    switch (origin) {
+        case Offset::Beg:
+            base = 0;
+            break;
+        case Offset::Cur:
+            base = static_cast<int64_t>(position);
+            break;
+        case Offset::End:
+            base = static_cast<int64_t>(entry.size);
+            break;
+    }
+    int64_t target = base + offset;
+    if (target < 0 || target > static_cast<int64_t>(entry.size)) {
+        return false;
+    }
+    position = static_cast<uint64_t>(target);
+    return true;
+}
+
+std::span<const uint8_t> PackFile::Map() {
+    std::span<const uint8_t> stored = pfs->GetStoredData(entry);
+    if ((entry.flags & pack::Compressed) == 0) {
+        return stored;
+    }
+    if (!is_decompressed) {
+        decompressed.resize(entry.size);
+        if (!DecompressBlock(stored, decompressed)) {
+            ENGINE_LOG_ERROR("Pack entry {} is corrupt", path);
+            decompressed.clear();
+        }
+        is_decompressed = true;
+    }
+    return decompressed;
+}
+
+IVirtualFileSystem* PackFile::GetFileSystem() { return pfs; }
+
+PackFileSystem::PackFileSystem(std::string _pack_path) : pack_path(std::move(_pack_path)) {}
+
+bool PackFileSystem::Initialize() {
+    ZoneScoped;
+    mapping = MappedFile(pack_path);
+    std::span<const uint8_t> data = mapping.View();
+    auto fail = [&](const char* reason) {
+        ENGINE_LOG_ERROR("Cannot load pack {}: {}", pack_path, reason);
+        mapping = MappedFile();
+        buckets = {};
+        entries = {};
+        names = {};
+        directories.clear();
+        return false;
+    };
+    if (data.size() < sizeof(pack::Header)) {
+        return fail("file is too small");
+    }
+    const auto* header = reinterpret_cast<const pack::Header*>(data.data());
+    if (std::memcmp(header->magic, pack::magic, sizeof(pack::magic)) != 0) {
+        return fail("not a pack file");
+    }
+    if (header->version != pack::version) {
+        return fail("unsupported version");
+    }
+    auto in_bounds = [&](uint64_t offset, uint64_t size) {
+        return offset <= data.size() && size <= data.size() - offset;
+    };
+    if (header->bucket_count == 0 || (header->bucket_count & (header->bucket_count - 1)) != 0 ||
+        !in_bounds(header->buckets_offset, uint64_t {header->bucket_count} * sizeof(uint32_t)) ||
+        !in_bounds(header->entries_offset, uint64_t {header->entry_count} * sizeof(pack::Entry)) ||
+        !in_bounds(header->names_offset, header->names_size)) {
+        return fail("table of contents is out of bounds");
+    }
+    buckets = std::span<const uint32_t>(reinterpret_cast<const uint32_t*>(data.data() + header->buckets_offset),
+                                        header->bucket_count);
+    entries = std::span<const pack::Entry>(
+        reinterpret_cast<const pack::Entry*>(data.data() + header->entries_offset), header->entry_count);
+    names = std::string_view(reinterpret_cast<const char*>(data.data() + header->names_offset), header->names_size);
+
+    directories.clear();
+    directories.emplace("");
+    for (const auto& entry : entries) {
+        if (!in_bounds(entry.offset, entry.stored_size) || entry.name_offset > names.size() ||
+            entry.name_length > names.size() - entry.name_offset ||
+            (entry.next != pack::empty_bucket && entry.next >= entries.size())) {
+            return fail("entry is out of bounds");
+        }
+        std::string_view name = GetName(entry);
+        for (size_t slash = name.find('/'); slash != std::string_view::npos; slash = name.find('/', slash + 1)) {
+            directories.emplace(name.substr(0, slash));
+        }
+    }
+    ENGINE_LOG_INFO("Loaded pack {} with {} files", pack_path, entries.size());
+    return true;
+}
+
+const pack::Entry* PackFileSystem::Find(std::string_view path) const {
+    if (buckets.empty()) {
+        return nullptr;
+    }
+    uint64_t hash = pack::HashPath(path);
+    uint32_t index = buckets[hash & (buckets.size() - 1)];
+    // Chains are bounded by the entry count, so a corrupt pack can't loop forever
+    for (size_t steps = 0; index != pack::empty_bucket && steps < entries.size(); steps++) {
+        const pack::Entry& entry = entries[index];
+        if (entry.hash == hash && GetName(entry) == path) {
+            return &entry;
+        }
+        index = entry.next;
+    }
+    return nullptr;
+}
+
+std::string_view PackFileSystem::GetName(const pack::Entry& entry) const {
+    return names.substr(entry.name_offset, entry.name_length);
+}
+
+std::span<const uint8_t> PackFileSystem::GetStoredData(const pack::Entry& entry) const {
+    return mapping.View().subspan(entry.offset, entry.stored_size);
+}
+
+std::shared_ptr<IVirtualFile> PackFileSystem::Open(const std::string& path, FileModes modes) {
+    std::string name = NormalizePath(path);
+    const pack::Entry* entry = Find(name);
+    if (entry == nullptr) {
+        return nullptr;
+    }
+    return std::make_shared<PackFile>(this, std::move(name), *entry);
+}
+
+void PackFileSystem::Close(std::shared_ptr<IVirtualFile>&) {
+    // Nothing to do, the data belongs to the pack
+}
+
+std::shared_ptr<IVirtualDirectory> PackFileSystem::OpenDirectory(const std::string& dir) {
+    std::string root = NormalizePath(dir);
+    if (!directories.contains(root)) {
+        return nullptr;
+    }
+    auto pack_dir = std::make_shared<PackDirectory>(this, dir);
+    std::string prefix = root.empty() ? root : root + '/';
+    // Entries are sorted by path, so everything in the directory is in one range
+    auto it = std::lower_bound(entries.begin(), entries.end(), prefix, [&](const pack::Entry& entry, const auto& p) {
+        return GetName(entry) < std::string_view(p);
+    });
+    for (; it != entries.end(); ++it) {
+        std::string_view name = GetName(*it);
+        if (!name.starts_with(prefix)) {
+            break;
+        }
+        pack_dir->paths.emplace_back(name.substr(prefix.size()));
+    }
+    return pack_dir;
+}
+
+bool PackFileSystem::IsFile(const std::string& path) { return Find(NormalizePath(path)) != nullptr; }
+
+bool PackFileSystem::IsDirectory(const std::string& path) {
+    return directories.contains(NormalizePath(path));
+}
+
+bool PackFileSystem::Exists(const std::string& path) {
+    std::string name = NormalizePath(path);
+    return Find(name) != nullptr || directories.contains(name);
+}
+
+std::shared_ptr<IVirtualFile> PackDirectory::GetFile(int index, FileModes modes) {
+    return pfs->Open(root + "/" + paths[index], modes);
+}
+}  // namespace cqsp::asset
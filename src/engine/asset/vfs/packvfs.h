@@ -0,0 +1,124 @@
+/* Conquer Space
+ * Copyright (C) 2021-2023 Conquer Space
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "engine/asset/vfs/mappedfile.h"
+#include "engine/asset/vfs/packformat.h"
+#include "engine/asset/vfs/vfs.h"
+
+namespace cqsp {
+namespace asset {
+class PackFileSystem;
+
+class PackFile : public IVirtualFile {
+ public:
+    PackFile(PackFileSystem* _pfs, std::string _path, const pack::Entry& _entry)
+        : pfs(_pfs), path(std::move(_path)), entry(_entry) {}
+
+    const std::string& Path() override { return path; }
+    uint64_t Size() override { return entry.size; }
+
+    void Read(uint8_t* buffer, int num_bytes) override;
+    bool Seek(long offset, Offset origin) override;
+    uint64_t Tell() override { return position; }
+
+    /// <summary>
+    /// Uncompressed entries are a view straight into the pack. Compressed entries are decompressed
+    /// the first time they are read or mapped.
+    /// </summary>
+    std::span<const uint8_t> Map() override;
+
+    IVirtualFileSystem* GetFileSystem() override;
+
+ private:
+    PackFileSystem* const pfs;
+    std::string path;
+    const pack::Entry& entry;
+    uint64_t position = 0;
+    std::vector<uint8_t> decompressed;
+    bool is_decompressed = false;
+};
+
+/// <summary>
+/// Read only filesystem over a single pack file made by @ref WritePack.
+/// </summary>
+/// The whole pack is mapped into memory when it is initialized, and paths are looked up in the
+/// hash table in the pack, so opening files doesn't touch the disk.
+class PackFileSystem : public IVirtualFileSystem {
+ public:
+    explicit PackFileSystem(std::string pack_path);
+
+    /// <summary>
+    /// Maps and validates the pack. If this fails, the filesystem acts as if it's empty.
+    /// </summary>
+    bool Initialize() override;
+
+    std::shared_ptr<IVirtualFile> Open(const std::string& path, FileModes modes = None) override;
+    void Close(std::shared_ptr<IVirtualFile>&) override;
+    std::shared_ptr<IVirtualDirectory> OpenDirectory(const std::string& dir) override;
+
+    bool IsFile(const std::string& path) override;
+    bool IsDirectory(const std::string& path) override;
+    bool Exists(const std::string& path) override;
+
+    const std::string& GetPackPath() { return pack_path; }
+    size_t GetEntryCount() const { return entries.size(); }
+
+    /// <summary>
+    /// Finds the entry of a normalized path, or returns nullptr if it isn't in the pack.
+    /// </summary>
+    const pack::Entry* Find(std::string_view path) const;
+    std::string_view GetName(const pack::Entry& entry) const;
+    /// Data of the entry as it is stored in the pack
+    std::span<const uint8_t> GetStoredData(const pack::Entry& entry) const;
+
+ private:
+    std::string pack_path;
+    MappedFile mapping;
+    std::span<const uint32_t> buckets;
+    std::span<const pack::Entry> entries;
+    std::string_view names;
+    // Every directory that has a file in it, including the parents
+    std::unordered_set<std::string> directories;
+};
+
+class PackDirectory : public IVirtualDirectory {
+ public:
+    PackDirectory(PackFileSystem* _pfs, std::string _root) : root(std::move(_root)), pfs(_pfs) {}
+
+    uint64_t GetSize() override { return paths.size(); }
+    const std::string& GetRoot() override { return root; }
+    std::shared_ptr<IVirtualFile> GetFile(int index, FileModes modes) override;
+    const std::string& GetFilename(int index) override { return paths[index]; }
+    IVirtualFileSystem* GetFileSystem() override { return pfs; }
+
+ private:
+    friend PackFileSystem;
+    std::vector<std::string> paths;
+    std::string root;
+    PackFileSystem* const pfs;
+};
+}  // namespace asset
+}  // namespace cqsp
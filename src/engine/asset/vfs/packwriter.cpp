@@ -0,0 +1,197 @@
+/* Conquer Space
+ * Copyright (C) 2021-2023 Conquer Space
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "engine/asset/vfs/packwriter.h"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <span>
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "engine/asset/vfs/blockcompression.h"
+#include "engine/asset/vfs/mappedfile.h"
+#include "engine/asset/vfs/packformat.h"
+#include "engine/asset/vfs/vfs.h"
+#include "engine/enginelogger.h"
+
+namespace cqsp::asset {
+namespace {
+bool IsCompressible(const std::filesystem::path& path) {
+    // Images and audio are already compressed, so only text is worth it
+    static const std::unordered_set<std::string> text_extensions = {
+        ".hjson", ".json", ".lua", ".txt", ".md", ".vert", ".frag", ".geom", ".rml", ".rcss", ".csv", ".svg"};
+    std::string extension = path.extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return text_extensions.contains(extension);
+}
+
+void Pad(std::ofstream& out, uint64_t& offset, uint32_t alignment) {
+    static const char zeros[64] = {};
+    uint64_t padding = (alignment - offset % alignment) % alignment;
+    while (padding > 0) {
+        uint64_t count = std::min<uint64_t>(padding, sizeof(zeros));
+        out.write(zeros, static_cast<std::streamsize>(count));
+        padding -= count;
+        offset += count;
+    }
+}
+
+template <typename T>
+void Write(std::ofstream& out, uint64_t& offset, std::span<const T> data) {
+    out.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size_bytes()));
+    offset += data.size_bytes();
+}
+}  // namespace
+
+bool WritePack(const std::string& directory, const std::string& output, const PackWriterOptions& options) {
+    namespace fs = std::filesystem;
+    std::error_code ec;
+    if (!fs::is_directory(directory, ec)) {
+        ENGINE_LOG_ERROR("Cannot pack {}: not a directory", directory);
+        return false;
+    }
+    if (options.alignment == 0 || (options.alignment & (options.alignment - 1)) != 0 || options.alignment > 4096) {
+        ENGINE_LOG_ERROR("Pack alignment {} has to be a power of two up to 4096", options.alignment);
+        return false;
+    }
+
+    fs::path output_path = fs::absolute(output);
+    fs::path temp_path = output_path;
+    temp_path += ".tmp";
+
+    struct Source {
+        std::string name;
+        fs::path path;
+    };
+    std::vector<Source> sources;
+    for (const auto& dir_entry : fs::recursive_directory_iterator(directory)) {
+        if (!dir_entry.is_regular_file()) {
+            continue;
+        }
+        // Don't pack the pack if it's being written into the directory
+        fs::path absolute = fs::absolute(dir_entry.path());
+        if (absolute == output_path || absolute == temp_path) {
+            continue;
+        }
+        std::string name = NormalizePath(dir_entry.path().lexically_relative(directory).generic_string());
+        sources.push_back(Source {std::move(name), dir_entry.path()});
+    }
+    std::sort(sources.begin(), sources.end(), [](const Source& a, const Source& b) { return a.name < b.name; });
+
+    std::ofstream out(temp_path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        ENGINE_LOG_ERROR("Cannot write pack {}", temp_path.string());
+        return false;
+    }
+
+    pack::Header header {};
+    std::memcpy(header.magic, pack::magic, sizeof(pack::magic));
+    header.version = pack::version;
+    header.alignment = options.alignment;
+    uint64_t offset = 0;
+    // Filled in at the end, when the offsets are known
+    Write(out, offset, std::span<const pack::Header>(&header, 1));
+
+    std::vector<pack::Entry> entries;
+    entries.reserve(sources.size());
+    std::string names;
+    uint64_t total_size = 0;
+    for (const auto& source : sources) {
+        MappedFile file(source.path.string());
+        if (!file.IsOpen()) {
+            ENGINE_LOG_ERROR("Cannot read {}", source.path.string());
+            out.close();
+            fs::remove(temp_path, ec);
+            return false;
+        }
+        std::span<const uint8_t> data = file.View();
+
+        pack::Entry entry {};
+        entry.hash = pack::HashPath(source.name);
+        entry.size = data.size();
+        entry.name_offset = static_cast<uint32_t>(names.size());
+        entry.name_length = static_cast<uint32_t>(source.name.size());
+        names += source.name;
+
+        std::vector<uint8_t> compressed;
+        if (options.compress && !data.empty() && IsCompressible(source.path)) {
+            compressed = CompressBlock(data);
+            // Only keep it if it saves more than a tenth
+            if (compressed.size() < data.size() - data.size() / 10) {
+                data = compressed;
+                entry.flags |= pack::Compressed;
+            }
+        }
+
+        Pad(out, offset, options.alignment);
+        entry.offset = offset;
+        entry.stored_size = data.size();
+        Write(out, offset, data);
+        total_size += entry.size;
+        entries.push_back(entry);
+    }
+
+    // Chain the entries into the hash table. Going backwards keeps each chain in path order.
+    uint32_t bucket_count = 1;
+    while (bucket_count < entries.size() * 2) {
+        bucket_count <<= 1;
+    }
+    std::vector<uint32_t> buckets(bucket_count, pack::empty_bucket);
+    for (size_t i = entries.size(); i-- > 0;) {
+        uint32_t& bucket = buckets[entries[i].hash & (bucket_count - 1)];
+        entries[i].next = bucket;
+        bucket = static_cast<uint32_t>(i);
+    }
+
+    Pad(out, offset, alignof(pack::Entry));
+    header.bucket_count = bucket_count;
+    header.buckets_offset = offset;
+    Write(out, offset, std::span<const uint32_t>(buckets));
+
+    Pad(out, offset, alignof(pack::Entry));
+    header.entry_count = static_cast<uint32_t>(entries.size());
+    header.entries_offset = offset;
+    Write(out, offset, std::span<const pack::Entry>(entries));
+
+    header.names_offset = offset;
+    header.names_size = names.size();
+    Write(out, offset, std::span<const char>(names));
+
+    out.seekp(0);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.close();
+    if (!out) {
+        ENGINE_LOG_ERROR("Failed to write pack {}", temp_path.string());
+        fs::remove(temp_path, ec);
+        return false;
+    }
+    fs::rename(temp_path, output_path, ec);
+    if (ec) {
+        ENGINE_LOG_ERROR("Failed to move pack to {}: {}", output_path.string(), ec.message());
+        fs::remove(temp_path, ec);
+        return false;
+    }
+    ENGINE_LOG_INFO("Packed {} files ({} bytes) from {} into {} ({} bytes)", entries.size(), total_size, directory,
+                    output_path.string(), offset);
+    return true;
+}
+}  // namespace cqsp::asset
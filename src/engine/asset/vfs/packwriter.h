@@ -0,0 +1,38 @@
+/* Conquer Space
+ * Copyright (C) 2021-2023 Conquer Space
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+namespace cqsp::asset {
+struct PackWriterOptions {
+    // Compress text files when it makes them noticeably smaller
+    bool compress = false;
+    // Alignment of the data of each entry, has to be a power of two
+    uint32_t alignment = 16;
+};
+
+/// <summary>
+/// Packs every file under `directory` into a single pack file that @ref PackFileSystem can read.
+/// </summary>
+/// Paths in the pack are relative to `directory`. The pack is written to a temporary file first,
+/// so a failed write doesn't leave a broken pack behind.
+/// <returns>false if the directory can't be read or the pack can't be written</returns>
+bool WritePack(const std::string& directory, const std::string& output,
+               const PackWriterOptions& options = PackWriterOptions());
+}  // namespace cqsp::asset
@@ -16,7 +16,10 @@
  */
 #include "engine/asset/vfs/vfs.h"
 
+#include <algorithm>
 #include <cstring>
+#include <iterator>
+#include <string_view>
 
 namespace cqsp::asset {
 VirtualMounter::~VirtualMounter() {
@@ -26,99 +29,131 @@ VirtualMounter::~VirtualMounter() {
 }
 
 void VirtualMounter::AddMountPoint(const std::string& path, IVirtualFileSystem* fs) {
+    std::unique_lock lock(mount_mutex);
     mount_points[std::string(path)] = fs;
+    std::lock_guard cache_lock(cache_mutex);
+    resolve_cache.clear();
 }
 
-std::shared_ptr<IVirtualFile> VirtualMounter::Open(const std::string& path, FileModes mode) {
-    for (auto it = mount_points.begin(); it != mount_points.end(); it++) {
-        if (path.rfind(it->first, 0) == 0) {
-            // Then it's the mount point
-            // Remove the path string and the path separator, and get the path
-            // to get from the file system
-            std::string mount_path = path.substr(it->first.size() + 1, path.size());
-            return it->second->Open(mount_path, mode);
+VirtualMounter::Resolution VirtualMounter::Resolve(const std::string& path) {
+    // The caller holds mount_mutex
+    {
+        std::lock_guard lock(cache_mutex);
+        auto cached = resolve_cache.find(path);
+        if (cached != resolve_cache.end()) {
+            return cached->second;
+        }
+    }
+
+    Resolution resolution;
+    // Try the whole path first, and then every parent of it, so the longest mount point wins
+    std::string_view view(path);
+    size_t end = view.size();
+    while (true) {
+        auto it = mount_points.find(view.substr(0, end));
+        if (it != mount_points.end()) {
+            resolution.fs = it->second;
+            resolution.offset = std::min(end + 1, view.size());
+            break;
+        }
+        if (end == 0) {
+            break;
+        }
+        end = view.rfind('/', end - 1);
+        if (end == std::string_view::npos) {
+            break;
         }
     }
-    return nullptr;
+
+    std::lock_guard lock(cache_mutex);
+    if (resolve_cache.size() >= max_resolve_cache_size) {
+        resolve_cache.clear();
+    }
+    resolve_cache.emplace(path, resolution);
+    return resolution;
+}
+
+IVirtualFileSystem* VirtualMounter::FindMount(const std::string& mount) {
+    // The caller holds mount_mutex, so this can't add the mount point like operator[] would
+    auto it = mount_points.find(mount);
+    return it == mount_points.end() ? nullptr : it->second;
+}
+
+void VirtualMounter::Invalidate() {
+    std::unique_lock lock(mount_mutex);
+    {
+        std::lock_guard cache_lock(cache_mutex);
+        resolve_cache.clear();
+    }
+    for (auto& [mount, fs] : mount_points) {
+        fs->Invalidate();
+    }
+}
+
+std::shared_ptr<IVirtualFile> VirtualMounter::Open(const std::string& path, FileModes mode) {
+    std::shared_lock lock(mount_mutex);
+    Resolution resolution = Resolve(path);
+    if (resolution.fs == nullptr) {
+        return nullptr;
+    }
+    return resolution.fs->Open(path.substr(resolution.offset), mode);
 }
 
 std::shared_ptr<IVirtualFile> VirtualMounter::Open(const std::string& mount, const std::string& path, FileModes mode) {
-    return mount_points[mount]->Open(path, mode);
+    std::shared_lock lock(mount_mutex);
+    IVirtualFileSystem* fs = FindMount(mount);
+    return fs == nullptr ? nullptr : fs->Open(path, mode);
 }
 
 std::shared_ptr<IVirtualDirectory> VirtualMounter::OpenDirectory(const std::string& path) {
-    for (auto it = mount_points.begin(); it != mount_points.end(); it++) {
-        if (path.rfind(it->first, 0) != 0) {
-            continue;
-        }
-        // Then it's the mount point
-        // Remove the path string and the path separator, and get the path
-        // to get from the file system
-        std::string mount_path;
-        if (it->first.size() >= path.size()) {
-            mount_path = it->first;
-        } else {
-            mount_path = path.substr(it->first.size() + 1, path.size());
-        }
-
-        return it->second->OpenDirectory(mount_path);
+    std::shared_lock lock(mount_mutex);
+    Resolution resolution = Resolve(path);
+    if (resolution.fs == nullptr) {
+        return nullptr;
     }
-    return nullptr;
+    return resolution.fs->OpenDirectory(path.substr(resolution.offset));
 }
 
 std::shared_ptr<IVirtualDirectory> VirtualMounter::OpenDirectory(const std::string& mount, const std::string& path) {
-    return mount_points[mount]->OpenDirectory(path);
+    std::shared_lock lock(mount_mutex);
+    IVirtualFileSystem* fs = FindMount(mount);
+    return fs == nullptr ? nullptr : fs->OpenDirectory(path);
 }
 
 bool VirtualMounter::IsFile(const std::string& path) {
-    for (auto it = mount_points.begin(); it != mount_points.end(); it++) {
-        if (path.rfind(it->first, 0) == 0) {
-            // Then it's the mount point
-            // Remove the path string and the path separator, and get the path
-            // to get from the file system
-            std::string mount_path = path.substr(it->first.size() + 1, path.size());
-            if (it->second->IsFile(mount_path)) {
-                return true;
-            }
-        }
-    }
-    return false;
+    std::shared_lock lock(mount_mutex);
+    Resolution resolution = Resolve(path);
+    return resolution.fs != nullptr && resolution.fs->IsFile(path.substr(resolution.offset));
 }
 
 bool VirtualMounter::IsFile(const std::string& mount, const std::string& path) {
-    return mount_points[mount]->IsFile(path);
+    std::shared_lock lock(mount_mutex);
+    IVirtualFileSystem* fs = FindMount(mount);
+    return fs != nullptr && fs->IsFile(path);
 }
 
 bool VirtualMounter::IsDirectory(const std::string& path) {
-    for (auto it = mount_points.begin(); it != mount_points.end(); it++) {
-        if (path.rfind(it->first, 0) == 0) {
-            std::string mount_path = path.substr(it->first.size() + 1, path.size());
-            if (it->second->IsDirectory(mount_path)) {
-                return true;
-            }
-        }
-    }
-    return false;
+    std::shared_lock lock(mount_mutex);
+    Resolution resolution = Resolve(path);
+    return resolution.fs != nullptr && resolution.fs->IsDirectory(path.substr(resolution.offset));
 }
 
 bool VirtualMounter::IsDirectory(const std::string& mount, const std::string& path) {
-    return mount_points[mount]->IsDirectory(path);
+    std::shared_lock lock(mount_mutex);
+    IVirtualFileSystem* fs = FindMount(mount);
+    return fs != nullptr && fs->IsDirectory(path);
 }
 
 bool VirtualMounter::Exists(const std::string& path) {
-    for (auto it = mount_points.begin(); it != mount_points.end(); it++) {
-        if (path.rfind(it->first, 0) == 0) {
-            std::string mount_path = path.substr(it->first.size() + 1, path.size());
-            if (it->second->Exists(mount_path)) {
-                return true;
-            }
-        }
-    }
-    return false;
+    std::shared_lock lock(mount_mutex);
+    Resolution resolution = Resolve(path);
+    return resolution.fs != nullptr && resolution.fs->Exists(path.substr(resolution.offset));
 }
 
 bool VirtualMounter::Exists(const std::string& mount, const std::string& path) {
-    return mount_points[mount]->Exists(path);
+    std::shared_lock lock(mount_mutex);
+    IVirtualFileSystem* fs = FindMount(mount);
+    return fs != nullptr && fs->Exists(path);
 }
 
 std::vector<uint8_t> ReadAllFromVFile(IVirtualFile* file) {
@@ -129,22 +164,59 @@ std::vector<uint8_t> ReadAllFromVFile(IVirtualFile* file) {
     return buffer;
 }
 
+std::span<const uint8_t> ViewVFile(IVirtualFile* file, std::vector<uint8_t>& fallback) {
+    std::span<const uint8_t> view = file->Map();
+    if (!view.empty() || file->Size() == 0) {
+        return view;
+    }
+    fallback = ReadAllFromVFile(file);
+    return fallback;
+}
+
 std::string ReadAllFromVFileToString(IVirtualFile* file) {
-    int size = file->Size();
-    uint8_t* buf = new uint8_t[size];
-    file->Read(buf, size);
+    std::vector<uint8_t> fallback;
+    std::span<const uint8_t> view = ViewVFile(file, fallback);
     // Output to string
-    std::string str(reinterpret_cast<char*>(buf), size);
-    // Now convert to a proper string
-    size_t start_pos = 0;
-    // Replace carrige returns because it's text mode
-    // Carrige return is 2 characters long, and findflaws is stupid and complaining about strlen.
-    const int return_length = 2;
-    while ((start_pos = str.find("\r\n", start_pos)) != std::string::npos) {
-        str.replace(start_pos, return_length, "\n");
-        start_pos += 1;  // In case 'to' contains 'from', like replacing 'x' with 'yx'
+    std::string str(reinterpret_cast<const char*>(view.data()), view.size());
+    // Replace carrige returns because it's text mode, in a single pass
+    auto out = str.begin();
+    for (auto it = str.begin(); it != str.end(); ++it) {
+        if (*it == '\r' && std::next(it) != str.end() && *std::next(it) == '\n') {
+            continue;
+        }
+        *out++ = *it;
     }
-    delete[] buf;
+    str.erase(out, str.end());
     return str;
 }
+
+std::string NormalizePath(std::string_view path) {
+    std::vector<std::string_view> components;
+    size_t start = 0;
+    while (start <= path.size()) {
+        size_t end = path.find_first_of("/\\", start);
+        if (end == std::string_view::npos) {
+            end = path.size();
+        }
+        std::string_view component = path.substr(start, end - start);
+        if (component == "..") {
+            if (!components.empty()) {
+                components.pop_back();
+            }
+        } else if (!component.empty() && component != ".") {
+            components.push_back(component);
+        }
+        start = end + 1;
+    }
+
+    std::string result;
+    result.reserve(path.size());
+    for (size_t i = 0; i < components.size(); i++) {
+        if (i != 0) {
+            result += '/';
+        }
+        result += components[i];
+    }
+    return result;
+}
 }  // namespace cqsp::asset
@@ -16,9 +16,15 @@
  */
 #pragma once
 
+#include <functional>
 #include <map>
 #include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <span>
 #include <string>
+#include <string_view>
+#include <unordered_map>
 #include <vector>
 
 namespace cqsp {
@@ -78,6 +84,11 @@ class IVirtualFileSystem {
     /// Does the file exist
     /// </summary>
     virtual bool Exists(const std::string& path) = 0;
+
+    /// <summary>
+    /// Drops any metadata the filesystem has cached, so that changes on disk are picked up again.
+    /// </summary>
+    virtual void Invalidate() {}
 };
 
 /// <summary>
@@ -144,6 +155,13 @@ class IVirtualFile {
     /// </summary>
     virtual uint64_t Tell() = 0;
 
+    /// <summary>
+    /// Maps the whole file into memory and returns a read only view of it, without copying.
+    /// </summary>
+    /// The view is valid for as long as the file is. Filesystems that can't map files return an
+    /// empty span, so use @ref ViewVFile if the file has to be read either way.
+    virtual std::span<const uint8_t> Map() { return {}; }
+
     /// <summary>
     /// Get file path relative to the filesystem.
     /// </summary>
@@ -152,6 +170,9 @@ class IVirtualFile {
     virtual IVirtualFileSystem* GetFileSystem() = 0;
 };
 
+/// <summary>
+/// Mounts filesystems on paths. It can be used from several threads at once.
+/// </summary>
 class VirtualMounter {
  public:
     ~VirtualMounter();
@@ -184,8 +205,37 @@ class VirtualMounter {
     bool Exists(const std::string& path);
     bool Exists(const std::string& mount, const std::string& path);
 
+    /// <summary>
+    /// Drops the cached mount lookups and the metadata of every mounted filesystem. Call this when
+    /// files change on disk, such as when hot reloading.
+    /// </summary>
+    void Invalidate();
+
  private:
-    std::map<std::string, IVirtualFileSystem*> mount_points;
+    struct Resolution {
+        IVirtualFileSystem* fs = nullptr;
+        // Where the path inside the filesystem starts
+        size_t offset = 0;
+    };
+
+    /// <summary>
+    /// Finds the mount point that `path` is in, matching whole path components, and the longest
+    /// mount point if several match.
+    /// </summary>
+    Resolution Resolve(const std::string& path);
+
+    /// <summary>
+    /// Filesystem mounted at exactly `mount`, or null if there isn't one.
+    /// </summary>
+    IVirtualFileSystem* FindMount(const std::string& mount);
+
+    // Shared while looking files up, and exclusive while mounting or invalidating
+    std::shared_mutex mount_mutex;
+    std::map<std::string, IVirtualFileSystem*, std::less<>> mount_points;
+    // Resolved mount points by the full path, asset loading asks for the same paths many times
+    std::mutex cache_mutex;
+    std::unordered_map<std::string, Resolution> resolve_cache;
+    static constexpr size_t max_resolve_cache_size = 16384;
 };
 
 // These functions feel like a hack
@@ -202,6 +252,13 @@ std::vector<uint8_t> ReadAllFromVFile(IVirtualFile*);
 /// </summary>
 std::string ReadAllFromVFileToString(IVirtualFile* file);
 
+/// <summary>
+/// Gets the contents of the whole file, mapped if the filesystem supports it.
+/// </summary>
+/// If the file can't be mapped, it is read into `fallback` and the view points into that.
+/// The view is valid as long as both the file and `fallback` are.
+std::span<const uint8_t> ViewVFile(IVirtualFile* file, std::vector<uint8_t>& fallback);
+
 /// <summary>
 /// Gets filename from path.
 /// </summary>
@@ -216,6 +273,13 @@ inline std::string GetFilename(const std::string& path) {
     return path.substr(last + 1);
 }
 
+/// <summary>
+/// Converts a path to the canonical form that the filesystems use for lookups.
+/// </summary>
+/// Backslashes become forward slashes, and empty, `.` and `..` components are resolved,
+/// so `/data\\goods/../goods/./a.hjson` becomes `data/goods/a.hjson`.
+std::string NormalizePath(std::string_view path);
+
 inline std::string GetParentPath(const std::string& path) {
     size_t last = path.find_last_of("/\\");
 
@@ -44,5 +44,5 @@ class ALAudioAsset : public AudioAsset {
 };
 
 std::unique_ptr<AudioAsset> LoadOgg(std::ifstream& input);
-std::unique_ptr<AudioAsset> LoadOgg(uint8_t* buffer, int size);
+std::unique_ptr<AudioAsset> LoadOgg(const uint8_t* buffer, int size);
 }  // namespace cqsp::asset
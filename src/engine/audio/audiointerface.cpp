@@ -16,8 +16,6 @@
  */
 #include "engine/audio/audiointerface.h"
 
-#include <chrono>
-#include <future>
 #include <random>
 #include <string>
 
@@ -60,8 +58,9 @@ void AudioInterface::Destruct() {
     to_quit = true;
     SPDLOG_LOGGER_INFO(logger, "Killing OpenAL");
     // Clear sources and buffers
+    // The stream uses the music channel's source, so it has to go first
+    music.reset();
     for (int i = 0; i < channels.size(); i++) channels[i].reset();
-    music_asset.reset();
 }
 
 void AudioInterface::StartWorker() {
@@ -72,7 +71,7 @@ void AudioInterface::StartWorker() {
 void AudioInterface::RequestPlayAudio() {}
 
 void AudioInterface::SetMusicVolume(float volume) {
-    if (music_asset != nullptr) {
+    if (music != nullptr) {
         channels[MUSIC_CHANNEL]->SetGain(volume);
     }
     music_volume = volume;
@@ -100,41 +99,30 @@ void cqsp::engine::audio::AudioInterface::SetChannelVolume(int channel, float ga
 }
 
 void cqsp::engine::audio::AudioInterface::OnFrame() {
-    bool to_quit = false;
-    if (channels[MUSIC_CHANNEL]->IsPlaying() && !to_quit) {
+    // The stream keeps the source fed on its own thread, so there's only work when a track ends
+    if (music != nullptr && !music->IsFinished()) {
         return;
     }
 
-    if (channels[MUSIC_CHANNEL]->IsStopped()) {
-        // Check for device error?
-        int error = alcGetError(device);
-        ALCint status;
-        //alcGetIntegerv(device, ALC_, 1, &status);
-        if (error != ALC_NO_ERROR) {
-            SPDLOG_LOGGER_INFO(logger, "Error {}", error);
-        }
+    // Check for device error?
+    int error = alcGetError(device);
+    if (error != ALC_NO_ERROR) {
+        SPDLOG_LOGGER_INFO(logger, "Error {}", error);
     }
 
-    if (music_asset != nullptr) {
+    if (music != nullptr) {
         SPDLOG_LOGGER_INFO(logger, "Completed track");
-        channels[MUSIC_CHANNEL]->Stop();
-        channels[MUSIC_CHANNEL]->EmptyBuffer();
-        music_asset.reset();
+        music.reset();
     }
 
-    if (audio_future.valid()) {
-        if (audio_future.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
-            music_asset = audio_future.get();
-        }
-    } else {
-        audio_future = std::async(&AudioInterface::LoadNextFile, &*this);
+    if (playlist.size() == 0) {
+        return;
     }
-    // Get the thing after it loads
-    if (music_asset != nullptr) {
-        // Set the music_asset
-        channels[MUSIC_CHANNEL]->SetBuffer(music_asset.get());
+    // Opening only reads the headers, so this is cheap enough to do on the main thread
+    music = LoadNextFile();
+    if (music != nullptr) {
         channels[MUSIC_CHANNEL]->SetGain(music_volume);
-        channels[MUSIC_CHANNEL]->Play();
+        music->Play();
     }
 }
 
@@ -250,7 +238,7 @@ void AudioInterface::InitALContext() {
     }
 }
 
-std::unique_ptr<AudioAsset> cqsp::engine::audio::AudioInterface::LoadNextFile() {
+std::unique_ptr<cqsp::engine::audio::MusicStream> cqsp::engine::audio::AudioInterface::LoadNextFile() {
     // Choose random song from playlist
     std::random_device dev;
     std::mt19937 rng(dev());
@@ -262,14 +250,13 @@ std::unique_ptr<AudioAsset> cqsp::engine::audio::AudioInterface::LoadNextFile()
     Hjson::Value track_info = playlist[selected_track];
     std::string track_file = cqsp::common::util::GetCqspDataPath() + "/core/music/" + track_info["file"];
     SPDLOG_LOGGER_INFO(logger, "Loading track \'{}\'", track_info["name"]);
-    auto mfile = std::ifstream(track_file, std::ios::binary);
-    if (mfile.good()) {
-        return cqsp::asset::LoadOgg(mfile);
-        SPDLOG_LOGGER_INFO(logger, "Length of audio: {}", music_asset->Length());
-    } else {
+    auto stream = std::make_unique<MusicStream>(channels[MUSIC_CHANNEL]->GetSource());
+    if (!stream->Open(track_file)) {
         SPDLOG_LOGGER_ERROR(logger, "Failed to load audio {}", track_info["name"]);
         return nullptr;
     }
+    SPDLOG_LOGGER_INFO(logger, "Length of audio: {}", stream->Length());
+    return stream;
 }
 
 void cqsp::engine::audio::AudioChannel::SetBuffer(cqsp::asset::AudioAsset* buffer) {
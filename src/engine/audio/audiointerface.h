@@ -22,7 +22,6 @@
 
 #include <atomic>
 #include <fstream>
-#include <future>
 #include <map>
 #include <memory>
 #include <string>
@@ -30,6 +29,7 @@
 
 #include "engine/audio/audioasset.h"
 #include "engine/audio/iaudiointerface.h"
+#include "engine/audio/musicstream.h"
 
 namespace cqsp::engine::audio {
 struct AudioChannel {
@@ -82,6 +82,7 @@ struct AudioChannel {
     void EmptyBuffer() { alSourcei(channel, AL_BUFFER, NULL); }
 
     void SetBuffer(cqsp::asset::AudioAsset *buffer);
+    ALuint GetSource() const { return channel; }
     float length = 0;
 
     ~AudioChannel() {
@@ -121,7 +122,8 @@ class AudioInterface : public IAudioInterface {
     ~AudioInterface();
 
     std::unique_ptr<cqsp::asset::AudioAsset> LoadWav(std::ifstream &input);
-    std::unique_ptr<cqsp::asset::AudioAsset> music_asset = nullptr;
+    /// The track that is playing, streamed from the disk
+    std::unique_ptr<MusicStream> music = nullptr;
 
     std::shared_ptr<spdlog::logger> logger;
 
@@ -133,7 +135,10 @@ class AudioInterface : public IAudioInterface {
     void PrintInformation();
     void InitListener();
     void InitALContext();
-    std::unique_ptr<cqsp::asset::AudioAsset> LoadNextFile();
+    /// <summary>
+    /// Opens a random track from the playlist on the music channel
+    /// </summary>
+    std::unique_ptr<MusicStream> LoadNextFile();
     std::map<std::string, cqsp::asset::AudioAsset *> assets;
     std::vector<std::unique_ptr<AudioChannel>> channels;
 
@@ -141,10 +146,5 @@ class AudioInterface : public IAudioInterface {
 
     static const int MUSIC_CHANNEL = 0;
     static const int UI_CHANNEL = 1;
-
-    /// <summary>
-    /// Async load audio files
-    /// </summary>
-    std::future<std::unique_ptr<cqsp::asset::AudioAsset>> audio_future;
 };
 }  // namespace cqsp::engine::audio
@@ -0,0 +1,134 @@
+/* Conquer Space
+ * Copyright (C) 2021-2023 Conquer Space
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "engine/audio/musicstream.h"
+
+#include <stb_vorbis.h>
+
+#include <algorithm>
+#include <chrono>
+
+namespace cqsp::engine::audio {
+MusicStream::MusicStream(ALuint _source) : source(_source) { alGenBuffers(buffer_count, buffers.data()); }
+
+MusicStream::~MusicStream() {
+    {
+        std::lock_guard lock(mutex);
+        quit = true;
+    }
+    wake.notify_all();
+    if (worker.joinable()) {
+        worker.join();
+    }
+    alSourceStop(source);
+    // Detaches every queued buffer, so that they can be deleted
+    alSourcei(source, AL_BUFFER, 0);
+    alDeleteBuffers(buffer_count, buffers.data());
+    if (vorbis != nullptr) {
+        stb_vorbis_close(vorbis);
+    }
+}
+
+bool MusicStream::Open(const std::string& path) {
+    file = asset::MappedFile(path);
+    if (!file.IsOpen() || file.Size() == 0) {
+        return false;
+    }
+    int error = 0;
+    vorbis = stb_vorbis_open_memory(file.View().data(), static_cast<int>(file.Size()), &error, nullptr);
+    if (vorbis == nullptr) {
+        return false;
+    }
+    stb_vorbis_info info = stb_vorbis_get_info(vorbis);
+    // Anything with more channels is mixed down to stereo by the decoder
+    channels = std::min(info.channels, 2);
+    sample_rate = static_cast<int>(info.sample_rate);
+    length = stb_vorbis_stream_length_in_seconds(vorbis);
+    pcm.resize(static_cast<size_t>(frames_per_buffer) * channels);
+    return true;
+}
+
+bool MusicStream::FillBuffer(ALuint buffer) {
+    if (vorbis == nullptr || decoder_done) {
+        return false;
+    }
+    int frames = 0;
+    while (frames < frames_per_buffer) {
+        int decoded = stb_vorbis_get_samples_short_interleaved(vorbis, channels, pcm.data() + frames * channels,
+                                                                (frames_per_buffer - frames) * channels);
+        if (decoded == 0) {
+            decoder_done = true;
+            break;
+        }
+        frames += decoded;
+    }
+    if (frames == 0) {
+        return false;
+    }
+    ALenum format = (channels == 1) ? AL_FORMAT_MONO16 : AL_FORMAT_STEREO16;
+    alBufferData(buffer, format, pcm.data(), static_cast<ALsizei>(frames * channels * sizeof(int16_t)), sample_rate);
+    return true;
+}
+
+void MusicStream::Play() {
+    int queued = 0;
+    for (ALuint buffer : buffers) {
+        if (!FillBuffer(buffer)) {
+            break;
+        }
+        alSourceQueueBuffers(source, 1, &buffer);
+        queued++;
+    }
+    if (queued == 0) {
+        finished = true;
+        return;
+    }
+    alSourcePlay(source);
+    worker = std::thread(&MusicStream::Run, this);
+}
+
+void MusicStream::Run() {
+    std::unique_lock lock(mutex);
+    while (!quit) {
+        // The state is read first, because a stopped source counts all of its buffers as processed,
+        // so after the refill below everything that is queued is unplayed
+        ALint state = 0;
+        alGetSourcei(source, AL_SOURCE_STATE, &state);
+        ALint processed = 0;
+        alGetSourcei(source, AL_BUFFERS_PROCESSED, &processed);
+        for (; processed > 0; processed--) {
+            ALuint buffer = 0;
+            alSourceUnqueueBuffers(source, 1, &buffer);
+            if (FillBuffer(buffer)) {
+                alSourceQueueBuffers(source, 1, &buffer);
+            }
+        }
+
+        if (state == AL_STOPPED) {
+            ALint queued = 0;
+            alGetSourcei(source, AL_BUFFERS_QUEUED, &queued);
+            if (queued == 0) {
+                finished = true;
+                return;
+            }
+            // The ring ran dry before we refilled it, so the source stopped by itself
+            alSourcePlay(source);
+        }
+        // A buffer lasts a third of a second, so this has plenty of slack
+        wake.wait_for(lock, std::chrono::milliseconds(25), [this]() { return quit; });
+    }
+}
+}  // namespace cqsp::engine::audio
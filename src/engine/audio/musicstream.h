@@ -0,0 +1,103 @@
+/* Conquer Space
+ * Copyright (C) 2021-2023 Conquer Space
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <AL/al.h>
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "engine/asset/vfs/mappedfile.h"
+
+// Forward declared so that the whole of stb_vorbis doesn't end up in every file that plays music
+struct stb_vorbis;
+
+namespace cqsp::engine::audio {
+/// <summary>
+/// Plays an ogg file on a source by decoding it a little at a time, instead of decoding the whole
+/// file up front.
+/// </summary>
+/// The compressed file is memory mapped, and a worker thread keeps a small ring of OpenAL buffers
+/// filled, unqueueing the ones that have been played and queueing them again with new samples.
+/// Memory use is the size of the ring, no matter how long the track is.
+class MusicStream {
+ public:
+    /// <param name="source">OpenAL source to play on. It is only used for streaming while this exists.</param>
+    explicit MusicStream(ALuint source);
+    ~MusicStream();
+
+    MusicStream(const MusicStream&) = delete;
+    MusicStream& operator=(const MusicStream&) = delete;
+
+    /// <summary>
+    /// Opens the file and reads the vorbis headers, without decoding any audio yet.
+    /// </summary>
+    bool Open(const std::string& path);
+
+    /// <summary>
+    /// Fills the ring, starts the source and starts the worker thread.
+    /// </summary>
+    void Play();
+
+    /// <summary>
+    /// True once every sample has been decoded and the source has played them all.
+    /// </summary>
+    bool IsFinished() const { return finished; }
+
+    /// Length in seconds
+    float Length() const { return length; }
+    int GetSampleRate() const { return sample_rate; }
+    int GetChannels() const { return channels; }
+
+    static constexpr int buffer_count = 4;
+    // About a third of a second per buffer at 44.1 kHz
+    static constexpr int frames_per_buffer = 16384;
+
+ private:
+    void Run();
+
+    /// <summary>
+    /// Decodes the next chunk into the buffer.
+    /// </summary>
+    /// <returns>false if there was nothing left to decode</returns>
+    bool FillBuffer(ALuint buffer);
+
+    ALuint source;
+    std::array<ALuint, buffer_count> buffers {};
+    // Scratch space for one buffer of samples
+    std::vector<int16_t> pcm;
+
+    asset::MappedFile file;
+    stb_vorbis* vorbis = nullptr;
+    int channels = 0;
+    int sample_rate = 0;
+    float length = 0;
+    bool decoder_done = false;
+
+    std::thread worker;
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool quit = false;
+    std::atomic_bool finished = false;
+};
+}  // namespace cqsp::engine::audio
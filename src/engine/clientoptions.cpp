@@ -47,6 +47,9 @@ Hjson::Value cqsp::client::ClientOptions::GetDefaultOptions() {
     default_options["audio"]["ui"] = 0.80f;
     default_options["splashscreens"] = "../data/core/gui/splashscreens";
     default_options["samples"] = 4;
+    // Memory that lazily loaded assets may use, in megabytes, 0 for no limit
+    default_options["memory"]["cpu_budget"] = 512;
+    default_options["memory"]["gpu_budget"] = 1024;
     return default_options;
 }
 
@@ -0,0 +1,58 @@
+/* Conquer Space
+ * Copyright (C) 2021-2023 Conquer Space
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "engine/graphics/atlaspacker.h"
+
+namespace cqsp::engine {
+AtlasPacker::AtlasPacker(int width, int height, int padding) : width(width), height(height), padding(padding) {}
+
+bool AtlasPacker::Pack(const glm::ivec2& size, glm::ivec2& position) {
+    const int w = size.x + padding;
+    const int h = size.y + padding;
+    if (w > width || h > height) {
+        return false;
+    }
+
+    // Find the shelf that wastes the least space
+    Shelf* best = nullptr;
+    for (auto& shelf : shelves) {
+        if (shelf.height < h || width - shelf.x < w) {
+            continue;
+        }
+        if (best == nullptr || shelf.height < best->height) {
+            best = &shelf;
+        }
+    }
+
+    if (best == nullptr) {
+        if (next_shelf_y + h > height) {
+            return false;
+        }
+        shelves.push_back(Shelf {next_shelf_y, h, 0});
+        next_shelf_y += h;
+        best = &shelves.back();
+    }
+
+    position = glm::ivec2(best->x, best->y);
+    best->x += w;
+    return true;
+}
+
+void AtlasPacker::Clear() {
+    shelves.clear();
+    next_shelf_y = 0;
+}
+}  // namespace cqsp::engine
@@ -0,0 +1,61 @@
+/* Conquer Space
+ * Copyright (C) 2021-2023 Conquer Space
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <vector>
+
+#include <glm/glm.hpp>
+
+namespace cqsp::engine {
+/// <summary>
+/// Packs rectangles into a fixed size texture atlas.
+/// </summary>
+/// Rectangles are placed on horizontal shelves. Each rectangle goes on the shelf that wastes the least height,
+/// and a new shelf is opened under the last one when nothing fits. This works well for glyphs, which are all
+/// about the same height.
+class AtlasPacker {
+ public:
+    AtlasPacker() = default;
+    AtlasPacker(int width, int height, int padding = 1);
+
+    /// <summary>
+    /// Finds a spot for a rectangle
+    /// </summary>
+    /// <param name="size">Size of the rectangle in pixels</param>
+    /// <param name="position">[out] Top left corner of the rectangle in the atlas</param>
+    /// <returns>false if the atlas is full</returns>
+    bool Pack(const glm::ivec2& size, glm::ivec2& position);
+    void Clear();
+
+    int GetWidth() const { return width; }
+    int GetHeight() const { return height; }
+
+ private:
+    struct Shelf {
+        int y;
+        int height;
+        // Where the next rectangle goes on this shelf
+        int x;
+    };
+
+    std::vector<Shelf> shelves;
+    int width = 0;
+    int height = 0;
+    int padding = 1;
+    int next_shelf_y = 0;
+};
+}  // namespace cqsp::engine
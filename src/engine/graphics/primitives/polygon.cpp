@@ -95,12 +95,6 @@ Mesh* CreateLineCircle(int segments, float size) {
 
 Mesh* CreateLineSequence(const std::vector<glm::vec3>& sequence) {
     Mesh* mesh = new Mesh();
-    std::vector<float> positions;
-    for (int i = 0; i < sequence.size(); i++) {
-        positions.push_back(sequence[i].x);
-        positions.push_back(sequence[i].y);
-        positions.push_back(sequence[i].z);
-    }
 
     GLuint vao = 0;
     glGenVertexArrays(1, &vao);
@@ -111,7 +105,8 @@ Mesh* CreateLineSequence(const std::vector<glm::vec3>& sequence) {
     glBindVertexArray(vao);
 
     glBindBuffer(GL_ARRAY_BUFFER, vbo);
-    glBufferData(GL_ARRAY_BUFFER, positions.size() * sizeof(float), positions.data(), GL_STATIC_DRAW);
+    // glm::vec3 is tightly packed, so the points can be uploaded directly
+    glBufferData(GL_ARRAY_BUFFER, sequence.size() * sizeof(glm::vec3), sequence.data(), GL_STATIC_DRAW);
     int stride = 3;
     glEnableVertexAttribArray(0);
     glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride * sizeof(float), reinterpret_cast<void*>(0));
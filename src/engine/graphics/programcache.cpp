@@ -0,0 +1,231 @@
+/* Conquer Space
+ * Copyright (C) 2021-2023 Conquer Space
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "engine/graphics/programcache.h"
+
+#include <glad/glad.h>
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <utility>
+
+#include <fmt/format.h>
+#include <tracy/Tracy.hpp>
+
+#include "engine/enginelogger.h"
+#include "engine/graphics/shader.h"
+
+namespace cqsp::asset {
+namespace {
+ProgramBinaryCache* program_binary_cache = nullptr;
+
+struct BinaryHeader {
+    char magic[4];
+    uint32_t format;
+    uint64_t key;
+    uint64_t size;
+};
+constexpr char binary_magic[4] = {'C', 'Q', 'S', 'B'};
+
+void HashBytes(uint64_t& hash, const std::string& str) {
+    for (char c : str) {
+        hash ^= static_cast<uint8_t>(c);
+        hash *= 0x100000001b3ULL;
+    }
+    // Separator so that moving code between the stages changes the hash
+    hash ^= 0xff;
+    hash *= 0x100000001b3ULL;
+}
+
+std::string GetGlString(GLenum name) {
+    const GLubyte* str = glGetString(name);
+    return str == nullptr ? std::string() : std::string(reinterpret_cast<const char*>(str));
+}
+
+unsigned int LinkFromSource(const std::string& vert, const std::string& frag, const std::string& geometry,
+                            bool retrievable) {
+    Shader vert_shader(vert, ShaderType::VERT);
+    Shader frag_shader(frag, ShaderType::FRAG);
+    std::unique_ptr<Shader> geom_shader;
+    if (!geometry.empty()) {
+        geom_shader = std::make_unique<Shader>(geometry, ShaderType::GEOM);
+    }
+
+    unsigned int program = glCreateProgram();
+    glAttachShader(program, vert_shader.id);
+    glAttachShader(program, frag_shader.id);
+    if (geom_shader != nullptr) {
+        glAttachShader(program, geom_shader->id);
+    }
+    if (retrievable) {
+        glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
+    glLinkProgram(program);
+
+    GLint linked = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &linked);
+    if (linked == GL_FALSE) {
+        GLint length = 0;
+        glGetProgramiv(program, GL_INFO_LOG_LENGTH, &length);
+        std::string log(std::max(length, 1), '\0');
+        glGetProgramInfoLog(program, length, nullptr, log.data());
+        ENGINE_LOG_ERROR("Failed to link program: {}", log);
+    }
+    // The shaders are deleted when they go out of scope, which is fine once they are linked
+    glDetachShader(program, vert_shader.id);
+    glDetachShader(program, frag_shader.id);
+    if (geom_shader != nullptr) {
+        glDetachShader(program, geom_shader->id);
+    }
+    return program;
+}
+}  // namespace
+
+ProgramBinaryCache::ProgramBinaryCache(std::string _directory) : directory(std::move(_directory)) {}
+
+bool ProgramBinaryCache::IsSupported() {
+    if (supported == -1) {
+        GLint formats = 0;
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+        supported = formats > 0 ? 1 : 0;
+        driver = fmt::format("{}\n{}\n{}\n{}", GetGlString(GL_VENDOR), GetGlString(GL_RENDERER),
+                             GetGlString(GL_VERSION), GetGlString(GL_SHADING_LANGUAGE_VERSION));
+        std::error_code ec;
+        std::filesystem::create_directories(directory, ec);
+        if (supported == 0) {
+            ENGINE_LOG_INFO("Driver has no program binary formats, shaders will be compiled from source");
+        }
+    }
+    return supported == 1;
+}
+
+uint64_t ProgramBinaryCache::GetKey(const std::string& vert, const std::string& frag, const std::string& geometry) {
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    HashBytes(hash, driver);
+    HashBytes(hash, vert);
+    HashBytes(hash, frag);
+    HashBytes(hash, geometry);
+    return hash;
+}
+
+std::string ProgramBinaryCache::GetPath(uint64_t key) const {
+    return (std::filesystem::path(directory) / fmt::format("{:016x}.bin", key)).string();
+}
+
+bool ProgramBinaryCache::ReadBinary(uint64_t key, Binary& binary) {
+    auto it = binaries.find(key);
+    if (it != binaries.end()) {
+        binary = it->second;
+        return true;
+    }
+    std::ifstream file(GetPath(key), std::ios::binary);
+    if (!file) {
+        return false;
+    }
+    BinaryHeader header {};
+    file.read(reinterpret_cast<char*>(&header), sizeof(header));
+    // The key is checked too, in case the file was copied over from somewhere else
+    if (!file || std::memcmp(header.magic, binary_magic, sizeof(binary_magic)) != 0 || header.key != key ||
+        header.size == 0 || header.size > (1u << 30)) {
+        return false;
+    }
+    binary.format = header.format;
+    binary.data.resize(header.size);
+    file.read(reinterpret_cast<char*>(binary.data.data()), static_cast<std::streamsize>(header.size));
+    if (!file) {
+        return false;
+    }
+    binaries[key] = binary;
+    return true;
+}
+
+void ProgramBinaryCache::WriteBinary(uint64_t key, const Binary& binary) {
+    std::string path = GetPath(key);
+    std::string temp_path = path + ".tmp";
+    {
+        std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+        if (!file) {
+            return;
+        }
+        BinaryHeader header {};
+        std::memcpy(header.magic, binary_magic, sizeof(binary_magic));
+        header.format = binary.format;
+        header.key = key;
+        header.size = binary.data.size();
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(binary.data.data()), static_cast<std::streamsize>(binary.data.size()));
+        if (!file) {
+            return;
+        }
+    }
+    // Written to the side and moved in, so a crash halfway never leaves a broken binary behind
+    std::error_code ec;
+    std::filesystem::rename(temp_path, path, ec);
+    if (ec) {
+        std::filesystem::remove(temp_path, ec);
+        return;
+    }
+    binaries[key] = binary;
+}
+
+unsigned int ProgramBinaryCache::Link(const std::string& vert, const std::string& frag, const std::string& geometry) {
+    ZoneScoped;
+    if (!IsSupported()) {
+        return LinkFromSource(vert, frag, geometry, false);
+    }
+
+    uint64_t key = GetKey(vert, frag, geometry);
+    Binary binary;
+    if (ReadBinary(key, binary)) {
+        unsigned int program = glCreateProgram();
+        glProgramBinary(program, binary.format, binary.data.data(), static_cast<GLsizei>(binary.data.size()));
+        GLint linked = GL_FALSE;
+        glGetProgramiv(program, GL_LINK_STATUS, &linked);
+        if (linked == GL_TRUE) {
+            hits++;
+            return program;
+        }
+        // Usually a driver update that the version string didn't catch
+        ENGINE_LOG_INFO("Cached program {:016x} was rejected by the driver, compiling it again", key);
+        glDeleteProgram(program);
+        binaries.erase(key);
+    }
+
+    misses++;
+    unsigned int program = LinkFromSource(vert, frag, geometry, true);
+    GLint linked = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &linked);
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (linked == GL_FALSE || length <= 0) {
+        return program;
+    }
+    binary.data.resize(length);
+    GLenum format = 0;
+    glGetProgramBinary(program, length, &length, &format, binary.data.data());
+    binary.data.resize(length);
+    binary.format = format;
+    WriteBinary(key, binary);
+    return program;
+}
+
+void SetProgramBinaryCache(ProgramBinaryCache* cache) { program_binary_cache = cache; }
+
+ProgramBinaryCache* GetProgramBinaryCache() { return program_binary_cache; }
+}  // namespace cqsp::asset
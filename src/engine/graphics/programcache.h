@@ -0,0 +1,79 @@
+/* Conquer Space
+ * Copyright (C) 2021-2023 Conquer Space
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace cqsp::asset {
+/// <summary>
+/// Caches linked shader programs on disk, so that they don't have to be compiled on every launch.
+/// </summary>
+/// Programs are keyed by a hash of their sources and of the driver that built them, because a
+/// binary is only valid for the exact driver version it came from. If the driver rejects a cached
+/// binary, the program is compiled from source again and the cache entry is replaced.
+///
+/// This needs a current GL context, and has to be used from the thread that owns it.
+class ProgramBinaryCache {
+ public:
+    explicit ProgramBinaryCache(std::string directory);
+
+    /// <summary>
+    /// Makes a linked program out of the sources, from the cache if possible.
+    /// </summary>
+    /// Throws std::runtime_error if a shader fails to compile, the same as @ref Shader does.
+    /// <param name="geometry">Geometry shader source, or empty if there is none</param>
+    /// <returns>The GL program id</returns>
+    unsigned int Link(const std::string& vert, const std::string& frag, const std::string& geometry);
+
+    /// false if the driver can't give us program binaries, then everything is compiled from source
+    bool IsSupported();
+
+    int GetHits() const { return hits; }
+    int GetMisses() const { return misses; }
+
+ private:
+    struct Binary {
+        uint32_t format = 0;
+        std::vector<uint8_t> data;
+    };
+
+    uint64_t GetKey(const std::string& vert, const std::string& frag, const std::string& geometry);
+    std::string GetPath(uint64_t key) const;
+
+    bool ReadBinary(uint64_t key, Binary& binary);
+    void WriteBinary(uint64_t key, const Binary& binary);
+
+    std::string directory;
+    // Vendor, renderer and version of the driver, only known once there's a context
+    std::string driver;
+    int supported = -1;
+    // Binaries already read or written this session
+    std::unordered_map<uint64_t, Binary> binaries;
+    int hits = 0;
+    int misses = 0;
+};
+
+/// <summary>
+/// Sets the cache that @ref ShaderDefinition::MakeShader links programs with.
+/// </summary>
+/// The cache isn't owned. Setting it to nullptr compiles every program from source.
+void SetProgramBinaryCache(ProgramBinaryCache* cache);
+ProgramBinaryCache* GetProgramBinaryCache();
+}  // namespace cqsp::asset
@@ -24,8 +24,5 @@ void cqsp::engine::Renderable::SetTexture(const std::string& name, int id, asset
 }
 
 void cqsp::engine::Renderable::SetMVP(const glm::mat4& model, const glm::mat4& view, const glm::mat4& projection) {
-    shaderProgram->UseProgram();
-    shaderProgram->setMat4("model", model);
-    shaderProgram->setMat4("view", view);
-    shaderProgram->setMat4("projection", projection);
+    shaderProgram->SetMVP(model, view, projection);
 }
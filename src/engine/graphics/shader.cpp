@@ -19,10 +19,59 @@
 #include <glad/glad.h>
 #include <spdlog/spdlog.h>
 
+#include <algorithm>
+#include <deque>
 #include <map>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "engine/enginelogger.h"
+#include "engine/graphics/programcache.h"
+
+namespace {
+// Static ids can be made on any thread that first reaches them, so lookups share the lock and only new names
+// take it exclusively. Names are in a deque so that the references `Name` hands out stay valid.
+struct UniformRegistry {
+    std::unordered_map<std::string, uint32_t> ids;
+    std::deque<std::string> names;
+    mutable std::shared_mutex mutex;
+
+    uint32_t Intern(const std::string& name) {
+        {
+            std::shared_lock lock(mutex);
+            auto it = ids.find(name);
+            if (it != ids.end()) {
+                return it->second;
+            }
+        }
+        std::unique_lock lock(mutex);
+        auto [it, inserted] = ids.emplace(name, static_cast<uint32_t>(names.size()));
+        if (inserted) {
+            names.push_back(name);
+        }
+        return it->second;
+    }
+
+    const std::string& Name(uint32_t index) const {
+        std::shared_lock lock(mutex);
+        return names[index];
+    }
+};
+
+UniformRegistry& GetUniformRegistry() {
+    static UniformRegistry registry;
+    return registry;
+}
+}  // namespace
+
+cqsp::asset::UniformId::UniformId(const char* name) : index(GetUniformRegistry().Intern(name)) {}
+
+cqsp::asset::UniformId::UniformId(const std::string& name) : index(GetUniformRegistry().Intern(name)) {}
+
+const std::string& cqsp::asset::UniformId::Name() const { return GetUniformRegistry().Name(index); }
 
 unsigned int cqsp::asset::LoadShaderData(const std::string& code, int type) {
     unsigned int shader;
@@ -72,109 +121,112 @@ std::string cqsp::asset::GetErrorLog(unsigned int shader) {
 
 using cqsp::asset::ShaderProgram;
 
-void ShaderProgram::setBool(const std::string& name, bool value) {
-    glUniform1i(glGetUniformLocation(program, name.c_str()), static_cast<int>(value));
+void ShaderProgram::setBool(UniformId name, bool value) {
+    glUniform1i(GetUniformLocation(name), static_cast<int>(value));
 }
 
-void ShaderProgram::setInt(const std::string& name, int value) {
-    glUniform1i(glGetUniformLocation(program, name.c_str()), value);
+void ShaderProgram::setInt(UniformId name, int value) {
+    glUniform1i(GetUniformLocation(name), value);
 }
 
-void ShaderProgram::setFloat(const std::string& name, float value) {
-    glUniform1f(glGetUniformLocation(program, name.c_str()), static_cast<GLfloat>(value));
+void ShaderProgram::setFloat(UniformId name, float value) {
+    glUniform1f(GetUniformLocation(name), static_cast<GLfloat>(value));
 }
 
-void ShaderProgram::setVec2(const std::string& name, const glm::vec2& value) {
-    glUniform2fv(glGetUniformLocation(program, name.c_str()), 1, &value[0]);
+void ShaderProgram::setVec2(UniformId name, const glm::vec2& value) {
+    glUniform2fv(GetUniformLocation(name), 1, &value[0]);
 }
 
-void ShaderProgram::setVec2(const std::string& name, float x, float y) {
-    glUniform2f(glGetUniformLocation(program, name.c_str()), x, y);
+void ShaderProgram::setVec2(UniformId name, float x, float y) {
+    glUniform2f(GetUniformLocation(name), x, y);
 }
 
-void ShaderProgram::setVec3(const std::string& name, const glm::vec3& value) {
-    glUniform3fv(glGetUniformLocation(program, name.c_str()), 1, &value[0]);
+void ShaderProgram::setVec3(UniformId name, const glm::vec3& value) {
+    glUniform3fv(GetUniformLocation(name), 1, &value[0]);
 }
 
-void ShaderProgram::setVec3(const std::string& name, float x, float y, float z) {
-    glUniform3f(glGetUniformLocation(program, name.c_str()), x, y, z);
+void ShaderProgram::setVec3(UniformId name, float x, float y, float z) {
+    glUniform3f(GetUniformLocation(name), x, y, z);
 }
 
-void ShaderProgram::setVec4(const std::string& name, const glm::vec4& value) {
-    glUniform4fv(glGetUniformLocation(program, name.c_str()), 1, &value[0]);
+void ShaderProgram::setVec4(UniformId name, const glm::vec4& value) {
+    glUniform4fv(GetUniformLocation(name), 1, &value[0]);
 }
 
-void ShaderProgram::setVec4(const std::string& name, float x, float y, float z, float w) {
-    glUniform4f(glGetUniformLocation(program, name.c_str()), x, y, z, w);
+void ShaderProgram::setVec4(UniformId name, float x, float y, float z, float w) {
+    glUniform4f(GetUniformLocation(name), x, y, z, w);
 }
 
-void ShaderProgram::setMat2(const std::string& name, const glm::mat2& mat) {
-    glUniformMatrix2fv(glGetUniformLocation(program, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+void ShaderProgram::setMat2(UniformId name, const glm::mat2& mat) {
+    glUniformMatrix2fv(GetUniformLocation(name), 1, GL_FALSE, &mat[0][0]);
 }
 
-void ShaderProgram::setMat3(const std::string& name, const glm::mat3& mat) {
-    glUniformMatrix3fv(glGetUniformLocation(program, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+void ShaderProgram::setMat3(UniformId name, const glm::mat3& mat) {
+    glUniformMatrix3fv(GetUniformLocation(name), 1, GL_FALSE, &mat[0][0]);
 }
 
-void ShaderProgram::setMat4(const std::string& name, const glm::mat4& mat) {
-    glUniformMatrix4fv(glGetUniformLocation(program, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+void ShaderProgram::setMat4(UniformId name, const glm::mat4& mat) {
+    glUniformMatrix4fv(GetUniformLocation(name), 1, GL_FALSE, &mat[0][0]);
 }
 
-void ShaderProgram::Set(const std::string& name, bool value) {
-    glUniform1i(glGetUniformLocation(program, name.c_str()), static_cast<int>(value));
+void ShaderProgram::Set(UniformId name, bool value) {
+    glUniform1i(GetUniformLocation(name), static_cast<int>(value));
 }
 
-void ShaderProgram::Set(const std::string& name, int value) {
-    glUniform1i(glGetUniformLocation(program, name.c_str()), value);
+void ShaderProgram::Set(UniformId name, int value) {
+    glUniform1i(GetUniformLocation(name), value);
 }
 
-void ShaderProgram::Set(const std::string& name, float value) {
-    glUniform1f(glGetUniformLocation(program, name.c_str()), static_cast<GLfloat>(value));
+void ShaderProgram::Set(UniformId name, float value) {
+    glUniform1f(GetUniformLocation(name), static_cast<GLfloat>(value));
 }
 
-void ShaderProgram::Set(const std::string& name, const glm::vec2& value) {
-    glUniform2fv(glGetUniformLocation(program, name.c_str()), 1, &value[0]);
+void ShaderProgram::Set(UniformId name, const glm::vec2& value) {
+    glUniform2fv(GetUniformLocation(name), 1, &value[0]);
 }
 
-void ShaderProgram::Set(const std::string& name, float x, float y) {
-    glUniform2f(glGetUniformLocation(program, name.c_str()), x, y);
+void ShaderProgram::Set(UniformId name, float x, float y) {
+    glUniform2f(GetUniformLocation(name), x, y);
 }
 
-void ShaderProgram::Set(const std::string& name, const glm::vec3& value) {
-    glUniform3fv(glGetUniformLocation(program, name.c_str()), 1, &value[0]);
+void ShaderProgram::Set(UniformId name, const glm::vec3& value) {
+    glUniform3fv(GetUniformLocation(name), 1, &value[0]);
 }
 
-void ShaderProgram::Set(const std::string& name, float x, float y, float z) {
-    glUniform3f(glGetUniformLocation(program, name.c_str()), x, y, z);
+void ShaderProgram::Set(UniformId name, float x, float y, float z) {
+    glUniform3f(GetUniformLocation(name), x, y, z);
 }
 
-void ShaderProgram::Set(const std::string& name, const glm::vec4& value) {
-    glUniform4fv(glGetUniformLocation(program, name.c_str()), 1, &value[0]);
+void ShaderProgram::Set(UniformId name, const glm::vec4& value) {
+    glUniform4fv(GetUniformLocation(name), 1, &value[0]);
 }
 
-void ShaderProgram::Set(const std::string& name, float x, float y, float z, float w) {
-    glUniform4f(glGetUniformLocation(program, name.c_str()), x, y, z, w);
+void ShaderProgram::Set(UniformId name, float x, float y, float z, float w) {
+    glUniform4f(GetUniformLocation(name), x, y, z, w);
 }
 
-void ShaderProgram::Set(const std::string& name, const glm::mat2& mat) {
-    glUniformMatrix2fv(glGetUniformLocation(program, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+void ShaderProgram::Set(UniformId name, const glm::mat2& mat) {
+    glUniformMatrix2fv(GetUniformLocation(name), 1, GL_FALSE, &mat[0][0]);
 }
 
-void ShaderProgram::Set(const std::string& name, const glm::mat3& mat) {
-    glUniformMatrix3fv(glGetUniformLocation(program, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+void ShaderProgram::Set(UniformId name, const glm::mat3& mat) {
+    glUniformMatrix3fv(GetUniformLocation(name), 1, GL_FALSE, &mat[0][0]);
 }
 
-void ShaderProgram::Set(const std::string& name, const glm::mat4& mat) {
-    glUniformMatrix4fv(glGetUniformLocation(program, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+void ShaderProgram::Set(UniformId name, const glm::mat4& mat) {
+    glUniformMatrix4fv(GetUniformLocation(name), 1, GL_FALSE, &mat[0][0]);
 }
 
 void ShaderProgram::UseProgram() { glUseProgram(program); }
 
 void ShaderProgram::SetMVP(const glm::mat4& model, const glm::mat4& view, const glm::mat4& projection) {
+    static const UniformId model_id("model");
+    static const UniformId view_id("view");
+    static const UniformId projection_id("projection");
     UseProgram();
-    setMat4("model", model);
-    setMat4("view", view);
-    setMat4("projection", projection);
+    setMat4(model_id, model);
+    setMat4(view_id, view);
+    setMat4(projection_id, projection);
 }
 
 ShaderProgram::ShaderProgram() { program = -1; }
@@ -183,6 +235,7 @@ ShaderProgram::ShaderProgram(const Shader& vert, const Shader& frag) {
     assert(vert.shader_type == ShaderType::VERT);
     assert(frag.shader_type == ShaderType::FRAG);
     program = MakeShaderProgram(vert.id, frag.id);
+    ResolveUniforms();
 }
 
 cqsp::asset::ShaderProgram::ShaderProgram(const Shader& vert, const Shader& frag, const Shader& geom) {
@@ -190,6 +243,43 @@ cqsp::asset::ShaderProgram::ShaderProgram(const Shader& vert, const Shader& frag
     assert(frag.shader_type == ShaderType::FRAG);
     assert(geom.shader_type == ShaderType::GEOM);
     program = MakeShaderProgram(vert.id, frag.id, geom.id);
+    ResolveUniforms();
+}
+
+ShaderProgram::ShaderProgram(unsigned int _program) : program(_program) { ResolveUniforms(); }
+
+void ShaderProgram::ResolveUniforms() {
+    uniform_locations.clear();
+    auto set_location = [&](UniformId id, int location) {
+        if (id.Index() >= uniform_locations.size()) {
+            uniform_locations.resize(id.Index() + 1, -1);
+        }
+        uniform_locations[id.Index()] = location;
+    };
+
+    GLint count = 0;
+    glGetProgramiv(program, GL_ACTIVE_UNIFORMS, &count);
+    GLint max_length = 0;
+    glGetProgramiv(program, GL_ACTIVE_UNIFORM_MAX_LENGTH, &max_length);
+    std::vector<GLchar> name_buffer(std::max(max_length, 1));
+    for (GLint i = 0; i < count; i++) {
+        GLsizei length = 0;
+        GLint size = 0;
+        GLenum type = 0;
+        glGetActiveUniform(program, i, static_cast<GLsizei>(name_buffer.size()), &length, &size, &type,
+                           name_buffer.data());
+        std::string name(name_buffer.data(), length);
+        GLint location = glGetUniformLocation(program, name.c_str());
+        if (location == -1) {
+            // Uniforms in uniform blocks don't have a location
+            continue;
+        }
+        set_location(UniformId(name), location);
+        // Arrays are listed as name[0], but GL lets them be set by the plain name too
+        if (name.ends_with("[0]")) {
+            set_location(UniformId(name.substr(0, name.size() - 3)), location);
+        }
+    }
 }
 
 cqsp::asset::ShaderProgram::~ShaderProgram() { glDeleteProgram(program); }
@@ -433,17 +523,20 @@ std::map<Hjson::Type, std::string> hjson_type_set {
 }  // namespace
 
 cqsp::asset::ShaderProgram_t cqsp::asset::ShaderDefinition::MakeShader() {
-    cqsp::asset::Shader vert_shader(vert, cqsp::asset::ShaderType::VERT);
-    cqsp::asset::Shader frag_shader(frag, cqsp::asset::ShaderType::FRAG);
-
     // Create the shader
     cqsp::asset::ShaderProgram_t shader = nullptr;
-    if (!geometry.empty()) {
-        cqsp::asset::Shader geom_shader(geometry, cqsp::asset::ShaderType::GEOM);
-        // Add to the shader
-        shader = cqsp::asset::MakeShaderProgram(vert_shader, frag_shader, geom_shader);
+    if (ProgramBinaryCache* cache = GetProgramBinaryCache(); cache != nullptr) {
+        shader = std::make_shared<ShaderProgram>(cache->Link(vert, frag, geometry));
     } else {
-        shader = cqsp::asset::MakeShaderProgram(vert_shader, frag_shader);
+        cqsp::asset::Shader vert_shader(vert, cqsp::asset::ShaderType::VERT);
+        cqsp::asset::Shader frag_shader(frag, cqsp::asset::ShaderType::FRAG);
+        if (!geometry.empty()) {
+            cqsp::asset::Shader geom_shader(geometry, cqsp::asset::ShaderType::GEOM);
+            // Add to the shader
+            shader = cqsp::asset::MakeShaderProgram(vert_shader, frag_shader, geom_shader);
+        } else {
+            shader = cqsp::asset::MakeShaderProgram(vert_shader, frag_shader);
+        }
     }
     // Initial values
     shader->UseProgram();
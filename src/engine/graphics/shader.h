@@ -18,9 +18,11 @@
 
 #include <hjson.h>
 
+#include <cstdint>
 #include <istream>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include <glm/glm.hpp>
 
@@ -59,6 +61,30 @@ class Shader : public Asset {
     explicit Shader(const Shader&) = default;
 };
 
+/// <summary>
+/// A uniform name interned into a small integer, so that programs can find uniform locations by index.
+/// </summary>
+/// Strings convert implicitly so that setters still take names, but every conversion is a hash lookup.
+/// For uniforms that are set every frame, keep the id around, such as in a static:
+/// ```
+/// static const UniformId model("model");
+/// shader->Set(model, matrix);
+/// ```
+/// Ids can be created from any thread, but the programs that use them are still render thread only.
+class UniformId {
+ public:
+    UniformId(const char* name);         // NOLINT(runtime/explicit)
+    UniformId(const std::string& name);  // NOLINT(runtime/explicit)
+
+    uint32_t Index() const { return index; }
+    const std::string& Name() const;
+
+    bool operator==(const UniformId&) const = default;
+
+ private:
+    uint32_t index;
+};
+
 /// <summary>A shader program.</summary>
 ///
 /// Do note that using this as a direct object is not the preferred usage of the class, and
@@ -70,35 +96,44 @@ class ShaderProgram {
     ShaderProgram();
     ShaderProgram(const Shader& vert, const Shader& frag);
     ShaderProgram(const Shader& vert, const Shader& frag, const Shader& geom);
+    /// Takes ownership of an already linked program
+    explicit ShaderProgram(unsigned int program);
     ~ShaderProgram();
 
-    void setBool(const std::string& name, bool value);
-    void setInt(const std::string& name, int value);
-    void setFloat(const std::string& name, float value);
-    void setVec2(const std::string& name, const glm::vec2& value);
-    void setVec2(const std::string& name, float x, float y);
-    void setVec3(const std::string& name, const glm::vec3& value);
-    void setVec3(const std::string& name, float x, float y, float z);
-    void setVec4(const std::string& name, const glm::vec4& value);
-    void setVec4(const std::string& name, float x, float y, float z, float w);
-    void setMat2(const std::string& name, const glm::mat2& mat);
-    void setMat3(const std::string& name, const glm::mat3& mat);
-    void setMat4(const std::string& name, const glm::mat4& mat);
+    void setBool(UniformId name, bool value);
+    void setInt(UniformId name, int value);
+    void setFloat(UniformId name, float value);
+    void setVec2(UniformId name, const glm::vec2& value);
+    void setVec2(UniformId name, float x, float y);
+    void setVec3(UniformId name, const glm::vec3& value);
+    void setVec3(UniformId name, float x, float y, float z);
+    void setVec4(UniformId name, const glm::vec4& value);
+    void setVec4(UniformId name, float x, float y, float z, float w);
+    void setMat2(UniformId name, const glm::mat2& mat);
+    void setMat3(UniformId name, const glm::mat3& mat);
+    void setMat4(UniformId name, const glm::mat4& mat);
 
     // Simpler overloaded functions so that you can just say set xxx and change the type
     // as and when you like.
-    void Set(const std::string& name, bool value);
-    void Set(const std::string& name, int value);
-    void Set(const std::string& name, float value);
-    void Set(const std::string& name, const glm::vec2& value);
-    void Set(const std::string& name, float x, float y);
-    void Set(const std::string& name, const glm::vec3& value);
-    void Set(const std::string& name, float x, float y, float z);
-    void Set(const std::string& name, const glm::vec4& value);
-    void Set(const std::string& name, float x, float y, float z, float w);
-    void Set(const std::string& name, const glm::mat2& mat);
-    void Set(const std::string& name, const glm::mat3& mat);
-    void Set(const std::string& name, const glm::mat4& mat);
+    void Set(UniformId name, bool value);
+    void Set(UniformId name, int value);
+    void Set(UniformId name, float value);
+    void Set(UniformId name, const glm::vec2& value);
+    void Set(UniformId name, float x, float y);
+    void Set(UniformId name, const glm::vec3& value);
+    void Set(UniformId name, float x, float y, float z);
+    void Set(UniformId name, const glm::vec4& value);
+    void Set(UniformId name, float x, float y, float z, float w);
+    void Set(UniformId name, const glm::mat2& mat);
+    void Set(UniformId name, const glm::mat3& mat);
+    void Set(UniformId name, const glm::mat4& mat);
+
+    /// <summary>
+    /// Location of the uniform in this program, or -1 if the program doesn't have it.
+    /// </summary>
+    int GetUniformLocation(UniformId name) const {
+        return name.Index() < uniform_locations.size() ? uniform_locations[name.Index()] : -1;
+    }
 
     void UseProgram();
     unsigned int program;
@@ -106,6 +141,15 @@ class ShaderProgram {
     void SetMVP(const glm::mat4& model, const glm::mat4& view, const glm::mat4& projection);
 
     operator unsigned int() const { return program; }
+
+ private:
+    /// <summary>
+    /// Looks up the locations of every active uniform once, so the setters don't have to ask GL.
+    /// </summary>
+    void ResolveUniforms();
+
+    // Uniform locations indexed by UniformId
+    std::vector<int> uniform_locations;
 };
 
 /// The preferred way of using a shader program
@@ -23,117 +23,234 @@
 
 #include <glad/glad.h>
 
-#include <istream>
+#include <cstddef>
 #include <string>
 #include <utility>
 
 #include "engine/enginelogger.h"
 
-void cqsp::asset::LoadFontData(Font &font, unsigned char *fontBuffer, uint64_t size) {
-    FT_Library ft;
+namespace cqsp::asset {
+namespace {
+static_assert(sizeof(TextVertex) == sizeof(float) * 7, "Text vertices have to be tightly packed");
+
+/// Decodes the next code point of a utf-8 string, and moves `it` past it.
+/// Malformed sequences decode to U+FFFD.
+char32_t NextCodePoint(std::string::const_iterator& it, const std::string::const_iterator& end) {
+    auto lead = static_cast<unsigned char>(*it++);
+    if (lead < 0x80) {
+        return lead;
+    }
+    int length;
+    char32_t code_point;
+    if ((lead & 0xE0) == 0xC0) {
+        length = 1;
+        code_point = lead & 0x1F;
+    } else if ((lead & 0xF0) == 0xE0) {
+        length = 2;
+        code_point = lead & 0x0F;
+    } else if ((lead & 0xF8) == 0xF0) {
+        length = 3;
+        code_point = lead & 0x07;
+    } else {
+        return 0xFFFD;
+    }
+    for (int i = 0; i < length; i++) {
+        if (it == end || (static_cast<unsigned char>(*it) & 0xC0) != 0x80) {
+            return 0xFFFD;
+        }
+        code_point = (code_point << 6) | (static_cast<unsigned char>(*it++) & 0x3F);
+    }
+    return code_point;
+}
+}  // namespace
+
+Font::~Font() {
+    if (texture != 0) {
+        glDeleteTextures(1, &texture);
+    }
+    if (VBO != 0) {
+        glDeleteBuffers(1, &VBO);
+    }
+    if (VAO != 0) {
+        glDeleteVertexArrays(1, &VAO);
+    }
+    if (face != nullptr) {
+        FT_Done_Face(face);
+    }
+    if (library != nullptr) {
+        FT_Done_FreeType(library);
+    }
+}
+
+bool Font::LoadGlyph(char32_t c) {
+    if (face == nullptr || FT_Get_Char_Index(face, c) == 0) {
+        return false;
+    }
+    if (FT_Load_Char(face, c, FT_LOAD_RENDER) != 0) {
+        ENGINE_LOG_WARN("Freetype cannot render character {}", static_cast<uint32_t>(c));
+        return false;
+    }
+    FT_GlyphSlot glyph = face->glyph;
+    glm::ivec2 size(glyph->bitmap.width, glyph->bitmap.rows);
+    glm::ivec2 position(0, 0);
+    if (size.x > 0 && size.y > 0) {
+        if (!packer.Pack(size, position)) {
+            ENGINE_LOG_WARN("Font atlas is full, cannot add character {}", static_cast<uint32_t>(c));
+            return false;
+        }
+        // Glyph bitmaps are one byte per pixel with no row alignment
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glBindTexture(GL_TEXTURE_2D, texture);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, position.x, position.y, size.x, size.y, GL_RED, GL_UNSIGNED_BYTE,
+                        glyph->bitmap.buffer);
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
+    glm::vec4 uv = glm::vec4(position, position + size) / static_cast<float>(atlas_size);
+    characters[c] = Character {uv, size, glm::ivec2(glyph->bitmap_left, glyph->bitmap_top),
+                               static_cast<unsigned int>(glyph->advance.x)};
+    return true;
+}
+
+const Character& Font::GetCharacter(char32_t c) {
+    auto it = characters.find(c);
+    if (it != characters.end()) {
+        return it->second;
+    }
+    if (LoadGlyph(c)) {
+        return characters[c];
+    }
+    // Remember the fallback so that we don't try to load the character every frame
+    if (c != '?' && (characters.contains('?') || LoadGlyph('?'))) {
+        return characters[c] = characters['?'];
+    }
+    return characters[c] = Character {glm::vec4(0), glm::ivec2(0), glm::ivec2(0), 0};
+}
+
+const std::vector<GlyphQuad>& Font::Layout(const std::string& text) {
+    auto it = layout_cache.find(text);
+    if (it != layout_cache.end()) {
+        return it->second;
+    }
+    if (layout_cache.size() >= max_layout_cache) {
+        layout_cache.clear();
+    }
+
+    std::vector<GlyphQuad> quads;
+    quads.reserve(text.size());
+    float x = 0;
+    for (auto c = text.cbegin(); c != text.cend();) {
+        const Character& ch = GetCharacter(NextCodePoint(c, text.cend()));
+        if (ch.Size.x > 0 && ch.Size.y > 0) {
+            quads.push_back(GlyphQuad {glm::vec2(x + ch.Bearing.x, -(ch.Size.y - ch.Bearing.y)), ch.Size, ch.uv});
+        }
+        // now advance cursors for next glyph (note that advance is number of 1/64 pixels)
+        // bitshift by 6 to get value in pixels
+        // (2^6 = 64 (divide amount of 1/64th pixels by 64 to get amount of pixels))
+        x += ch.Advance >> 6;
+    }
+    return layout_cache.emplace(text, std::move(quads)).first->second;
+}
+
+void LoadFontData(Font& font, std::vector<unsigned char> fontBuffer) {
     // All functions return a value different than 0 whenever an error occurred
-    if (FT_Init_FreeType(&ft) != 0) {
+    if (FT_Init_FreeType(&font.library) != 0) {
         ENGINE_LOG_INFO("Cannot load freetype library");
+        return;
     }
 
-    // Create a face from a memory buffer.  Be sure not to delete the memory
-    // buffer until you are done using that font as FreeType will reference
-    // it directly.
-    FT_Face face;
-    int id = FT_New_Memory_Face(ft, fontBuffer, size, 0, &face);
+    // Freetype references the memory buffer directly, so the font keeps it
+    font.font_data = std::move(fontBuffer);
+    int id = FT_New_Memory_Face(font.library, font.font_data.data(), static_cast<FT_Long>(font.font_data.size()),
+                                0, &font.face);
     if (id != 0) {
         ENGINE_LOG_INFO("Cannot load font: {}", id);
+        font.face = nullptr;
         return;
     }
 
     // Larger font initial size, so that larget text looks better.
     font.initial_size = 72;
     // set size to load glyphs as
-    FT_Set_Pixel_Sizes(face, 0, font.initial_size);
+    FT_Set_Pixel_Sizes(font.face, 0, font.initial_size);
 
-    // disable byte-alignment restriction
-    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glGenTextures(1, &font.texture);
+    glBindTexture(GL_TEXTURE_2D, font.texture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RED, Font::atlas_size, Font::atlas_size, 0, GL_RED, GL_UNSIGNED_BYTE, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    font.packer = engine::AtlasPacker(Font::atlas_size, Font::atlas_size);
 
-    // load first 128 characters of ASCII set
-    for (unsigned char c = 0; c < 128; c++) {
-        // Load character glyph
-        if (FT_Load_Char(face, c, FT_LOAD_RENDER) != 0) {
-            ENGINE_LOG_WARN("Freetype does not have character {}", c);
-            continue;
+    // Printable ASCII is used all the time, so load that up front
+    for (char32_t c = 32; c < 127; c++) {
+        if (!font.LoadGlyph(c)) {
+            ENGINE_LOG_WARN("Freetype does not have character {}", static_cast<uint32_t>(c));
         }
-        // generate texture
-        unsigned int texture;
-        glGenTextures(1, &texture);
-        glBindTexture(GL_TEXTURE_2D, texture);
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RED, face->glyph->bitmap.width, face->glyph->bitmap.rows, 0, GL_RED,
-                     GL_UNSIGNED_BYTE, face->glyph->bitmap.buffer);
-
-        // set texture options
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-        // now store character for later use
-        Character character = {texture, glm::ivec2(face->glyph->bitmap.width, face->glyph->bitmap.rows),
-                               glm::ivec2(face->glyph->bitmap_left, face->glyph->bitmap_top),
-                               static_cast<unsigned int>(face->glyph->advance.x)};
-        font.characters.insert(std::pair<char, Character>(c, character));
     }
-    glBindTexture(GL_TEXTURE_2D, 0);
-
-    FT_Done_Face(face);
-    FT_Done_FreeType(ft);
 
     glGenVertexArrays(1, &font.VAO);
     glGenBuffers(1, &font.VBO);
     glBindVertexArray(font.VAO);
     glBindBuffer(GL_ARRAY_BUFFER, font.VBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(float) * 6 * 4, NULL, GL_DYNAMIC_DRAW);
+    // Position and texture coordinates
     glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), 0);
+    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, sizeof(TextVertex), reinterpret_cast<void*>(0));
+    // Color
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(TextVertex),
+                          reinterpret_cast<void*>(offsetof(TextVertex, color)));
     glBindBuffer(GL_ARRAY_BUFFER, 0);
     glBindVertexArray(0);
 }
 
-void cqsp::asset::RenderText(cqsp::asset::ShaderProgram &shader, Font &font, std::string text, float x, float y,
-                             float scale, glm::vec3 color) {
-    // activate corresponding render state
-    shader.UseProgram();
-    shader.setVec3("textColor", color);
-    glActiveTexture(GL_TEXTURE0);
-    glBindVertexArray(font.VAO);
-
+void RenderText(ShaderProgram& shader, Font& font, const std::string& text, float x, float y, float scale,
+                glm::vec3 color) {
+    if (font.face == nullptr) {
+        return;
+    }
     // Set scale
     scale /= font.initial_size;
-    // iterate through all characters
-    std::string::const_iterator c;
-    for (c = text.begin(); c != text.end(); ++c) {
-        Character ch = font.characters[*c];
-
-        float xpos = x + ch.Bearing.x * scale;
-        float ypos = y - (ch.Size.y - ch.Bearing.y) * scale;
-        float w = ch.Size.x * scale;
-        float h = ch.Size.y * scale;
-        // update VBO for each character
-        float vertices[6][4] = {
-            {xpos, ypos + h, 0.0f, 0.0f}, {xpos, ypos, 0.0f, 1.0f},     {xpos + w, ypos, 1.0f, 1.0f},
-
-            {xpos, ypos + h, 0.0f, 0.0f}, {xpos + w, ypos, 1.0f, 1.0f}, {xpos + w, ypos + h, 1.0f, 0.0f}};
-        // render glyph texture over quad
-        glBindTexture(GL_TEXTURE_2D, ch.TextureID);
-        // update content of VBO memory
-        glBindBuffer(GL_ARRAY_BUFFER, font.VBO);
-        // be sure to use glBufferSubData and not glBufferData
-        glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(vertices), vertices);
-
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
-        // render quad
-        glDrawArrays(GL_TRIANGLES, 0, 6);
-        // now advance cursors for next glyph (note that advance is number of 1/64 pixels)
-        // bitshift by 6 to get value in pixels
-        // (2^6 = 64 (divide amount of 1/64th pixels by 64 to get amount of pixels))
-        x += (ch.Advance >> 6) * scale;
+    for (const GlyphQuad& quad : font.Layout(text)) {
+        float xpos = x + quad.offset.x * scale;
+        float ypos = y + quad.offset.y * scale;
+        float w = quad.size.x * scale;
+        float h = quad.size.y * scale;
+        // The top of the glyph is the first row of the bitmap
+        TextVertex top_left {{xpos, ypos + h}, {quad.uv.x, quad.uv.y}, color};
+        TextVertex bottom_left {{xpos, ypos}, {quad.uv.x, quad.uv.w}, color};
+        TextVertex bottom_right {{xpos + w, ypos}, {quad.uv.z, quad.uv.w}, color};
+        TextVertex top_right {{xpos + w, ypos + h}, {quad.uv.z, quad.uv.y}, color};
+        font.batch.insert(font.batch.end(), {top_left, bottom_left, bottom_right, top_left, bottom_right, top_right});
     }
+    if (!font.batching) {
+        FlushText(shader, font);
+    }
+}
+
+void BeginTextBatch(Font& font) { font.batching = true; }
+
+void EndTextBatch(ShaderProgram& shader, Font& font) {
+    FlushText(shader, font);
+    font.batching = false;
+}
+
+void FlushText(ShaderProgram& shader, Font& font) {
+    if (font.batch.empty()) {
+        return;
+    }
+    shader.UseProgram();
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, font.texture);
+    glBindVertexArray(font.VAO);
+    glBindBuffer(GL_ARRAY_BUFFER, font.VBO);
+    // The whole batch is rewritten every time, so orphan the old buffer instead of waiting on it
+    glBufferData(GL_ARRAY_BUFFER, font.batch.size() * sizeof(TextVertex), font.batch.data(), GL_STREAM_DRAW);
+    glDrawArrays(GL_TRIANGLES, 0, static_cast<GLsizei>(font.batch.size()));
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
     glBindVertexArray(0);
     glBindTexture(GL_TEXTURE_2D, 0);
+    font.batch.clear();
 }
+}  // namespace cqsp::asset
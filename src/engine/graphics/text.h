@@ -16,34 +16,118 @@
  */
 #pragma once
 
-#include <map>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 #include <glm/glm.hpp>
 
+#include "engine/graphics/atlaspacker.h"
 #include "engine/graphics/shader.h"
 
+// Freetype handles, so that freetype doesn't have to be included everywhere
+struct FT_LibraryRec_;
+struct FT_FaceRec_;
+
 namespace cqsp {
 namespace asset {
 struct Character {
-    unsigned int TextureID;  // ID handle of the glyph texture
-    glm::ivec2 Size;         // Size of glyph
-    glm::ivec2 Bearing;      // Offset from baseline to left/top of glyph
-    unsigned int Advance;    // Horizontal offset to advance to next glyph
+    glm::vec4 uv;          // Texture coordinates of the glyph in the atlas, (u0, v0, u1, v1)
+    glm::ivec2 Size;       // Size of glyph
+    glm::ivec2 Bearing;    // Offset from baseline to left/top of glyph
+    unsigned int Advance;  // Horizontal offset to advance to next glyph
+};
+
+/// <summary>
+/// Glyph quad of a laid out string, relative to the origin of the string at the font's initial size.
+/// </summary>
+struct GlyphQuad {
+    glm::vec2 offset;
+    glm::vec2 size;
+    glm::vec4 uv;
+};
+
+struct TextVertex {
+    glm::vec2 position;
+    glm::vec2 uv;
+    glm::vec3 color;
 };
 
+/// <summary>
+/// Font with all its glyphs packed into a single texture atlas.
+/// </summary>
+/// Printable ASCII is rendered into the atlas when the font is loaded, and any other character is
+/// rendered the first time it is drawn. Text is collected into one vertex buffer and drawn all at once,
+/// see @ref BeginTextBatch and @ref EndTextBatch.
 class Font : public Asset {
  public:
-    std::map<unsigned char, Character> characters;
-    unsigned int VAO, VBO;
-    unsigned int texture;
-    float initial_size;
+    Font() = default;
+    Font(const Font&) = delete;
+    Font& operator=(const Font&) = delete;
+    ~Font();
+
+    /// <summary>
+    /// Gets a glyph, rendering it into the atlas if needed.
+    /// </summary>
+    /// Characters the font doesn't have, or that don't fit in the atlas, are drawn as '?'.
+    const Character& GetCharacter(char32_t c);
+
+    /// <summary>
+    /// Lays out a utf-8 string, reusing the layout if the string was drawn before.
+    /// </summary>
+    const std::vector<GlyphQuad>& Layout(const std::string& text);
+
+    std::unordered_map<char32_t, Character> characters;
+    unsigned int VAO = 0, VBO = 0;
+    // Atlas texture
+    unsigned int texture = 0;
+    float initial_size = 0;
+
+    // Text collected since the last flush
+    std::vector<TextVertex> batch;
+    // If true, text is only drawn when the batch is flushed
+    bool batching = false;
+
+    FT_LibraryRec_* library = nullptr;
+    FT_FaceRec_* face = nullptr;
+    // Freetype reads the font directly from this buffer, so it has to live as long as the face
+    std::vector<unsigned char> font_data;
 
     AssetType GetAssetType() override { return AssetType::FONT; }
+
+    static constexpr int atlas_size = 2048;
+
+ private:
+    friend void LoadFontData(Font& font, std::vector<unsigned char> fontBuffer);
+    bool LoadGlyph(char32_t c);
+
+    engine::AtlasPacker packer;
+    std::unordered_map<std::string, std::vector<GlyphQuad>> layout_cache;
+    // Number of strings kept before the layout cache is flushed
+    static constexpr size_t max_layout_cache = 4096;
 };
 
-void LoadFontData(Font& font, unsigned char* fontBuffer, uint64_t size);
-void RenderText(cqsp::asset::ShaderProgram& shader, Font& font, std::string text, float x, float y, float scale,
-                glm::vec3 color);
+void LoadFontData(Font& font, std::vector<unsigned char> fontBuffer);
+
+/// <summary>
+/// Adds the text to the font's batch. If the font isn't batching, the text is drawn immediately.
+/// </summary>
+void RenderText(cqsp::asset::ShaderProgram& shader, Font& font, const std::string& text, float x, float y,
+                float scale, glm::vec3 color);
+
+/// <summary>
+/// Starts collecting text, so that it can all be drawn with a single draw call.
+/// </summary>
+void BeginTextBatch(Font& font);
+
+/// <summary>
+/// Draws all the text collected since @ref BeginTextBatch, and stops batching.
+/// </summary>
+void EndTextBatch(cqsp::asset::ShaderProgram& shader, Font& font);
+
+/// <summary>
+/// Draws all the text collected so far without ending the batch.
+/// </summary>
+void FlushText(cqsp::asset::ShaderProgram& shader, Font& font);
 }  // namespace asset
 }  // namespace cqsp
@@ -106,10 +106,14 @@ bool cqsp::asset::SaveImage(const char* path, int width, int height, int compone
 
 cqsp::asset::Texture::Texture() : width(-1), height(-1), id(0), texture_type(-1) {}
 
-cqsp::asset::Texture::~Texture() {
+cqsp::asset::Texture::~Texture() { Release(); }
+
+void cqsp::asset::Texture::Release() {
     // Delete textures
     // If it's a null texture, then no need to destroy it
     if (texture_type != -1) {
         glDeleteTextures(1, &id);
     }
+    id = 0;
+    texture_type = -1;
 }
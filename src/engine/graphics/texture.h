@@ -40,6 +40,11 @@ class Texture : public Asset {
     Texture();
     ~Texture();
 
+    /// <summary>
+    /// Deletes the GL texture, keeping the size so that layouts that depend on it don't change.
+    /// </summary>
+    void Release();
+
     AssetType GetAssetType() override { return AssetType::TEXTURE; }
 };
 
@@ -0,0 +1,170 @@
+/* Conquer Space
+ * Copyright (C) 2021-2023 Conquer Space
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "engine/renderer/billboardrenderer.h"
+
+#include <glad/glad.h>
+
+#include <cmath>
+#include <cstddef>
+#include <utility>
+
+namespace cqsp::engine {
+namespace {
+// Attribute locations of the instance data in the billboard shader
+constexpr int position_location = 2;
+constexpr int size_location = 3;
+constexpr int color_location = 4;
+
+void SetInstanceAttribute(int location, int size, size_t base, size_t offset) {
+    glEnableVertexAttribArray(location);
+    glVertexAttribPointer(location, size, GL_FLOAT, GL_FALSE, sizeof(BillboardInstance),
+                          reinterpret_cast<void*>(base + offset));  // NOLINT
+    glVertexAttribDivisor(location, 1);
+}
+}  // namespace
+
+BillboardRenderer::~BillboardRenderer() {
+    for (auto& icon : icons) {
+        glDeleteVertexArrays(1, &icon.VAO);
+    }
+    if (instance_buffer != 0) {
+        glDeleteBuffers(1, &instance_buffer);
+    }
+}
+
+void BillboardRenderer::Initialize(cqsp::asset::ShaderProgram_t _shader) {
+    shader = std::move(_shader);
+    if (instance_buffer == 0) {
+        glGenBuffers(1, &instance_buffer);
+    }
+}
+
+int BillboardRenderer::AddIcon(const Mesh& mesh) {
+    // The icon gets its own vertex array that shares the mesh's buffers, so that the instance
+    // attributes don't leak into other things that draw the mesh
+    Icon icon {0, mesh.mode, mesh.indicies, mesh.buffer_type};
+    glGenVertexArrays(1, &icon.VAO);
+    glBindVertexArray(icon.VAO);
+    glBindBuffer(GL_ARRAY_BUFFER, mesh.VBO);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), reinterpret_cast<void*>(0));  // NOLINT
+    glEnableVertexAttribArray(0);
+    if (mesh.buffer_type == DrawType::ELEMENTS) {
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.EBO);
+    }
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    icons.push_back(icon);
+    return static_cast<int>(icons.size()) - 1;
+}
+
+void BillboardRenderer::Begin(const glm::mat4& _view_projection) {
+    view_projection = _view_projection;
+    pos_x.clear();
+    pos_y.clear();
+    pos_z.clear();
+    icon_index.clear();
+    sizes.clear();
+    colors.clear();
+}
+
+void BillboardRenderer::Add(int icon, const glm::vec3& position, const glm::vec2& size, const glm::vec4& color) {
+    pos_x.push_back(position.x);
+    pos_y.push_back(position.y);
+    pos_z.push_back(position.z);
+    icon_index.push_back(icon);
+    sizes.push_back(size);
+    colors.push_back(color);
+}
+
+void BillboardRenderer::CullBillboards() {
+    const size_t count = pos_x.size();
+    ndc_x.resize(count);
+    ndc_y.resize(count);
+    visible.resize(count);
+
+    // Only the rows of the matrix that give x, y and w are needed
+    const glm::mat4& m = view_projection;
+    const float* x = pos_x.data();
+    const float* y = pos_y.data();
+    const float* z = pos_z.data();
+    float* out_x = ndc_x.data();
+    float* out_y = ndc_y.data();
+    uint8_t* out_visible = visible.data();
+    // No branches in here so that the compiler can vectorize it. Points behind the camera can divide
+    // by zero, but they fail the visibility test anyway.
+    for (size_t i = 0; i < count; i++) {
+        float cx = m[0][0] * x[i] + m[1][0] * y[i] + m[2][0] * z[i] + m[3][0];
+        float cy = m[0][1] * x[i] + m[1][1] * y[i] + m[2][1] * z[i] + m[3][1];
+        float cw = m[0][3] * x[i] + m[1][3] * y[i] + m[2][3] * z[i] + m[3][3];
+        out_visible[i] = static_cast<uint8_t>((cw > 0) & (std::fabs(cx) < cw) & (std::fabs(cy) < cw));
+        out_x[i] = cx / cw;
+        out_y[i] = cy / cw;
+    }
+
+    // Counting sort of the visible billboards by icon
+    icon_offsets.assign(icons.size() + 1, 0);
+    for (size_t i = 0; i < count; i++) {
+        icon_offsets[icon_index[i] + 1] += visible[i];
+    }
+    for (size_t i = 1; i < icon_offsets.size(); i++) {
+        icon_offsets[i] += icon_offsets[i - 1];
+    }
+    instances.resize(icon_offsets.back());
+    std::vector<size_t> cursor(icon_offsets.begin(), icon_offsets.end() - 1);
+    for (size_t i = 0; i < count; i++) {
+        if (visible[i] == 0) {
+            continue;
+        }
+        instances[cursor[icon_index[i]]++] = BillboardInstance {glm::vec2(ndc_x[i], ndc_y[i]), sizes[i], colors[i]};
+    }
+}
+
+void BillboardRenderer::Draw() {
+    CullBillboards();
+    if (instances.empty() || shader == nullptr) {
+        return;
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, instance_buffer);
+    glBufferData(GL_ARRAY_BUFFER, instances.size() * sizeof(BillboardInstance), instances.data(), GL_STREAM_DRAW);
+
+    shader->UseProgram();
+    for (size_t i = 0; i < icons.size(); i++) {
+        GLsizei instance_count = static_cast<GLsizei>(icon_offsets[i + 1] - icon_offsets[i]);
+        if (instance_count == 0) {
+            continue;
+        }
+        const Icon& icon = icons[i];
+        glBindVertexArray(icon.VAO);
+        // GL 3.3 has no base instance, so point the attributes at the start of this icon's group
+        size_t base = icon_offsets[i] * sizeof(BillboardInstance);
+        SetInstanceAttribute(position_location, 2, base, offsetof(BillboardInstance, position));
+        SetInstanceAttribute(size_location, 2, base, offsetof(BillboardInstance, size));
+        SetInstanceAttribute(color_location, 4, base, offsetof(BillboardInstance, color));
+        switch (icon.type) {
+            case DrawType::ELEMENTS:
+                glDrawElementsInstanced(icon.mode, icon.count, GL_UNSIGNED_INT, 0, instance_count);
+                break;
+            case DrawType::ARRAYS:
+                glDrawArraysInstanced(icon.mode, 0, icon.count, instance_count);
+        }
+    }
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+}  // namespace cqsp::engine
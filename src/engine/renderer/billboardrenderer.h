@@ -0,0 +1,112 @@
+/* Conquer Space
+ * Copyright (C) 2021-2023 Conquer Space
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "engine/graphics/mesh.h"
+#include "engine/graphics/shader.h"
+
+namespace cqsp {
+namespace engine {
+/// <summary>
+/// A single billboard as it is uploaded to the instance buffer.
+/// </summary>
+struct BillboardInstance {
+    // Center of the billboard in normalized device coordinates
+    glm::vec2 position;
+    // Scale of the icon mesh in normalized device coordinates
+    glm::vec2 size;
+    glm::vec4 color;
+};
+
+/// <summary>
+/// Draws screen space icons at points in the world, with one instanced draw call per icon type.
+/// </summary>
+/// Billboards are collected between @ref Begin and @ref Draw. When drawing, all of them are projected and
+/// tested against the screen in one pass over flat arrays, and the visible ones are grouped by icon and
+/// uploaded in a single buffer.
+class BillboardRenderer {
+ public:
+    BillboardRenderer() = default;
+    BillboardRenderer(const BillboardRenderer&) = delete;
+    BillboardRenderer& operator=(const BillboardRenderer&) = delete;
+    ~BillboardRenderer();
+
+    void Initialize(cqsp::asset::ShaderProgram_t shader);
+
+    /// <summary>
+    /// Adds a mesh that can be drawn as an icon.
+    /// </summary>
+    /// The mesh has to use the layout of the primitives, with the position at location 0 and
+    /// 5 floats per vertex, such as @ref primitive::CreateFilledCircle or @ref primitive::MakeTexturedPaneMesh.
+    /// The mesh has to outlive the renderer.
+    /// <returns>The icon index to pass into @ref Add</returns>
+    int AddIcon(const Mesh& mesh);
+
+    /// <summary>
+    /// Clears the billboards, and sets the matrix that world positions are projected with.
+    /// </summary>
+    void Begin(const glm::mat4& view_projection);
+    void Add(int icon, const glm::vec3& position, const glm::vec2& size, const glm::vec4& color);
+
+    /// <summary>
+    /// Draws every visible billboard added since @ref Begin
+    /// </summary>
+    void Draw();
+
+    /// Number of billboards that passed the visibility test in the last draw
+    size_t GetVisibleCount() const { return instances.size(); }
+
+ private:
+    void CullBillboards();
+
+    struct Icon {
+        unsigned int VAO;
+        unsigned int mode;
+        unsigned int count;
+        DrawType type;
+    };
+
+    std::vector<Icon> icons;
+    glm::mat4 view_projection = glm::mat4(1.0);
+
+    // Billboards added this frame, kept as separate arrays so that the visibility test vectorizes
+    std::vector<float> pos_x;
+    std::vector<float> pos_y;
+    std::vector<float> pos_z;
+    std::vector<int> icon_index;
+    std::vector<glm::vec2> sizes;
+    std::vector<glm::vec4> colors;
+
+    // Results of the visibility test
+    std::vector<float> ndc_x;
+    std::vector<float> ndc_y;
+    std::vector<uint8_t> visible;
+
+    // Visible billboards grouped by icon, and where each icon's group starts
+    std::vector<BillboardInstance> instances;
+    std::vector<size_t> icon_offsets;
+
+    unsigned int instance_buffer = 0;
+    cqsp::asset::ShaderProgram_t shader;
+};
+}  // namespace engine
+}  // namespace cqsp
@@ -36,10 +36,6 @@ void cqsp::engine::Draw(Renderable &renderable) {
         }
         glActiveTexture(GL_TEXTURE0 + i);
         glBindTexture((*it)->texture_type, (*it)->id);
-        GLenum error = glGetError();
-        if (error != GL_NO_ERROR) {
-            ENGINE_LOG_ERROR("Error when binding texture {}: {}", (*it)->id, error);
-        }
     }
 
     renderable.mesh->Draw();
@@ -62,10 +58,6 @@ void cqsp::engine::Draw(Renderable &renderable, asset::ShaderProgram *shader) {
         }
         glActiveTexture(GL_TEXTURE0 + i);
         glBindTexture((*it)->texture_type, (*it)->id);
-        GLenum error = glGetError();
-        if (error != GL_NO_ERROR) {
-            ENGINE_LOG_ERROR("Error when binding texture {}: {}", (*it)->id, error);
-        }
     }
 
     renderable.mesh->Draw();
@@ -81,12 +73,15 @@ cqsp::engine::BasicRendererObject cqsp::engine::MakeRenderable() {
 cqsp::engine::BasicRenderer::~BasicRenderer() = default;
 
 void cqsp::engine::BasicRenderer::Draw() {
+    static const asset::UniformId model_id("model");
+    static const asset::UniformId view_id("view");
+    static const asset::UniformId projection_id("projection");
     // Then iterate through them and render
     for (const auto &renderable : renderables) {
         renderable->shaderProgram->UseProgram();
-        renderable->shaderProgram->setMat4("model", renderable->model);
-        renderable->shaderProgram->setMat4("view", view);
-        renderable->shaderProgram->setMat4("projection", projection);
+        renderable->shaderProgram->setMat4(model_id, renderable->model);
+        renderable->shaderProgram->setMat4(view_id, view);
+        renderable->shaderProgram->setMat4(projection_id, projection);
         int i = 0;
         for (std::vector<cqsp::asset::Texture *>::iterator it = renderable->textures.begin();
              it != renderable->textures.end(); ++it) {
@@ -0,0 +1,62 @@
+/* Conquer Space
+ * Copyright (C) 2021-2023 Conquer Space
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include "common/util/logging.h"
+#include "engine/asset/vfs/packwriter.h"
+#include "engine/enginelogger.h"
+
+namespace {
+void PrintUsage() {
+    std::cerr << "Usage: cqsp-pack <directory> <output.cqpk> [--compress] [--align N]\n"
+                 "  --compress  Compress text assets in the pack\n"
+                 "  --align N   Align every file in the pack to N bytes (power of two, default 16)\n";
+}
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    cqsp::engine::engine_logger = cqsp::common::util::make_logger("pack", true);
+
+    std::string directory;
+    std::string output;
+    cqsp::asset::PackWriterOptions options;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--compress") {
+            options.compress = true;
+        } else if (arg == "--align" && i + 1 < argc) {
+            options.alignment = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (arg == "-h" || arg == "--help") {
+            PrintUsage();
+            return 0;
+        } else if (directory.empty()) {
+            directory = arg;
+        } else if (output.empty()) {
+            output = arg;
+        } else {
+            PrintUsage();
+            return 1;
+        }
+    }
+    if (directory.empty() || output.empty()) {
+        PrintUsage();
+        return 1;
+    }
+    return cqsp::asset::WritePack(directory, output, options) ? 0 : 1;
+}
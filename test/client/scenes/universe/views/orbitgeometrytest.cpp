@@ -0,0 +1,50 @@
+/* Conquer Space
+ * Copyright (C) 2021-2023 Conquer Space
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <gtest/gtest.h>
+
+#include <limits>
+#include <vector>
+
+#include "client/scenes/universe/views/orbitgeometry.h"
+
+using cqsp::client::systems::GenerateOrbitPoints;
+using cqsp::client::systems::OrbitShapeKey;
+
+namespace {
+OrbitShapeKey Key(double eccentricity) {
+    OrbitShapeKey key;
+    key.semi_major_axis = 10000;
+    key.eccentricity = eccentricity;
+    key.SOI = std::numeric_limits<double>::infinity();
+    return key;
+}
+}  // namespace
+
+TEST(OrbitGeometryTest, CircleSegments) {
+    // 16 segments, halved until half of one turns less than the angle
+    std::vector<glm::vec3> points = GenerateOrbitPoints(Key(0));
+    EXPECT_EQ(points.size(), 65u);
+    EXPECT_LT(glm::distance(points.front(), points.back()), 1e-3);
+    EXPECT_EQ(GenerateOrbitPoints(Key(0), 0.1).size(), 33u);
+}
+
+TEST(OrbitGeometryTest, EccentricOrbitsGetMorePoints) {
+    size_t circle = GenerateOrbitPoints(Key(0)).size();
+    size_t eccentric = GenerateOrbitPoints(Key(0.7)).size();
+    EXPECT_GT(eccentric, circle);
+    EXPECT_LT(eccentric, 2 * circle);
+}
@@ -0,0 +1,176 @@
+/* Conquer Space
+ * Copyright (C) 2021-2023 Conquer Space
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "client/scenes/universe/views/spatialindex.h"
+
+using cqsp::client::systems::BodyBVH;
+using cqsp::client::systems::Frustum;
+using cqsp::client::systems::SurfaceGrid;
+
+namespace {
+entt::entity Entity(int i) { return static_cast<entt::entity>(i); }
+
+// A 5x5x5 lattice of bodies, enough that the tree has several levels
+std::vector<BodyBVH::Primitive> Lattice() {
+    std::vector<BodyBVH::Primitive> primitives;
+    for (int x = 0; x < 5; x++) {
+        for (int y = 0; y < 5; y++) {
+            for (int z = 0; z < 5; z++) {
+                int i = static_cast<int>(primitives.size());
+                primitives.push_back({Entity(i), glm::dvec3(x * 10, y * 10, z * 10), 1 + (i % 3) * 0.5});
+            }
+        }
+    }
+    return primitives;
+}
+
+// Closest hit by testing every body
+BodyBVH::RayHit BruteForce(const std::vector<BodyBVH::Primitive>& primitives, const glm::dvec3& origin,
+                           const glm::dvec3& direction) {
+    BodyBVH::RayHit hit;
+    double closest = INFINITY;
+    for (const auto& prim : primitives) {
+        glm::dvec3 sub = origin - prim.center;
+        double b = glm::dot(direction, sub);
+        double discriminant = b * b - glm::dot(sub, sub) + prim.radius * prim.radius;
+        if (discriminant < 0 || -b + std::sqrt(discriminant) < 0) {
+            continue;
+        }
+        double distance = std::max(-b - std::sqrt(discriminant), 0.0);
+        if (distance < closest) {
+            closest = distance;
+            hit.entity = prim.entity;
+            hit.distance = distance;
+        }
+    }
+    return hit;
+}
+}  // namespace
+
+TEST(SpatialIndexTest, RaycastPicksClosest) {
+    BodyBVH bvh;
+    bvh.Build({{Entity(0), glm::dvec3(30, 0, 0), 1}, {Entity(1), glm::dvec3(10, 0, 0), 1},
+               {Entity(2), glm::dvec3(20, 0, 0), 1}});
+    auto hit = bvh.Raycast(glm::dvec3(0, 0, 0), glm::dvec3(1, 0, 0));
+    EXPECT_EQ(hit.entity, Entity(1));
+    EXPECT_DOUBLE_EQ(hit.distance, 9);
+
+    // Starting past the first one
+    EXPECT_EQ(bvh.Raycast(glm::dvec3(15, 0, 0), glm::dvec3(1, 0, 0)).entity, Entity(2));
+    EXPECT_EQ(bvh.Raycast(glm::dvec3(0, 0, 0), glm::dvec3(0, 1, 0)).entity, entt::null);
+    EXPECT_EQ(bvh.Raycast(glm::dvec3(0, 0, 0), glm::dvec3(-1, 0, 0)).entity, entt::null);
+}
+
+TEST(SpatialIndexTest, RaycastMatchesBruteForce) {
+    auto primitives = Lattice();
+    BodyBVH bvh;
+    bvh.Build(primitives);
+    ASSERT_EQ(bvh.size(), primitives.size());
+    for (int i = 0; i < 200; i++) {
+        glm::dvec3 origin(-20 + i % 7, -20 + i % 11, -20 + i % 13);
+        glm::dvec3 direction = glm::normalize(glm::dvec3(1 + i % 5, 1 + i % 3, 1 + i % 4));
+        auto expected = BruteForce(primitives, origin, direction);
+        auto hit = bvh.Raycast(origin, direction);
+        EXPECT_EQ(hit.entity, expected.entity) << i;
+        if (expected.entity != entt::null) {
+            EXPECT_NEAR(hit.distance, expected.distance, 1e-9) << i;
+        }
+    }
+}
+
+TEST(SpatialIndexTest, RefitMovesBodies) {
+    auto primitives = Lattice();
+    BodyBVH bvh;
+    bvh.Build(primitives);
+    // Move the first body far out of the lattice, where the old bounds don't reach
+    primitives[0].center = glm::dvec3(500, 500, 500);
+    bvh.Refit(primitives);
+    EXPECT_EQ(bvh.Raycast(glm::dvec3(500, 500, 400), glm::dvec3(0, 0, 1)).entity, Entity(0));
+    // And nothing is left where it was
+    EXPECT_EQ(bvh.Raycast(glm::dvec3(0, 0, -10), glm::dvec3(0, 0, 1)).entity, Entity(1));
+
+    // Different bodies rebuild the tree
+    primitives.pop_back();
+    bvh.Refit(primitives);
+    EXPECT_EQ(bvh.size(), primitives.size());
+}
+
+TEST(SpatialIndexTest, FrustumCulling) {
+    glm::dmat4 projection = glm::perspective(glm::radians(60.0), 1.0, 0.1, 1000.0);
+    glm::dmat4 view = glm::lookAt(glm::dvec3(0, 0, 0), glm::dvec3(0, 0, -1), glm::dvec3(0, 1, 0));
+    Frustum frustum(projection * view);
+    EXPECT_TRUE(frustum.SphereVisible(glm::dvec3(0, 0, -50), 1));
+    EXPECT_FALSE(frustum.SphereVisible(glm::dvec3(0, 0, 50), 1));
+    EXPECT_FALSE(frustum.SphereVisible(glm::dvec3(0, 0, -2000), 1));
+    // Off to the side, but big enough to reach into the view
+    EXPECT_FALSE(frustum.SphereVisible(glm::dvec3(100, 0, -50), 1));
+    EXPECT_TRUE(frustum.SphereVisible(glm::dvec3(100, 0, -50), 80));
+
+    BodyBVH bvh;
+    bvh.Build({{Entity(0), glm::dvec3(0, 0, -50), 1},
+               {Entity(1), glm::dvec3(0, 0, 50), 1},
+               {Entity(2), glm::dvec3(5, 5, -100), 1},
+               {Entity(3), glm::dvec3(-300, 0, -10), 1},
+               {Entity(4), glm::dvec3(0, 0, -5000), 1},
+               {Entity(5), glm::dvec3(0, -2, -20), 1}});
+    std::vector<entt::entity> visible;
+    bvh.QueryFrustum(frustum, visible);
+    std::sort(visible.begin(), visible.end());
+    EXPECT_EQ(visible, (std::vector<entt::entity> {Entity(0), Entity(2), Entity(5)}));
+}
+
+TEST(SpatialIndexTest, SurfaceGridHorizon) {
+    SurfaceGrid grid(8);
+    std::vector<glm::vec3> directions;
+    for (int i = 0; i < 500; i++) {
+        // Spread over the sphere with the golden angle
+        double z = 1 - 2 * (i + 0.5) / 500;
+        double r = std::sqrt(1 - z * z);
+        double angle = i * 2.399963229728653;
+        directions.emplace_back(r * std::cos(angle), r * std::sin(angle), z);
+        grid.Insert(Entity(i), directions.back());
+    }
+    EXPECT_EQ(grid.size(), directions.size());
+
+    const glm::dvec3 viewer(0, 0, 3);
+    std::vector<entt::entity> visible;
+    grid.QueryHorizon(viewer, visible);
+    EXPECT_LT(visible.size(), directions.size());
+    // Everything above the horizon has to be there, culling is only allowed to let extra through
+    for (int i = 0; i < static_cast<int>(directions.size()); i++) {
+        if (glm::dot(glm::dvec3(directions[i]), glm::normalize(viewer)) > 1 / glm::length(viewer)) {
+            EXPECT_NE(std::find(visible.begin(), visible.end(), Entity(i)), visible.end()) << i;
+        }
+    }
+    // The far side is culled
+    EXPECT_EQ(std::find(visible.begin(), visible.end(), Entity(499)), visible.end());
+
+    // No horizon from inside the planet
+    visible.clear();
+    grid.QueryHorizon(glm::dvec3(0, 0, 0.5), visible);
+    EXPECT_EQ(visible.size(), directions.size());
+
+    grid.Clear();
+    EXPECT_EQ(grid.size(), 0u);
+}
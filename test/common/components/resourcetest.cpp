@@ -16,9 +16,13 @@
  */
 #include <gtest/gtest.h>
 
+#include <utility>
+
 #include "common/components/resource.h"
+#include "common/util/tickarena.h"
 
 using cqsp::common::components::ResourceLedger;
+using cqsp::common::components::CopyVals;
 
 TEST(Common_ResourceLedger, ResourceLedgerComparison) {
     ResourceLedger first;
@@ -167,3 +171,33 @@ TEST(Common_ResourceLedger, LedgerSubtractionTest1) {
     EXPECT_EQ(first.size(), 1);
     EXPECT_EQ(second.size(), 1);
 }
+
+TEST(Common_ResourceLedger, ArenaLedger) {
+    entt::registry reg;
+    entt::entity good_one = reg.create();
+    entt::entity good_two = reg.create();
+
+    cqsp::common::util::TickArena arena;
+    ResourceLedger heap;
+    heap[good_one] = 10;
+    heap[good_two] = 20;
+
+    ResourceLedger kept;
+    {
+        // Assigning keeps the memory of the arena ledger
+        ResourceLedger transient(arena.GetResource());
+        transient = heap;
+        transient *= 2;
+        EXPECT_DOUBLE_EQ(transient[good_one], 20);
+        EXPECT_DOUBLE_EQ(heap[good_one], 10);
+
+        EXPECT_DOUBLE_EQ(CopyVals(heap, transient, arena.GetResource())[good_two], 40);
+        EXPECT_DOUBLE_EQ(transient.SafeDivision(heap, arena.GetResource())[good_two], 2);
+
+        // Moving out of the arena makes a ledger on the heap, so it can outlive the arena
+        kept = std::move(transient);
+    }
+    arena.Reset();
+    EXPECT_DOUBLE_EQ(kept[good_one], 20);
+    EXPECT_DOUBLE_EQ(kept[good_two], 40);
+}
@@ -0,0 +1,224 @@
+/* Conquer Space
+ * Copyright (C) 2021-2023 Conquer Space
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <gtest/gtest.h>
+
+#include "common/components/area.h"
+#include "common/components/coordinates.h"
+#include "common/components/economy.h"
+#include "common/components/infrastructure.h"
+#include "common/components/lod.h"
+#include "common/components/orbit.h"
+#include "common/components/organizations.h"
+#include "common/components/player.h"
+#include "common/components/population.h"
+#include "common/components/resource.h"
+#include "common/components/surface.h"
+#include "common/game.h"
+#include "common/systems/economy/sysfactory.h"
+#include "common/systems/economy/syslod.h"
+#include "common/systems/economy/sysmarket.h"
+#include "common/systems/economy/syspopulation.h"
+
+namespace cqspc = cqsp::common::components;
+namespace cqspt = cqsp::common::components::types;
+using cqsp::common::systems::GetLodScale;
+using cqsp::common::systems::SysLod;
+
+class SimulationLodTest : public ::testing::Test {
+ protected:
+    SimulationLodTest() : universe(game.GetUniverse()), lod_system(game) {}
+
+    void SetUp() override {
+        player = universe.create();
+        universe.emplace<cqspc::Player>(player);
+
+        entt::entity sun = universe.create();
+        home = AddPlanet(sun);
+        moon = AddPlanet(home);
+        entt::entity other_star = universe.create();
+        far_planet = AddPlanet(other_star);
+
+        home_city = AddCity(home);
+        universe.emplace<cqspc::Governed>(home_city, player);
+        moon_city = AddCity(moon);
+        far_city = AddCity(far_planet);
+    }
+
+    entt::entity AddPlanet(entt::entity reference) {
+        entt::entity planet = universe.create();
+        universe.emplace<cqspt::Orbit>(planet).reference_body = reference;
+        universe.emplace<cqspc::Habitation>(planet);
+        return planet;
+    }
+
+    entt::entity AddCity(entt::entity planet) {
+        entt::entity city = universe.create();
+        universe.emplace<cqspc::Settlement>(city);
+        universe.emplace<cqspt::SurfaceCoordinate>(city).planet = planet;
+        universe.get<cqspc::Habitation>(planet).settlements.push_back(city);
+        return city;
+    }
+
+    cqspc::LodTier Tier(entt::entity entity) { return universe.get<cqspc::SimulationLod>(entity).tier; }
+
+    // Runs the system for `days` days, and returns how many days `entity` simulated over that time
+    int RunDays(int days, entt::entity entity) {
+        int simulated = 0;
+        for (int i = 0; i < days; i++) {
+            universe.date.SetDate(day * cqspc::StarDate::DAY);
+            lod_system.DoSystem();
+            simulated += GetLodScale(universe, entity);
+            day++;
+        }
+        return simulated;
+    }
+
+    cqsp::common::Game game;
+    cqsp::common::Universe& universe;
+    SysLod lod_system;
+    int day = 1;
+
+    entt::entity player;
+    entt::entity home;
+    entt::entity moon;
+    entt::entity far_planet;
+    entt::entity home_city;
+    entt::entity moon_city;
+    entt::entity far_city;
+};
+
+TEST_F(SimulationLodTest, TiersFollowDistance) {
+    RunDays(1, home_city);
+    EXPECT_EQ(Tier(home_city), cqspc::LodTier::Full);
+    EXPECT_EQ(Tier(moon_city), cqspc::LodTier::Reduced);
+    EXPECT_EQ(Tier(far_city), cqspc::LodTier::Dormant);
+    EXPECT_EQ(Tier(home), cqspc::LodTier::Full);
+    EXPECT_EQ(Tier(moon), cqspc::LodTier::Reduced);
+    EXPECT_EQ(Tier(far_planet), cqspc::LodTier::Dormant);
+
+    // Without a level of detail, everything is simulated every day
+    EXPECT_EQ(GetLodScale(universe, universe.create()), 1);
+}
+
+TEST_F(SimulationLodTest, NoDaysAreLost) {
+    EXPECT_EQ(RunDays(100, home_city), 100);
+    day = 1;
+    universe.clear<cqspc::SimulationLod>();
+    // The far city is only simulated every month, so stop just after it was simulated
+    int simulated = RunDays(100, far_city);
+    EXPECT_EQ(simulated, universe.get<cqspc::SimulationLod>(far_city).last_day);
+    EXPECT_GT(simulated, 60);
+}
+
+TEST_F(SimulationLodTest, PromotedAtOnce) {
+    RunDays(3, far_city);
+    int skipped = day - universe.get<cqspc::SimulationLod>(far_city).last_day;
+    universe.emplace<cqspc::LodFocus>(far_planet);
+    // Catches up on every day it skipped
+    EXPECT_EQ(RunDays(1, far_city), skipped);
+    EXPECT_EQ(Tier(far_city), cqspc::LodTier::Full);
+    EXPECT_EQ(Tier(far_planet), cqspc::LodTier::Full);
+    EXPECT_EQ(RunDays(5, far_city), 5);
+}
+
+TEST_F(SimulationLodTest, DemotedSlowly) {
+    universe.emplace<cqspc::FullDetail>(far_city);
+    RunDays(1, far_city);
+    EXPECT_EQ(Tier(far_city), cqspc::LodTier::Full);
+    universe.remove<cqspc::FullDetail>(far_city);
+
+    RunDays(SysLod::demotion_delay - 1, far_city);
+    EXPECT_EQ(Tier(far_city), cqspc::LodTier::Full);
+    RunDays(1, far_city);
+    // One tier at a time
+    EXPECT_EQ(Tier(far_city), cqspc::LodTier::Reduced);
+    RunDays(SysLod::demotion_delay, far_city);
+    EXPECT_EQ(Tier(far_city), cqspc::LodTier::Dormant);
+}
+
+namespace {
+// A city that is its own planet, so that its population and its factory trade on the same market
+entt::entity AddMarket(cqsp::common::Universe& universe, entt::entity recipe, entt::entity food, int scale) {
+    entt::entity city = universe.create();
+    universe.emplace<cqspc::Habitation>(city).settlements.push_back(city);
+    universe.emplace<cqspc::infrastructure::CityInfrastructure>(city, 10., 0.);
+    universe.emplace<cqspc::SimulationLod>(city).scale = scale;
+
+    entt::entity segment = universe.create();
+    universe.emplace<cqspc::PopulationSegment>(segment, uint64_t {1000}, uint64_t {500});
+    universe.emplace<cqspc::Wallet>(segment, entt::null, 1e6);
+    universe.emplace<cqspc::Settlement>(city).population.push_back(segment);
+
+    entt::entity industry = universe.create();
+    universe.emplace<cqspc::Production>(industry, cqspc::ProductionType::factory, recipe);
+    universe.emplace<cqspc::IndustrySize>(industry, 1000., 10.);
+    universe.emplace<cqspc::IndustrialZone>(city).industries.push_back(industry);
+
+    auto& market = universe.emplace<cqspc::Market>(city);
+    for (entt::entity good : universe.view<cqspc::Price>()) {
+        market.price[good] = 1;
+    }
+    // Food was sold yesterday, so it can be bought, the other goods are only wanted
+    market.previous_supply[food] = 1;
+    market.sd_ratio[food] = 1;
+    market.history.push_back(market);
+    return city;
+}
+}  // namespace
+
+TEST(SimulationLodMarketTest, DormantMarketClearsLikeFullMarket) {
+    cqsp::common::Game game;
+    cqsp::common::Universe& universe = game.GetUniverse();
+    entt::entity food = universe.create();
+    entt::entity luxury = universe.create();
+    entt::entity steel = universe.create();
+    for (entt::entity good : {food, luxury, steel}) {
+        universe.emplace<cqspc::Price>(good, 1.);
+    }
+    for (entt::entity good : {food, luxury}) {
+        universe.emplace<cqspc::ConsumerGood>(good, 1., 0.);
+        universe.consumergoods.push_back(good);
+    }
+    entt::entity recipe = universe.create();
+    auto& steel_recipe = universe.emplace<cqspc::Recipe>(recipe);
+    steel_recipe.output.entity = steel;
+    steel_recipe.output.amount = 1;
+    steel_recipe.input[food] = 1;
+    steel_recipe.capitalcost[food] = 0.1;
+    steel_recipe.workers = 1;
+
+    entt::entity full = AddMarket(universe, recipe, food, 1);
+    // A month's worth of everything at once
+    entt::entity dormant = AddMarket(universe, recipe, food, 30);
+
+    cqsp::common::systems::SysProduction(game).DoSystem();
+    cqsp::common::systems::SysPopulationConsumption(game).DoSystem();
+    cqsp::common::systems::SysMarket(game).DoSystem();
+
+    auto& full_market = universe.get<cqspc::Market>(full);
+    auto& dormant_market = universe.get<cqspc::Market>(dormant);
+    for (entt::entity good : {food, luxury, steel}) {
+        EXPECT_NEAR(dormant_market.previous_supply[good], full_market.previous_supply[good], 1e-9);
+        EXPECT_NEAR(dormant_market.previous_demand[good], full_market.previous_demand[good], 1e-9);
+        EXPECT_NEAR(dormant_market.last_latent_demand[good], full_market.last_latent_demand[good], 1e-9);
+        EXPECT_NEAR(dormant_market.price[good], full_market.price[good], 1e-9);
+    }
+    // Every kind of figure was checked with something in it
+    EXPECT_GT(full_market.previous_supply[steel], 0);
+    EXPECT_GT(full_market.previous_demand[food], 0);
+    EXPECT_GT(full_market.last_latent_demand[luxury], 0);
+}
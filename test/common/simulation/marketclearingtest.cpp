@@ -0,0 +1,101 @@
+/* Conquer Space
+ * Copyright (C) 2021-2023 Conquer Space
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <span>
+#include <vector>
+
+#include "common/systems/economy/marketclearing.h"
+
+using cqsp::common::systems::economy::ClearingParameters;
+using cqsp::common::systems::economy::ClearMarket;
+using cqsp::common::systems::economy::ClearMarkets;
+
+TEST(MarketClearingTest, ConvergesToClearingPrice) {
+    ClearingParameters parameters;
+    parameters.max_change = 10;
+    std::vector<double> supply = {100, 200, 50};
+    std::vector<double> demand = {200, 100, 50};
+    std::vector<double> price = {10, 10, 4};
+    ClearMarket(supply, demand, price, parameters);
+
+    // With constant elasticities the clearing price is p0 * (demand / supply) ^ (1 / (e_d + e_s))
+    const double exponent = 1 / (parameters.demand_elasticity + parameters.supply_elasticity);
+    EXPECT_NEAR(price[0], 10 * std::pow(2., exponent), 1e-9);
+    EXPECT_NEAR(price[1], 10 * std::pow(0.5, exponent), 1e-9);
+    // Already cleared
+    EXPECT_DOUBLE_EQ(price[2], 4);
+
+    // Supply and demand meet at the new prices
+    for (size_t i = 0; i < 2; i++) {
+        const double ratio = price[i] / 10;
+        EXPECT_NEAR(demand[i] * std::pow(ratio, -parameters.demand_elasticity),
+                    supply[i] * std::pow(ratio, parameters.supply_elasticity), 1e-9);
+    }
+}
+
+TEST(MarketClearingTest, ChangeIsLimited) {
+    ClearingParameters parameters;
+    std::vector<double> supply = {100, 100};
+    std::vector<double> demand = {1000, 101};
+    std::vector<double> price = {1, 1};
+    ClearMarket(supply, demand, price, parameters);
+    EXPECT_NEAR(price[0], std::exp(parameters.max_change), 1e-12);
+    EXPECT_NEAR(price[1], std::pow(1.01, 1 / (parameters.demand_elasticity + parameters.supply_elasticity)), 1e-12);
+}
+
+TEST(MarketClearingTest, OneSidedMarketsAreBounded) {
+    ClearingParameters parameters;
+    // No supply, no demand, and neither
+    std::vector<double> supply = {0, 100, 0};
+    std::vector<double> demand = {100, 0, 0};
+    std::vector<double> price = {10, 10, 10};
+    ClearMarket(supply, demand, price, parameters);
+    EXPECT_NEAR(price[0], 10 * std::exp(parameters.max_change), 1e-9);
+    EXPECT_NEAR(price[1], 10 * std::exp(-parameters.max_change), 1e-9);
+    EXPECT_DOUBLE_EQ(price[2], 10);
+
+    // Prices never go below the minimum
+    price = {parameters.min_price};
+    supply = {100};
+    demand = {0};
+    ClearMarket(std::span(supply).first(1), std::span(demand).first(1), price, parameters);
+    EXPECT_DOUBLE_EQ(price[0], parameters.min_price);
+}
+
+TEST(MarketClearingTest, ManyMarketsMatchOneAtATime) {
+    ClearingParameters parameters;
+    const size_t goods = 5;
+    const size_t markets = 100;
+    std::vector<double> supply(goods * markets);
+    std::vector<double> demand(goods * markets);
+    std::vector<double> price(goods * markets);
+    for (size_t i = 0; i < supply.size(); i++) {
+        supply[i] = 10 + static_cast<double>(i % 7);
+        demand[i] = 5 + static_cast<double>(i % 11);
+        price[i] = 1 + static_cast<double>(i % 3);
+    }
+    std::vector<double> expected = price;
+    for (size_t m = 0; m < markets; m++) {
+        ClearMarket(std::span(supply).subspan(m * goods, goods), std::span(demand).subspan(m * goods, goods),
+                    std::span(expected).subspan(m * goods, goods), parameters);
+    }
+
+    ClearMarkets(goods, supply, demand, price, parameters);
+    EXPECT_EQ(price, expected);
+}
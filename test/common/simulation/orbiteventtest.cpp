@@ -0,0 +1,145 @@
+/* Conquer Space
+ * Copyright (C) 2021-2023 Conquer Space
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <limits>
+
+#include "common/components/bodies.h"
+#include "common/components/orbit.h"
+#include "common/components/ships.h"
+#include "common/game.h"
+#include "common/systems/movement/orbitevents.h"
+#include "common/systems/movement/sysmovement.h"
+
+namespace cqspb = cqsp::common::components::bodies;
+namespace cqspt = cqsp::common::components::types;
+namespace cqsps = cqsp::common::systems;
+
+namespace {
+constexpr double earth_mu = 398600.4418;
+constexpr double tick = cqsp::common::components::StarDate::TIME_INCREMENT;
+
+cqspt::Orbit MakeOrbit(double sma, double ecc, double M0) {
+    cqspt::Orbit orbit(sma, ecc, 0, 0, 0, M0);
+    orbit.GM = earth_mu;
+    orbit.CalculateVariables();
+    return orbit;
+}
+
+double Radius(const cqspt::Orbit& orbit, double time) { return glm::length(cqspt::OrbitTimeToVec3(orbit, time)); }
+}  // namespace
+
+TEST(OrbitEventTest, SOIExit) {
+    // Apoapsis at 15000 km
+    auto orbit = MakeOrbit(10000, 0.5, 0);
+    double exit = cqsps::PredictSOIExit(orbit, 12000, 0);
+    ASSERT_TRUE(std::isfinite(exit));
+    EXPECT_GT(exit, 0);
+    EXPECT_LT(exit, orbit.T / 2);
+    EXPECT_NEAR(Radius(orbit, exit), 12000, 1);
+    EXPECT_LT(Radius(orbit, exit - tick), 12000);
+
+    EXPECT_TRUE(std::isinf(cqsps::PredictSOIExit(orbit, 20000, 0)));
+    EXPECT_TRUE(std::isinf(cqsps::PredictSOIExit(orbit, std::numeric_limits<double>::infinity(), 0)));
+    // Already outside
+    EXPECT_EQ(cqsps::PredictSOIExit(orbit, 12000, orbit.T / 2), orbit.T / 2);
+}
+
+TEST(OrbitEventTest, HyperbolicSOIExit) {
+    cqspt::Orbit orbit;
+    orbit.semi_major_axis = -10000;
+    orbit.eccentricity = 1.5;
+    orbit.GM = earth_mu;
+    orbit.epoch = 0;
+    double exit = cqsps::PredictSOIExit(orbit, 50000, 0);
+    ASSERT_TRUE(std::isfinite(exit));
+    EXPECT_GT(exit, 0);
+    EXPECT_NEAR(Radius(orbit, exit), 50000, 5);
+}
+
+TEST(OrbitEventTest, Impact) {
+    // Periapsis at 5000 km, starting from the apoapsis
+    auto orbit = MakeOrbit(10000, 0.5, cqspt::PI);
+    double impact = cqsps::PredictImpact(orbit, 6000, 0);
+    ASSERT_TRUE(std::isfinite(impact));
+    EXPECT_LT(impact, orbit.T / 2);
+    EXPECT_NEAR(Radius(orbit, impact), 6000, 1);
+    EXPECT_GT(Radius(orbit, impact - tick), 6000);
+
+    EXPECT_TRUE(std::isinf(cqsps::PredictImpact(orbit, 4000, 0)));
+}
+
+TEST(OrbitEventTest, SOIEntry) {
+    // The inner orbit is faster, so it catches up with the outer one
+    auto inner = MakeOrbit(90000, 0, 0);
+    auto outer = MakeOrbit(100000, 0, 1);
+    double end = inner.T * 20;
+    auto search = cqsps::PredictSOIEntry(inner, outer, 15000, 0, end, 100000);
+    ASSERT_TRUE(search.entered);
+    double entry = search.time;
+    ASSERT_TRUE(std::isfinite(entry));
+    auto distance = [&](double time) {
+        return glm::distance(cqspt::OrbitTimeToVec3(inner, time), cqspt::OrbitTimeToVec3(outer, time));
+    };
+    EXPECT_LE(distance(entry), 15000);
+    EXPECT_GT(distance(entry - tick), 15000);
+
+    // They never get closer than 10000 km
+    EXPECT_TRUE(std::isinf(cqsps::PredictSOIEntry(inner, outer, 5000, 0, end, 100000).time));
+
+    // Giving up isn't an entry
+    auto gave_up = cqsps::PredictSOIEntry(inner, outer, 15000, 0, end, 1);
+    EXPECT_FALSE(gave_up.entered);
+    EXPECT_GT(gave_up.time, 0);
+    EXPECT_LT(gave_up.time, entry);
+}
+
+TEST(OrbitEventTest, SysOrbitCrashesOnPrediction) {
+    cqsp::common::Game game;
+    auto& universe = game.GetUniverse();
+    entt::entity planet = universe.create();
+    universe.sun = planet;
+    universe.emplace<cqspt::Orbit>(planet);
+    auto& body = universe.emplace<cqspb::Body>(planet);
+    body.radius = 6000;
+    body.GM = earth_mu;
+
+    entt::entity satellite = universe.create();
+    auto& orbit = universe.emplace<cqspt::Orbit>(satellite, MakeOrbit(10000, 0.5, cqspt::PI));
+    orbit.reference_body = planet;
+    universe.emplace<cqspb::OrbitalSystem>(planet).push_back(satellite);
+    double impact = cqsps::PredictImpact(orbit, body.radius, 0);
+
+    cqsps::SysOrbit system(game);
+    system.DoSystem();
+    ASSERT_EQ(system.GetEvents().size(), 1u);
+    EXPECT_EQ(system.GetEvents().Peek()->type, cqsps::OrbitEventType::Impact);
+
+    int crash_tick = -1;
+    for (int i = 1; i < 200 && crash_tick < 0; i++) {
+        universe.date.IncrementDate();
+        system.DoSystem();
+        if (universe.any_of<cqsp::common::components::ships::Crash>(satellite)) {
+            crash_tick = i;
+        }
+    }
+    // The first tick after the impact, or the one after if the impact is right on a tick
+    int expected = static_cast<int>(std::ceil(impact / tick));
+    EXPECT_GE(crash_tick, expected);
+    EXPECT_LE(crash_tick, expected + 1);
+}
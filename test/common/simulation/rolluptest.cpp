@@ -0,0 +1,164 @@
+/* Conquer Space
+ * Copyright (C) 2021-2023 Conquer Space
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <gtest/gtest.h>
+
+#include <algorithm>
+
+#include "common/components/economy.h"
+#include "common/components/organizations.h"
+#include "common/components/population.h"
+#include "common/components/rollup.h"
+#include "common/components/surface.h"
+#include "common/game.h"
+#include "common/systems/population/cityinformation.h"
+#include "common/systems/population/sysrollup.h"
+#include "common/universe.h"
+
+namespace cqspc = cqsp::common::components;
+namespace cqspcs = cqsp::common::systems;
+
+class RollupTest : public ::testing::Test {
+ protected:
+    void SetUp() override {
+        country = universe.create();
+        province_1 = universe.create();
+        province_2 = universe.create();
+        universe.emplace<cqspc::Province>(province_1, country);
+        universe.emplace<cqspc::Province>(province_2, country);
+        city_1 = AddCity(province_1, 1000, 600);
+        city_2 = AddCity(province_1, 500, 200);
+        city_3 = AddCity(province_2, 100, 50);
+    }
+
+    entt::entity AddCity(entt::entity province, uint64_t population, uint64_t labor_force) {
+        entt::entity city = universe.create();
+        entt::entity segment = universe.create();
+        universe.emplace<cqspc::PopulationSegment>(segment, population, labor_force);
+        universe.emplace<cqspc::Settlement>(city).population.push_back(segment);
+        universe.get<cqspc::Province>(province).cities.push_back(city);
+        return city;
+    }
+
+    void SetPopulation(entt::entity city, uint64_t population) {
+        entt::entity segment = universe.get<cqspc::Settlement>(city).population.front();
+        universe.get<cqspc::PopulationSegment>(segment).population = population;
+    }
+
+    void ExpectSameAsRebuild() {
+        cqspc::Rollup province_1_rollup = cqspcs::GetRollup(universe, province_1);
+        cqspc::Rollup province_2_rollup = cqspcs::GetRollup(universe, province_2);
+        cqspc::Rollup country_rollup = cqspcs::GetRollup(universe, country);
+        cqspcs::RebuildRollups(universe);
+        EXPECT_EQ(province_1_rollup.population, cqspcs::GetRollup(universe, province_1).population);
+        EXPECT_EQ(province_2_rollup.population, cqspcs::GetRollup(universe, province_2).population);
+        EXPECT_EQ(country_rollup.population, cqspcs::GetRollup(universe, country).population);
+        EXPECT_EQ(country_rollup.labor_force, cqspcs::GetRollup(universe, country).labor_force);
+        EXPECT_EQ(country_rollup.cities, cqspcs::GetRollup(universe, country).cities);
+    }
+
+    cqsp::common::Universe universe;
+    entt::entity country;
+    entt::entity province_1;
+    entt::entity province_2;
+    entt::entity city_1;
+    entt::entity city_2;
+    entt::entity city_3;
+};
+
+TEST_F(RollupTest, SumsCities) {
+    cqspcs::UpdateRollups(universe);
+    EXPECT_EQ(cqspcs::GetRollup(universe, province_1).population, 1500);
+    EXPECT_EQ(cqspcs::GetRollup(universe, province_1).labor_force, 800);
+    EXPECT_EQ(cqspcs::GetRollup(universe, province_1).cities, 2);
+    EXPECT_EQ(cqspcs::GetRollup(universe, province_2).population, 100);
+    EXPECT_EQ(cqspcs::GetRollup(universe, country).population, 1600);
+    EXPECT_EQ(cqspcs::GetRollup(universe, country).cities, 3);
+    EXPECT_EQ(cqspcs::GetCityPopulation(universe, city_2), 500);
+}
+
+TEST_F(RollupTest, IncrementalMatchesRebuild) {
+    cqspcs::UpdateRollups(universe);
+    SetPopulation(city_1, 1200);
+    // Shrinking has to wrap around properly
+    SetPopulation(city_3, 10);
+    cqspcs::UpdateRollups(universe);
+    EXPECT_EQ(cqspcs::GetRollup(universe, province_1).population, 1700);
+    EXPECT_EQ(cqspcs::GetRollup(universe, province_2).population, 10);
+    EXPECT_EQ(cqspcs::GetRollup(universe, country).population, 1710);
+    ExpectSameAsRebuild();
+}
+
+TEST_F(RollupTest, CityChangesProvince) {
+    cqspcs::UpdateRollups(universe);
+    auto& cities = universe.get<cqspc::Province>(province_1).cities;
+    cities.erase(std::find(cities.begin(), cities.end(), city_2));
+    universe.get<cqspc::Province>(province_2).cities.push_back(city_2);
+    cqspcs::UpdateRollups(universe);
+    EXPECT_EQ(cqspcs::GetRollup(universe, province_1).population, 1000);
+    EXPECT_EQ(cqspcs::GetRollup(universe, province_1).cities, 1);
+    EXPECT_EQ(cqspcs::GetRollup(universe, province_2).population, 600);
+    EXPECT_EQ(cqspcs::GetRollup(universe, province_2).cities, 2);
+    EXPECT_EQ(cqspcs::GetRollup(universe, country).population, 1600);
+    ExpectSameAsRebuild();
+}
+
+TEST_F(RollupTest, GdpFromMarket) {
+    entt::entity good = universe.create();
+    auto& market = universe.emplace<cqspc::Market>(city_1);
+    market.previous_supply[good] = 10;
+    market.price[good] = 3;
+    cqspcs::UpdateRollups(universe);
+    EXPECT_DOUBLE_EQ(cqspcs::GetRollup(universe, province_1).gdp, 30);
+    EXPECT_DOUBLE_EQ(cqspcs::GetRollup(universe, country).gdp, 30);
+    EXPECT_DOUBLE_EQ(market.GDP, 30);
+}
+
+TEST_F(RollupTest, EmptyRollup) {
+    entt::entity nothing = universe.create();
+    EXPECT_EQ(cqspcs::GetRollup(universe, nothing).population, 0);
+    EXPECT_EQ(cqspcs::GetRollup(universe, nothing).cities, 0);
+}
+
+TEST(RollupSystemTest, DestroyedCity) {
+    cqsp::common::Game game;
+    auto& universe = game.GetUniverse();
+    cqspcs::SysRollup rollup(game);
+    entt::entity country = universe.create();
+    entt::entity province = universe.create();
+    auto& cities = universe.emplace<cqspc::Province>(province, country).cities;
+    for (uint64_t population : {1000, 300}) {
+        entt::entity city = universe.create();
+        entt::entity segment = universe.create();
+        universe.emplace<cqspc::PopulationSegment>(segment, population, population / 2);
+        universe.emplace<cqspc::Settlement>(city).population.push_back(segment);
+        cities.push_back(city);
+    }
+    rollup.DoSystem();
+    EXPECT_EQ(cqspcs::GetRollup(universe, country).population, 1300);
+
+    universe.destroy(cities.back());
+    cities.pop_back();
+    EXPECT_EQ(cqspcs::GetRollup(universe, province).population, 1000);
+    EXPECT_EQ(cqspcs::GetRollup(universe, province).labor_force, 500);
+    EXPECT_EQ(cqspcs::GetRollup(universe, country).population, 1000);
+    EXPECT_EQ(cqspcs::GetRollup(universe, country).cities, 1);
+
+    // Rebuilding with the system around doesn't count anything twice
+    cqspcs::RebuildRollups(universe);
+    EXPECT_EQ(cqspcs::GetRollup(universe, country).population, 1000);
+    EXPECT_EQ(cqspcs::GetRollup(universe, country).cities, 1);
+}
@@ -0,0 +1,225 @@
+/* Conquer Space
+ * Copyright (C) 2021-2023 Conquer Space
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <vector>
+
+#include "common/components/bodies.h"
+#include "common/components/coordinates.h"
+#include "common/components/orbit.h"
+#include "common/game.h"
+#include "common/systems/movement/lambert.h"
+#include "common/systems/movement/sysmovement.h"
+#include "common/systems/movement/transferplanner.h"
+
+namespace cqspb = cqsp::common::components::bodies;
+namespace cqspt = cqsp::common::components::types;
+namespace cqsps = cqsp::common::systems;
+
+namespace {
+constexpr double earth_mu = 398600.4418;
+constexpr double tick = cqsp::common::components::StarDate::TIME_INCREMENT;
+
+cqspt::Orbit MakeOrbit(double sma, double M0) {
+    cqspt::Orbit orbit(sma, 0, 0, 0, 0, M0);
+    orbit.GM = earth_mu;
+    orbit.CalculateVariables();
+    return orbit;
+}
+
+// Going from one point of a circular orbit to a later one
+cqsps::LambertProblem CircularProblem(double radius, double time) {
+    const double n = std::sqrt(earth_mu / (radius * radius * radius));
+    cqsps::LambertProblem problem;
+    problem.r1 = glm::dvec3(radius, 0, 0);
+    problem.r2 = glm::dvec3(radius * std::cos(n * time), radius * std::sin(n * time), 0);
+    problem.time_of_flight = time;
+    problem.GM = earth_mu;
+    return problem;
+}
+
+double HohmannDeltaV(double r1, double r2) {
+    return std::sqrt(earth_mu / r1) * (std::sqrt(2 * r2 / (r1 + r2)) - 1) +
+           std::sqrt(earth_mu / r2) * (1 - std::sqrt(2 * r1 / (r1 + r2)));
+}
+}  // namespace
+
+TEST(TransferTest, LambertFollowsCircularOrbit) {
+    const double radius = 10000;
+    const double period = cqspt::TWOPI * std::sqrt(radius * radius * radius / earth_mu);
+    const double speed = std::sqrt(earth_mu / radius);
+    // Both the short way and the long way around
+    for (double fraction : {0.1, 0.3, 0.45, 0.55, 0.75, 0.95}) {
+        auto problem = CircularProblem(radius, fraction * period);
+        auto solution = cqsps::SolveLambert(problem);
+        ASSERT_TRUE(solution.valid) << fraction;
+        EXPECT_NEAR(solution.v1.x, 0, 1e-6) << fraction;
+        EXPECT_NEAR(solution.v1.y, speed, 1e-6) << fraction;
+        EXPECT_NEAR(glm::length(solution.v2), speed, 1e-6) << fraction;
+
+        // The other way around goes clockwise
+        problem.normal = glm::dvec3(0, 0, -1);
+        auto retrograde = cqsps::SolveLambert(problem);
+        ASSERT_TRUE(retrograde.valid) << fraction;
+        EXPECT_LT(glm::cross(problem.r1, retrograde.v1).z, 0) << fraction;
+    }
+}
+
+TEST(TransferTest, LambertFollowsPolarOrbit) {
+    // Over the poles, so the positions don't say anything about which way is prograde around the z axis
+    const double radius = 10000;
+    const double period = cqspt::TWOPI * std::sqrt(radius * radius * radius / earth_mu);
+    const double speed = std::sqrt(earth_mu / radius);
+    const glm::dvec3 velocity(0, 0, speed);
+    for (double fraction : {0.1, 0.3, 0.45, 0.55, 0.75, 0.95}) {
+        const double angle = fraction * cqspt::TWOPI;
+        cqsps::LambertProblem problem;
+        problem.r1 = glm::dvec3(radius, 0, 0);
+        problem.r2 = glm::dvec3(radius * std::cos(angle), 0, radius * std::sin(angle));
+        problem.time_of_flight = fraction * period;
+        problem.GM = earth_mu;
+        problem.normal = glm::cross(problem.r1, velocity);
+        auto solution = cqsps::SolveLambert(problem);
+        ASSERT_TRUE(solution.valid) << fraction;
+        EXPECT_NEAR(glm::length(solution.v1 - velocity), 0, 1e-6) << fraction;
+    }
+}
+
+TEST(TransferTest, LambertUnsolvable) {
+    // Half way around, the plane of the transfer isn't known
+    cqsps::LambertProblem problem {glm::dvec3(10000, 0, 0), glm::dvec3(-20000, 0, 0), 3600, earth_mu};
+    EXPECT_FALSE(cqsps::SolveLambert(problem).valid);
+    problem.r2 = glm::dvec3(0, 20000, 0);
+    problem.time_of_flight = 0;
+    EXPECT_FALSE(cqsps::SolveLambert(problem).valid);
+}
+
+TEST(TransferTest, LambertBatchMatchesSingle) {
+    // Enough to be split between threads
+    std::vector<cqsps::LambertProblem> problems;
+    for (int i = 0; i < 3000; i++) {
+        problems.push_back(CircularProblem(7000 + i * 10, 600 + i * 5));
+    }
+    std::vector<cqsps::LambertSolution> solutions(problems.size());
+    cqsps::SolveLambert(problems, solutions);
+    for (size_t i = 0; i < problems.size(); i++) {
+        auto single = cqsps::SolveLambert(problems[i]);
+        ASSERT_EQ(solutions[i].valid, single.valid) << i;
+        EXPECT_EQ(solutions[i].v1, single.v1) << i;
+        EXPECT_EQ(solutions[i].v2, single.v2) << i;
+    }
+}
+
+TEST(TransferTest, PorkchopFindsHohmann) {
+    auto origin = MakeOrbit(7000, 0);
+    auto target = MakeOrbit(42164, 1);
+    auto porkchop = cqsps::ComputePorkchop(origin, target, 100);
+    ASSERT_TRUE(porkchop.best.valid());
+    EXPECT_EQ(porkchop.delta_v.size(), porkchop.departures.size() * porkchop.flight_times.size());
+
+    const double hohmann = HohmannDeltaV(7000, 42164);
+    EXPECT_GT(porkchop.best.delta_v, hohmann * 0.999);
+    EXPECT_LT(porkchop.best.delta_v, hohmann * 1.01);
+    // Lined up with the ticks
+    EXPECT_GE(porkchop.best.departure, 100);
+    EXPECT_EQ(std::fmod(porkchop.best.departure, tick), 0);
+    EXPECT_EQ(std::fmod(porkchop.best.arrival, tick), 0);
+
+    // Hyperbolic orbits aren't planned for
+    target.eccentricity = 1.5;
+    target.semi_major_axis = -42164;
+    EXPECT_FALSE(cqsps::ComputePorkchop(origin, target, 100).best.valid());
+}
+
+TEST(TransferTest, PlannerCachesWindow) {
+    cqsps::PorkchopParameters parameters;
+    parameters.departure_steps = 8;
+    parameters.flight_steps = 8;
+    cqsps::TransferPlanner planner(parameters);
+    auto origin = MakeOrbit(7000, 0);
+    auto target = MakeOrbit(42164, 1);
+    const double window = cqsps::TransferPlanner::epoch_window;
+
+    double departure = planner.Plan(origin, target, 0).departure;
+    EXPECT_GE(departure, window);
+    EXPECT_EQ(planner.Plan(origin, target, window / 2).departure, departure);
+    EXPECT_EQ(planner.hits(), 1u);
+    EXPECT_EQ(planner.size(), 1u);
+
+    planner.Plan(origin, MakeOrbit(20000, 0), 0);
+    EXPECT_EQ(planner.size(), 2u);
+
+    // The next window departs later, and the old transfers are dropped
+    EXPECT_GE(planner.Plan(origin, target, window).departure, 2 * window);
+    EXPECT_EQ(planner.size(), 1u);
+}
+
+TEST(TransferTest, SysPathSchedulesImpulses) {
+    cqsp::common::Game game;
+    auto& universe = game.GetUniverse();
+    entt::entity planet = universe.create();
+    universe.emplace<cqspt::Orbit>(planet);
+    universe.emplace<cqspb::Body>(planet).GM = earth_mu;
+
+    entt::entity ship = universe.create();
+    universe.emplace<cqspt::Orbit>(ship, MakeOrbit(7000, 0)).reference_body = planet;
+    entt::entity station = universe.create();
+    universe.emplace<cqspt::Orbit>(station, MakeOrbit(42164, 1)).reference_body = planet;
+    universe.emplace<cqspt::MoveTarget>(ship, station);
+
+    cqsps::SysPath system(game);
+    system.DoSystem();
+    ASSERT_TRUE(universe.all_of<cqspt::ImpulseSchedule>(ship));
+    const auto schedule = universe.get<cqspt::ImpulseSchedule>(ship);
+    EXPECT_EQ(schedule.target, station);
+    // Leaving, and matching the station's velocity when it gets there
+    ASSERT_EQ(schedule.burns.size(), 2u);
+    EXPECT_LT(schedule.burns[0].time, schedule.burns[1].time);
+    EXPECT_FALSE(universe.any_of<cqspt::Impulse>(ship));
+
+    while (universe.date.ToSecond() < schedule.burns[0].time) {
+        universe.date.IncrementDate();
+    }
+    system.DoSystem();
+    ASSERT_TRUE(universe.all_of<cqspt::Impulse>(ship));
+    EXPECT_EQ(universe.get<cqspt::Impulse>(ship).impulse, schedule.burns[0].impulse);
+    EXPECT_EQ(universe.get<cqspt::ImpulseSchedule>(ship).burns.size(), 1u);
+    universe.remove<cqspt::Impulse>(ship);
+
+    while (universe.date.ToSecond() < schedule.burns[1].time) {
+        universe.date.IncrementDate();
+    }
+    system.DoSystem();
+    EXPECT_EQ(universe.get<cqspt::Impulse>(ship).impulse, schedule.burns[1].impulse);
+    EXPECT_FALSE(universe.any_of<cqspt::ImpulseSchedule, cqspt::MoveTarget>(ship));
+}
+
+TEST(TransferTest, SysPathDropsUnreachableTarget) {
+    cqsp::common::Game game;
+    auto& universe = game.GetUniverse();
+    entt::entity ship = universe.create();
+    universe.emplace<cqspt::Orbit>(ship, MakeOrbit(7000, 0)).reference_body = universe.create();
+    // Around something else
+    entt::entity target = universe.create();
+    universe.emplace<cqspt::Orbit>(target, MakeOrbit(42164, 0)).reference_body = universe.create();
+    universe.emplace<cqspt::MoveTarget>(ship, target);
+
+    cqsps::SysPath system(game);
+    system.DoSystem();
+    EXPECT_FALSE(universe.any_of<cqspt::MoveTarget, cqspt::ImpulseSchedule>(ship));
+}
@@ -0,0 +1,103 @@
+/* Conquer Space
+ * Copyright (C) 2021-2023 Conquer Space
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <gtest/gtest.h>
+#include <hjson.h>
+
+#include <string>
+
+#include "common/components/economy.h"
+#include "common/components/name.h"
+#include "common/systems/loading/hjsonloader.h"
+#include "common/systems/loading/loadgoods.h"
+
+namespace cqspc = cqsp::common::components;
+using cqsp::common::systems::loading::ApplyDefaults;
+
+TEST(HjsonLoaderTest, ApplyDefaultsMatchesMerge) {
+    Hjson::Value defaults = Hjson::Unmarshal(R"({
+        price: 1
+        tags: []
+        cost: { fixed: 1, scaling: 2 }
+    })");
+    Hjson::Value value = Hjson::Unmarshal(R"({
+        identifier: steel
+        price: 5
+        cost: { fixed: 4 }
+    })");
+    Hjson::Value merged = Hjson::Merge(defaults, value);
+    Hjson::Value applied = ApplyDefaults(defaults, value);
+    EXPECT_EQ(Hjson::Marshal(merged), Hjson::Marshal(applied));
+    EXPECT_EQ(applied["price"].to_double(), 5);
+    EXPECT_EQ(applied["cost"]["fixed"].to_double(), 4);
+    EXPECT_EQ(applied["cost"]["scaling"].to_double(), 2);
+
+    // Neither of the inputs is changed
+    EXPECT_FALSE(value["tags"].defined());
+    EXPECT_FALSE(value["cost"]["scaling"].defined());
+    EXPECT_EQ(defaults["price"].to_double(), 1);
+}
+
+TEST(HjsonLoaderTest, LoadGoods) {
+    Hjson::Value goods = Hjson::Unmarshal(R"([
+        { identifier: steel, name: Steel, price: 5 }
+        { name: No identifier }
+        { identifier: copper, description: Red metal }
+    ])");
+    cqsp::common::Universe universe;
+    cqsp::common::systems::loading::GoodLoader loader(universe);
+    EXPECT_EQ(loader.LoadHjson(goods), 2);
+
+    ASSERT_EQ(universe.goods.size(), 2);
+    entt::entity steel = universe.goods["steel"];
+    EXPECT_EQ(universe.get<cqspc::Name>(steel).name, "Steel");
+    EXPECT_EQ(universe.get<cqspc::Price>(steel).price, 5);
+    entt::entity copper = universe.goods["copper"];
+    EXPECT_FALSE(universe.any_of<cqspc::Name>(copper));
+    EXPECT_EQ(universe.get<cqspc::Description>(copper).description, "Red metal");
+    // Default price
+    EXPECT_EQ(universe.get<cqspc::Price>(copper).price, 1);
+}
+
+TEST(HjsonLoaderTest, LoadGoodsInParallel) {
+    // Enough goods, over several packages, that they get split across threads
+    cqsp::common::Universe universe;
+    cqsp::common::systems::loading::GoodLoader loader(universe);
+    for (int package = 0; package < 2; package++) {
+        Hjson::Value goods(Hjson::Type::Vector);
+        for (int i = 0; i < 1000; i++) {
+            Hjson::Value good;
+            good["identifier"] = "good_" + std::to_string(package * 1000 + i);
+            good["price"] = package * 1000 + i;
+            goods.push_back(good);
+        }
+        loader.Prepare(goods);
+    }
+    EXPECT_EQ(loader.Commit(), 2000);
+    ASSERT_EQ(universe.goods.size(), 2000);
+
+    // Entities are created in the order of the elements
+    entt::entity previous = entt::null;
+    for (int i = 0; i < 2000; i++) {
+        entt::entity good = universe.goods["good_" + std::to_string(i)];
+        EXPECT_EQ(universe.get<cqspc::Identifier>(good).identifier, "good_" + std::to_string(i));
+        EXPECT_EQ(universe.get<cqspc::Price>(good).price, i);
+        if (previous != entt::null) {
+            EXPECT_LT(previous, good);
+        }
+        previous = good;
+    }
+}
@@ -0,0 +1,105 @@
+/* Conquer Space
+ * Copyright (C) 2021-2023 Conquer Space
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "common/systems/loading/loadingpipeline.h"
+
+using cqsp::common::systems::loading::LoadingPipeline;
+
+TEST(Common_Loading_Pipeline, KeepsAddedOrderWhenPossible) {
+    LoadingPipeline pipeline;
+    pipeline.AddStage("goods", {}, {"goods"}, []() {});
+    pipeline.AddStage("recipes", {"goods"}, {"recipes"}, []() {});
+    pipeline.AddStage("names", {}, {"names"}, []() {});
+    std::vector<std::string> expected = {"goods", "recipes", "names"};
+    EXPECT_EQ(pipeline.GetCommitOrder(), expected);
+}
+
+TEST(Common_Loading_Pipeline, CommitsInputsFirst) {
+    LoadingPipeline pipeline;
+    pipeline.AddStage("cities", {"planets", "countries"}, {"cities"}, []() {});
+    pipeline.AddStage("countries", {}, {"countries"}, []() {});
+    pipeline.AddStage("planets", {}, {"planets"}, []() {});
+    pipeline.AddStage("satellites", {"planets"}, {"satellites"}, []() {});
+    std::vector<std::string> expected = {"countries", "planets", "cities", "satellites"};
+    EXPECT_EQ(pipeline.GetCommitOrder(), expected);
+}
+
+TEST(Common_Loading_Pipeline, IgnoresMissingInputs) {
+    LoadingPipeline pipeline;
+    pipeline.AddStage("recipes", {"goods"}, {"recipes"}, []() {});
+    std::vector<std::string> expected = {"recipes"};
+    EXPECT_EQ(pipeline.GetCommitOrder(), expected);
+}
+
+TEST(Common_Loading_Pipeline, BreaksCycles) {
+    LoadingPipeline pipeline;
+    pipeline.AddStage("a", {"b"}, {"a"}, []() {});
+    pipeline.AddStage("b", {"a"}, {"b"}, []() {});
+    pipeline.AddStage("c", {}, {"c"}, []() {});
+    std::vector<std::string> expected = {"c", "a", "b"};
+    EXPECT_EQ(pipeline.GetCommitOrder(), expected);
+}
+
+TEST(Common_Loading_Pipeline, RunsEveryStage) {
+    LoadingPipeline pipeline;
+    std::vector<std::string> commits;
+    std::atomic_int prepared = 0;
+    // Commits see the prepared data of their own stage
+    int parsed = 0;
+    pipeline.AddStage(
+        "recipes", {"goods"}, {"recipes"},
+        [&]() {
+            EXPECT_EQ(parsed, 2);
+            commits.push_back("recipes");
+        },
+        [&]() { prepared++; });
+    pipeline.AddStage(
+        "goods", {}, {"goods"}, [&]() { commits.push_back("goods"); },
+        [&]() {
+            parsed = 2;
+            prepared++;
+        });
+
+    auto timings = pipeline.Run();
+    EXPECT_EQ(prepared, 2);
+    std::vector<std::string> expected = {"goods", "recipes"};
+    EXPECT_EQ(commits, expected);
+    ASSERT_EQ(timings.size(), 2);
+    EXPECT_EQ(timings[0].name, "goods");
+    EXPECT_EQ(timings[1].name, "recipes");
+}
+
+TEST(Common_Loading_Pipeline, SkipsStagesThatFailToPrepare) {
+    LoadingPipeline pipeline;
+    std::vector<std::string> commits;
+    pipeline.AddStage(
+        "goods", {}, {"goods"}, [&]() { commits.push_back("goods"); },
+        []() { throw std::runtime_error("bad goods"); });
+    pipeline.AddStage("names", {}, {"names"}, [&]() { commits.push_back("names"); });
+
+    std::vector<LoadingPipeline::StageTiming> timings;
+    EXPECT_NO_THROW(timings = pipeline.Run());
+    std::vector<std::string> expected = {"names"};
+    EXPECT_EQ(commits, expected);
+    EXPECT_EQ(timings.size(), 2);
+}
@@ -0,0 +1,93 @@
+/* Conquer Space
+ * Copyright (C) 2021-2023 Conquer Space
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <string>
+
+#include "common/components/economy.h"
+#include "common/components/name.h"
+#include "common/components/resource.h"
+#include "common/util/memorycensus.h"
+
+namespace cqspc = cqsp::common::components;
+using cqsp::common::util::PoolCensus;
+
+namespace {
+const PoolCensus* FindPool(const cqsp::common::util::MemoryCensus& census, const std::string& name) {
+    auto it = std::find_if(census.pools.begin(), census.pools.end(),
+                           [&](const PoolCensus& pool) { return pool.name == name; });
+    return it == census.pools.end() ? nullptr : &*it;
+}
+}  // namespace
+
+TEST(MemoryCensusTest, CountsPools) {
+    cqsp::common::Universe universe;
+    for (int i = 0; i < 10; i++) {
+        entt::entity entity = universe.create();
+        universe.emplace<cqspc::Identifier>(entity, "entity_" + std::to_string(i));
+        if (i % 2 == 0) {
+            universe.emplace<cqspc::Wallet>(entity);
+        }
+    }
+    auto census = cqsp::common::util::TakeMemoryCensus(universe);
+    EXPECT_EQ(census.alive, 10);
+
+    const PoolCensus* identifiers = FindPool(census, "Identifier");
+    ASSERT_NE(identifiers, nullptr);
+    EXPECT_EQ(identifiers->system, "names");
+    EXPECT_EQ(identifiers->size, 10);
+    EXPECT_GE(identifiers->capacity, 10);
+    EXPECT_GE(identifiers->pool_bytes, 10 * sizeof(cqspc::Identifier));
+
+    const PoolCensus* wallets = FindPool(census, "Wallet");
+    ASSERT_NE(wallets, nullptr);
+    EXPECT_EQ(wallets->system, "economy");
+    EXPECT_EQ(wallets->size, 5);
+    EXPECT_EQ(wallets->heap_bytes, 0);
+}
+
+TEST(MemoryCensusTest, MeasuresLedgers) {
+    cqsp::common::Universe universe;
+    entt::entity good = universe.create();
+    entt::entity entity = universe.create();
+    auto& stockpile = universe.emplace<cqspc::ResourceStockpile>(entity);
+    auto census = cqsp::common::util::TakeMemoryCensus(universe);
+    EXPECT_EQ(FindPool(census, "ResourceStockpile")->heap_bytes, 0);
+
+    stockpile[good] = 10;
+    census = cqsp::common::util::TakeMemoryCensus(universe);
+    size_t one_good = FindPool(census, "ResourceStockpile")->heap_bytes;
+    EXPECT_GT(one_good, 0);
+    EXPECT_EQ(census.SystemTotals()["economy"], FindPool(census, "ResourceStockpile")->TotalBytes());
+    EXPECT_GE(census.TotalBytes(), census.SystemTotals()["economy"]);
+}
+
+TEST(MemoryCensusTest, Format) {
+    cqsp::common::Universe universe;
+    for (int i = 0; i < 3; i++) {
+        universe.emplace<cqspc::Name>(universe.create(), "A name that is too long for small string optimization");
+    }
+    auto census = cqsp::common::util::TakeMemoryCensus(universe);
+    EXPECT_GT(FindPool(census, "Name")->heap_bytes, 0);
+
+    auto lines = cqsp::common::util::FormatMemoryCensus(census, 1);
+    // The summary, one line for the names system and one for the name pool
+    ASSERT_EQ(lines.size(), 3);
+    EXPECT_NE(lines[1].find("names"), std::string::npos);
+    EXPECT_NE(lines[2].find("Name"), std::string::npos);
+}
@@ -0,0 +1,84 @@
+/* Conquer Space
+ * Copyright (C) 2021-2023 Conquer Space
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "common/util/parallel.h"
+
+using cqsp::common::util::ParallelFor;
+
+TEST(ParallelTest, CoversEveryElementOnce) {
+    std::vector<std::atomic<int>> visits(10007);
+    ParallelFor(visits.size(), 1, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            visits[i]++;
+        }
+    });
+    for (size_t i = 0; i < visits.size(); i++) {
+        ASSERT_EQ(visits[i], 1) << i;
+    }
+}
+
+TEST(ParallelTest, ChunksAreMultiplesOfGrain) {
+    std::atomic<bool> aligned = true;
+    ParallelFor(1000, 1, [&](size_t begin, size_t end) {
+        if (begin % 64 != 0 || (end != 1000 && end % 64 != 0)) {
+            aligned = false;
+        }
+    }, 64);
+    EXPECT_TRUE(aligned);
+}
+
+TEST(ParallelTest, SmallLoopsRunOnCaller) {
+    const std::thread::id caller = std::this_thread::get_id();
+    int calls = 0;
+    ParallelFor(10, 100, [&](size_t begin, size_t end) {
+        EXPECT_EQ(std::this_thread::get_id(), caller);
+        EXPECT_EQ(begin, 0u);
+        EXPECT_EQ(end, 10u);
+        calls++;
+    });
+    EXPECT_EQ(calls, 1);
+}
+
+TEST(ParallelTest, NestedLoops) {
+    std::atomic<size_t> total = 0;
+    ParallelFor(64, 1, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            ParallelFor(100, 1, [&](size_t inner_begin, size_t inner_end) { total += inner_end - inner_begin; });
+        }
+    });
+    EXPECT_EQ(total, 6400u);
+}
+
+TEST(ParallelTest, RethrowsExceptions) {
+    std::atomic<size_t> done = 0;
+    EXPECT_THROW(ParallelFor(1000, 1,
+                             [&](size_t begin, size_t end) {
+                                 if (begin == 0) {
+                                     throw std::runtime_error("chunk");
+                                 }
+                                 done += end - begin;
+                             }),
+                 std::runtime_error);
+    // Every other chunk still ran
+    EXPECT_GT(done, 0u);
+}
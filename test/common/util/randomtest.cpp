@@ -0,0 +1,112 @@
+/* Conquer Space
+ * Copyright (C) 2021-2023 Conquer Space
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <gtest/gtest.h>
+
+#include <array>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <vector>
+
+#include "common/util/random/philoxrandom.h"
+#include "common/util/random/stdrandom.h"
+
+using cqsp::common::util::Philox4x32;
+using cqsp::common::util::PhiloxRandom;
+using cqsp::common::util::RandomStreamId;
+
+TEST(RandomTest, PhiloxKnownAnswers) {
+    // Known answer tests from Random123
+    EXPECT_EQ(Philox4x32({0, 0, 0, 0}, {0, 0}),
+              (std::array<uint32_t, 4> {0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8}));
+    EXPECT_EQ(Philox4x32({0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff}, {0xffffffff, 0xffffffff}),
+              (std::array<uint32_t, 4> {0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd}));
+    EXPECT_EQ(Philox4x32({0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344}, {0xa4093822, 0x299f31d0}),
+              (std::array<uint32_t, 4> {0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1}));
+}
+
+TEST(RandomTest, StreamsDontDependOnOrder) {
+    PhiloxRandom random(42);
+    const uint32_t system = RandomStreamId("test");
+    std::vector<int> forward;
+    for (uint32_t entity = 0; entity < 16; entity++) {
+        forward.push_back(random.Stream(system, entity, 100).GetRandomInt(0, 1000000));
+    }
+    // Drawing from the parent, or making the streams in another order doesn't change them
+    random.GetRandomInt(0, 10);
+    for (uint32_t entity = 16; entity-- > 0;) {
+        EXPECT_EQ(random.Split(system, entity, 100)->GetRandomInt(0, 1000000), forward[entity]);
+    }
+    // Different ticks and systems give different streams
+    EXPECT_NE(random.Stream(system, 0, 101).NextUInt64(), random.Stream(system, 0, 100).NextUInt64());
+    EXPECT_NE(random.Stream(RandomStreamId("other"), 0, 100).NextUInt64(),
+              random.Stream(system, 0, 100).NextUInt64());
+}
+
+TEST(RandomTest, RandomIntRange) {
+    PhiloxRandom random(1);
+    std::vector<int> counts(6);
+    for (int i = 0; i < 6000; i++) {
+        int value = random.GetRandomInt(1, 6);
+        ASSERT_GE(value, 1);
+        ASSERT_LE(value, 6);
+        counts[value - 1]++;
+    }
+    for (int count : counts) {
+        EXPECT_NEAR(count, 1000, 150);
+    }
+    EXPECT_EQ(random.GetRandomInt(5, 5), 5);
+    // The whole range of int doesn't overflow
+    random.GetRandomInt(std::numeric_limits<int>::min(), std::numeric_limits<int>::max());
+}
+
+TEST(RandomTest, BatchDistributions) {
+    PhiloxRandom random(7);
+    std::vector<double> uniform(10001);
+    random.FillUniform(uniform);
+    for (double value : uniform) {
+        ASSERT_GE(value, 0);
+        ASSERT_LT(value, 1);
+    }
+    EXPECT_NEAR(std::accumulate(uniform.begin(), uniform.end(), 0.) / uniform.size(), 0.5, 0.02);
+
+    std::vector<double> normal(10001);
+    random.FillNormal(normal, 10, 2);
+    double mean = std::accumulate(normal.begin(), normal.end(), 0.) / normal.size();
+    double variance = 0;
+    for (double value : normal) {
+        variance += (value - mean) * (value - mean);
+    }
+    variance /= normal.size();
+    EXPECT_NEAR(mean, 10, 0.1);
+    EXPECT_NEAR(std::sqrt(variance), 2, 0.1);
+
+    // The same stream gives the same batch
+    std::vector<double> first(64);
+    std::vector<double> second(64);
+    random.Stream(3, 4, 5).FillNormal(first, 0, 1);
+    random.Stream(3, 4, 5).FillNormal(second, 0, 1);
+    EXPECT_EQ(first, second);
+}
+
+TEST(RandomTest, StdRandomSplit) {
+    cqsp::common::util::StdRandom random(42);
+    auto first = random.Split(1, 2, 3);
+    random.GetRandomInt(0, 10);
+    auto second = random.Split(1, 2, 3);
+    EXPECT_EQ(first->GetRandomInt(0, 1000000), second->GetRandomInt(0, 1000000));
+}
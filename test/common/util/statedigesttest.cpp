@@ -0,0 +1,181 @@
+/* Conquer Space
+ * Copyright (C) 2021-2023 Conquer Space
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <gtest/gtest.h>
+
+#include <sstream>
+
+#include "common/components/economy.h"
+#include "common/components/resource.h"
+#include "common/util/statedigest.h"
+
+namespace cqspc = cqsp::common::components;
+using cqsp::common::util::DigestHasher;
+using cqsp::common::util::Divergence;
+using cqsp::common::util::StateDigest;
+
+namespace {
+struct Counter {
+    double value = 0;
+};
+
+int counters_hashed = 0;
+
+void HashCounter(DigestHasher& hasher, const Counter& counter) {
+    counters_hashed++;
+    hasher.Add(counter.value);
+}
+
+void Populate(cqsp::common::Universe& universe) {
+    entt::entity good = universe.create();
+    for (int i = 0; i < 5; i++) {
+        entt::entity entity = universe.create();
+        universe.emplace<cqspc::Wallet>(entity, good, 100.0 * i);
+        auto& stockpile = universe.emplace<cqspc::ResourceStockpile>(entity);
+        stockpile[good] = i;
+    }
+}
+}  // namespace
+
+TEST(StateDigestTest, SameStateSameDigest) {
+    cqsp::common::Universe first;
+    cqsp::common::Universe second;
+    Populate(first);
+    Populate(second);
+    StateDigest first_digest(first);
+    StateDigest second_digest(second);
+    EXPECT_EQ(first_digest.Get(), second_digest.Get());
+    EXPECT_FALSE(cqsp::common::util::FindDivergence(first_digest.Snapshot(), second_digest.Snapshot()));
+}
+
+TEST(StateDigestTest, IncrementalMatchesRehash) {
+    cqsp::common::Universe universe;
+    Populate(universe);
+    StateDigest digest(universe);
+    uint64_t initial = digest.Get();
+
+    // Written through a reference, which the registry doesn't see
+    entt::entity entity = universe.view<cqspc::Wallet>().front();
+    universe.get<cqspc::Wallet>(entity) += 10;
+    digest.Update();
+    EXPECT_NE(digest.Get(), initial);
+    uint64_t incremental = digest.Get();
+    digest.Rehash();
+    EXPECT_EQ(digest.Get(), incremental);
+
+    // Undoing the change brings back the same digest
+    universe.get<cqspc::Wallet>(entity) -= 10;
+    digest.Update();
+    EXPECT_EQ(digest.Get(), initial);
+}
+
+TEST(StateDigestTest, OnlyRehashesPatched) {
+    cqsp::common::Universe universe;
+    entt::entity patched = universe.create();
+    entt::entity untouched = universe.create();
+    universe.emplace<Counter>(patched);
+    universe.emplace<Counter>(untouched);
+    StateDigest digest(universe);
+    digest.Track<Counter>("Counter", HashCounter);
+    digest.Update();
+    uint64_t initial = digest.Get();
+
+    counters_hashed = 0;
+    universe.patch<Counter>(patched).value = 1;
+    digest.Update();
+    EXPECT_EQ(counters_hashed, 1);
+    EXPECT_NE(digest.Get(), initial);
+
+    // Nothing was patched, so nothing is hashed
+    counters_hashed = 0;
+    digest.Update();
+    EXPECT_EQ(counters_hashed, 0);
+}
+
+TEST(StateDigestTest, PatchedMarketChangesDigest) {
+    cqsp::common::Universe universe;
+    entt::entity good = universe.create();
+    entt::entity market = universe.create();
+    universe.emplace<cqspc::Market>(market);
+    StateDigest digest(universe);
+    uint64_t initial = digest.Get();
+
+    universe.patch<cqspc::Market>(market).supply[good] = 10;
+    digest.Update();
+    EXPECT_NE(digest.Get(), initial);
+    uint64_t incremental = digest.Get();
+    digest.Rehash();
+    EXPECT_EQ(digest.Get(), incremental);
+}
+
+TEST(StateDigestTest, TracksAddedAndRemoved) {
+    cqsp::common::Universe universe;
+    Populate(universe);
+    StateDigest digest(universe);
+    uint64_t initial = digest.Get();
+
+    entt::entity entity = universe.create();
+    universe.emplace<cqspc::Wallet>(entity, entt::null, 5.0);
+    digest.Update();
+    EXPECT_NE(digest.Get(), initial);
+
+    universe.destroy(entity);
+    digest.Update();
+    EXPECT_EQ(digest.Get(), initial);
+}
+
+TEST(StateDigestTest, FindDivergence) {
+    cqsp::common::Universe first;
+    cqsp::common::Universe second;
+    Populate(first);
+    Populate(second);
+    entt::entity entity = second.view<cqspc::ResourceStockpile>().back();
+    second.get<cqspc::ResourceStockpile>(entity)[entity] = 1;
+    entt::entity extra = second.create();
+    second.emplace<cqspc::Wallet>(extra);
+
+    StateDigest first_digest(first);
+    StateDigest second_digest(second);
+    EXPECT_NE(first_digest.Get(), second_digest.Get());
+
+    auto divergence = cqsp::common::util::FindDivergence(first_digest.Snapshot(), second_digest.Snapshot());
+    ASSERT_TRUE(divergence);
+    EXPECT_EQ(divergence->component, "ResourceStockpile");
+    EXPECT_EQ(divergence->entity, entity);
+    EXPECT_EQ(divergence->kind, Divergence::Kind::Different);
+
+    second.remove<cqspc::ResourceStockpile>(entity);
+    second_digest.Update();
+    divergence = cqsp::common::util::FindDivergence(first_digest.Snapshot(), second_digest.Snapshot());
+    ASSERT_TRUE(divergence);
+    EXPECT_EQ(divergence->component, "ResourceStockpile");
+    EXPECT_EQ(divergence->kind, Divergence::Kind::OnlyInFirst);
+
+    auto wallets = cqsp::common::util::FindDivergence({{"Wallet", {}}}, second_digest.Snapshot());
+    ASSERT_TRUE(wallets);
+    EXPECT_EQ(wallets->component, "ResourceStockpile");
+    EXPECT_EQ(wallets->kind, Divergence::Kind::OnlyInSecond);
+}
+
+TEST(StateDigestTest, SnapshotRoundTrip) {
+    cqsp::common::Universe universe;
+    Populate(universe);
+    StateDigest digest(universe);
+
+    std::stringstream stream;
+    cqsp::common::util::WriteDigestSnapshot(stream, digest.Snapshot());
+    EXPECT_EQ(cqsp::common::util::ReadDigestSnapshot(stream), digest.Snapshot());
+}
@@ -0,0 +1,64 @@
+/* Conquer Space
+ * Copyright (C) 2021-2023 Conquer Space
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <gtest/gtest.h>
+
+#include <memory_resource>
+#include <thread>
+#include <vector>
+
+#include "common/util/tickarena.h"
+
+using cqsp::common::util::TickArena;
+using cqsp::common::util::TickArenas;
+
+TEST(TickArenaTest, GrowsAfterOverflow) {
+    TickArena arena(1024);
+    {
+        std::pmr::vector<int> small(64, 0, arena.GetResource());
+        EXPECT_EQ(arena.GetOverflow(), 0);
+        std::pmr::vector<int> large(4096, 0, arena.GetResource());
+        EXPECT_GT(arena.GetOverflow(), 0);
+    }
+    arena.Reset();
+    EXPECT_EQ(arena.GetOverflow(), 0);
+    EXPECT_GE(arena.GetCapacity(), 4096 * sizeof(int));
+
+    // The same tick fits in the buffer now
+    std::pmr::vector<int> small(64, 0, arena.GetResource());
+    std::pmr::vector<int> large(4096, 0, arena.GetResource());
+    EXPECT_EQ(arena.GetOverflow(), 0);
+}
+
+TEST(TickArenaTest, ReusesMemory) {
+    TickArena arena(1024);
+    void* first = arena.GetResource()->allocate(128);
+    arena.Reset();
+    void* second = arena.GetResource()->allocate(128);
+    EXPECT_EQ(first, second);
+}
+
+TEST(TickArenaTest, ArenaPerThread) {
+    TickArenas arenas;
+    TickArena* main_arena = &arenas.Local();
+    EXPECT_EQ(main_arena, &arenas.Local());
+    TickArena* worker_arena = nullptr;
+    std::thread worker([&]() { worker_arena = &arenas.Local(); });
+    worker.join();
+    EXPECT_NE(main_arena, worker_arena);
+    EXPECT_EQ(arenas.GetCapacity(), main_arena->GetCapacity() + worker_arena->GetCapacity());
+    arenas.Reset();
+}
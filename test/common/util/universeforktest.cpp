@@ -0,0 +1,156 @@
+/* Conquer Space
+ * Copyright (C) 2021-2023 Conquer Space
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <gtest/gtest.h>
+#include <hjson.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "common/components/bodies.h"
+#include "common/components/economy.h"
+#include "common/components/player.h"
+#include "common/components/resource.h"
+#include "common/forecast.h"
+#include "common/util/random/philoxrandom.h"
+#include "common/util/statedigest.h"
+#include "common/util/universefork.h"
+
+namespace cqspc = cqsp::common::components;
+using cqsp::common::util::ForkUniverse;
+
+namespace {
+void Populate(cqsp::common::Universe& universe) {
+    entt::entity good = universe.create();
+    universe.goods["good"] = good;
+    for (int i = 0; i < 5; i++) {
+        entt::entity entity = universe.create();
+        universe.emplace<cqspc::Wallet>(entity, good, 100.0 * i);
+        auto& stockpile = universe.emplace<cqspc::ResourceStockpile>(entity);
+        stockpile[good] = i;
+    }
+    // Leave a hole in the entities
+    universe.destroy(universe.view<cqspc::Wallet>().front());
+    universe.emplace<cqspc::Player>(universe.create());
+}
+}  // namespace
+
+TEST(UniverseForkTest, SameState) {
+    cqsp::common::Universe source;
+    Populate(source);
+    cqsp::common::Universe fork;
+    auto stats = ForkUniverse(source, fork);
+
+    EXPECT_EQ(stats.entities, source.alive());
+    EXPECT_EQ(fork.alive(), source.alive());
+    EXPECT_EQ(fork.goods, source.goods);
+    for (entt::entity entity : source.view<cqspc::Wallet>()) {
+        ASSERT_TRUE(fork.valid(entity));
+        EXPECT_EQ(fork.get<cqspc::Wallet>(entity).GetBalance(), source.get<cqspc::Wallet>(entity).GetBalance());
+    }
+    EXPECT_EQ(fork.view<cqspc::Player>().size(), 1);
+
+    // Views go through the fork in the same order
+    std::vector<entt::entity> source_order(source.view<cqspc::Wallet>().begin(), source.view<cqspc::Wallet>().end());
+    std::vector<entt::entity> fork_order(fork.view<cqspc::Wallet>().begin(), fork.view<cqspc::Wallet>().end());
+    EXPECT_EQ(fork_order, source_order);
+
+    cqsp::common::util::StateDigest source_digest(source);
+    cqsp::common::util::StateDigest fork_digest(fork);
+    EXPECT_EQ(fork_digest.Get(), source_digest.Get());
+}
+
+TEST(UniverseForkTest, ForkIsIndependent) {
+    cqsp::common::Universe source;
+    Populate(source);
+    cqsp::common::Universe fork;
+    ForkUniverse(source, fork);
+
+    entt::entity entity = fork.view<cqspc::ResourceStockpile>().front();
+    double before = source.get<cqspc::ResourceStockpile>(entity)[source.goods["good"]];
+    fork.get<cqspc::ResourceStockpile>(entity)[fork.goods["good"]] += 10;
+    fork.destroy(fork.view<cqspc::Wallet>().back());
+    fork.create();
+
+    EXPECT_EQ(source.get<cqspc::ResourceStockpile>(entity)[source.goods["good"]], before);
+    EXPECT_EQ(source.view<cqspc::Wallet>().size(), 4);
+}
+
+TEST(UniverseForkTest, LeavesOutUnusedState) {
+    cqsp::common::Universe source;
+    entt::entity planet = source.create();
+    source.emplace<cqspc::bodies::TerrainData>(planet);
+    source.emplace<cqspc::Description>(planet, "Blue");
+    auto& market = source.emplace<cqspc::Market>(planet);
+    market.GDP = 10;
+    market.connected_markets.emplace(planet);
+    for (int i = 0; i < 3; i++) {
+        market.history.push_back(market);
+    }
+
+    cqsp::common::Universe fork;
+    auto stats = ForkUniverse(source, fork);
+    EXPECT_EQ(stats.skipped_pools, 2);
+    EXPECT_FALSE(fork.any_of<cqspc::bodies::TerrainData>(planet));
+    EXPECT_FALSE(fork.any_of<cqspc::Description>(planet));
+
+    const auto& fork_market = fork.get<cqspc::Market>(planet);
+    EXPECT_EQ(fork_market.history.size(), 1);
+    EXPECT_EQ(fork_market.GDP, 10);
+    EXPECT_TRUE(fork_market.connected_markets.contains(planet));
+}
+
+TEST(UniverseForkTest, NamesUseForkRandom) {
+    cqsp::common::Universe source;
+    source.random = std::make_unique<cqsp::common::util::PhiloxRandom>(42);
+    auto& generator = source.name_generators["test"];
+    generator.LoadNameGenerator(Hjson::Unmarshal(R"({
+        name: test
+        rules: { 1: "{first}{second}" }
+        first: [ "Ael", "Ash" ]
+        second: [ "ash", "burn" ]
+    })"));
+    generator.SetRandom(source.random.get());
+
+    cqsp::common::Universe fork;
+    ForkUniverse(source, fork);
+    for (int i = 0; i < 10; i++) {
+        EXPECT_NE(fork.name_generators["test"].Generate("1"), "");
+    }
+
+    // Nothing was drawn from the source
+    cqsp::common::util::PhiloxRandom reference(42);
+    for (int i = 0; i < 10; i++) {
+        EXPECT_EQ(source.random->GetRandomInt(0, 1000000), reference.GetRandomInt(0, 1000000));
+    }
+}
+
+TEST(UniverseForkTest, ForecastLeavesGameAlone) {
+    cqsp::common::Game game;
+    Populate(game.GetUniverse());
+    int date = game.GetUniverse().date.GetDate();
+
+    cqsp::common::systems::simulation::ForecastRequest request;
+    request.days = 2;
+    request.setup = [](cqsp::common::Universe& universe) { universe.create(); };
+    auto result = cqsp::common::systems::simulation::StartForecast(game, request).get();
+
+    EXPECT_EQ(result.start_date, date);
+    EXPECT_EQ(result.end_date, date + 2 * cqspc::StarDate::DAY);
+    EXPECT_EQ(game.GetUniverse().date.GetDate(), date);
+    EXPECT_EQ(game.GetUniverse().alive(), 6);
+}
@@ -0,0 +1,283 @@
+/* Conquer Space
+ * Copyright (C) 2021-2023 Conquer Space
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <gtest/gtest.h>
+#include <spdlog/sinks/null_sink.h>
+
+#include <atomic>
+#include <future>
+#include <memory>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "engine/asset/residency.h"
+#include "engine/enginelogger.h"
+
+namespace {
+// Logs failed loads, and nothing sets up the engine logger in the tests
+void SetUpLogger() {
+    if (cqsp::engine::engine_logger == nullptr) {
+        cqsp::engine::engine_logger = spdlog::null_logger_mt("residencytest");
+    }
+}
+
+class FakeAsset : public cqsp::asset::Asset {
+ public:
+    std::vector<uint8_t> data;
+    cqsp::asset::AssetType GetAssetType() override { return cqsp::asset::AssetType::BINARY; }
+};
+
+/// Pretends to load `size` bytes of GPU memory
+class FakeLoader : public cqsp::asset::ResidentLoader {
+ public:
+    FakeLoader(uint64_t size, std::atomic_int& decodes, bool fail = false)
+        : size(size), decodes(decodes), fail(fail) {}
+
+    bool Decode() override {
+        decodes++;
+        return !fail;
+    }
+
+    cqsp::asset::ResidentSize Upload(cqsp::asset::Asset* asset) override {
+        dynamic_cast<FakeAsset*>(asset)->data.resize(1);
+        return {0, size};
+    }
+
+    void Evict(cqsp::asset::Asset* asset) override { dynamic_cast<FakeAsset*>(asset)->data.clear(); }
+
+ private:
+    uint64_t size;
+    std::atomic_int& decodes;
+    bool fail;
+};
+
+/// Decodes only once the test lets it
+class BlockingLoader : public FakeLoader {
+ public:
+    BlockingLoader(std::atomic_int& decodes, std::shared_future<void> gate, std::atomic_bool& started)
+        : FakeLoader(100, decodes), gate(std::move(gate)), started(started) {}
+
+    bool Decode() override {
+        started = true;
+        gate.wait();
+        return FakeLoader::Decode();
+    }
+
+ private:
+    std::shared_future<void> gate;
+    std::atomic_bool& started;
+};
+}  // namespace
+
+class ResidencyTest : public ::testing::Test {
+ protected:
+    void SetUp() { SetUpLogger(); }
+
+    FakeAsset* Add(uint64_t size, bool fail = false) {
+        assets.push_back(std::make_unique<FakeAsset>());
+        residency.Register(assets.back().get(), std::make_unique<FakeLoader>(size, decodes, fail));
+        return assets.back().get();
+    }
+
+    // Runs frames until the background loads are done
+    void WaitForLoads() {
+        for (int i = 0; i < 1000 && residency.GetLoadCount() + failures < static_cast<int>(assets.size()); i++) {
+            residency.Update();
+            std::this_thread::yield();
+        }
+    }
+
+    std::atomic_int decodes = 0;
+    int failures = 0;
+    std::vector<std::unique_ptr<FakeAsset>> assets;
+    cqsp::asset::ResidencyManager residency;
+};
+
+TEST_F(ResidencyTest, LoadsOnFirstUse) {
+    auto asset = Add(100);
+    EXPECT_TRUE(residency.IsManaged(asset));
+    EXPECT_FALSE(residency.IsResident(asset));
+    EXPECT_EQ(decodes, 0);
+
+    EXPECT_TRUE(residency.Touch(asset));
+    EXPECT_TRUE(residency.IsResident(asset));
+    EXPECT_EQ(asset->data.size(), 1);
+    EXPECT_EQ(residency.GetGpuUsage(), 100);
+
+    // Already resident, so it isn't loaded again
+    EXPECT_TRUE(residency.Touch(asset));
+    EXPECT_EQ(decodes, 1);
+}
+
+TEST_F(ResidencyTest, UnmanagedAssetsAreResident) {
+    FakeAsset asset;
+    EXPECT_FALSE(residency.IsManaged(&asset));
+    EXPECT_TRUE(residency.IsResident(&asset));
+    EXPECT_TRUE(residency.Touch(&asset));
+    EXPECT_TRUE(residency.Request(&asset));
+}
+
+TEST_F(ResidencyTest, EvictsLeastRecentlyUsed) {
+    residency.SetBudget({0, 250});
+    auto first = Add(100);
+    auto second = Add(100);
+    auto third = Add(100);
+
+    residency.Touch(first);
+    residency.Update();
+    residency.Touch(second);
+    residency.Update();
+    residency.Touch(third);
+    residency.Update();
+
+    EXPECT_FALSE(residency.IsResident(first));
+    EXPECT_TRUE(residency.IsResident(second));
+    EXPECT_TRUE(residency.IsResident(third));
+    EXPECT_TRUE(first->data.empty());
+    EXPECT_EQ(residency.GetGpuUsage(), 200);
+    EXPECT_EQ(residency.GetEvictionCount(), 1);
+
+    // Loaded again when it's used
+    EXPECT_TRUE(residency.Touch(first));
+    residency.Update();
+    EXPECT_TRUE(residency.IsResident(first));
+    EXPECT_FALSE(residency.IsResident(second));
+    EXPECT_EQ(decodes, 4);
+}
+
+TEST_F(ResidencyTest, KeepsAssetsUsedThisFrame) {
+    residency.SetBudget({0, 150});
+    auto first = Add(100);
+    auto second = Add(100);
+
+    // Both are needed for the same frame, so neither can go even though that's over budget
+    residency.Touch(first);
+    residency.Touch(second);
+    residency.Update();
+    EXPECT_TRUE(residency.IsResident(first));
+    EXPECT_TRUE(residency.IsResident(second));
+
+    residency.Touch(second);
+    residency.Update();
+    EXPECT_FALSE(residency.IsResident(first));
+    EXPECT_TRUE(residency.IsResident(second));
+}
+
+TEST_F(ResidencyTest, RequestLoadsInBackground) {
+    auto first = Add(100);
+    auto second = Add(100);
+    auto third = Add(100);
+
+    EXPECT_FALSE(residency.Request(first));
+    EXPECT_FALSE(residency.Request(second));
+    residency.Prefetch(third);
+    EXPECT_FALSE(residency.IsResident(first));
+
+    WaitForLoads();
+    EXPECT_TRUE(residency.IsResident(first));
+    EXPECT_TRUE(residency.IsResident(second));
+    EXPECT_TRUE(residency.IsResident(third));
+    EXPECT_TRUE(residency.Request(first));
+    EXPECT_EQ(decodes, 3);
+}
+
+TEST_F(ResidencyTest, TouchFinishesPendingLoad) {
+    auto asset = Add(100);
+    residency.Prefetch(asset);
+    // Starts the background load
+    residency.Update();
+    EXPECT_TRUE(residency.Touch(asset));
+    EXPECT_TRUE(residency.IsResident(asset));
+    EXPECT_EQ(decodes, 1);
+}
+
+TEST_F(ResidencyTest, FailedLoad) {
+    auto asset = Add(100, true);
+    EXPECT_FALSE(residency.Touch(asset));
+    EXPECT_FALSE(residency.IsResident(asset));
+    // Doesn't keep trying
+    EXPECT_FALSE(residency.Touch(asset));
+    EXPECT_EQ(decodes, 1);
+    EXPECT_EQ(residency.GetGpuUsage(), 0);
+}
+
+TEST_F(ResidencyTest, Clear) {
+    auto first = Add(100);
+    auto second = Add(100);
+    residency.Touch(first);
+    residency.Prefetch(second);
+    residency.Update();
+    residency.Clear();
+    EXPECT_EQ(residency.GetManagedCount(), 0);
+    EXPECT_EQ(residency.GetGpuUsage(), 0);
+    EXPECT_TRUE(first->data.empty());
+}
+
+TEST_F(ResidencyTest, ReleaseResident) {
+    FakeAsset asset;
+    asset.data.resize(1);
+    residency.RegisterResident(&asset, std::make_unique<FakeLoader>(100, decodes), {50, 0});
+    EXPECT_TRUE(residency.IsResident(&asset));
+    EXPECT_EQ(residency.GetCpuUsage(), 50);
+
+    cqsp::asset::ResidentSize released = residency.Release(&asset);
+    EXPECT_EQ(released.cpu, 50);
+    EXPECT_FALSE(residency.IsResident(&asset));
+    EXPECT_TRUE(asset.data.empty());
+    EXPECT_EQ(residency.GetCpuUsage(), 0);
+    // Nothing left to release
+    EXPECT_EQ(residency.Release(&asset).cpu, 0);
+
+    // Loaded again on demand
+    EXPECT_TRUE(residency.Touch(&asset));
+    EXPECT_EQ(asset.data.size(), 1);
+    EXPECT_EQ(decodes, 1);
+    residency.Unregister(&asset);
+}
+
+TEST_F(ResidencyTest, BudgetKeepsReleasableAssets) {
+    residency.SetBudget({10, 0});
+    FakeAsset asset;
+    residency.RegisterResident(&asset, std::make_unique<FakeLoader>(100, decodes), {50, 0});
+    residency.Update();
+    residency.Update();
+    EXPECT_TRUE(residency.IsResident(&asset));
+    residency.Unregister(&asset);
+}
+
+TEST_F(ResidencyTest, TouchDoesNotBlockOthers) {
+    std::promise<void> gate;
+    std::atomic_bool started = false;
+    FakeAsset slow;
+    residency.Register(&slow, std::make_unique<BlockingLoader>(decodes, gate.get_future().share(), started));
+    auto fast = Add(100);
+
+    std::thread touching([&]() { EXPECT_TRUE(residency.Touch(&slow)); });
+    while (!started) {
+        std::this_thread::yield();
+    }
+    // The slow asset is still decoding, and the manager can be used meanwhile
+    EXPECT_TRUE(residency.Touch(fast));
+    EXPECT_FALSE(residency.IsResident(&slow));
+    residency.Update();
+
+    gate.set_value();
+    touching.join();
+    EXPECT_TRUE(residency.IsResident(&slow));
+    EXPECT_EQ(decodes, 2);
+    residency.Unregister(&slow);
+}
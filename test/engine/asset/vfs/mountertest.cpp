@@ -0,0 +1,101 @@
+/* Conquer Space
+ * Copyright (C) 2021-2023 Conquer Space
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include "engine/asset/vfs/directoryindex.h"
+#include "engine/asset/vfs/nativevfs.h"
+#include "engine/asset/vfs/vfs.h"
+
+TEST(VirtualMounterTest, ResolveTest) {
+    cqsp::asset::VirtualMounter mounter;
+    auto* nfs = new cqsp::asset::NativeFileSystem("../data/core");
+    ASSERT_TRUE(nfs->Initialize());
+    mounter.AddMountPoint("core", nfs);
+
+    ASSERT_TRUE(mounter.IsFile("core/info.hjson"));
+    ASSERT_TRUE(mounter.Exists("core/info.hjson"));
+    ASSERT_FALSE(mounter.IsDirectory("core/info.hjson"));
+    ASSERT_NE(mounter.Open("core/info.hjson"), nullptr);
+    // Asked twice so that the second one comes from the cache
+    ASSERT_TRUE(mounter.IsFile("core/info.hjson"));
+
+    // Mount points have to match whole path components
+    ASSERT_FALSE(mounter.IsFile("cor/info.hjson"));
+    ASSERT_FALSE(mounter.IsFile("coreinfo.hjson"));
+    ASSERT_EQ(mounter.Open("other/info.hjson"), nullptr);
+    ASSERT_EQ(mounter.OpenDirectory("other/"), nullptr);
+
+    auto root = mounter.OpenDirectory("core/");
+    ASSERT_NE(root, nullptr);
+    cqsp::asset::NativeFileSystem unindexed("../data/core");
+    ASSERT_EQ(root->GetSize(), unindexed.OpenDirectory("")->GetSize());
+}
+
+TEST(VirtualMounterTest, InvalidateTest) {
+    std::filesystem::path root = std::filesystem::temp_directory_path() / "cqsp-mountertest";
+    std::filesystem::remove_all(root);
+    std::filesystem::create_directories(root / "data");
+    std::ofstream(root / "data" / "a.txt") << "a";
+
+    cqsp::asset::VirtualMounter mounter;
+    auto* nfs = new cqsp::asset::NativeFileSystem(root.string());
+    ASSERT_TRUE(nfs->Initialize());
+    mounter.AddMountPoint("test", nfs);
+    ASSERT_TRUE(mounter.IsFile("test/data/a.txt"));
+    ASSERT_TRUE(mounter.IsDirectory("test/data"));
+    ASSERT_FALSE(mounter.Exists("test/data/b.txt"));
+
+    // The index doesn't see new files until it's invalidated
+    std::ofstream(root / "data" / "b.txt") << "bb";
+    ASSERT_FALSE(mounter.Exists("test/data/b.txt"));
+    mounter.Invalidate();
+    ASSERT_TRUE(mounter.IsFile("test/data/b.txt"));
+    auto file = mounter.Open("test/data/b.txt");
+    ASSERT_NE(file, nullptr);
+    ASSERT_EQ(file->Size(), 2);
+    ASSERT_EQ(mounter.OpenDirectory("test/data")->GetSize(), 2);
+
+    file.reset();
+    std::filesystem::remove_all(root);
+}
+
+TEST(DirectoryIndexTest, BuildTest) {
+    cqsp::asset::DirectoryIndex index;
+    ASSERT_FALSE(index.Build("../data/core/does_not_exist"));
+    ASSERT_FALSE(index.IsBuilt());
+
+    ASSERT_TRUE(index.Build("../data/core"));
+    const auto* info = index.Find("info.hjson");
+    ASSERT_NE(info, nullptr);
+    ASSERT_FALSE(info->directory);
+    ASSERT_EQ(info->size, std::filesystem::file_size("../data/core/info.hjson"));
+    const auto* root = index.Find("");
+    ASSERT_NE(root, nullptr);
+    ASSERT_TRUE(root->directory);
+    ASSERT_EQ(index.Find("does_not_exist"), nullptr);
+}
+
+TEST(NormalizePathTest, NormalizeTest) {
+    ASSERT_EQ(cqsp::asset::NormalizePath("/data\\goods/../goods/./a.hjson"), "data/goods/a.hjson");
+    ASSERT_EQ(cqsp::asset::NormalizePath("data//goods/"), "data/goods");
+    ASSERT_EQ(cqsp::asset::NormalizePath(""), "");
+    ASSERT_EQ(cqsp::asset::NormalizePath("../a"), "a");
+}
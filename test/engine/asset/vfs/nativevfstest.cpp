@@ -17,7 +17,10 @@
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
+#include <algorithm>
 #include <filesystem>
+#include <span>
+#include <vector>
 
 #include "engine/asset/vfs/nativevfs.h"
 
@@ -78,6 +81,17 @@ TEST_F(NativeVfsTest, FileReadTest) {
     nfs.Close(ptr);
 }
 
+TEST_F(NativeVfsTest, MapTest) {
+    auto ptr = nfs.Open(test_file, cqsp::asset::FileModes::None);
+    std::span<const uint8_t> view = ptr->Map();
+    ASSERT_EQ(view.size(), ptr->Size());
+
+    // Mapping shouldn't move the file position, so reading gives the same bytes
+    std::vector<uint8_t> read = cqsp::asset::ReadAllFromVFile(ptr.get());
+    ASSERT_TRUE(std::equal(view.begin(), view.end(), read.begin(), read.end()));
+    nfs.Close(ptr);
+}
+
 TEST_F(NativeVfsTest, SeekTest) {
     int size = std::filesystem::file_size(full_name);
 
@@ -0,0 +1,167 @@
+/* Conquer Space
+ * Copyright (C) 2021-2023 Conquer Space
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <gtest/gtest.h>
+#include <spdlog/sinks/null_sink.h>
+
+#include <algorithm>
+#include <filesystem>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "engine/asset/vfs/blockcompression.h"
+#include "engine/asset/vfs/nativevfs.h"
+#include "engine/asset/vfs/packvfs.h"
+#include "engine/asset/vfs/packwriter.h"
+#include "engine/enginelogger.h"
+
+namespace {
+// The pack code logs, and nothing sets up the engine logger in the tests
+void SetUpLogger() {
+    if (cqsp::engine::engine_logger == nullptr) {
+        cqsp::engine::engine_logger = spdlog::null_logger_mt("packvfstest");
+    }
+}
+}  // namespace
+
+class PackVfsTest : public ::testing::TestWithParam<bool> {
+ protected:
+    PackVfsTest()
+        : pack_path((std::filesystem::temp_directory_path() / "cqsp-packvfstest.cqpk").string()),
+          nfs(package_root),
+          pfs(pack_path) {}
+
+    void SetUp() {
+        SetUpLogger();
+        if (!std::filesystem::exists(package_root)) {
+            FAIL() << "Directory " << package_root << ", which is needed for this test";
+        }
+        cqsp::asset::PackWriterOptions options;
+        options.compress = GetParam();
+        ASSERT_TRUE(cqsp::asset::WritePack(package_root, pack_path, options));
+        nfs.Initialize();
+        ASSERT_TRUE(pfs.Initialize());
+    }
+
+    void TearDown() { std::filesystem::remove(pack_path); }
+
+    std::string package_root = "../data/core";
+    std::string pack_path;
+    cqsp::asset::NativeFileSystem nfs;
+    cqsp::asset::PackFileSystem pfs;
+};
+
+TEST_P(PackVfsTest, ContentsTest) {
+    auto native_dir = nfs.OpenDirectory("");
+    auto pack_dir = pfs.OpenDirectory("");
+    ASSERT_NE(native_dir, nullptr);
+    ASSERT_NE(pack_dir, nullptr);
+    ASSERT_EQ(native_dir->GetSize(), pack_dir->GetSize());
+    ASSERT_EQ(pfs.GetEntryCount(), pack_dir->GetSize());
+
+    for (uint64_t i = 0; i < native_dir->GetSize(); i++) {
+        const std::string& name = native_dir->GetFilename(i);
+        ASSERT_TRUE(pfs.IsFile(name)) << name;
+        auto native_file = native_dir->GetFile(i);
+        auto pack_file = pfs.Open(name);
+        ASSERT_NE(pack_file, nullptr) << name;
+        ASSERT_EQ(native_file->Size(), pack_file->Size()) << name;
+
+        std::vector<uint8_t> native_buffer;
+        std::vector<uint8_t> pack_buffer;
+        auto native_view = cqsp::asset::ViewVFile(native_file.get(), native_buffer);
+        auto pack_view = cqsp::asset::ViewVFile(pack_file.get(), pack_buffer);
+        ASSERT_TRUE(std::equal(native_view.begin(), native_view.end(), pack_view.begin(), pack_view.end())) << name;
+    }
+}
+
+TEST_P(PackVfsTest, ReadTest) {
+    auto file = pfs.Open("info.hjson");
+    ASSERT_NE(file, nullptr);
+    std::string streamed = cqsp::asset::ReadAllFromVFileToString(file.get());
+    auto native_file = nfs.Open("info.hjson", cqsp::asset::FileModes::None);
+    ASSERT_EQ(streamed, cqsp::asset::ReadAllFromVFileToString(native_file.get()));
+
+    // Seek back and read a slice
+    ASSERT_TRUE(file->Seek(1, cqsp::asset::Offset::Beg));
+    std::vector<uint8_t> buffer(4);
+    file->Read(buffer.data(), static_cast<int>(buffer.size()));
+    ASSERT_EQ(std::string(buffer.begin(), buffer.end()), streamed.substr(1, 4));
+    ASSERT_EQ(file->Tell(), 5);
+}
+
+TEST_P(PackVfsTest, LookupTest) {
+    ASSERT_TRUE(pfs.IsFile("info.hjson"));
+    ASSERT_TRUE(pfs.IsFile("./info.hjson"));
+    ASSERT_TRUE(pfs.Exists("info.hjson"));
+    ASSERT_FALSE(pfs.IsDirectory("info.hjson"));
+    ASSERT_FALSE(pfs.IsFile("does_not_exist.hjson"));
+    ASSERT_FALSE(pfs.Exists("does_not_exist.hjson"));
+    ASSERT_EQ(pfs.Open("does_not_exist.hjson"), nullptr);
+    ASSERT_EQ(pfs.OpenDirectory("does_not_exist"), nullptr);
+
+    // Every directory that the native filesystem has should be in the pack too
+    for (const auto& entry : std::filesystem::recursive_directory_iterator(package_root)) {
+        if (!entry.is_directory()) {
+            continue;
+        }
+        std::string name = std::filesystem::relative(entry.path(), package_root).generic_string();
+        if (std::filesystem::is_empty(entry.path())) {
+            continue;
+        }
+        ASSERT_TRUE(pfs.IsDirectory(name)) << name;
+        ASSERT_TRUE(pfs.Exists(name)) << name;
+        ASSERT_FALSE(pfs.IsFile(name)) << name;
+        ASSERT_EQ(pfs.OpenDirectory(name)->GetSize(), nfs.OpenDirectory(name)->GetSize()) << name;
+    }
+}
+
+INSTANTIATE_TEST_SUITE_P(PackVfs, PackVfsTest, ::testing::Values(false, true));
+
+TEST(PackVfsTest, InvalidPackTest) {
+    SetUpLogger();
+    cqsp::asset::PackFileSystem pfs("../data/core/info.hjson");
+    ASSERT_FALSE(pfs.Initialize());
+    ASSERT_FALSE(pfs.IsFile("info.hjson"));
+    ASSERT_EQ(pfs.Open("info.hjson"), nullptr);
+}
+
+TEST(BlockCompressionTest, RoundTripTest) {
+    std::vector<uint8_t> data(100000);
+    // Repetitive with some noise so that there are both matches and literals
+    uint32_t state = 1;
+    for (size_t i = 0; i < data.size(); i++) {
+        state = state * 1664525 + 1013904223;
+        data[i] = (i % 64 < 48) ? static_cast<uint8_t>(i % 7) : static_cast<uint8_t>(state >> 24);
+    }
+    std::vector<uint8_t> compressed = cqsp::asset::CompressBlock(data);
+    ASSERT_LT(compressed.size(), data.size());
+
+    std::vector<uint8_t> output(data.size());
+    ASSERT_TRUE(cqsp::asset::DecompressBlock(compressed, output));
+    ASSERT_EQ(data, output);
+
+    // Wrong output size has to fail instead of overrunning
+    std::vector<uint8_t> short_output(data.size() - 1);
+    ASSERT_FALSE(cqsp::asset::DecompressBlock(compressed, short_output));
+}
+
+TEST(BlockCompressionTest, EmptyTest) {
+    std::vector<uint8_t> compressed = cqsp::asset::CompressBlock({});
+    std::vector<uint8_t> output;
+    ASSERT_TRUE(cqsp::asset::DecompressBlock(compressed, output));
+}
@@ -0,0 +1,89 @@
+/* Conquer Space
+ * Copyright (C) 2021-2023 Conquer Space
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <AL/al.h>
+#include <AL/alc.h>
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <thread>
+
+#include "engine/audio/musicstream.h"
+
+/// <summary>
+/// Needs an OpenAL device, OpenAL Soft's null backend works for this (ALSOFT_DRIVERS=null).
+/// </summary>
+class MusicStreamTest : public ::testing::Test {
+ protected:
+    void SetUp() override {
+        device = alcOpenDevice(nullptr);
+        if (device == nullptr) {
+            GTEST_SKIP() << "No OpenAL device";
+        }
+        context = alcCreateContext(device, nullptr);
+        alcMakeContextCurrent(context);
+        alGenSources(1, &source);
+    }
+
+    void TearDown() override {
+        if (device == nullptr) {
+            return;
+        }
+        alDeleteSources(1, &source);
+        alcMakeContextCurrent(nullptr);
+        alcDestroyContext(context);
+        alcCloseDevice(device);
+    }
+
+    ALCdevice* device = nullptr;
+    ALCcontext* context = nullptr;
+    ALuint source = 0;
+};
+
+TEST_F(MusicStreamTest, OpenTest) {
+    cqsp::engine::audio::MusicStream stream(source);
+    ASSERT_TRUE(stream.Open("../data/core/music/Starlight.ogg"));
+    ASSERT_GT(stream.Length(), 0);
+    ASSERT_GT(stream.GetSampleRate(), 0);
+    ASSERT_TRUE(stream.GetChannels() == 1 || stream.GetChannels() == 2);
+
+    cqsp::engine::audio::MusicStream missing(source);
+    ASSERT_FALSE(missing.Open("../data/core/music/does_not_exist.ogg"));
+    ASSERT_FALSE(missing.Open("../data/core/music/music_list.hjson"));
+}
+
+TEST_F(MusicStreamTest, PlayTest) {
+    {
+        cqsp::engine::audio::MusicStream stream(source);
+        ASSERT_TRUE(stream.Open("../data/core/music/Starlight.ogg"));
+        stream.Play();
+        ASSERT_FALSE(stream.IsFinished());
+
+        // Let the worker go around a few times, the ring should never grow
+        for (int i = 0; i < 10; i++) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(30));
+            ALint queued = 0;
+            alGetSourcei(source, AL_BUFFERS_QUEUED, &queued);
+            ASSERT_LE(queued, cqsp::engine::audio::MusicStream::buffer_count);
+            ASSERT_GT(queued, 0);
+        }
+    }
+    // Destroying the stream detaches the buffers from the source
+    ALint queued = -1;
+    alGetSourcei(source, AL_BUFFERS_QUEUED, &queued);
+    ASSERT_EQ(queued, 0);
+    ASSERT_EQ(alGetError(), AL_NO_ERROR);
+}
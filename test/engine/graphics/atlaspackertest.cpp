@@ -0,0 +1,72 @@
+/* Conquer Space
+ * Copyright (C) 2021-2023 Conquer Space
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "engine/graphics/atlaspacker.h"
+
+namespace {
+bool Overlaps(const glm::ivec2& a_pos, const glm::ivec2& a_size, const glm::ivec2& b_pos, const glm::ivec2& b_size) {
+    return a_pos.x < b_pos.x + b_size.x && b_pos.x < a_pos.x + a_size.x && a_pos.y < b_pos.y + b_size.y &&
+           b_pos.y < a_pos.y + a_size.y;
+}
+}  // namespace
+
+TEST(AtlasPackerTest, PacksWithoutOverlap) {
+    cqsp::engine::AtlasPacker packer(128, 128);
+    std::vector<glm::ivec2> positions;
+    std::vector<glm::ivec2> sizes;
+    for (int i = 0; i < 40; i++) {
+        glm::ivec2 size(5 + i % 7, 8 + i % 5);
+        glm::ivec2 position;
+        ASSERT_TRUE(packer.Pack(size, position));
+        EXPECT_GE(position.x, 0);
+        EXPECT_GE(position.y, 0);
+        EXPECT_LE(position.x + size.x, 128);
+        EXPECT_LE(position.y + size.y, 128);
+        for (size_t j = 0; j < positions.size(); j++) {
+            EXPECT_FALSE(Overlaps(position, size, positions[j], sizes[j]));
+        }
+        positions.push_back(position);
+        sizes.push_back(size);
+    }
+}
+
+TEST(AtlasPackerTest, ReusesShelves) {
+    cqsp::engine::AtlasPacker packer(64, 64, 0);
+    glm::ivec2 first;
+    glm::ivec2 second;
+    ASSERT_TRUE(packer.Pack(glm::ivec2(10, 10), first));
+    ASSERT_TRUE(packer.Pack(glm::ivec2(10, 8), second));
+    // The shorter rectangle fits on the first shelf
+    EXPECT_EQ(first.y, second.y);
+    EXPECT_EQ(second.x, 10);
+}
+
+TEST(AtlasPackerTest, ReportsFull) {
+    cqsp::engine::AtlasPacker packer(16, 16, 0);
+    glm::ivec2 position;
+    EXPECT_FALSE(packer.Pack(glm::ivec2(17, 1), position));
+    for (int i = 0; i < 4; i++) {
+        EXPECT_TRUE(packer.Pack(glm::ivec2(16, 4), position));
+    }
+    EXPECT_FALSE(packer.Pack(glm::ivec2(1, 1), position));
+    packer.Clear();
+    EXPECT_TRUE(packer.Pack(glm::ivec2(1, 1), position));
+    EXPECT_EQ(position, glm::ivec2(0, 0));
+}
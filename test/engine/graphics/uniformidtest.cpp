@@ -0,0 +1,32 @@
+/* Conquer Space
+ * Copyright (C) 2021-2023 Conquer Space
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "engine/graphics/shader.h"
+
+TEST(UniformIdTest, InternsNames) {
+    cqsp::asset::UniformId model("uniformidtest_model");
+    cqsp::asset::UniformId model_again(std::string("uniformidtest_model"));
+    cqsp::asset::UniformId view("uniformidtest_view");
+
+    ASSERT_EQ(model, model_again);
+    ASSERT_NE(model.Index(), view.Index());
+    ASSERT_EQ(model.Name(), "uniformidtest_model");
+    ASSERT_EQ(view.Name(), "uniformidtest_view");
+}
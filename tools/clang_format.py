@@ -1,9 +1,9 @@
-# Clang Format all the files in src and test
+# Clang Format all the files in src, test and benchmark
 
 import os
 import subprocess
 
-dirs = ['src', 'test']
+dirs = ['src', 'test', 'benchmark']
 extensions = ['h', 'cpp']
 
 def is_cpp_file(file):
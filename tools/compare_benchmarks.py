@@ -0,0 +1,50 @@
+# Compares two runs of cqsp-bench, written with --benchmark_out_format=json
+# Usage: python compare_benchmarks.py before.json after.json [threshold percent]
+
+import json
+import sys
+
+def load(path):
+    with open(path) as f:
+        data = json.load(f)
+    results = {}
+    for bench in data['benchmarks']:
+        # Skip the mean, median and stddev rows of repeated runs
+        if bench.get('run_type') == 'aggregate':
+            continue
+        # Times are in the unit of each benchmark, which is the same in both runs
+        results[bench['name']] = bench['cpu_time']
+    return results
+
+def compare(before_path, after_path, threshold):
+    before = load(before_path)
+    after = load(after_path)
+    width = max([len(name) for name in after] + [9])
+    print(f"{'Benchmark':<{width}} {'Before':>12} {'After':>12} {'Change':>9}")
+    regressions = 0
+    for name, after_time in after.items():
+        if name not in before:
+            print(f"{name:<{width}} {'':>12} {after_time:>12.1f} {'new':>9}")
+            continue
+        before_time = before[name]
+        change = (after_time - before_time) / before_time * 100 if before_time > 0 else 0
+        marker = ''
+        if change > threshold:
+            marker = ' slower'
+            regressions += 1
+        elif change < -threshold:
+            marker = ' faster'
+        print(f"{name:<{width}} {before_time:>12.1f} {after_time:>12.1f} {change:>+8.1f}%{marker}")
+    for name in before:
+        if name not in after:
+            print(f"{name:<{width}} {before[name]:>12.1f} {'':>12} {'removed':>9}")
+    return regressions
+
+if __name__ == "__main__":
+    if len(sys.argv) < 3:
+        print("Usage: python compare_benchmarks.py before.json after.json [threshold percent]")
+        sys.exit(1)
+    threshold = float(sys.argv[3]) if len(sys.argv) > 3 else 5
+    regressions = compare(sys.argv[1], sys.argv[2], threshold)
+    # Fail if anything got slower, so that this can be used in scripts
+    sys.exit(1 if regressions > 0 else 0)
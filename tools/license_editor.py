@@ -3,7 +3,7 @@ import datetime
 import os
 import glob
 
-dirs = ["src", "test"]
+dirs = ["src", "test", "benchmark"]
 
 # Open the file, replace the line?
 copyright = f"Copyright (C) 2021-{datetime.date.today().year} Conquer Space"